@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+Compare two json results of benchmark_operators.
+
+Usage: compare.py base.json new.json [--threshold 5] [--fail-on-regression]
+
+Cases are matched by group, name, dtype and threads, and compared by median time.
+Speedup over 1 means new is faster. Cases changed over threshold percent are marked.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        results = json.load(f)["results"]
+    return {(r["group"], r["name"], r["dtype"], r["threads"]): r for r in results}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two benchmark_operators json results.")
+    parser.add_argument("base", help="json of baseline run")
+    parser.add_argument("new", help="json of new run")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="percent of median time change to be marked, default 5")
+    parser.add_argument("--fail-on-regression", action="store_true",
+                        help="exit with 1 if any case is slower over threshold")
+    args = parser.parse_args()
+
+    base = load(args.base)
+    new = load(args.new)
+
+    title = "{:<60} {:<8} {:>3} {:>12} {:>12} {:>8}".format(
+        "case", "dtype", "t", "base(ms)", "new(ms)", "speedup")
+    print(title)
+    print("-" * len(title))
+
+    regressions = 0
+    improvements = 0
+    for key in sorted(base.keys()):
+        if key not in new:
+            continue
+        group, name, dtype, threads = key
+        base_ms = base[key]["median_ms"]
+        new_ms = new[key]["median_ms"]
+        speedup = base_ms / new_ms if new_ms > 0 else float("inf")
+        change = (new_ms - base_ms) / base_ms * 100 if base_ms > 0 else 0
+        mark = ""
+        if change > args.threshold:
+            mark = "  slower"
+            regressions += 1
+        elif change < -args.threshold:
+            mark = "  faster"
+            improvements += 1
+        print("{:<60} {:<8} {:>3} {:>12.3f} {:>12.3f} {:>7.2f}x{}".format(
+            group + "/" + name, dtype, threads, base_ms, new_ms, speedup, mark))
+
+    only_base = sorted(set(base.keys()) - set(new.keys()))
+    only_new = sorted(set(new.keys()) - set(base.keys()))
+    for title, keys in (("Only in base:", only_base), ("Only in new:", only_new)):
+        if keys:
+            print(title)
+            for group, name, dtype, threads in keys:
+                print("    {}/{} {} t={}".format(group, name, dtype, threads))
+
+    print("{} faster, {} slower over {}%".format(improvements, regressions, args.threshold))
+
+    if args.fail_on_regression and regressions:
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,75 @@
+#include "operator_benchmark.h"
+
+namespace ts {
+    namespace bench {
+        struct ConvParam {
+            int batch, channels, height, width;
+            int number, kernel, stride;
+        };
+
+        static Bubble conv_bubble(const std::string &op, int kernel, int stride) {
+            Bubble bubble(op, op);
+            auto pad = kernel / 2;
+            bubble.set(name::format, tensor::from(name::NCHW));
+            bubble.set(name::padding, padding4x2(pad, pad, pad, pad));
+            bubble.set(name::stride, nchw4(stride, stride));
+            bubble.set(name::dilation, nchw4(1, 1));
+            return bubble;
+        }
+
+        static std::vector<Case> conv2d(DTYPE dtype) {
+            // typical layers in ResNet and VGG
+            static const std::vector<ConvParam> params = {
+                    {1, 3, 224, 224, 64, 7, 2},
+                    {1, 64, 56, 56, 64, 3, 1},
+                    {1, 128, 56, 56, 128, 3, 2},
+                    {1, 256, 14, 14, 256, 3, 1},
+                    {1, 512, 7, 7, 512, 3, 1},
+                    {1, 64, 56, 56, 256, 1, 1},
+                    {1, 256, 56, 56, 64, 1, 1},
+                    {1, 1024, 14, 14, 256, 1, 1},
+                    {8, 64, 56, 56, 64, 3, 1},
+            };
+            std::vector<Case> cases;
+            for (auto &p : params) {
+                auto pad = p.kernel / 2;
+                auto oh = (p.height + 2 * pad - p.kernel) / p.stride + 1;
+                auto ow = (p.width + 2 * pad - p.kernel) / p.stride + 1;
+                auto x = random(dtype, {p.batch, p.channels, p.height, p.width});
+                auto w = random(dtype, {p.number, p.channels, p.kernel, p.kernel});
+                double flops = 2.0 * p.batch * p.number * oh * ow * p.channels * p.kernel * p.kernel;
+                cases.emplace_back(conv_string(p.kernel, p.stride) + " " + to_string(x.sizes()) + " -> " + std::to_string(p.number),
+                                   conv_bubble(name::layer::conv2d(), p.kernel, p.stride), std::vector<Tensor>({x, w}), flops);
+            }
+            return cases;
+        }
+
+        static std::vector<Case> depthwise_conv2d(DTYPE dtype) {
+            // typical layers in MobileNet
+            static const std::vector<ConvParam> params = {
+                    {1, 32, 112, 112, 1, 3, 1},
+                    {1, 96, 112, 112, 1, 3, 2},
+                    {1, 144, 56, 56, 1, 3, 1},
+                    {1, 576, 14, 14, 1, 3, 1},
+                    {1, 960, 7, 7, 1, 3, 1},
+                    {1, 32, 112, 112, 1, 5, 1},
+            };
+            std::vector<Case> cases;
+            for (auto &p : params) {
+                auto pad = p.kernel / 2;
+                auto oh = (p.height + 2 * pad - p.kernel) / p.stride + 1;
+                auto ow = (p.width + 2 * pad - p.kernel) / p.stride + 1;
+                auto x = random(dtype, {p.batch, p.channels, p.height, p.width});
+                auto w = random(dtype, {p.number, p.channels, p.kernel, p.kernel});
+                double flops = 2.0 * p.batch * p.channels * oh * ow * p.kernel * p.kernel;
+                cases.emplace_back(conv_string(p.kernel, p.stride) + " " + to_string(x.sizes()),
+                                   conv_bubble(name::layer::depthwise_conv2d(), p.kernel, p.stride),
+                                   std::vector<Tensor>({x, w}), flops);
+            }
+            return cases;
+        }
+    }
+}
+
+TS_REGISTER_BENCHMARK("conv2d", ts::bench::conv2d)
+TS_REGISTER_BENCHMARK("depthwise_conv2d", ts::bench::depthwise_conv2d)
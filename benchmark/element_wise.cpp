@@ -0,0 +1,40 @@
+#include "operator_benchmark.h"
+
+namespace ts {
+    namespace bench {
+        static std::vector<Case> add(DTYPE dtype) {
+            static const std::vector<std::pair<Shape, Shape>> params = {
+                    {{1, 64, 112, 112}, {1, 64, 112, 112}},
+                    {{1, 64, 112, 112}, {1, 64, 1, 1}},     // bias
+                    {{1, 64, 112, 112}, {1}},               // scalar
+            };
+            std::vector<Case> cases;
+            for (auto &p : params) {
+                Bubble bubble(name::layer::add(), name::layer::add());
+                auto lhs = random(dtype, p.first);
+                auto rhs = random(dtype, p.second);
+                cases.emplace_back(to_string(p.first) + " + " + to_string(p.second),
+                                   bubble, std::vector<Tensor>({lhs, rhs}), double(lhs.count()));
+            }
+            return cases;
+        }
+
+        static std::vector<Case> relu(DTYPE dtype) {
+            Bubble bubble(name::layer::relu(), name::layer::relu());
+            auto x = random(dtype, {1, 64, 112, 112});
+            return {Case(to_string(x.sizes()), bubble, {x}, double(x.count()))};
+        }
+
+        static std::vector<Case> concat(DTYPE dtype) {
+            Bubble bubble(name::layer::concat(), name::layer::concat());
+            bubble.set(name::dim, tensor::from<int32_t>(1));
+            auto a = random(dtype, {1, 128, 56, 56});
+            auto b = random(dtype, {1, 128, 56, 56});
+            return {Case(to_string(a.sizes()) + " x 2 dim=1", bubble, {a, b})};
+        }
+    }
+}
+
+TS_REGISTER_BENCHMARK("add", ts::bench::add)
+TS_REGISTER_BENCHMARK("relu", ts::bench::relu)
+TS_REGISTER_BENCHMARK("concat", ts::bench::concat)
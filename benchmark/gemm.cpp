@@ -0,0 +1,58 @@
+#include "operator_benchmark.h"
+
+namespace ts {
+    namespace bench {
+        struct MatMulParam {
+            int m, n, k;
+        };
+
+        static std::string mnk_string(const MatMulParam &p) {
+            return "m" + std::to_string(p.m) + "n" + std::to_string(p.n) + "k" + std::to_string(p.k);
+        }
+
+        static std::vector<Case> gemm(DTYPE dtype) {
+            static const std::vector<MatMulParam> params = {
+                    {64, 64, 64},
+                    {256, 256, 256},
+                    {1024, 1024, 1024},
+                    {1, 1000, 2048},
+                    {3136, 64, 576},    // im2col of conv 3x3 [1, 64, 56, 56]
+            };
+            std::vector<Case> cases;
+            for (auto &p : params) {
+                Bubble bubble(name::layer::gemm(), name::layer::gemm());
+                bubble.set(name::alpha, tensor::from<float>(1.0f));
+                bubble.set(name::beta, tensor::from<float>(1.0f));
+                bubble.set(name::transA, tensor::from<bool>(false));
+                bubble.set(name::transB, tensor::from<bool>(false));
+                auto A = random(dtype, {p.m, p.k});
+                auto B = random(dtype, {p.k, p.n});
+                auto C = random(dtype, {p.m, p.n});
+                double flops = 2.0 * p.m * p.n * p.k + 2.0 * p.m * p.n;
+                cases.emplace_back(mnk_string(p), bubble, std::vector<Tensor>({A, B, C}), flops);
+            }
+            return cases;
+        }
+
+        static std::vector<Case> inner_prod(DTYPE dtype) {
+            static const std::vector<MatMulParam> params = {
+                    {1, 1000, 2048},
+                    {1, 4096, 4096},
+                    {32, 512, 512},
+                    {128, 128, 1152},
+            };
+            std::vector<Case> cases;
+            for (auto &p : params) {
+                Bubble bubble(name::layer::inner_prod(), name::layer::inner_prod());
+                auto A = random(dtype, {p.m, p.k});
+                auto B = random(dtype, {p.k, p.n});
+                double flops = 2.0 * p.m * p.n * p.k;
+                cases.emplace_back(mnk_string(p), bubble, std::vector<Tensor>({A, B}), flops);
+            }
+            return cases;
+        }
+    }
+}
+
+TS_REGISTER_BENCHMARK("gemm", ts::bench::gemm)
+TS_REGISTER_BENCHMARK("inner_prod", ts::bench::inner_prod)
@@ -0,0 +1,50 @@
+#include "operator_benchmark.h"
+#include "utils/random.h"
+
+namespace ts {
+    namespace bench {
+        /**
+         * boxes in xyxy mode, clustered like detector outputs, so suppression happens
+         */
+        static Tensor random_boxes(int count) {
+            Tensor boxes(FLOAT32, {count, 4});
+            Random rand(4399);
+            auto data = boxes.data<float>();
+            for (int i = 0; i < count; ++i) {
+                auto cluster = rand.next(0, 63);
+                auto cx = float(cluster % 8) * 80 + float(rand.u()) * 16;
+                auto cy = float(cluster / 8) * 80 + float(rand.u()) * 16;
+                auto w = 20 + float(rand.u()) * 40;
+                auto h = 20 + float(rand.u()) * 40;
+                data[i * 4 + 0] = cx - w / 2;
+                data[i * 4 + 1] = cy - h / 2;
+                data[i * 4 + 2] = cx + w / 2;
+                data[i * 4 + 3] = cy + h / 2;
+            }
+            return boxes;
+        }
+
+        static std::vector<Case> non_max_suppression_v3(DTYPE dtype) {
+            static const std::vector<std::pair<int, int>> params = {
+                    {1000, 100},
+                    {6000, 300},
+                    {20000, 1000},
+            };
+            std::vector<Case> cases;
+            for (auto &p : params) {
+                Bubble bubble(name::layer::non_max_suppression_v3(), name::layer::non_max_suppression_v3());
+                bubble.set(name::max_output_size, tensor::from<int32_t>(p.second));
+                bubble.set(name::iou_threshold, tensor::from<float>(0.5f));
+                bubble.set(name::score_threshold, tensor::from<float>(0.05f));
+                bubble.set(name::mode, tensor::from("xyxy"));
+                auto boxes = tensor::cast(dtype, random_boxes(p.first));
+                auto scores = random(dtype, {p.first}, 0, 1);
+                cases.emplace_back(std::to_string(p.first) + " boxes -> " + std::to_string(p.second),
+                                   bubble, std::vector<Tensor>({boxes, scores}));
+            }
+            return cases;
+        }
+    }
+}
+
+TS_REGISTER_BENCHMARK("non_max_suppression_v3", ts::bench::non_max_suppression_v3)
@@ -0,0 +1,251 @@
+#include "operator_benchmark.h"
+
+#include "runtime/workbench.h"
+#include "utils/random.h"
+#include "utils/except.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+/**
+ * Operator micro benchmarks, build with -DTS_BUILD_BENCHMARKS=ON -DTS_USE_DEBUG_API=ON
+ * Usage: benchmark_operators [options]
+ *     --filter <text>         only run cases which "group/name" contains text
+ *     --threads <n[,n...]>    thread numbers, default 1
+ *     --dtypes <t[,t...]>     float32, float64 or float16, default float32
+ *     --time <seconds>        min running time of each case, default 0.3
+ *     --json <path>           write results in json, compare two of them by benchmark/compare.py
+ *     --list                  list cases only
+ */
+
+namespace ts {
+    namespace bench {
+        static std::vector<std::pair<std::string, Generator>> &registry() {
+            static std::vector<std::pair<std::string, Generator>> generators;
+            return generators;
+        }
+
+        void Registry::Register(const std::string &group, const Generator &generator) {
+            registry().emplace_back(group, generator);
+        }
+
+        const std::vector<std::pair<std::string, Generator>> &Registry::All() {
+            return registry();
+        }
+
+        Tensor random(DTYPE dtype, const Shape &shape, float low, float high) {
+            Tensor x(FLOAT32, shape);
+            Random rand(4399);
+            auto data = x.data<float>();
+            auto count = x.count();
+            for (int i = 0; i < count; ++i) {
+                data[i] = low + float(rand.u()) * (high - low);
+            }
+            return dtype == FLOAT32 ? x : tensor::cast(dtype, x);
+        }
+
+        Tensor padding4x2(int top, int bottom, int left, int right) {
+            return tensor::build(INT32, Shape({4, 2}), {0, 0, 0, 0, top, bottom, left, right});
+        }
+
+        Tensor nchw4(int height, int width) {
+            return tensor::from<int32_t>({1, 1, height, width});
+        }
+    }
+}
+
+using namespace ts;
+
+struct Result {
+    std::string group;
+    std::string name;
+    DTYPE dtype;
+    int threads;
+    int iterations;
+    double median_ms;
+    double min_ms;
+    double mean_ms;
+    double gflops;
+    double gbps;
+};
+
+static std::vector<std::string> split(const std::string &str, char sep) {
+    std::vector<std::string> items;
+    std::istringstream iss(str);
+    std::string item;
+    while (std::getline(iss, item, sep)) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static DTYPE parse_dtype(const std::string &str) {
+    if (str == "float32") return FLOAT32;
+    if (str == "float64") return FLOAT64;
+    if (str == "float16") return FLOAT16;
+    std::cerr << "Unsupported dtype: " << str << std::endl;
+    std::exit(1);
+}
+
+static double bytes_of(const std::vector<Tensor> &tensors) {
+    double bytes = 0;
+    for (auto &tensor : tensors) {
+        for (size_t i = 0; i < tensor.fields_count(); ++i) {
+            auto field = tensor.field(int(i));
+            bytes += double(field.count()) * type_bytes(field.dtype());
+        }
+    }
+    return bytes;
+}
+
+static std::string json_escape(const std::string &str) {
+    std::string escaped;
+    for (auto ch : str) {
+        if (ch == '"' || ch == '\\') escaped.push_back('\\');
+        escaped.push_back(ch);
+    }
+    return escaped;
+}
+
+static Result run_case(Workbench &bench, const std::string &group, bench::Case &c,
+                       DTYPE dtype, int threads, double min_time) {
+    using clock = std::chrono::steady_clock;
+    auto op = bench.offline_create(c.bubble, true);
+    std::vector<Tensor> outputs;
+
+    // warm up, also let memory pool ready
+    for (int i = 0; i < 2; ++i) bench.offline_run(op, c.inputs, outputs);
+    auto bytes = bytes_of(c.inputs) + bytes_of(outputs);
+
+    std::vector<double> times;
+    double total = 0;
+    while ((total < min_time * 1000 || times.size() < 3) && times.size() < 10000) {
+        auto start = clock::now();
+        bench.offline_run(op, c.inputs, outputs);
+        auto end = clock::now();
+        auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+        times.push_back(ms);
+        total += ms;
+    }
+
+    std::sort(times.begin(), times.end());
+    Result result;
+    result.group = group;
+    result.name = c.name;
+    result.dtype = dtype;
+    result.threads = threads;
+    result.iterations = int(times.size());
+    result.median_ms = times[times.size() / 2];
+    result.min_ms = times.front();
+    result.mean_ms = total / times.size();
+    result.gflops = c.flops / (result.median_ms * 1e6);
+    result.gbps = bytes / (result.median_ms * 1e6);
+    return result;
+}
+
+static void write_json(const std::string &path, const std::vector<Result> &results) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Can not open " << path << std::endl;
+        std::exit(1);
+    }
+    out << "{\n  \"version\": 1,\n  \"device\": \"cpu\",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto &r = results[i];
+        out << (i ? "," : "") << "\n    {"
+            << "\"group\": \"" << json_escape(r.group) << "\", "
+            << "\"name\": \"" << json_escape(r.name) << "\", "
+            << "\"dtype\": \"" << type_str(r.dtype) << "\", "
+            << "\"threads\": " << r.threads << ", "
+            << "\"iterations\": " << r.iterations << ", "
+            << std::setprecision(6)
+            << "\"median_ms\": " << r.median_ms << ", "
+            << "\"min_ms\": " << r.min_ms << ", "
+            << "\"mean_ms\": " << r.mean_ms << ", "
+            << "\"gflops\": " << r.gflops << ", "
+            << "\"gbps\": " << r.gbps << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, const char *argv[]) {
+    std::string filter;
+    std::vector<int> thread_numbers = {1};
+    std::vector<DTYPE> dtypes = {FLOAT32};
+    double min_time = 0.3;
+    std::string json;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " need value" << std::endl;
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--filter") {
+            filter = value();
+        } else if (arg == "--threads") {
+            thread_numbers.clear();
+            for (auto &item : split(value(), ',')) thread_numbers.push_back(std::max(1, std::atoi(item.c_str())));
+        } else if (arg == "--dtypes") {
+            dtypes.clear();
+            for (auto &item : split(value(), ',')) dtypes.push_back(parse_dtype(item));
+        } else if (arg == "--time") {
+            min_time = std::atof(value().c_str());
+        } else if (arg == "--json") {
+            json = value();
+        } else if (arg == "--list") {
+            list = true;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter text] [--threads 1,4] [--dtypes float32,float64]"
+                         " [--time seconds] [--json path] [--list]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    for (auto dtype : dtypes) {
+        for (auto &generator : bench::Registry::All()) {
+            auto cases = generator.second(dtype);
+            for (auto &c : cases) {
+                auto title = generator.first + "/" + c.name;
+                if (!filter.empty() && title.find(filter) == std::string::npos) continue;
+                if (list) {
+                    std::cout << title << " " << type_str(dtype) << std::endl;
+                    continue;
+                }
+                for (auto threads : thread_numbers) {
+                    Workbench bench(ComputingDevice(CPU), threads);
+                    try {
+                        auto r = run_case(bench, generator.first, c, dtype, threads, min_time);
+                        results.push_back(r);
+                        std::cout << std::left << std::setw(52) << title
+                                  << std::setw(8) << type_str(dtype)
+                                  << "t=" << std::setw(3) << threads << std::right << std::fixed
+                                  << std::setprecision(3) << std::setw(10) << r.median_ms << "ms"
+                                  << std::setprecision(2) << std::setw(9) << r.gflops << " GFLOP/s"
+                                  << std::setw(9) << r.gbps << " GB/s" << std::endl;
+                    } catch (const Exception &e) {
+                        std::cout << std::left << std::setw(52) << title
+                                  << std::setw(8) << type_str(dtype)
+                                  << "t=" << std::setw(3) << threads << " skipped: " << e.what() << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+    if (!json.empty()) write_json(json, results);
+
+    return 0;
+}
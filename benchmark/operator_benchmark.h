@@ -0,0 +1,83 @@
+#ifndef TENSORSTACK_BENCHMARK_OPERATOR_BENCHMARK_H
+#define TENSORSTACK_BENCHMARK_OPERATOR_BENCHMARK_H
+
+#include "module/bubble.h"
+#include "core/tensor.h"
+#include "core/tensor_builder.h"
+#include "backend/name.h"
+#include "utils/static.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ts {
+    namespace bench {
+        /**
+         * One benchmark case, operator with params and inputs
+         */
+        class Case {
+        public:
+            using self = Case;
+
+            Case() = default;
+
+            Case(const std::string &name, const Bubble &bubble, const std::vector<Tensor> &inputs, double flops = 0)
+                    : name(name), bubble(bubble), inputs(inputs), flops(flops) {}
+
+            std::string name;           ///< describe shape and params, unique in group
+            Bubble bubble;              ///< operator and params
+            std::vector<Tensor> inputs;
+            double flops = 0;           ///< float operations each run, 0 for memory bound operators
+        };
+
+        /**
+         * generate cases in given dtype, return empty if dtype not supported.
+         */
+        using Generator = std::function<std::vector<Case>(DTYPE)>;
+
+        class Registry {
+        public:
+            static void Register(const std::string &group, const Generator &generator);
+
+            /**
+             * @return pair of group and generator, in registering order
+             */
+            static const std::vector<std::pair<std::string, Generator>> &All();
+        };
+
+        /**
+         * @return tensor filled with uniformly distributed numbers in [low, high), same serial in each call
+         */
+        Tensor random(DTYPE dtype, const Shape &shape, float low = -1, float high = 1);
+
+        /**
+         * @return padding tensor of NCHW format in shape [4, 2]
+         */
+        Tensor padding4x2(int top, int bottom, int left, int right);
+
+        /**
+         * @return stride or dilation tensor of NCHW format in shape [4]
+         */
+        Tensor nchw4(int height, int width);
+
+        inline std::string conv_string(int kernel, int stride) {
+            return std::to_string(kernel) + "x" + std::to_string(kernel) + "s" + std::to_string(stride);
+        }
+    }
+}
+
+/**
+ * Register generator of benchmark group, like:
+ * ```
+ * static std::vector<bench::Case> relu(DTYPE dtype) { ... }
+ * TS_REGISTER_BENCHMARK("relu", relu)
+ * ```
+ */
+#define TS_REGISTER_BENCHMARK(group, generator) \
+    namespace \
+    { \
+        ts::StaticAction ts_serial_name(_ts_static_action_)(ts::bench::Registry::Register, group, generator); \
+    }
+
+#endif //TENSORSTACK_BENCHMARK_OPERATOR_BENCHMARK_H
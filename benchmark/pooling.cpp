@@ -0,0 +1,41 @@
+#include "operator_benchmark.h"
+#include "backend/common_structure.h"
+
+namespace ts {
+    namespace bench {
+        struct PoolingParam {
+            int channels, size;
+            int kernel, stride, pad;
+            Pooling2DType type;
+        };
+
+        static std::vector<Case> pooling2d(DTYPE dtype) {
+            static const std::vector<PoolingParam> params = {
+                    {64, 112, 3, 2, 1, Pooling2DType::MAX},
+                    {256, 56, 2, 2, 0, Pooling2DType::MAX},
+                    {256, 56, 3, 1, 1, Pooling2DType::AVG},
+                    {512, 19, 5, 1, 2, Pooling2DType::MAX},     // SPP
+                    {512, 19, 13, 1, 6, Pooling2DType::MAX},
+            };
+            std::vector<Case> cases;
+            for (auto &p : params) {
+                Bubble bubble(name::layer::pooling2d(), name::layer::pooling2d());
+                bubble.set(name::format, tensor::from(name::NCHW));
+                bubble.set(name::type, tensor::from<int32_t>(int32_t(p.type)));
+                bubble.set(name::padding, padding4x2(p.pad, p.pad, p.pad, p.pad));
+                bubble.set(name::padding_type, tensor::from<int32_t>(int32_t(Padding2DType::BLACK)));
+                bubble.set(name::ksize, nchw4(p.kernel, p.kernel));
+                bubble.set(name::stride, nchw4(p.stride, p.stride));
+                auto x = random(dtype, {1, p.channels, p.size, p.size});
+                auto out = (p.size + 2 * p.pad - p.kernel) / p.stride + 1;
+                double flops = double(p.channels) * out * out * p.kernel * p.kernel;
+                cases.emplace_back(std::string(p.type == Pooling2DType::MAX ? "max " : "avg ") +
+                                   conv_string(p.kernel, p.stride) + " " + to_string(x.sizes()),
+                                   bubble, std::vector<Tensor>({x}), flops);
+            }
+            return cases;
+        }
+    }
+}
+
+TS_REGISTER_BENCHMARK("pooling2d", ts::bench::pooling2d)
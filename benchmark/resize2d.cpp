@@ -0,0 +1,46 @@
+#include "operator_benchmark.h"
+#include "backend/common_structure.h"
+
+namespace ts {
+    namespace bench {
+        struct ResizeParam {
+            Shape x;
+            int height, width;
+            Resize2DType type;
+        };
+
+        static const char *resize_type_string(Resize2DType type) {
+            switch (type) {
+                case Resize2DType::LINEAR: return "linear";
+                case Resize2DType::CUBIC: return "cubic";
+                case Resize2DType::NEAREST: return "nearest";
+                case Resize2DType::HARD: return "hard";
+            }
+            return "unknown";
+        }
+
+        static std::vector<Case> resize2d(DTYPE dtype) {
+            static const std::vector<ResizeParam> params = {
+                    {{1, 3, 480, 640}, 224, 224, Resize2DType::LINEAR},
+                    {{1, 3, 480, 640}, 224, 224, Resize2DType::CUBIC},
+                    {{1, 3, 480, 640}, 224, 224, Resize2DType::NEAREST},
+                    {{1, 256, 20, 20}, 40, 40, Resize2DType::NEAREST},  // upsample in FPN
+                    {{1, 128, 40, 40}, 80, 80, Resize2DType::LINEAR},
+            };
+            std::vector<Case> cases;
+            for (auto &p : params) {
+                Bubble bubble(name::layer::resize2d(), name::layer::resize2d());
+                bubble.set(name::type, tensor::from<int32_t>(int32_t(p.type)));
+                auto x = random(dtype, p.x, 0, 255);
+                auto size = tensor::from<int32_t>({-1, -1, p.height, p.width});
+                // no flops counted, memory bound
+                cases.emplace_back(std::string(resize_type_string(p.type)) + " " + to_string(p.x) + " -> " +
+                                   std::to_string(p.height) + "x" + std::to_string(p.width),
+                                   bubble, std::vector<Tensor>({x, size}));
+            }
+            return cases;
+        }
+    }
+}
+
+TS_REGISTER_BENCHMARK("resize2d", ts::bench::resize2d)
@@ -0,0 +1,25 @@
+#include "operator_benchmark.h"
+
+namespace ts {
+    namespace bench {
+        static std::vector<Case> softmax(DTYPE dtype) {
+            static const std::vector<std::pair<Shape, int>> params = {
+                    {{1, 1000}, 1},
+                    {{64, 1000}, 1},
+                    {{1, 21, 128, 128}, 1},     // segmentation
+                    {{1, 8, 256, 256}, 3},      // attention
+            };
+            std::vector<Case> cases;
+            for (auto &p : params) {
+                Bubble bubble(name::layer::softmax(), name::layer::softmax());
+                bubble.set(name::dim, tensor::from<int32_t>(p.second));
+                auto x = random(dtype, p.first, -10, 10);
+                cases.emplace_back(to_string(p.first) + " dim=" + std::to_string(p.second),
+                                   bubble, std::vector<Tensor>({x}));
+            }
+            return cases;
+        }
+    }
+}
+
+TS_REGISTER_BENCHMARK("softmax", ts::bench::softmax)
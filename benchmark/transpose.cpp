@@ -0,0 +1,26 @@
+#include "operator_benchmark.h"
+
+namespace ts {
+    namespace bench {
+        static std::vector<Case> transpose(DTYPE dtype) {
+            static const std::vector<std::pair<Shape, Shape>> params = {
+                    {{1, 3, 224, 224}, {0, 2, 3, 1}},     // NCHW -> NHWC
+                    {{1, 224, 224, 3}, {0, 3, 1, 2}},     // NHWC -> NCHW
+                    {{1, 64, 56, 56}, {0, 2, 3, 1}},
+                    {{1, 56, 56, 64}, {0, 3, 1, 2}},
+                    {{512, 512}, {1, 0}},
+            };
+            std::vector<Case> cases;
+            for (auto &p : params) {
+                Bubble bubble(name::layer::transpose(), name::layer::transpose());
+                bubble.set(name::permute, tensor::from<int32_t>(p.second));
+                auto x = random(dtype, p.first);
+                cases.emplace_back(to_string(p.first) + " permute=" + to_string(p.second),
+                                   bubble, std::vector<Tensor>({x}));
+            }
+            return cases;
+        }
+    }
+}
+
+TS_REGISTER_BENCHMARK("transpose", ts::bench::transpose)
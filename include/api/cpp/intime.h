@@ -10,6 +10,7 @@
 #include "../image_filter.h"
 
 #include <array>
+#include <vector>
 
 namespace ts {
     namespace api {
@@ -150,6 +151,28 @@ namespace ts {
                         dim, outer_value, method);
             }
 
+            /**
+             * sample affines.size() crops from one image x, return in shape [affines.size(), height, width, ...]
+             */
+            inline Tensor affine_sample2d(
+                    const Tensor &x,
+                    const std::array<int32_t, 2> &size,
+                    const std::vector<std::array<float, 9>> &affines,
+                    int32_t dim = -2,
+                    float outer_value = 0,
+                    ResizeMethod method = ResizeMethod::BILINEAR) {
+                std::vector<float> affine_data;
+                affine_data.reserve(affines.size() * 9);
+                for (auto &affine : affines) {
+                    affine_data.insert(affine_data.end(), affine.begin(), affine.end());
+                }
+                return affine_sample2d(
+                        x,
+                        tensor::build(INT32, Shape({2,}), &size[0]),
+                        tensor::build(FLOAT32, Shape({int32_t(affines.size()), 3, 3}), affine_data.data()),
+                        dim, outer_value, method);
+            }
+
             inline Tensor affine_on_sample2d(
                     const Tensor &x,
                     const Tensor &size,
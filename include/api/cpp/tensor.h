@@ -203,6 +203,17 @@ namespace ts {
                 return Tensor(packed_raw);
             }
 
+            /**
+             * tensor on data without copy, data must be available until release called
+             */
+            static Tensor Borrow(DTYPE dtype, const Shape &shape, void *data,
+                                 ts_Tensor_release *release = nullptr, void *userdata = nullptr) {
+                auto borrowed_raw = ts_new_Tensor_borrowed(shape.data(), int32_t(shape.size()), ts_DTYPE(dtype),
+                                                           data, release, userdata);
+                TS_API_AUTO_CHECK(borrowed_raw != nullptr);
+                return Tensor(borrowed_raw);
+            }
+
             static self BorrowedRef(raw *ptr) {
                 self borrowed(nullptr);
                 borrowed.m_impl = shared_raw(ptr, [](raw *) {});
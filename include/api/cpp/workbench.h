@@ -15,6 +15,7 @@
 #include "program.h"
 
 #include <string>
+#include <vector>
 
 namespace ts {
     namespace api {
@@ -104,6 +105,14 @@ namespace ts {
                 TS_API_AUTO_CHECK(ts_Workbench_run(m_impl.get()));
             }
 
+            void run_into(const std::vector<Tensor> &outputs) {
+                std::vector<ts_Tensor *> raw_outputs;
+                for (auto &output : outputs) {
+                    raw_outputs.emplace_back(output.get_raw());
+                }
+                TS_API_AUTO_CHECK(ts_Workbench_run_into(m_impl.get(), raw_outputs.data(), int32_t(raw_outputs.size())));
+            }
+
             void output(int slot, ts_Tensor *tensor) {
                 TS_API_AUTO_CHECK(ts_Workbench_output(m_impl.get(), slot, tensor));
             }
@@ -136,6 +145,14 @@ namespace ts {
                 TS_API_AUTO_CHECK(ts_Workbench_set_computing_thread_number(m_impl.get(), number));
             }
 
+            void share_computing_threads(const Workbench &src) {
+                TS_API_AUTO_CHECK(ts_Workbench_share_computing_threads(m_impl.get(), src.get_raw()));
+            }
+
+            void set_thread_wait_policy(ts_ThreadWaitPolicy policy, int spin_time = 100) {
+                TS_API_AUTO_CHECK(ts_Workbench_set_thread_wait_policy(m_impl.get(), policy, spin_time));
+            }
+
             void bind_filter(int slot, const ts_ImageFilter *filter) {
                 TS_API_AUTO_CHECK(ts_Workbench_bind_filter(m_impl.get(), slot, filter));
             }
@@ -230,6 +247,14 @@ namespace ts {
                 return ts_Workbench_set_cpu_mode(m_impl.get(), ts_CpuPowerMode(mode));
             }
 
+            bool set_cpu_affinity(const std::vector<int32_t> &cpu_ids) {
+                return ts_Workbench_set_cpu_affinity(m_impl.get(), cpu_ids.data(), int32_t(cpu_ids.size()));
+            }
+
+            bool set_numa_node(int node, bool replicate_data = false) {
+                return ts_Workbench_set_numa_node(m_impl.get(), node, ts_bool(replicate_data));
+            }
+
         private:
             Workbench(raw *ptr) : m_impl(pack(ptr)) {}
 
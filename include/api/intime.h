@@ -111,12 +111,14 @@ TENNIS_C_API ts_Tensor *ts_intime_resize2d(const ts_Tensor *x, const ts_Tensor *
  * Return sample2d tensor, out_position = affine * in_position
  * @param x input tensor
  * @param size size tensor like Int[2], means {height, width}
- * @param affine affine tensor like Float[3, 3]
+ * @param affine affine tensor like Float[3, 3], or Float[K, 3, 3] to sample K crops from one image
  * @param method 0-BILINEAR, 1-BICUBIC, 2-NEAREST, @sa ts_ResizeMethod
  * @param dim first dim of image height and width
  * @param outer_value set value to outer_value if sample out of image
  * @return new reference tensor, nullptr if failed.
  * @note call ts_Workbench_setup_context to fix Exception "Must bind Workbench before run"
+ * @note with Float[K, 3, 3] affine, the dims before dim must be 1, like x in [1, H, W, C] with dim=1,
+ *       return tensor in [K, height, width, C].
  */
 TENNIS_C_API ts_Tensor *ts_intime_affine_sample2d(
         const ts_Tensor *x,
@@ -128,7 +130,7 @@ TENNIS_C_API ts_Tensor *ts_intime_affine_sample2d(
  * Return sample2d tensor, out_position = affine * in_position
  * @param x input tensor
  * @param size size tensor like Int[2], means {height, width}
- * @param affine affine tensor like Float[3, 3]
+ * @param affine affine tensor like Float[3, 3], or Float[K, 3, 3] to sample K crops from one image
  * @param dim first dim of image height and width
  * @param method 0-BILINEAR, 1-BICUBIC, 2-NEAREST, @sa ts_ResizeMethod
  * @return new reference tensor, nullptr if failed.
@@ -72,12 +72,23 @@ TENNIS_C_API int32_t ts_Program_output_count(ts_Program *program);
  * Option can have:
  * 1. "--float16" using float16 operator
  * 2. "--winograd" using winograd conv2d
+ * 3. "--tune" benchmark kernels of each conv2d and inner_prod layer, and use the fastest, only on CPU now.
+ *    Inputs of module need #shape. Winners are saved in tuning cache, @sa ts_set_tuning_cache
  * Reservation options:
  * 1. "--pack" Default ON, pack weights
  * 2. "--filter" Default OFF, filter const values, set values to zero which smaller than FLT_EPSILON
  */
 TENNIS_C_API ts_Program *ts_Program_Compile_v2(const ts_Module *module, const ts_Device *device,
                                                const char *options);
+
+/**
+ * Set tuning cache file used by "--tune" compile option.
+ * @param path file path, NULL or "" for default
+ * @return ts_true if succeed
+ * @note Default file is $TS_TUNING_CACHE if set, or no file is read or written, tuning on every compile.
+ * @note Cache is keyed by cpu model, thread number and layer shape, so one file can be shared by many cpus.
+ */
+TENNIS_C_API ts_bool ts_set_tuning_cache(const char *path);
 /**
  * Set operator's param value.
  * @param program instance of program
@@ -17,6 +17,27 @@ extern "C" {
  */
 TENNIS_C_API ts_bool ts_setup();
 
+/**
+ * How large CPU memory blocks are backed
+ */
+enum ts_HugePageMode {
+    TS_HUGE_PAGE_NONE = 0,      ///< normal pages, default
+    TS_HUGE_PAGE_ADVISE = 1,    ///< transparent huge pages by madvise
+    TS_HUGE_PAGE_HUGETLB = 2,   ///< hugetlb pool, fallback to TS_HUGE_PAGE_ADVISE if pool not enough
+};
+typedef enum ts_HugePageMode ts_HugePageMode;
+
+/**
+ * Set CPU memory allocator, effect memory allocated after setting.
+ * @param alignment alignment of each block, power of 2 and at least 16, default 64
+ * @param huge_page @sa ts_HugePageMode
+ * @param large_block_size blocks not smaller than it are mapped from system directly, default 2MB.
+ *        They can be backed by huge pages, and are given back to system once freed.
+ * @return ts_true if succeed.
+ * @note only linux supports huge pages and mapped blocks, other platforms only use alignment
+ */
+TENNIS_C_API ts_bool ts_set_cpu_allocator(int32_t alignment, ts_HugePageMode huge_page, int64_t large_block_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -212,6 +212,28 @@ TENNIS_C_API ts_bool ts_Tensor_save(const char *path, const ts_Tensor *tensor);
  */
 TENNIS_C_API ts_Tensor *ts_Tensor_load(const char *path);
 
+/**
+ * Release callback of borrowed data
+ * @param data borrowed data pointer
+ * @param userdata userdata given in ts_new_Tensor_borrowed
+ */
+typedef void ts_Tensor_release(void *data, void *userdata);
+
+/**
+ * New tensor on given cpu data, without copy
+ * @param shape shape of new tensor
+ * @param shape_len length of given shape
+ * @param dtype data type of tensor
+ * @param data data on cpu, at least count of shape * sizeof(dtype) bytes, must have same data type as dtype
+ * @param release called when tensor and all its references released, NULL if caller manages data itself
+ * @param userdata passed to release
+ * @return new reference, NULL if failed.
+ * @note data must be available until release called, or until all referenced tensors freed if release is NULL
+ * @note CPU workbench uses this tensor as input without copy, and ts_Workbench_run_into can write into it
+ */
+TENNIS_C_API ts_Tensor *ts_new_Tensor_borrowed(const int32_t *shape, int32_t shape_len, ts_DTYPE dtype, void *data,
+                                               ts_Tensor_release *release, void *userdata);
+
 
 #ifdef __cplusplus
 }
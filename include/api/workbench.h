@@ -30,6 +30,15 @@ enum ts_CpuPowerMode {
     TS_CPU_LITTLE_CORE = 2, ///< only used in little core
 };
 
+/**
+ * How idle computing threads wait for next task
+ */
+enum ts_ThreadWaitPolicy {
+    TS_THREAD_PASSIVE = 0,  ///< sleep once no task, cost least cpu
+    TS_THREAD_HYBRID = 1,   ///< spin for spin time, then sleep, default
+    TS_THREAD_ACTIVE = 2,   ///< always spin, fastest response, but keep the cores busy
+};
+
 // Workbench API
 
 /**
@@ -106,6 +115,27 @@ TENNIS_C_API ts_bool ts_Workbench_output_by_name(ts_Workbench *workbench, const
  */
 TENNIS_C_API ts_bool ts_Workbench_set_computing_thread_number(ts_Workbench *workbench, int32_t number);
 
+/**
+ * Share computing threads of src workbench, parallel tasks of both workbenches run on same threads one by one.
+ * @param workbench instance of workbench
+ * @param src workbench whose computing threads shared
+ * @return false if failed.
+ * @note used to run many workbenches in one process without oversubscribing cores.
+ * @note ts_Workbench_set_computing_thread_number after sharing gives workbench its own threads again.
+ */
+TENNIS_C_API ts_bool ts_Workbench_share_computing_threads(ts_Workbench *workbench, const ts_Workbench *src);
+
+/**
+ * Set how idle computing threads wait for next task
+ * @param workbench instance of workbench
+ * @param policy wait policy
+ * @param spin_time spinning time in microseconds used in TS_THREAD_HYBRID, 100 by default
+ * @return false if failed.
+ * @note threads shared with other workbenches changed too.
+ */
+TENNIS_C_API ts_bool ts_Workbench_set_thread_wait_policy(ts_Workbench *workbench,
+                                                         ts_ThreadWaitPolicy policy, int32_t spin_time);
+
 /**
  * Bind filter on i-th input.
  * @param workbench instance of workbench
@@ -201,6 +231,8 @@ TENNIS_C_API ts_bool ts_Workbench_run_hook(ts_Workbench *workbench, const char *
  * Option can have:
  * 1. "--float16" using float16 operator
  * 2. "--winograd" using winograd conv2d
+ * 3. "--tune" benchmark kernels of each conv2d and inner_prod layer, and use the fastest, only on CPU now.
+ *    Inputs of module need #shape. Winners are saved in tuning cache, @sa ts_set_tuning_cache
  * Reservation options:
  * 1. "--pack" Default ON, pack weights
  * 2. "--filter" Default OFF, filter const values, set values to zero which smaller than FLT_EPSILON
@@ -217,6 +249,8 @@ TENNIS_C_API ts_Workbench *ts_Workbench_Load_v2(const ts_Module *module, const t
  * Option can have:
  * 1. "--float16" using float16 operator
  * 2. "--winograd" using winograd conv2d
+ * 3. "--tune" benchmark kernels of each conv2d and inner_prod layer, and use the fastest, only on CPU now.
+ *    Inputs of module need #shape. Winners are saved in tuning cache, @sa ts_set_tuning_cache
  * Reservation options:
  * 1. "--pack" Default ON, pack weights
  * 2. "--filter" Default OFF, filter const values, set values to zero which smaller than FLT_EPSILON
@@ -254,6 +288,195 @@ TENNIS_C_API const char *ts_Workbench_summary(ts_Workbench *workbench);
  */
 TENNIS_C_API ts_bool ts_Workbench_set_cpu_mode(ts_Workbench *workbench, ts_CpuPowerMode mode);
 
+/**
+ * Pin computing threads of workbench to given cpus
+ * @param workbench instance of workbench
+ * @param cpu_ids cpu ids, thread i runs on cpu_ids[i % count]
+ * @param count length of cpu_ids, 0 for no pinning
+ * @return false if failed or pinning not supported
+ * @note only support linux and android now
+ */
+TENNIS_C_API ts_bool ts_Workbench_set_cpu_affinity(ts_Workbench *workbench, const int32_t *cpu_ids, int32_t count);
+
+/**
+ * Place workbench on NUMA node, computing threads are pinned to cpus of node, and memory on CPU is allocated on node
+ * @param workbench instance of workbench
+ * @param node NUMA node id, -1 for no placement
+ * @param replicate_data if use copy of data segment on node, copies are shared by workbenches cloned from same one
+ * @return false if failed or node not exists
+ * @note call before first run, memory already allocated is not moved.
+ * @note only support linux now
+ */
+TENNIS_C_API ts_bool ts_Workbench_set_numa_node(ts_Workbench *workbench, int32_t node, ts_bool replicate_data);
+
+/**
+ * Run network, and write outputs into given tensors.
+ * @param workbench instance of workbench
+ * @param outputs output tensors, NULL item for output not given, then get it by ts_Workbench_output
+ * @param count length of outputs, must be ts_Workbench_output_count
+ * @return false if failed.
+ * @note if network ends with operator, it writes its outputs into given tensors directly,
+ *       when dtype, shape and device match, otherwise copied.
+ * @note given tensor can be created by ts_new_Tensor_borrowed, so output is written into caller's memory.
+ */
+TENNIS_C_API ts_bool ts_Workbench_run_into(ts_Workbench *workbench, ts_Tensor **outputs, int32_t count);
+
+/**
+ * Run network with given inputs, can be called from many threads at same time on one workbench.
+ * Each call uses its own stack and memory, program and its weights are shared.
+ * @param workbench instance of workbench
+ * @param inputs input tensors, length must be ts_Workbench_input_count
+ * @param input_count length of inputs
+ * @param outputs tensors to get outputs, like ts_Workbench_output, length must be ts_Workbench_output_count
+ * @param output_count length of outputs
+ * @return false if failed.
+ * @note operators run in calling thread, call from more threads to use more cores.
+ * @note do not call at same time with ts_Workbench_setup, ts_Workbench_bind_filter or ts_Workbench_set_operator_param.
+ */
+TENNIS_C_API ts_bool ts_Workbench_run_concurrent(ts_Workbench *workbench,
+                                                 const ts_Tensor **inputs, int32_t input_count,
+                                                 ts_Tensor **outputs, int32_t output_count);
+
+/**
+ * Release idle memory kept by workbench for reusing, like memory left by one large input.
+ * @param workbench instance of workbench
+ * @param high_water bytes of memory to keep on each device, 0 for releasing all idle memory
+ * @return false if failed.
+ * @note memory of outputs still in use is kept. Do not call at same time with running.
+ */
+TENNIS_C_API ts_bool ts_Workbench_trim(ts_Workbench *workbench, int64_t high_water);
+
+/**
+ * Trim memory to high_water after each run, @see ts_Workbench_trim
+ * @param workbench instance of workbench
+ * @param high_water bytes of memory to keep on each device, negative for never trimming, which is default
+ * @return false if failed.
+ */
+TENNIS_C_API ts_bool ts_Workbench_set_trim_policy(ts_Workbench *workbench, int64_t high_water);
+
+/**
+ * Limit memory allocated by workbench on its device. When limit reached, workbench releases idle memory,
+ *     then runs in lower memory way, like smaller im2col tiles or batch sample by sample, before failing.
+ * @param workbench instance of workbench
+ * @param limit bytes of memory, 0 for unlimited, which is default
+ * @return false if failed.
+ * @note counters of budget are in ts_Workbench_summary
+ */
+TENNIS_C_API ts_bool ts_Workbench_set_memory_budget(ts_Workbench *workbench, int64_t limit);
+
+/**
+ * Profile time spent of each operator and whole run. Times are kept in histograms with constant memory,
+ *     so profiling can keep on in long-running service.
+ * @param workbench instance of workbench
+ * @param profile if profile, default false
+ * @return false if failed.
+ */
+TENNIS_C_API ts_bool ts_Workbench_do_profile(ts_Workbench *workbench, ts_bool profile);
+
+/**
+ * Get time statistics of profiling, in milliseconds
+ * @param workbench instance of workbench
+ * @param reset if clear statistics after getting, for polling periodically
+ * @return json string, NULL if failed, like:
+ *     {"op(0001):conv2d:conv1": {"count": 100, "avg": 1.2, "min": 1.1, "max": 2.5,
+ *         "p50": 1.2, "p90": 1.3, "p99": 2.1, "p999": 2.5}, ..., "run": {...}}
+ * @note string is kept until next calling
+ */
+TENNIS_C_API const char *ts_Workbench_profile(ts_Workbench *workbench, ts_bool reset);
+
+/**
+ * Capture outputs of given nodes in sampled runs, kept in ring buffer of slots for latest sampled runs.
+ * Nodes are resolved once here, running nodes not captured has no more cost.
+ * @param workbench instance of workbench
+ * @param node_names names of captured nodes, NULL or count 0 for stopping capture
+ * @param count length of node_names
+ * @param slots number of latest sampled runs kept
+ * @param interval sample one run in every interval runs, 0 for pausing
+ * @return false if failed.
+ * @note capture is reset by ts_Workbench_setup, ts_Workbench_run_concurrent is not captured
+ */
+TENNIS_C_API ts_bool ts_Workbench_set_capture(ts_Workbench *workbench, const char **node_names, int32_t count,
+                                              int32_t slots, int32_t interval);
+
+/**
+ * @param workbench instance of workbench
+ * @param interval sample one run in every interval runs, 0 for pausing
+ * @return false if failed.
+ */
+TENNIS_C_API ts_bool ts_Workbench_set_capture_interval(ts_Workbench *workbench, int32_t interval);
+
+/**
+ * @param workbench instance of workbench
+ * @return number of sampled runs kept, negative if failed.
+ */
+TENNIS_C_API int32_t ts_Workbench_captured_count(ts_Workbench *workbench);
+
+/**
+ * Get captured value of node.
+ * @param workbench instance of workbench
+ * @param age 0 for latest sampled run, 1 for the one before it, and so on
+ * @param node_name name of node
+ * @param tensor captured value on CPU, overwritten by later sampled runs, clone it to keep
+ * @return false if failed, or not captured.
+ */
+TENNIS_C_API ts_bool ts_Workbench_captured(ts_Workbench *workbench, int32_t age, const char *node_name,
+                                           ts_Tensor *tensor);
+
+/**
+ * How asynchronous run finished
+ */
+enum ts_RunStatus {
+    TS_RUN_SUCCEED = 0,     ///< outputs are set
+    TS_RUN_FAILED = 1,      ///< get error message by ts_last_error_message in callback
+    TS_RUN_CANCELLED = 2,   ///< cancelled by ts_Workbench_cancel before running
+};
+typedef enum ts_RunStatus ts_RunStatus;
+
+/**
+ * Callback of ts_Workbench_run_async, called in dispatching thread of workbench,
+ *     or in thread calling ts_Workbench_cancel if cancelled.
+ * @param user_data user_data given to ts_Workbench_run_async
+ * @param request id of request
+ * @param status how run finished
+ */
+typedef void ts_Workbench_run_callback(void *user_data, int64_t request, ts_RunStatus status);
+
+/**
+ * Set queue of asynchronous run, waiting requests of old queue are cancelled.
+ * @param workbench instance of workbench
+ * @param threads number of runs at same time, each runs like ts_Workbench_run_concurrent
+ * @param capacity max number of requests waiting to run
+ * @return false if failed.
+ * @note queue is created with 1 thread and capacity 16 at first ts_Workbench_run_async if not set
+ */
+TENNIS_C_API ts_bool ts_Workbench_set_async(ts_Workbench *workbench, int32_t threads, int32_t capacity);
+
+/**
+ * Submit run with given inputs, return without waiting.
+ * @param workbench instance of workbench
+ * @param inputs input tensors, length must be ts_Workbench_input_count, can be freed after return
+ * @param input_count length of inputs
+ * @param outputs tensors to get outputs, like ts_Workbench_output, length must be ts_Workbench_output_count
+ * @param output_count length of outputs
+ * @param callback called once request done, can be NULL
+ * @param user_data given to callback
+ * @return id of request, positive, 0 if failed or queue full.
+ * @note outputs must be kept until callback called, they are set before callback with TS_RUN_SUCCEED.
+ * @note do not free workbench in callback.
+ */
+TENNIS_C_API int64_t ts_Workbench_run_async(ts_Workbench *workbench,
+                                            const ts_Tensor **inputs, int32_t input_count,
+                                            ts_Tensor **outputs, int32_t output_count,
+                                            ts_Workbench_run_callback *callback, void *user_data);
+
+/**
+ * Cancel request of ts_Workbench_run_async not started, its callback is called with TS_RUN_CANCELLED before return.
+ * @param workbench instance of workbench
+ * @param request id of request
+ * @return false if failed, or request is running or done.
+ */
+TENNIS_C_API ts_bool ts_Workbench_cancel(ts_Workbench *workbench, int64_t request);
+
 
 #ifdef __cplusplus
 }
@@ -19,6 +19,8 @@ namespace ts {
 
             int infer(Stack &stack, std::vector<Tensor::Prototype> &output) override;
 
+            bool reentrant() const override { return true; }
+
             virtual void active(const Tensor &x, Tensor &out) = 0;
         };
     }
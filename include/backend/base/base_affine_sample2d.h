@@ -34,6 +34,18 @@ namespace ts {
                                            AffineOuterMode outer_mode, float outer_value,
                                            Tensor &out) = 0;
 
+            /**
+             * sample number crops from one image, crop k using affine[9 * k, 9 * k + 9)
+             * @param x image, x.sizes() starts with [height, width] at dim
+             * @param affine number of 3x3 matrix, in row major
+             * @param out in shape [number, dst_height, dst_width, ...]
+             * @note default implementation calls affine_sample_run on each slice of out
+             */
+            virtual void affine_sample_batch_run(const Tensor &x, const float *affine, int number,
+                                                 Affine_Sample2DType type, int dim,
+                                                 AffineOuterMode outer_mode, float outer_value,
+                                                 Tensor &out);
+
         protected:
 
             Affine_Sample2DType m_type;
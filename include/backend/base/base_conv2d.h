@@ -31,6 +31,8 @@ namespace ts {
 
             int infer(Stack &stack, std::vector<Tensor::Prototype> &output) override;
 
+            bool reentrant() const override { return true; }
+
         private:
             Conv2DFormat m_format;
             std::valarray<int> m_padding4x2;
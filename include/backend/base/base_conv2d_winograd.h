@@ -30,6 +30,7 @@ namespace ts{
 
         private:
             WinogradConv2DMode m_winograd_mode;
+            bool m_winograd_mode_fixed = false;
             Conv2DFormat m_format;
             std::valarray<int> m_padding4x2;
             float m_padding_value;
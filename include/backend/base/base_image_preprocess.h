@@ -0,0 +1,65 @@
+#ifndef TENSORSTACK_BACKEND_BASE_BASE_IMAGE_PREPROCESS_H
+#define TENSORSTACK_BACKEND_BASE_BASE_IMAGE_PREPROCESS_H
+
+#include "operator_on_device.h"
+#include "backend/common_structure.h"
+
+namespace ts {
+    namespace base {
+        /**
+         * Fused image filter chain, one pass from NHWC image to network input.
+         * Output channel c of pixel (y, x) is:
+         *     resize(cast(x))[y, x, shuffle[c]] * scale[c] + shift[c]
+         * each step is optional:
+         * size: [height, width] of resized image, no resize if not set
+         * type: Resize2DType, only LINEAR and NEAREST
+         * dtype: output dtype, cast to it; keep input dtype if not set
+         * cast_after_resize: resize in input dtype, then cast, else cast then resize
+         * shuffle: output channel c comes from input channel shuffle[c]
+         * scale, shift: per output channel (or scalar) affine, only for FLOAT32 output
+         * format: NHWC or NCHW output
+         */
+        class ImagePreprocess : public OperatorOnDevice {
+        public:
+            using self = ImagePreprocess;
+            using supper = OperatorOnDevice;
+
+            ImagePreprocess();
+
+            void init() override;
+
+            int infer(Stack &stack, std::vector<Tensor::Prototype> &output) override;
+
+            /**
+             * @param stack contains: x in NHWC
+             * @return
+             */
+            int run(Stack &stack) override;
+
+            /**
+             * @param x NHWC image
+             * @param resize if resize needed, false if no size set or size not changed
+             * @param out output sized by infer
+             */
+            virtual void image_preprocess(const Tensor &x, bool resize, Tensor &out) = 0;
+
+        protected:
+            bool m_resize = false;
+            int m_height = -1;
+            int m_width = -1;
+            Resize2DType m_type = Resize2DType::LINEAR;
+            DTYPE m_dtype = VOID;
+            bool m_cast_after_resize = false;
+            std::vector<int32_t> m_shuffle;
+            std::vector<float> m_scale;
+            std::vector<float> m_shift;
+            bool m_chw = false;
+
+        private:
+            Tensor::Prototype infer_output(const Tensor &x, bool &resize) const;
+        };
+    }
+}
+
+
+#endif //TENSORSTACK_BACKEND_BASE_BASE_IMAGE_PREPROCESS_H
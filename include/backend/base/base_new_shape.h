@@ -21,6 +21,8 @@ namespace ts {
 
             int infer(Stack &stack, std::vector<Tensor::Prototype> &output) override;
 
+            bool reentrant() const override { return true; }
+
             virtual Shape newshape(const Tensor &x) = 0;
         };
     }
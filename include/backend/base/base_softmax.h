@@ -25,6 +25,8 @@ namespace ts {
 
             int infer(Stack &stack, std::vector<Tensor::Prototype> &output) override;
 
+            bool reentrant() const override { return true; }
+
             virtual void softmax(const Tensor &x, int dim, bool smooth, Tensor &out) = 0;
 
         private:
@@ -22,6 +22,8 @@ namespace ts {
 
             int infer(ts::Stack &stack, std::vector<ts::Tensor::Prototype> &output) override;
 
+            bool reentrant() const override { return true; }
+
             virtual void transpose(const Tensor &x, const std::vector<int> &permute, Tensor &out) = 0;
 
         private:
@@ -22,6 +22,8 @@ namespace ts {
 
         int infer(Stack &stack, std::vector<Tensor::Prototype> &output) override;
 
+        bool reentrant() const override { return true; }
+
         /**
          *
          * @param lhs
@@ -143,6 +143,9 @@ namespace ts {
 
             TS_DEBUG_API const string &conv2d_winograd_v2() TS_NOEXCEPT;
 
+            // 2020-03-30
+            TS_DEBUG_API const string &image_preprocess() TS_NOEXCEPT;
+
         }
 
         namespace typo {
@@ -230,6 +233,7 @@ namespace ts {
 
         TS_DEBUG_API extern string transpose;
         TS_DEBUG_API extern string kernel_winograd_transformed;
+        TS_DEBUG_API extern string cast_after_resize;
     }
 }
 
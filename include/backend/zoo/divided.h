@@ -26,6 +26,8 @@ namespace ts {
 
         private:
             std::vector<int32_t> m_size;
+            float m_padding_value = 0;
+            // pad operator on computing device, null when running on CPU directly
             Operator::shared m_pad_op;
 
             Tensor m_padding;
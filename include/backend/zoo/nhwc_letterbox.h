@@ -25,7 +25,17 @@ namespace ts {
             int infer(Stack &stack, std::vector<Tensor::Prototype> &output) override;
 
         private:
+            /**
+             * resize content region of x on stack directly, and fill borders with outer value
+             * @return false if not computing on CPU, or type or dtype not supported, nothing pushed,
+             *     then sampled by affine_sample2d
+             */
+            bool letterbox(Stack &stack, const Size2D &y_size, float inv_scale);
+
             std::vector<int> m_size;    ///< {width, height} format
+            Affine_Sample2DType m_type = Affine_Sample2DType::LINEAR;
+            float m_outer_value = 0;
+            bool m_direct = false;  ///< if computing on CPU, so letterbox can write output directly
             Operator::shared m_sample_op;
 
             Tensor m_sample_size;
@@ -13,10 +13,17 @@
 #include <numeric>
 #include <string>
 #include <algorithm>
+#include <mutex>
 
 #include <utils/api.h>
 
+#include "histogram.h"
+
 namespace ts {
+    /**
+     * Statistics of data, kept in histogram, so memory is constant however many data appended.
+     * @tparam T type of datum
+     */
     template <typename T>
     class TS_DEBUG_API Statistics {
     public:
@@ -24,58 +31,66 @@ namespace ts {
         using Datum = T;
 
     private:
-        std::vector<Datum> m_data;
-        using iterator = typename std::vector<Datum>::iterator;
-        using const_iterator = typename std::vector<Datum>::const_iterator;
+        Histogram m_histogram;
 
     public:
+        /**
+         * lock free, can be called from many threads
+         */
         void append(const Datum datum) {
-            this->m_data.push_back(datum);
+            this->m_histogram.record(double(datum));
         }
 
         void clear() {
-            this->m_data.clear();
+            this->m_histogram.clear();
         }
 
         Datum max() const {
-            if (this->m_data.empty()) return Datum(0);
-            return std::minmax(this->m_data.begin(), this->m_data.end()).second;
+            return Datum(this->m_histogram.max());
         }
 
         Datum min() const {
-            if (this->m_data.empty()) return Datum(0);
-            return std::minmax(this->m_data.begin(), this->m_data.end()).first;
+            return Datum(this->m_histogram.min());
         }
 
         Datum avg() const {
-            return this->m_data.empty() ? Datum(0) : (this->sum() / this->count());
+            return Datum(this->m_histogram.mean());
         }
 
         Datum sum() const {
-            return std::accumulate(this->m_data.begin(), this->m_data.end(), Datum(0));
+            return Datum(this->m_histogram.sum());
         }
 
         size_t count() const {
-            return this->m_data.size();
+            return size_t(this->m_histogram.count());
         }
 
-        iterator begin() {
-            return this->m_data.begin();
+        /**
+         * @param q quantile in [0, 1], like 0.99 for p99
+         */
+        Datum percentile(double q) const {
+            return Datum(this->m_histogram.percentile(q));
         }
 
-        iterator end() {
-            return this->m_data.end();
+        /**
+         * @param reset if clear after copy
+         * @return copy of statistics
+         */
+        self snapshot(bool reset = false) {
+            self copy;
+            copy.m_histogram = this->m_histogram.snapshot(reset);
+            return copy;
         }
 
-        const_iterator begin() const {
-            return this->m_data.begin();
-        }
-
-        const_iterator end() const {
-            return this->m_data.end();
+        const Histogram &histogram() const {
+            return this->m_histogram;
         }
     };
 
+    /**
+     * Statistics of data by name
+     * @note append and snapshot can be called from many threads, other methods can not be called while appending
+     */
     template <typename T>
     class TS_DEBUG_API Board {
     public:
@@ -87,16 +102,44 @@ namespace ts {
 
     private:
         std::unordered_map<key_type, value_type> m_board;
+        // only guard adding names, statistics are lock free
+        mutable std::mutex m_mutex;
         using iterator = typename std::unordered_map<key_type, value_type>::iterator;
         using const_iterator = typename std::unordered_map<key_type, value_type>::const_iterator;
 
     public:
+        Board() = default;
+
+        Board(const self &other) {
+            std::unique_lock<std::mutex> _lock(other.m_mutex);
+            this->m_board = other.m_board;
+        }
+
+        self &operator=(const self &other) {
+            if (this == &other) return *this;
+            std::unordered_map<key_type, value_type> board;
+            {
+                std::unique_lock<std::mutex> _lock(other.m_mutex);
+                board = other.m_board;
+            }
+            std::unique_lock<std::mutex> _lock(this->m_mutex);
+            this->m_board.swap(board);
+            return *this;
+        }
+
         void append(const key_type &name, const Datum datum) {
-            this->m_board[name].append(datum);
+            value_type *statistics = nullptr;
+            {
+                std::unique_lock<std::mutex> _lock(this->m_mutex);
+                // reference to value of unordered_map keeps valid after inserting
+                statistics = &this->m_board[name];
+            }
+            statistics->append(datum);
         }
 
         void clear(const key_type &name) {
-            this->query(name).clear();
+            auto it = this->m_board.find(name);
+            if (it != this->m_board.end()) it->second.clear();
         }
 
         Datum max(const key_type &name) const {
@@ -119,7 +162,30 @@ namespace ts {
             return this->query(name).count();
         }
 
+        /**
+         * @param name name of data
+         * @param q quantile in [0, 1], like 0.99 for p99
+         */
+        Datum percentile(const key_type &name, double q) const {
+            return this->query(name).percentile(q);
+        }
+
+        /**
+         * copy statistics of all names, and clear them if reset, names are kept
+         * @param reset if clear after copy
+         * @return copy of board
+         */
+        self snapshot(bool reset = false) {
+            self copy;
+            std::unique_lock<std::mutex> _lock(this->m_mutex);
+            for (auto &name_value : this->m_board) {
+                copy.m_board.insert(std::make_pair(name_value.first, name_value.second.snapshot(reset)));
+            }
+            return copy;
+        }
+
         void clean() {
+            std::unique_lock<std::mutex> _lock(this->m_mutex);
             this->m_board.clear();
         }
 
@@ -148,6 +214,7 @@ namespace ts {
         }
 
         value_type query(const key_type &name) const {
+            std::unique_lock<std::mutex> _lock(this->m_mutex);
             auto it = this->m_board.find(name);
             if (it == this->m_board.end()) return Statistics<Datum>();
             return it->second;
@@ -0,0 +1,86 @@
+#ifndef TENSORSTACK_BOARD_HISTOGRAM_H
+#define TENSORSTACK_BOARD_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <utils/api.h>
+
+namespace ts {
+    /**
+     * Log-linear histogram of non-negative values, with constant memory and lock free recording.
+     * Each power of 2 in [2^MinExponent, 2^MaxExponent) is split into SubBuckets linear buckets,
+     *     so percentile has relative error less than 1 / SubBuckets, min, max, sum and count are exact.
+     * Negative values are recorded as 0, values out of range are counted in the first or last bucket.
+     */
+    class TS_DEBUG_API Histogram {
+    public:
+        using self = Histogram;
+
+        static const int SubBuckets = 32;
+        static const int MinExponent = -16;
+        static const int MaxExponent = 32;
+        static const int BucketCount = (MaxExponent - MinExponent) * SubBuckets + 1;
+
+        Histogram();
+
+        Histogram(const self &other);
+
+        self &operator=(const self &other);
+
+        /**
+         * record value, can be called from many threads
+         * @param value recorded value
+         */
+        void record(double value);
+
+        uint64_t count() const;
+
+        double sum() const;
+
+        double min() const;
+
+        double max() const;
+
+        double mean() const;
+
+        /**
+         * @param q quantile in [0, 1], like 0.99 for p99
+         * @return value of quantile, 0 if no value recorded
+         */
+        double percentile(double q) const;
+
+        void clear();
+
+        /**
+         * copy recorded values, and clear this histogram if reset
+         * @param reset if clear after copy
+         * @return copy of histogram
+         * @note values recorded at same time are in either copy or this histogram
+         */
+        self snapshot(bool reset = false);
+
+        /**
+         * add values recorded in other histogram into this
+         */
+        void merge(const self &other);
+
+    private:
+        static int index_of(double value);
+
+        /**
+         * @return middle of bucket
+         */
+        static double value_of(int index);
+
+        std::atomic<uint64_t> m_buckets[BucketCount];
+        std::atomic<uint64_t> m_count;
+        // bits of double, non-negative doubles are ordered same as their bits
+        std::atomic<uint64_t> m_sum;
+        std::atomic<uint64_t> m_min;
+        std::atomic<uint64_t> m_max;
+    };
+}
+
+
+#endif //TENSORSTACK_BOARD_HISTOGRAM_H
@@ -9,6 +9,7 @@
 #include <string>
 #include <cstdint>
 #include <functional>
+#include <mutex>
 
 #include "utils/except.h"
 #include "utils/ctxmgr_lite.h"
@@ -55,9 +56,14 @@ namespace ts {
         std::function<void(void)> m_later;
     };
 
+    /**
+     * Time spent of each name, in milliseconds.
+     * Times are kept in histograms, so profiler can keep on in long-running service.
+     */
     class TS_DEBUG_API Profiler : public SetupContext<Profiler> {
     public:
         void clean() {
+            std::unique_lock<std::mutex> _lock(this->m_serial_mutex);
             this->m_serial.clear();
         }
 
@@ -74,10 +80,25 @@ namespace ts {
 
         const Board<float> &board() const;
 
+        /**
+         * copy times of all names, and clear them if reset, for polling periodically
+         * @param reset if clear after copy
+         * @return copy of board
+         */
+        Board<float> snapshot(bool reset = false);
+
+        /**
+         * @param reset if clear after summary
+         * @return json string, count, avg, min, max, p50, p90, p99 and p999 of each name, like
+         *     {"run": {"count": 100, "avg": 3.1, "min": 2.9, "max": 7.2, "p50": 3.0, ...}, ...}
+         */
+        std::string summary(bool reset = false);
+
         void log(std::ostream &out) const;
     private:
         Board<float> m_board;
         std::unordered_map<std::string, int32_t> m_serial;
+        std::mutex m_serial_mutex;
     };
 
     TS_DEBUG_API bool profiler_on();
@@ -0,0 +1,46 @@
+#ifndef TENSORSTACK_COMPILER_COMPILE_JOBS_H
+#define TENSORSTACK_COMPILER_COMPILE_JOBS_H
+
+#include "utils/api.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace ts {
+    class ThreadPool;
+
+    /**
+     * independent jobs found when compiling, like weight transforms and operators' init.
+     * Collect jobs first, then run them all at once on thread pool.
+     * Bind in context when translating, so options can push jobs instead of doing them.
+     */
+    class TS_DEBUG_API CompileJobs {
+    public:
+        using self = CompileJobs;
+
+        /**
+         * called as job(thread_id), thread_id in [0, pool size), so job can pick per thread resource
+         */
+        using Job = std::function<void(int)>;
+
+        void push(const Job &job);
+
+        size_t size() const { return m_jobs.size(); }
+
+        bool empty() const { return m_jobs.empty(); }
+
+        /**
+         * run and clear all jobs
+         * @param pool thread pool to run on, nullptr to run one by one in calling thread
+         * @note DeviceContext of calling thread is bound in each thread
+         * @note all jobs are finished before throwing exception of first failed job in pushed order
+         */
+        void run(ThreadPool *pool);
+
+    private:
+        std::vector<Job> m_jobs;
+    };
+}
+
+#endif //TENSORSTACK_COMPILER_COMPILE_JOBS_H
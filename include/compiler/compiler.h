@@ -9,6 +9,7 @@
 #include "module/graph.h"
 
 namespace ts {
+    class CompileJobs;
 
     class DeviceTensor
     {
@@ -46,8 +47,17 @@ namespace ts {
                 const std::string &options);
         std::vector<Instruction::shared> convert_operator_instruction(const Node &node);
 
+        /**
+         * fold const nodes, independent nodes are run together on ThreadPool of context
+         * @context Workbench, to run const nodes
+         */
         static void run_const_nodes(const std::vector<Node> &nodes, std::vector<Node> &const_nodes);
     private:
+        /**
+         * @param init_jobs push operator's init in it if not nullptr, or init at once
+         */
+        std::vector<Instruction::shared> convert_operator_instruction(const Node &node, CompileJobs *init_jobs);
+
         ComputingDevice m_computing_device;
     };
 }
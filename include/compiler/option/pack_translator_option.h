@@ -12,6 +12,21 @@ namespace ts {
             Node &translated_node,
             const std::string &params,
             bool output_flag) const final;
+
+        /**
+         * pack const kernel for gemm
+         * @param op conv2d, conv2d_v2 or inner_prod
+         * @param kernel kernel of op
+         * @param transpose if inner_prod's kernel is transposed
+         * @return packed kernel, for inner_prod it is not transposed
+         */
+        static Tensor PackKernel(const std::string &op, const Tensor &kernel, bool transpose);
+
+        /**
+         * pack const kernel into given tensor
+         * @param kernel_packed allocated packed kernel, shape is [kernel.size(1), kernel.size(0)] for transposed inner_prod
+         */
+        static void PackKernel(const std::string &op, const Tensor &kernel, bool transpose, Tensor &kernel_packed);
     };
 }
 
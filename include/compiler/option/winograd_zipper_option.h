@@ -13,6 +13,15 @@ namespace ts {
     public:
         bool zip(const ComputingDevice &device, Node node, Node &zipped_node) const final;
     };
+
+    /**
+     * zip conv2d to the kernel chosen in Context<TuningTable>,
+     *     tuned conv2d not using winograd keeps unchanged, so no other option zips it.
+     */
+    class TunedConv2dZipperOption : public ZipperOption {
+    public:
+        bool zip(const ComputingDevice &device, Node node, Node &zipped_node) const final;
+    };
 }
 
 
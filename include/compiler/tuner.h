@@ -0,0 +1,88 @@
+#ifndef TENSORSTACK_COMPILER_TUNER_H
+#define TENSORSTACK_COMPILER_TUNER_H
+
+#include "module/module.h"
+#include "core/device.h"
+#include "utils/api.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace ts {
+    /**
+     * kernel algorithm chosen for each tuned layer, find by node name.
+     * Bind in context when translating and zipping, then options follow the choices.
+     */
+    class TS_DEBUG_API TuningTable {
+    public:
+        using self = TuningTable;
+
+        enum Algorithm {
+            DEFAULT = 0,        ///< not tuned, use built-in heuristics
+            GEMM = 1,           ///< im2col + gemm, kernel packed in each run
+            GEMM_PACKED = 2,    ///< im2col + gemm, kernel packed when compiling
+            WINOGRAD_F23 = 3,   ///< winograd F(2x2, 3x3)
+            WINOGRAD_F63 = 4,   ///< winograd F(6x6, 3x3)
+        };
+
+        static std::string Name(Algorithm algorithm);
+
+        /**
+         * @param name algorithm name
+         * @return DEFAULT if unknown name
+         */
+        static Algorithm Parse(const std::string &name);
+
+        void set(const std::string &node, Algorithm algorithm);
+
+        /**
+         * @param node node name
+         * @return DEFAULT if node not tuned
+         */
+        Algorithm get(const std::string &node) const;
+
+        bool empty() const { return m_choices.empty(); }
+
+        size_t size() const { return m_choices.size(); }
+
+    private:
+        std::unordered_map<std::string, Algorithm> m_choices;
+    };
+
+    /**
+     * Benchmark candidate kernels of each conv2d and inner_prod layer on its real input shape,
+     *     with computing threads of Context<Workbench>.
+     * Winners are saved in tuning cache file, keyed by cpu model, thread number and layer shape,
+     *     so compiling on same cpu again reuses them without benchmark.
+     * Only CPU is tuned now.
+     */
+    class TS_DEBUG_API Tuner {
+    public:
+        using self = Tuner;
+
+        explicit Tuner(const ComputingDevice &device);
+
+        /**
+         * tune module
+         * @param module module not translated
+         * @return choice of each tuned layer
+         * @note module's inputs must set #shape, layers with unknown shape are not tuned
+         * @context Workbench, to benchmark with
+         */
+        TuningTable tune(const Module::shared &module) const;
+
+        /**
+         * set tuning cache file used by all tuners
+         * @param path file path, empty for default
+         * @note default path is $TS_TUNING_CACHE if set, or no cache file, tuning every compile
+         */
+        static void SetCacheFile(const std::string &path);
+
+        static std::string GetCacheFile();
+
+    private:
+        ComputingDevice m_device;
+    };
+}
+
+#endif //TENSORSTACK_COMPILER_TUNER_H
@@ -6,6 +6,7 @@
 #define TENSORSTACK_CORE_CONTROLLER_H
 
 #include "memory.h"
+#include "memory/budget.h"
 
 #include <utils/api.h>
 
@@ -31,6 +32,13 @@ namespace ts {
          * @return
          */
         virtual uint64_t summary() const { return 0; };
+
+        /**
+         * Release idle memory kept for reusing
+         * @param high_water bytes of memory to keep under control
+         * @return released bytes
+         */
+        virtual uint64_t trim(uint64_t high_water) { return 0; }
     };
 
     class TS_DEBUG_API DynamicMemoryController : public MemoryController {
@@ -43,6 +51,13 @@ namespace ts {
          */
         explicit DynamicMemoryController(const MemoryDevice &device);
 
+        /**
+         * @param budget memory allocated is charged to, nullptr for no limit
+         * @param device the memory device
+         * @note budget goes first, so braced device like {CPU, 0} never converts to controller
+         */
+        explicit DynamicMemoryController(const MemoryBudget::shared &budget, const MemoryDevice &device);
+
         Memory alloc(size_t size) override;
 
     private:
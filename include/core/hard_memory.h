@@ -59,6 +59,16 @@ namespace ts {
          */
         explicit HardMemory(const MemoryDevice &device, void *data, size_t size);
 
+        /**
+         * Initialize hardware memory
+         * @param device memory @sa Device
+         * @param data borrowed memory pointer
+         * @param size borrowed memory size
+         * @param release called with data when this memory disposed, take back the borrowed memory
+         */
+        explicit HardMemory(const MemoryDevice &device, void *data, size_t size,
+                            const std::function<void(void *)> &release);
+
         ~HardMemory();
 
         /**
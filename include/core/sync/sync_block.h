@@ -8,6 +8,9 @@
 #include <functional>
 #include <map>
 #include <utility>
+#include <memory>
+#include <new>
+#include <type_traits>
 
 #include <utils/mutex.h>
 #include <utils/log.h>
@@ -15,6 +18,12 @@
 #include <utils/api.h>
 
 namespace ts {
+    /**
+     * Value synchronized on keys, like memory on devices.
+     * Value on default key is kept in block, so single key block needs no more allocation,
+     *     and reading default value is lock free.
+     * Values on other keys are saved in param, which created at first synchronization and shared by views.
+     */
     template <typename _KEY, typename _VALUE>
     class TS_DEBUG_API SyncBlock {
     public:
@@ -30,37 +39,31 @@ namespace ts {
         self &operator=(const self &) = delete;
 
         SyncBlock(const _KEY &key, const _VALUE &value, const sync_handler &handler, bool need_lock)
-                : m_param(Param::Shared(handler)) {
-            m_default_key = key;
+                : self(key, value, std::make_shared<sync_handler>(handler), need_lock) {
+        }
+
+        /**
+         * @param handler shared handler, saving a copy of std::function for each block
+         */
+        SyncBlock(const _KEY &key, const _VALUE &value, std::shared_ptr<const sync_handler> handler, bool need_lock)
+                : m_default_key(key), m_handler(std::move(handler)) {
+            m_default_value = new (&m_value) _VALUE(value);
             if (need_lock) m_mutex = std::make_shared<ts::rwmutex>();
-            this->set(key, value);
         }
 
-    private:
-        void set(const _KEY &key, const _VALUE &value) {
-            auto _write = this->lock_write();
-            if (key == m_default_key) {
-                m_param->m_sync_values.clear();
-                auto pair_it_flag = m_param->m_sync_values.insert(std::make_pair(key, value));
-                m_default_value = &(pair_it_flag.first->second);
-            } else {
-                m_param->m_sync_values.clear();
-                m_param->m_sync_values.insert(std::make_pair(key, value));
-                auto default_key = key;
-                auto default_value = m_param->m_hanlder(value, key, m_default_key);
-                auto pair_it_flag = m_param->m_sync_values.insert(std::make_pair(default_key, default_value));
-                m_default_value = &(pair_it_flag.first->second);
-            }
+        ~SyncBlock() {
+            if (owned()) m_default_value->~_VALUE();
         }
 
+    private:
         _VALUE &get(const _KEY &key) {
-            auto _read = this->lock_read();
             if (key == m_default_key) return *m_default_value;
-            auto it = m_param->m_sync_values.find(key);
-            if (it == m_param->m_sync_values.end()) {
+            auto _read = this->lock_read();
+            auto value = m_param ? m_param->find(key) : nullptr;
+            if (value == nullptr) {
                 TS_LOG_ERROR << "Can not access key=" << key << eject;
             }
-            return it->second;
+            return *value;
         }
 
         const _VALUE &get(const _KEY &key) const {
@@ -69,27 +72,22 @@ namespace ts {
 
         void clear() {
             auto _write = this->lock_write();
-            auto kept_value = *m_default_key;
-            m_param->m_sync_values.clear();
-            auto pair_it_flag = m_param->m_sync_values.insert(std::make_pair(m_default_key, kept_value));
-            m_default_value = &(pair_it_flag.first->second);
+            if (m_param) m_param->keep(m_default_key);
         }
 
         void clear(const _KEY &key) {
-            auto _write = this->lock_write();
             if (key == m_default_key) TS_LOG_ERROR << "Can not clear default key=" << key << eject;
-            m_param->m_sync_values.erase(key);
+            auto _write = this->lock_write();
+            if (m_param) m_param->m_sync_values.erase(key);
         }
 
     public:
         _VALUE &sync(const _KEY &key) {
+            if (key == m_default_key) return *m_default_value;
             {
                 auto _read = this->lock_read();
-                if (key == m_default_key) return *m_default_value;
-                auto it = m_param->m_sync_values.find(key);
-                if (it != m_param->m_sync_values.end()) {
-                    return it->second;
-                }
+                auto value = m_param ? m_param->find(key) : nullptr;
+                if (value) return *value;
             }
             {
                 auto _write = this->lock_write();
@@ -102,34 +100,22 @@ namespace ts {
         }
 
         const _VALUE &value() const {
-            auto _read = this->lock_read();
+            return *m_default_value;
+        }
+
+        _VALUE &value() {
             return *m_default_value;
         }
 
         shared view(const _KEY &key) {
             std::shared_ptr<self> dolly(new self);
-            if (key == m_default_key) {
-                auto _write = this->lock_read();
-                dolly->m_default_key = m_default_key;
-                dolly->m_default_value = m_default_value;
-                dolly->m_param = m_param;
-                dolly->m_mutex = m_mutex;
-            } else {
-                auto _write = this->lock_write();
-                _VALUE *dolly_value = nullptr;
-
-                auto it = m_param->m_sync_values.find(key);
-                if (it != m_param->m_sync_values.end()) {
-                    dolly_value = &it->second;
-                } else {
-                    dolly_value = &this->sync_insert(key);
-                }
-
-                dolly->m_default_key = key;
-                dolly->m_default_value = dolly_value;
-                dolly->m_param = m_param;
-                dolly->m_mutex = m_mutex;
-            }
+            auto _write = this->lock_write();
+            auto &param = this->param();
+            dolly->m_default_key = key;
+            dolly->m_default_value = key == m_default_key ? &this->default_insert(param) : &this->sync_insert(key);
+            dolly->m_handler = m_handler;
+            dolly->m_param = m_param;
+            dolly->m_mutex = m_mutex;
             return std::move(dolly);
         }
 
@@ -137,15 +123,15 @@ namespace ts {
         // be careful, this action may disable already exist view
         void broadcast() {
             auto _write = this->lock_write();
-            auto key = m_default_key;
-            auto value = *m_default_value;
-            m_param->m_sync_values.clear();
-            auto pair_it_flag = m_param->m_sync_values.insert(std::make_pair(key, value));
-            m_default_value = &(pair_it_flag.first->second);
+            if (m_param) m_param->keep(m_default_key);
         }
 
         void foreach(const std::function<void(const _KEY &key, const _VALUE &value)> &handler) const {
             auto _read = this->lock_read();
+            if (!m_param) {
+                handler(m_default_key, *m_default_value);
+                return;
+            }
             for (auto &pair : this->m_param->m_sync_values) {
                 handler(pair.first, pair.second);
             }
@@ -154,68 +140,126 @@ namespace ts {
     private:
         SyncBlock() = default;
 
+        class Param;
+
+        /**
+         * @return param, created with default value if not exists
+         * @note must be called in write lock
+         */
+        Param &param() {
+            if (!m_param) {
+                m_param = std::make_shared<Param>();
+                m_param->m_sync_values.insert(std::make_pair(m_default_key, *m_default_value));
+            }
+            return *m_param;
+        }
+
+        /**
+         * @return default value in param, synchronized back if evicted by broadcast of other view
+         * @note must be called in write lock
+         */
+        _VALUE &default_insert(Param &param) {
+            auto found = param.find(m_default_key);
+            if (found) return *found;
+            if (!param.m_sync_values.empty()) {
+                auto &from = *param.m_sync_values.begin();
+                *m_default_value = (*m_handler)(from.second, from.first, m_default_key);
+            }
+            auto pair_it = param.m_sync_values.insert(std::make_pair(m_default_key, *m_default_value));
+            return pair_it.first->second;
+        }
+
         _VALUE &sync_insert(const _KEY &key) {
             if (key == m_default_key) return *m_default_value;
-            auto it = m_param->m_sync_values.find(key);
-            if (it != m_param->m_sync_values.end()) {
-                return it->second;
-            }
-            _VALUE value = m_param->m_hanlder(*m_default_value, m_default_key, key);
-            auto pair_it = m_param->m_sync_values.insert(std::make_pair(key, value));
+            auto &param = this->param();
+            auto found = param.find(key);
+            if (found) return *found;
+            _VALUE value = (*m_handler)(*m_default_value, m_default_key, key);
+            auto pair_it = param.m_sync_values.insert(std::make_pair(key, value));
             return pair_it.first->second;
         }
 
-        using unique_read_lock = ts::unique_read_lock<ts::rwmutex>;
-        using unique_write_lock = ts::unique_write_lock<ts::rwmutex>;
+        /**
+         * lock rwmutex if given, without allocation
+         */
+        template <void (ts::rwmutex::*LOCK)(), void (ts::rwmutex::*RELEASE)()>
+        class MayLock {
+        public:
+            explicit MayLock(ts::rwmutex *mutex) : m_mutex(mutex) {
+                if (m_mutex) (m_mutex->*LOCK)();
+            }
+
+            ~MayLock() {
+                if (m_mutex) (m_mutex->*RELEASE)();
+            }
 
-        std::unique_ptr<unique_read_lock> lock_read() const {
-            if (m_mutex) {
-                return std::unique_ptr<unique_read_lock>(new unique_read_lock(*m_mutex));
-            } else {
-                return std::unique_ptr<unique_read_lock>(nullptr);
+            MayLock(MayLock &&other) TS_NOEXCEPT : m_mutex(other.m_mutex) {
+                other.m_mutex = nullptr;
             }
+
+            MayLock(const MayLock &) = delete;
+            MayLock &operator=(const MayLock &) = delete;
+
+        private:
+            ts::rwmutex *m_mutex;
+        };
+
+        using may_read_lock = MayLock<&ts::rwmutex::lock_read, &ts::rwmutex::release_read>;
+        using may_write_lock = MayLock<&ts::rwmutex::lock_write, &ts::rwmutex::release_write>;
+
+        may_read_lock lock_read() const {
+            return may_read_lock(m_mutex.get());
         }
 
-        std::unique_ptr<unique_write_lock> lock_write() const {
-            if (m_mutex) {
-                return std::unique_ptr<unique_write_lock>(new unique_write_lock(*m_mutex));
-            } else {
-                return std::unique_ptr<unique_write_lock>(nullptr);
-            }
+        may_write_lock lock_write() const {
+            return may_write_lock(m_mutex.get());
         }
 
         class Param {
         public:
             using self = Param;
-            using shared = std::shared_ptr<self>;
 
             std::map<_KEY, _VALUE> m_sync_values;
-            sync_handler m_hanlder;
 
-            Param(const sync_handler &handler)
-                    : m_hanlder(handler) {
+            _VALUE *find(const _KEY &key) {
+                auto it = m_sync_values.find(key);
+                return it == m_sync_values.end() ? nullptr : &it->second;
             }
 
-            static shared Shared(const sync_handler &handler) {
-                return std::make_shared<self>(handler);
+            /**
+             * remove values on other keys
+             */
+            void keep(const _KEY &key) {
+                for (auto it = m_sync_values.begin(); it != m_sync_values.end();) {
+                    if (it->first == key) ++it;
+                    else it = m_sync_values.erase(it);
+                }
             }
         };
 
+        bool owned() const { return m_default_value == reinterpret_cast<const _VALUE *>(&m_value); }
+
         _KEY m_default_key;
-        _VALUE *m_default_value;
+        // value of default key, constructed only in block not from view
+        typename std::aligned_storage<sizeof(_VALUE), alignof(_VALUE)>::type m_value;
+        _VALUE *m_default_value = nullptr;
 
+        std::shared_ptr<const sync_handler> m_handler;
         std::shared_ptr<Param> m_param;
         std::shared_ptr<ts::rwmutex> m_mutex;
 
-        // std::shared_ptr<unique_write_lock> m_locked;
     public:
         SyncBlock(self &&other) {
             *this = std::move(other);
         }
         SyncBlock &operator=(self &&other) TS_NOEXCEPT {
 #define MOVE_MEMBER(member) this->member = std::move(other.member)
+            if (this->owned()) m_default_value->~_VALUE();
             MOVE_MEMBER(m_default_key);
-            MOVE_MEMBER(m_default_value);
+            this->m_default_value = other.owned()
+                                    ? new (&m_value) _VALUE(std::move(*other.m_default_value))
+                                    : other.m_default_value;
+            MOVE_MEMBER(m_handler);
             MOVE_MEMBER(m_param);
             MOVE_MEMBER(m_mutex);
 #undef MOVE_MEMBER
@@ -42,6 +42,13 @@ namespace ts {
         virtual SyncMemoryController::shared clone() const = 0;
 
         virtual std::string summary() const { return "{}"; }
+
+        /**
+         * Release idle memory kept for reusing, on each device
+         * @param high_water bytes of memory to keep on each device
+         * @return released bytes
+         */
+        virtual uint64_t trim(uint64_t high_water) { return 0; }
     };
 
     class TS_DEBUG_API SyncDeviceMemoryController : public SyncMemoryController {
@@ -75,15 +82,37 @@ namespace ts {
 
         using BaseMemoryController = _MemoryController;
 
-        static shared Make(const MemoryDevice &device, bool need_lock = false) {
-            return shared(new self(device, need_lock));
+        /**
+         * @param device default device
+         * @param need_lock if memory need lock when syncing
+         * @param budget memory allocated on default device is charged to, nullptr for no limit
+         * @return controller
+         */
+        static shared Make(const MemoryDevice &device, bool need_lock = false,
+                           const MemoryBudget::shared &budget = nullptr) {
+            shared controller(new self(device, need_lock, budget));
+            // weak reference, so memory synced after controller released is allocated dynamically
+            std::weak_ptr<self> weak_controller = controller;
+            controller->m_sync_handler = std::make_shared<SyncMemory::Block::sync_handler>(
+                    [weak_controller](const typename SyncMemory::Block::value_t &from_memory,
+                                      const typename SyncMemory::Block::key_t &from_device,
+                                      const typename SyncMemory::Block::key_t &to_device) {
+                        auto shared_this = weak_controller.lock();
+                        if (!shared_this) return SyncMemory::dynamic_sync_handler(from_memory, from_device, to_device);
+                        auto controller = shared_this->m_sync_controllers.sync(to_device);
+                        auto to_memory = controller->alloc(from_memory.size());
+                        memcpy(to_memory, from_memory);
+                        return to_memory;
+                    });
+            return controller;
         }
 
     private:
-        HypeSyncMemoryController(const MemoryDevice &device, bool need_lock = false)
+        HypeSyncMemoryController(const MemoryDevice &device, bool need_lock, const MemoryBudget::shared &budget)
                 : SyncDeviceMemoryController(device)
-                , m_sync_controllers(device, std::make_shared<BaseMemoryController>(device), sync_controller_handler, need_lock)
-                , m_memory_need_lock(need_lock) {
+                , m_sync_controllers(device, std::make_shared<BaseMemoryController>(budget, device), sync_controller_handler, need_lock)
+                , m_memory_need_lock(need_lock)
+                , m_budget(budget) {
         }
 
     public:
@@ -98,23 +127,15 @@ namespace ts {
         SyncMemory alloc(const MemoryDevice &device, size_t size) override {
             auto controller = m_sync_controllers.sync(device);
             auto memory = controller->alloc(size);
-            return SyncMemory(memory, m_memory_need_lock, this->sync_handler());
+            return SyncMemory(memory, m_memory_need_lock, m_sync_handler);
         }
 
         SyncMemoryController::shared clone() const override {
-            return shared(new self(m_device, m_memory_need_lock));
+            return Make(m_device, m_memory_need_lock, m_budget);
         }
 
-        SyncMemory::Block::sync_handler sync_handler() {
-            auto shared_this = this->shared_from_this();
-            return [=](const typename SyncMemory::Block::value_t &from_memory,
-                       const typename SyncMemory::Block::key_t &from_device,
-                       const typename SyncMemory::Block::key_t &to_device) {
-                auto controller = shared_this->m_sync_controllers.sync(to_device);
-                auto to_memory = controller->alloc(from_memory.size());
-                memcpy(to_memory, from_memory);
-                return to_memory;
-            };
+        const std::shared_ptr<const SyncMemory::Block::sync_handler> &sync_handler() const {
+            return m_sync_handler;
         }
 
         std::string summary() const override {
@@ -132,6 +153,16 @@ namespace ts {
             return oss.str();
         }
 
+        uint64_t trim(uint64_t high_water) override {
+            uint64_t released = 0;
+            m_sync_controllers.foreach([&](
+                    const typename SyncControllerBlock::key_t &,
+                    const typename SyncControllerBlock::value_t &controller){
+                released += controller->trim(high_water);
+            });
+            return released;
+        }
+
     private:
         using SyncControllerBlock = SyncBlock<MemoryDevice, std::shared_ptr<BaseMemoryController>>;
 
@@ -139,6 +170,11 @@ namespace ts {
 
         bool m_memory_need_lock;
 
+        MemoryBudget::shared m_budget;
+
+        // shared by all memory allocated from this controller
+        std::shared_ptr<const SyncMemory::Block::sync_handler> m_sync_handler;
+
         static typename SyncControllerBlock::value_t sync_controller_handler(
                 const typename SyncControllerBlock::value_t &,
                 const typename SyncControllerBlock::key_t &,
@@ -26,12 +26,25 @@ namespace ts {
             return to_memory;
         }
 
+        /**
+         * @return shared dynamic_sync_handler
+         */
+        static const std::shared_ptr<const Block::sync_handler> &DynamicSyncHandler() {
+            static const std::shared_ptr<const Block::sync_handler> handler =
+                    std::make_shared<Block::sync_handler>(dynamic_sync_handler);
+            return handler;
+        }
+
         SyncMemory(const Memory &memory, bool lock, Block::sync_handler handler) {
             m_sync_memory = std::make_shared<Block>(memory.device(), memory, handler, lock);
         }
 
+        SyncMemory(const Memory &memory, bool lock, std::shared_ptr<const Block::sync_handler> handler) {
+            m_sync_memory = std::make_shared<Block>(memory.device(), memory, std::move(handler), lock);
+        }
+
         SyncMemory(const Memory &memory, bool lock = false)
-            : SyncMemory(memory, lock, dynamic_sync_handler){}
+            : SyncMemory(memory, lock, DynamicSyncHandler()){}
 
         SyncMemory(const MemoryDevice &device, size_t size, bool lock = false)
             : SyncMemory(Memory(device, size), lock) {}
@@ -139,10 +152,7 @@ namespace ts {
          * Get memory pointer
          * @return memory pointer
          */
-        void *data() {
-            auto default_value = m_sync_memory->value();
-            return default_value.data();
-        }
+        void *data() { return m_sync_memory->value().data(); }
 
         /**
          * Get memory pointer
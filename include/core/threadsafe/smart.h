@@ -9,6 +9,8 @@
 #include "core/memory.h"
 
 #include <atomic>
+#include <new>
+#include <type_traits>
 
 #include <utils/api.h>
 
@@ -35,31 +37,37 @@ namespace ts {
         Counter(Object *object, int count)
             : object(object), use_count(count) {}
 
-        Counter(const Object &object) : self(new Object(object), 1) {}
+        /**
+         * object kept in counter, so one allocation for both
+         */
+        Counter(const Object &object)
+            : object(new (&storage) Object(object)), use_count(1), inplace(true) {}
+
+        Counter(Object &&object)
+            : object(new (&storage) Object(std::move(object))), use_count(1), inplace(true) {}
 
         ~Counter() {
-            if (object) deleter(object);
+            if (object == nullptr) return;
+            if (inplace) object->~Object();
+            else if (deleter) deleter(object);
+            else delete object;
         }
 
         Counter(const self &) = delete;
 
         Counter &operator=(const self &) = delete;
 
-        Counter(self &&other) {
-            *this == std::move(other);
-        }
+        Counter(self &&other) = delete;
 
-        Counter &operator==(self &&other) TS_NOEXCEPT {
-#define MOVE_MEMBER(member) this->member = std::move(other.member)
-            MOVE_MEMBER(object);
-            MOVE_MEMBER(use_count);
-#undef MOVE_MEMBER
-            return *this;
-        }
+        Counter &operator=(self &&other) = delete;
 
         Object *object = nullptr;
         int use_count = 0;
-        Deleter deleter = default_deleter<T>();
+        Deleter deleter;    ///< delete object if not set
+
+    private:
+        bool inplace = false;
+        typename std::aligned_storage<sizeof(Object), alignof(Object)>::type storage;
     };
 
     enum SmartMode {
@@ -80,6 +88,9 @@ namespace ts {
         Smart(const Object &object)
                 : m_mode(SMART), m_counted(new CountedObject(object)) {}
 
+        Smart(Object &&object)
+                : m_mode(SMART), m_counted(new CountedObject(std::move(object))) {}
+
         Smart(Object *object, const typename Counter<T>::Deleter &deleter)
                 : m_mode(SMART), m_counted(new CountedObject(object, 1, deleter)) {}
 
@@ -182,7 +193,7 @@ namespace ts {
 
     template <typename T, typename ...Args>
     TS_DEBUG_API Smart<T> make_smart(Args &&...args) {
-        return Smart<T>(new T(std::forward<Args>(args)...), default_deleter<T>());
+        return Smart<T>(T(std::forward<Args>(args)...));
     }
 }
 
@@ -9,7 +9,14 @@
 #include "module/io/stream.h"
 #include "utils/implement.h"
 
+#include <cstdint>
+
 namespace ts {
+    enum class EncryptionMode : int32_t {
+        AES_ECB = 0,    ///< AES-256-ECB with PKCS7 padding, readable by all versions
+        AES_CTR = 1,    ///< AES-256-CTR with random iv saved in header, not readable by version before it added
+    };
+
     class TS_DEBUG_API EncryptedFileStreamReader : public StreamReader {
     public:
         using self = EncryptedFileStreamReader;
@@ -37,6 +44,35 @@ namespace ts {
 
         size_t read(void *buffer, size_t size) final;
 
+        /**
+         * @return mode of opened file, detected from file header
+         */
+        EncryptionMode mode() const;
+
+        /**
+         * @return bytes of decrypted content
+         */
+        size_t size() const;
+
+        /**
+         * @return reading position in decrypted content
+         */
+        size_t tell() const;
+
+        /**
+         * move reading position, only blocks needed are read and decrypted after seek
+         * @param offset position in decrypted content
+         * @return false if offset over size or file is broken
+         */
+        bool seek(size_t offset);
+
+        /**
+         * set number of threads decrypting big reads, default is hardware concurrency.
+         * ThreadPool bound in context is used first if exists.
+         * @param number thread number
+         */
+        void set_computing_thread_number(int number);
+
     private:
         class Implement;
         Declare<Implement> m_impl;
@@ -62,6 +98,14 @@ namespace ts {
          */
         explicit EncryptedFileStreamWriter(const std::string &path, const std::string &key);
 
+        /**
+         *
+         * @param path file path
+         * @param key length over 32 will be ignore
+         * @param mode encryption mode, CTR for streaming and random access reading
+         */
+        explicit EncryptedFileStreamWriter(const std::string &path, const std::string &key, EncryptionMode mode);
+
         ~EncryptedFileStreamWriter();
 
         bool is_open() const;
@@ -5,34 +5,28 @@
 #ifndef TENSORSTACK_KERNELS_COMMON_OPENMP_H
 #define TENSORSTACK_KERNELS_COMMON_OPENMP_H
 
-#ifdef TS_USE_OPENMP
-#include <omp.h>
-#include "runtime/runtime.h"
-#include <algorithm>
+#include "runtime/inside/parallel.h"
 
 // #define TS_OPENMP_BLOCK_SIZE 10240
 
-#endif
+/**
+ * Kernels run parallel by `parallel_for` on the ThreadPool of RuntimeContext, no OpenMP needed.
+ * The openmp_xxx names are kept for old kernels.
+ */
 
 namespace ts {
+    /**
+     * @return number of threads `parallel_for` could use
+     */
     inline int openmp_threads(const int = 0) {
-#ifdef TS_USE_OPENMP
-        auto max_threads = omp_get_num_procs();
-        auto runtime = ctx::ptr<RuntimeContext>();
-        if (runtime == nullptr) return max_threads;
-        if (runtime->get_computing_thread_number() <= 0) return max_threads;
-        return runtime->get_computing_thread_number();
-#else
-        return 1;
-#endif
+        return int(parallel_size());
     }
 
+    /**
+     * @return id of calling thread in `parallel_for` or `parallel_run`, in [0, openmp_threads())
+     */
     inline int openmp_thread_id() {
-#ifdef TS_USE_OPENMP
-        return omp_get_thread_num();
-#else
-        return 0;
-#endif
+        return ThreadPool::ThreadID();
     }
 }
 
@@ -18,6 +18,11 @@ namespace ts {
                                            float rz20, float rz21, float rz22, Affine_Sample2DType type, int dim,
                                            base::AffineOuterMode outer_mode, float outer_value,
                                            Tensor &out) override;
+
+            void affine_sample_batch_run(const Tensor &x, const float *affine, int number,
+                                         Affine_Sample2DType type, int dim,
+                                         base::AffineOuterMode outer_mode, float outer_value,
+                                         Tensor &out) override;
         };
     }
 }
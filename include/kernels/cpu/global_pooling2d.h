@@ -8,11 +8,21 @@
 
 namespace ts {
     namespace cpu {
-        using GlobalPooling2D = base::Pooling2DWithCore<OperatorOnCPU<base::GlobalPooling2D>, Pooling2DCore>;
+        /**
+         * Global pooling is reduction over spatial axes, use ReduceAlgorithm instead of sliding window.
+         * Support both NCHW and NHWC.
+         */
+        class GlobalPooling2DCore : public base::Pooling2DCore {
+        public:
+            void pooling2d(const Tensor &x, Pooling2DType type,
+                           const Padding2D &padding, Padding2DType padding_type,
+                           const Size2D &ksize, const Stride2D &stride,
+                           Conv2DFormat format, Tensor &out) override;
+        };
+
+        using GlobalPooling2D = base::Pooling2DWithCore<OperatorOnCPU<base::GlobalPooling2D>, GlobalPooling2DCore>;
     }
 }
 
 
 #endif //TENSORSTACK_KERNELS_CPU_GLOBAL_POOLING2D_H
-
-
@@ -12,6 +12,43 @@ namespace ts {
     void *cpu_allocator(int id, size_t new_size, void *mem, size_t mem_size);
 
     void cpu_converter(int dst_id, void *dst, int src_id, const void *src, size_t size);
+
+    /**
+     * Settings of cpu_allocator, effect memory allocated after setting.
+     * Blocks not smaller than large block size are mapped from system directly,
+     *     so they are given back to system once freed, and can be backed by huge pages.
+     */
+    class TS_DEBUG_API CPUAllocator {
+    public:
+        enum class HugePage : int32_t {
+            NONE = 0,       ///< normal pages
+            ADVISE = 1,     ///< madvise(MADV_HUGEPAGE) on large blocks, for transparent huge pages
+            HUGETLB = 2,    ///< map large blocks from hugetlb pool, fallback to ADVISE if pool not enough
+        };
+
+        /**
+         * @param alignment power of 2, at least 16, default 64
+         */
+        static void SetAlignment(size_t alignment);
+
+        static size_t GetAlignment();
+
+        /**
+         * @param mode huge page mode, default NONE
+         * @note only linux supports huge pages, other platforms keep using normal pages
+         */
+        static void SetHugePage(HugePage mode);
+
+        static HugePage GetHugePage();
+
+        /**
+         * @param size in bytes, default 2MB
+         * @note only linux maps blocks directly, other platforms use malloc for all blocks
+         */
+        static void SetLargeBlockSize(size_t size);
+
+        static size_t GetLargeBlockSize();
+    };
 }
 
 
@@ -22,6 +22,29 @@ namespace ts {
             static void max_pooling_k2s2(const Tensor &input,
                                          Tensor &out,
                                          const Padding2D &padding);
+
+            /**
+             * Max pooling for any kernel and stride, NCHW.
+             * Separable running max, O(1) cost of each output no matter the kernel size.
+             * Window is clamped in input, parallel on channels.
+             */
+            static void max_pooling(const Tensor &input,
+                                    Tensor &out,
+                                    const Padding2D &padding,
+                                    const KSize2D &ksize,
+                                    const Stride2D &stride);
+
+            /**
+             * Average pooling for any kernel and stride, NCHW.
+             * Separable running sum, O(1) cost of each output no matter the kernel size.
+             * BLACK padding divides by the count of clamped window, WHITE padding divides by kernel size.
+             */
+            static void avg_pooling(const Tensor &input,
+                                    Tensor &out,
+                                    const Padding2D &padding,
+                                    const KSize2D &ksize,
+                                    const Stride2D &stride,
+                                    Padding2DType padding_type);
         };
     }//cpu
 }//ts
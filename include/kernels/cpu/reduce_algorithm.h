@@ -0,0 +1,61 @@
+#ifndef TENSORSTACK_KERNELS_CPU_REDUCE_ALGORITHM_H
+#define TENSORSTACK_KERNELS_CPU_REDUCE_ALGORITHM_H
+
+#include <core/tensor.h>
+#include <core/dtype.h>
+
+#include <vector>
+
+namespace ts {
+    namespace cpu {
+        enum class ReduceType {
+            SUM = 0,
+            MEAN = 1,
+            MAX = 2,
+            MIN = 3,
+            SUM_SQUARE = 4,
+        };
+
+        /**
+         * Reduce over an arbitrary set of axes.
+         * The layout of output is the layout of input with reduced axes removed (or set to 1),
+         *     so output can be any shape with the right count, like keep_dims or not.
+         * Adjacent axes are merged first, every reduction is done as [outer, size, inner]:
+         *     inner == 1: contiguous reduction, multi-accumulator SIMD, parallel on outer,
+         *                 or split size into chunks and combine as tree when outer is too small.
+         *     inner > 1: strided reduction, SIMD on inner, parallel on outer and inner blocks.
+         */
+        template<typename T>
+        class TS_DEBUG_API ReduceAlgorithm {
+        public:
+            /**
+             * @param x input tensor
+             * @param axes axes to reduce, negative axis supported, order and duplicates ignored
+             * @param type reduce type
+             * @param out output tensor, out.count() must equal x.count() / (product of reduced sizes)
+             */
+            static void reduce(const Tensor &x, const std::vector<int> &axes, ReduceType type, Tensor &out);
+
+            static void reduce(const T *x, const std::vector<int> &shape, const std::vector<int> &axes,
+                               ReduceType type, T *out);
+
+            /**
+             * reduce x in shape [outer, size, inner] to out in shape [outer, inner]
+             */
+            static void reduce(const T *x, int outer, int size, int inner, ReduceType type, T *out);
+        };
+    }
+}
+
+extern template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::INT8>::declare>;
+extern template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::UINT8>::declare>;
+extern template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::INT16>::declare>;
+extern template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::UINT16>::declare>;
+extern template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::INT32>::declare>;
+extern template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::UINT32>::declare>;
+extern template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::INT64>::declare>;
+extern template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::UINT64>::declare>;
+extern template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::FLOAT32>::declare>;
+extern template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::FLOAT64>::declare>;
+
+#endif //TENSORSTACK_KERNELS_CPU_REDUCE_ALGORITHM_H
@@ -0,0 +1,112 @@
+#ifndef TENSORSTACK_MEMORY_BUDGET_H
+#define TENSORSTACK_MEMORY_BUDGET_H
+
+#include "global/hard_allocator.h"
+
+#include <utils/api.h>
+
+#include <memory>
+#include <atomic>
+#include <string>
+
+namespace ts {
+    /**
+     * Limit of memory allocated from device, shared by memory controllers of one workbench.
+     * Allocation exceeding limit throws OutOfMemoryException,
+     *     so the runtime can degrade to lower memory way, like smaller im2col tiles or splitting the batch.
+     */
+    class TS_DEBUG_API MemoryBudget : public std::enable_shared_from_this<MemoryBudget> {
+    public:
+        using self = MemoryBudget;
+        using shared = std::shared_ptr<self>;  ///< smart pointer
+
+        /**
+         * reclaim idle memory kept by controller, return released bytes
+         */
+        using reclaimer = std::function<uint64_t()>;
+
+        /**
+         * @param limit bytes of memory can be allocated, 0 for unlimited
+         */
+        explicit MemoryBudget(uint64_t limit = 0);
+
+        MemoryBudget(const self &) = delete;
+        self &operator=(const self &) = delete;
+
+        /**
+         * @param limit bytes of memory can be allocated, 0 for unlimited
+         * @note memory allocated before setting is kept, even if over new limit
+         */
+        void set_limit(uint64_t limit);
+
+        uint64_t limit() const { return m_limit; }
+
+        bool limited() const { return m_limit > 0; }
+
+        /**
+         * @return bytes allocated in budget
+         */
+        uint64_t used() const { return m_used; }
+
+        /**
+         * @return the most bytes allocated at same time
+         */
+        uint64_t peak() const { return m_peak; }
+
+        /**
+         * @return bytes can still be allocated, max of uint64_t if unlimited
+         */
+        uint64_t available() const;
+
+        /**
+         * @return count of refused allocations
+         */
+        uint64_t refused() const { return m_refused; }
+
+        /**
+         * @return count of computing degraded to lower memory way
+         */
+        uint64_t degraded() const { return m_degraded; }
+
+        /**
+         * tell budget one computing is degraded because of it
+         */
+        void degrade() { ++m_degraded; }
+
+        /**
+         * @return json string of limit and counters
+         */
+        std::string summary() const;
+
+        /**
+         * charge memory allocated by allocator to this budget
+         * @param device allocating device
+         * @param allocator HardAllocator to wrap
+         * @param reclaim called once before refusing allocation, could be nullptr
+         * @return wrapped allocator
+         * @note budget must be owned by shared_ptr, the wrapped allocator throws OutOfMemoryException if limit reached
+         */
+        HardAllocator::function wrap(const MemoryDevice &device, const HardAllocator::function &allocator,
+                                     const reclaimer &reclaim = nullptr);
+
+        /**
+         * get memory budget of running workbench
+         * @return nullptr if not running in workbench
+         */
+        static shared Running();
+
+    private:
+        bool acquire(uint64_t size);
+
+        void release(uint64_t size);
+
+        std::atomic<uint64_t> m_limit;
+        std::atomic<uint64_t> m_used;
+        std::atomic<uint64_t> m_peak;
+        std::atomic<uint64_t> m_refused;
+        std::atomic<uint64_t> m_degraded;
+    };
+}
+
+
+#endif //TENSORSTACK_MEMORY_BUDGET_H
@@ -34,12 +34,21 @@ namespace ts {
          */
         explicit VatMemoryController(const MemoryDevice &device);
 
+        /**
+         * @param budget memory allocated is charged to, nullptr for no limit
+         * @param device the memory device
+         * @note idle memory kept for reusing is released before budget refusing allocation
+         */
+        explicit VatMemoryController(const MemoryBudget::shared &budget, const MemoryDevice &device);
+
         ~VatMemoryController() override;
 
         Memory alloc(size_t size) override;
 
         uint64_t summary() const override ;
 
+        uint64_t trim(uint64_t high_water) override;
+
     private:
         class Implement;
         Declare<Implement> m_impl;
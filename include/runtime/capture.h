@@ -0,0 +1,126 @@
+#ifndef TENSORSTACK_RUNTIME_CAPTURE_H
+#define TENSORSTACK_RUNTIME_CAPTURE_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <deque>
+
+#include "runtime/program.h"
+#include "core/tensor.h"
+#include "core/controller.h"
+
+namespace ts {
+    /**
+     * Capture outputs of named nodes while program running, for debug or monitoring in production.
+     * Node names are resolved to instruction indices once, so running instructions not captured costs one compare.
+     * Captured values are copied into ring buffer of slots on CPU, each slot keeps outputs of one sampled run,
+     *     tensors of slot are allocated at first capture and reused by later runs with same prototype.
+     * One run is sampled in every interval runs, only successfully finished runs are seen.
+     */
+    class TS_DEBUG_API Capture {
+    public:
+        using self = Capture;
+        using shared = std::shared_ptr<self>;
+
+        /**
+         * @param program running program, operators in it are found by name
+         * @param node_names names of nodes, whose first output captured
+         * @param slots number of latest sampled runs kept
+         * @param interval sample one run in every interval runs, 0 for never
+         * @note names not in program are ignored, as they may be optimized out in compiling
+         */
+        Capture(const Program &program, const std::vector<std::string> &node_names, int slots = 1, int interval = 1);
+
+        Capture(const self &) = delete;
+
+        self &operator=(const self &) = delete;
+
+        const std::vector<std::string> &names() const { return m_names; }
+
+        int slots() const { return int(m_slots.size()) - 1; }
+
+        void set_interval(int interval);
+
+        int interval() const { return m_interval; }
+
+        /**
+         * start one run
+         * @return if this run sampled, call capture and commit only if true
+         */
+        bool sample();
+
+        /**
+         * @param instruction index of instruction in program
+         * @return index in names of captured node, -1 if instruction not captured
+         */
+        int index_of(size_t instruction) const {
+            return instruction < m_index.size() ? m_index[instruction] : -1;
+        }
+
+        /**
+         * capture output of instruction, called after instruction run
+         * @param instruction index of instruction in program
+         * @param stack running stack, with outputs of instruction on top
+         */
+        void capture(size_t instruction, const Stack &stack);
+
+        /**
+         * make values captured in this run seen, overwriting oldest slot if ring full
+         */
+        void commit();
+
+        /**
+         * @return number of slots having captured values, not more than slots
+         */
+        int count() const;
+
+        /**
+         * @param age 0 for latest sampled run, 1 for the one before it, and so on
+         * @param name node name
+         * @return captured value, empty if not captured
+         * @note returned tensor is overwritten by later runs, clone it to keep
+         */
+        Tensor captured(int age, const std::string &name) const;
+
+        /**
+         * @param age 0 for latest sampled run
+         * @return serial number of captured run, counted by sample from 1, 0 if not captured
+         */
+        uint64_t serial(int age) const;
+
+        /**
+         * drop captured values, keep allocated slots
+         */
+        void clear();
+
+    private:
+        struct Slot {
+            uint64_t serial = 0;
+            std::vector<Tensor> values;
+            // if value captured in this run, values kept for reusing memory
+            std::vector<bool> written;
+        };
+
+        std::vector<std::string> m_names;
+        // capture id of each instruction, -1 for not captured
+        std::vector<int> m_index;
+        // output count of each captured instruction
+        std::vector<int> m_nresults;
+
+        int m_interval = 1;
+        uint64_t m_serial = 0;
+
+        DynamicMemoryController::shared m_controller;
+        std::vector<Slot> m_slots;
+        // slot written by running, not seen until commit
+        size_t m_writing = 0;
+        // seen slots, latest first
+        std::deque<size_t> m_ring;
+
+        mutable std::mutex m_mutex;
+    };
+}
+
+#endif //TENSORSTACK_RUNTIME_CAPTURE_H
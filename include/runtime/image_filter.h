@@ -78,6 +78,8 @@ namespace ts {
 
         /**
          * Compile all processor
+         * @note runs of resize(width, height), to_float, channel_swap, scale, sub_mean, div_std and to_chw
+         *       are fused into one pass over image
          */
         void compile();
 
@@ -91,6 +93,8 @@ namespace ts {
 
         shared clone() const;
 
+        const ComputingDevice &device() const;
+
         const Graph &graph() const;
 
         Module::shared module() const;
@@ -12,49 +12,63 @@
 #include "utils/log.h"
 #include <algorithm>
 
-#include <algorithm>
-
 // #define TS_THREAD_BLOCK_SIZE 40960
 
 namespace ts {
     using Range = std::pair<int, int>;
 
-    inline ThreadPool *try_parallel(int task_number) {
+    inline ThreadPool *try_parallel(int64_t task_number) {
         if (task_number <= 1) return nullptr;
         auto gun = ctx::ptr<ThreadPool>();
         if (gun != nullptr && gun->size() > 1) return gun;
         return nullptr;
     }
 
+    /**
+     * run func(i) for i in [begin, end) on ThreadPool bound in context, or in calling thread if no pool bound.
+     * @param begin loop begin
+     * @param end loop end
+     * @param func called as func(i), loop body
+     * @param grain min number of loops run in one thread, big grain for cheap loop body
+     * @note parallel_for in parallel_for runs in calling thread, like nested omp parallel disabled.
+     * Usage:
+     * ```
+     * parallel_for(0, 10, [&](int i) {
+     *     y[i] = x[i] * x[i];
+     * });
+     * ```
+     */
+    template <typename FUNC>
+    inline void parallel_for(int64_t begin, int64_t end, const FUNC &func, int64_t grain = 1) {
+        auto gun = try_parallel(end - begin);
+        if (gun == nullptr) {
+            for (auto i = begin; i < end; ++i) func(i);
+            return;
+        }
+        gun->parallel(begin, end, grain, [&](int, int64_t range_begin, int64_t range_end) {
+            for (auto i = range_begin; i < range_end; ++i) func(i);
+        });
+    }
+
     inline void parallel_run(const std::function<void(int, int, int)> &range_solver, int begin, int end, bool joinable = true) {
+        (void)(joinable);   // parallel always joined
         auto parallel_gun = ts::try_parallel(end - begin);
         if (parallel_gun) {
-            auto parallel_ranges = ts::split_bins(begin, end, int(parallel_gun->size()));
-            for (auto &parallel_range : parallel_ranges) {
-                parallel_gun->run([range_solver, parallel_range](int signet){
-                    range_solver(signet, parallel_range.first, parallel_range.second);
-                });
-            }
-            if (joinable) {
-                parallel_gun->join();
-            }
+            parallel_gun->parallel(begin, end, 1, [&](int signet, int64_t range_begin, int64_t range_end) {
+                range_solver(signet, int(range_begin), int(range_end));
+            });
         } else {
             range_solver(0, begin, end);
         }
     }
 
     inline void parallel_range(const std::function<void(int, const Range &)> &range_solver, int begin, int end, bool joinable = true) {
+        (void)(joinable);   // parallel always joined
         auto parallel_gun = ts::try_parallel(end - begin);
         if (parallel_gun) {
-            auto parallel_ranges = ts::split_bins(begin, end, int(parallel_gun->size()));
-            for (auto &parallel_range : parallel_ranges) {
-                parallel_gun->run([range_solver, parallel_range](int signet){
-                    range_solver(signet, parallel_range);
-                });
-            }
-            if (joinable) {
-                parallel_gun->join();
-            }
+            parallel_gun->parallel(begin, end, 1, [&](int signet, int64_t range_begin, int64_t range_end) {
+                range_solver(signet, Range(int(range_begin), int(range_end)));
+            });
         } else {
             range_solver(0, Range(begin, end));
         }
@@ -13,6 +13,7 @@
 #include <vector>
 #include <deque>
 #include <memory>
+#include <exception>
 
 #include <utils/api.h>
 #include "utils/ctxmgr_lite.h"
@@ -63,13 +64,29 @@ namespace ts {
     };
 
     /**
- * @brief The ThreadPool class the thread pool
- */
+     * @brief The ThreadPool class the thread pool
+     * Threads in pool serve both asynchronous tasks by `run` and fork-join tasks by `parallel`.
+     * The calling thread takes part in `parallel`, so pool in size N only starts N - 1 threads.
+     */
     class TS_DEBUG_API ThreadPool : public SetupContext<ThreadPool> {
     public:
         using self = ThreadPool;
         using shared = std::shared_ptr<self>;
 
+        /**
+         * task of parallel, called as task(thread_id, begin, end)
+         */
+        using range_task_type = std::function<void(int, int64_t, int64_t)>;
+
+        /**
+         * @brief How idle threads wait for next task
+         */
+        enum class WaitPolicy : int32_t {
+            PASSIVE = 0,    ///< sleep once no task, cost least cpu, but waking up takes tens of microseconds
+            HYBRID = 1,     ///< spin for spin time, then sleep, default
+            ACTIVE = 2,     ///< always spin with yield, fastest response, but keep the cores busy
+        };
+
         /**
          * @brief Shotgun
          * @param pool_size The thread number in pool. Number of threads
@@ -85,7 +102,8 @@ namespace ts {
         /**
          * @brief run Find ready thread, build task and run.
          * @param task the task ready to run
-         * @return The running thread
+         * @return nullptr, kept for compatibility
+         * @note run task in calling thread if pool has no thread
          */
         Thread *run(const Thread::task_type &task);
 
@@ -93,7 +111,7 @@ namespace ts {
          * @brief run Find ready thread, build task and run.
          * @param task the task ready to run
          * @param after_task the work after task finished
-         * @return The running thread
+         * @return nullptr, kept for compatibility
          */
         Thread *run(const Thread::task_type &task, const Thread::after_task_type &after_task);
 
@@ -114,25 +132,82 @@ namespace ts {
          */
         size_t size() const;
 
-    private:
+        /**
+         * @brief parallel split [begin, end) into chunks no smaller than grain, and run them on all threads.
+         *     Return after all chunks finished, the first exception thrown by task will be rethrown.
+         * @param begin range begin
+         * @param end range end
+         * @param grain min size of each chunk
+         * @param task called by task(thread_id, chunk_begin, chunk_end), thread_id in [0, size())
+         * @note parallel in parallel, or parallel in thread of pool, runs in calling thread directly.
+         * @note parallel from different threads are run one by one.
+         */
+        void parallel(int64_t begin, int64_t end, int64_t grain, const range_task_type &task);
+
+        void set_wait_policy(WaitPolicy policy);
+
+        WaitPolicy get_wait_policy() const;
 
         /**
-         * @brief load Get thread ready to run
-         * @return Get ready thread
+         * @param spin_time spinning time in microseconds used in HYBRID policy
          */
-        int load();
+        void set_spin_time(int spin_time);
+
+        int get_spin_time() const;
 
         /**
-         * @brief recycling_thread Recycle thread
-         * @param signet thread index
+         * @brief bind thread i of pool to cpu_ids[i % cpu_ids.size()], i in [1, size()).
+         *     thread 0 is the calling thread, which is not bound by pool.
+         * @param cpu_ids cpu ids to bind, empty for no binding
+         * @return false if binding not supported or failed
+         * @note only support linux and android now
          */
-        void recycling_thread(int signet);
+        bool set_affinity(const std::vector<int> &cpu_ids);
 
-        std::vector<Thread *> thread_pool;                     ///< all cartridges
+        const std::vector<int> &get_affinity() const;
 
-        std::mutex running_core_mutex;                  ///< mutex to get cartridges
-        std::condition_variable running_core_cond;      ///< active when cartridge pushed in chest
-        std::deque<int> running_core;                  ///< save all cartridge ready to fire
+        /**
+         * @brief id of calling thread in running parallel task, 0 if not in any parallel task.
+         */
+        static int ThreadID();
+
+    private:
+        void operating(int signet);
+
+        void wait_generation(uint64_t generation);
+
+        void join_parallel(int signet);
+
+        bool bind_affinity(int signet);
+
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cond;         ///< tell threads new generation
+        std::condition_variable m_done_cond;    ///< tell callers task finished
+        std::atomic<uint64_t> m_generation;     ///< increased on every new task
+        std::atomic<int> m_sleeping;
+        bool m_stop = false;
+
+        // parallel task
+        std::mutex m_parallel_mutex;
+        const range_task_type *m_task = nullptr;
+        int64_t m_begin = 0;
+        int64_t m_end = 0;
+        int64_t m_chunk = 1;
+        int64_t m_chunks = 0;
+        std::atomic<int64_t> m_next_chunk;
+        std::atomic<int64_t> m_done_chunks;
+        std::atomic<int> m_working;
+        std::exception_ptr m_exception;
+
+        // asynchronous tasks
+        std::deque<std::pair<Thread::task_type, Thread::after_task_type>> m_queue;
+        size_t m_running = 0;
+
+        std::atomic<int32_t> m_policy;
+        std::atomic<int> m_spin_time;
+        std::vector<int> m_affinity;
     };
 }
 
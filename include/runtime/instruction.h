@@ -99,6 +99,10 @@ namespace ts {
 
         Operator::shared op() const { return m_func; }
 
+        int nargs() const { return m_nargs; }
+
+        int nresults() const { return m_nresults; }
+
     private:
         Operator::shared m_func = nullptr;
         int m_nargs = 0;
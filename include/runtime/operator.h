@@ -66,6 +66,14 @@ namespace ts {
          */
         TensorPrototype infer(Stack &stack);
 
+        /**
+         * if run and infer can be called from many threads at same time
+         * @return true if run and infer only read operator's state, false by default
+         * @note only operators audited not to cache or change state in run return true,
+         *       others are copied for each concurrent context
+         */
+        virtual bool reentrant() const { return false; }
+
         bool has(const std::string &param) const;
 
         // the params start with "#" are Retention parameters
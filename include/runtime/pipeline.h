@@ -0,0 +1,170 @@
+#ifndef TENSORSTACK_RUNTIME_PIPELINE_H
+#define TENSORSTACK_RUNTIME_PIPELINE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+#include "core/tensor.h"
+#include "board/histogram.h"
+#include "runtime/workbench.h"
+#include "runtime/image_filter.h"
+
+namespace ts {
+    class PipelineChannel;
+
+    /**
+     * Chain stages, like preprocessing, detecting and recognizing, to run frames of stream overlapped.
+     * Each stage runs on its own worker threads, stages are linked by bounded queues,
+     *     so frame N+1 is preprocessed while frame N is inferring.
+     * Frames come out in the order pushed, even if stage has many workers.
+     * Pushing blocks when the first queue is full, and stage blocks when the next queue is full,
+     *     so frames in flight are bounded by capacities of queues.
+     * If stage throws, later stages skip the frame, and pop rethrows the exception.
+     * Usage:
+     * ```
+     * Pipeline pipeline;
+     * pipeline.add("detector", detector_bench, 2);
+     * pipeline.add("crop", [](const Pipeline::Frame &frame) { return crop(frame); });
+     * pipeline.add("recognizer", recognizer_bench);
+     * // in producer thread
+     * pipeline.push({image});
+     * pipeline.close();
+     * // in consumer thread
+     * Pipeline::Frame frame;
+     * while (pipeline.pop(frame)) {}
+     * ```
+     */
+    class TS_DEBUG_API Pipeline {
+    public:
+        using self = Pipeline;
+        using shared = std::shared_ptr<self>;
+
+        /**
+         * tensors of one frame, passed from stage to stage
+         */
+        using Frame = std::vector<Tensor>;
+
+        /**
+         * stage body, called on worker threads of stage, at same time if stage has more workers
+         */
+        using Function = std::function<Frame(const Frame &)>;
+
+        /**
+         * running statistics of stage, time in milliseconds
+         */
+        struct Statistics {
+            std::string name;
+            Histogram run;      ///< time running stage body
+            Histogram blocked;  ///< time waiting for next queue, for backpressure or frame order
+            int queued = 0;     ///< frames waiting in queue before stage
+        };
+
+        /**
+         * @param capacity capacity of each queue, for stages added without capacity, and queue of outputs
+         */
+        explicit Pipeline(int capacity = 2);
+
+        Pipeline(const self &) = delete;
+
+        self &operator=(const self &) = delete;
+
+        /**
+         * stop workers, frames in flight are dropped
+         */
+        ~Pipeline();
+
+        /**
+         * @param name stage name, for statistics and error message
+         * @param function stage body
+         * @param threads number of workers
+         * @param capacity capacity of queue before stage, 0 for pipeline's capacity
+         * @note stages can only be added before first push
+         */
+        void add(const std::string &name, const Function &function, int threads = 1, int capacity = 0);
+
+        /**
+         * run workbench on frame, frame tensors are inputs of workbench, outputs are the next frame
+         * @note workers run workbench at same time, so computing threads of workbench are shared by them
+         */
+        void add(const std::string &name, Workbench::shared bench, int threads = 1, int capacity = 0);
+
+        /**
+         * run filter on the first tensor of frame, other tensors passed to next stage
+         * @note each worker runs on its own clone of filter
+         */
+        void add(const std::string &name, ImageFilter::shared filter, int threads = 1, int capacity = 0);
+
+        /**
+         * push frame into the first stage, workers started at the first push
+         * @param frame input frame
+         * @return serial number of frame, counted from 0
+         * @note blocks if the first queue is full
+         */
+        uint64_t push(const Frame &frame);
+
+        /**
+         * @return if pushed, false if the first queue is full
+         */
+        bool try_push(const Frame &frame);
+
+        /**
+         * no more frames pushed, pop returns false after all pushed frames popped
+         */
+        void close();
+
+        /**
+         * pop frame out of the last stage, in pushed order
+         * @param [out] frame output frame
+         * @return false if pipeline closed and no frame left
+         * @note blocks until frame ready, rethrows exception if any stage failed on this frame
+         */
+        bool pop(Frame &frame);
+
+        /**
+         * @param [out] frame output frame
+         * @param [out] serial serial number of frame
+         */
+        bool pop(Frame &frame, uint64_t &serial);
+
+        /**
+         * @return number of frames pushed but not popped
+         */
+        int in_flight() const;
+
+        /**
+         * @param reset if clear histograms after read, for polling periodically
+         * @return statistics of each stage, in added order
+         */
+        std::vector<Statistics> statistics(bool reset = false);
+
+        /**
+         * @param reset if clear histogram after read
+         * @return time in milliseconds from push to pop, of each frame
+         */
+        Histogram latency(bool reset = false);
+
+    private:
+        struct Stage;
+
+        void start();
+
+        void work(Stage &stage, int worker);
+
+        int m_capacity;
+        std::vector<std::shared_ptr<Stage>> m_stages;
+        std::shared_ptr<PipelineChannel> m_outputs;
+        bool m_started = false;
+        bool m_closed = false;
+        std::mutex m_mutex;
+        std::atomic<uint64_t> m_pushed;
+        std::atomic<uint64_t> m_popped;
+        Histogram m_latency;
+    };
+}
+
+#endif //TENSORSTACK_RUNTIME_PIPELINE_H
@@ -7,6 +7,8 @@
 
 
 #include <memory>
+#include <map>
+#include <mutex>
 #include "module/module.h"
 #include "runtime/stack.h"
 #include "runtime/instruction.h"
@@ -41,6 +43,14 @@ namespace ts {
 
         shared clone() const;
 
+        /**
+         * copy of program for running in another thread at same time with this one,
+         *     data segment and reentrant operators are shared, only other operators are cloned.
+         * @return forked program
+         * @note operators' params set after fork are only seen by shared operators, fork again after setting
+         */
+        shared fork() const;
+
         void bind_filter(int slot, shared filter);
 
         shared input_filter(int slot) const;
@@ -69,6 +79,15 @@ namespace ts {
 
         const Stack &data_segment() const;
 
+        /**
+         * use copy of data segment placed on the NUMA node of RuntimeContext,
+         *     copies on each node are shared by programs cloned from the same one.
+         * @return false if RuntimeContext not placed on NUMA node
+         * @context RuntimeContext
+         * @note only memory on CPU is copied
+         */
+        bool replicate_data_segment();
+
         const std::vector<std::string> &input_names() const;
 
         const std::vector<std::string> &output_names() const;
@@ -82,6 +101,8 @@ namespace ts {
         std::vector<Instruction::shared> m_program; // running function, program area
 
         Stack::shared m_data_segment;   // save static area
+        // copies of static area on each NUMA node, shared in clones
+        std::shared_ptr<std::map<int, Stack::shared>> m_data_segment_replicas;
         // map slot, means <tensor'name, tensor's index in stack>
         map<std::string, int> m_map_input_slots;
         map<std::string, int> m_map_output_slots;
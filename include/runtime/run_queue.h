@@ -0,0 +1,127 @@
+#ifndef TENSORSTACK_RUNTIME_RUN_QUEUE_H
+#define TENSORSTACK_RUNTIME_RUN_QUEUE_H
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <atomic>
+
+#include "core/tensor.h"
+#include "utils/except.h"
+
+namespace ts {
+    /**
+     * thrown to request cancelled before running
+     */
+    class TS_DEBUG_API RunCancelledException : public Exception {
+    public:
+        explicit RunCancelledException(uint64_t request);
+
+        uint64_t request() const { return m_request; }
+
+    private:
+        uint64_t m_request;
+    };
+
+    /**
+     * Bounded queue of run requests, served by its own dispatching threads.
+     * Submitting never blocks, request is refused if queue is full, so caller like event loop can retry later.
+     * Requests not started can be cancelled.
+     */
+    class TS_DEBUG_API RunQueue {
+    public:
+        using self = RunQueue;
+        using shared = std::shared_ptr<self>;
+
+        using Runner = std::function<std::vector<Tensor>(const std::vector<Tensor> &)>;
+
+        /**
+         * counter of request ids, shared by queues replacing each other, so ids never repeat
+         */
+        using Serial = std::shared_ptr<std::atomic<uint64_t>>;
+
+        /**
+         * called in dispatching thread once request finished, failed or cancelled
+         * @param request id of request
+         * @param outputs outputs of run, empty if error
+         * @param error exception of run, RunCancelledException if cancelled, null if succeed
+         */
+        using Callback = std::function<void(uint64_t request, std::vector<Tensor> &outputs,
+                                            const std::exception_ptr &error)>;
+
+        /**
+         * @param runner function running request, called in dispatching threads at same time
+         * @param threads number of dispatching threads, which are started at first submit
+         * @param capacity max number of requests waiting, not counting running ones
+         * @param serial counter of request ids, nullptr for counting in this queue only
+         */
+        RunQueue(const Runner &runner, int threads, int capacity, Serial serial = nullptr);
+
+        RunQueue(const self &) = delete;
+
+        self &operator=(const self &) = delete;
+
+        /**
+         * cancel waiting requests, and wait running ones finished
+         * @note must not be destroyed in its dispatching thread, like in callback
+         */
+        ~RunQueue();
+
+        /**
+         * @param inputs inputs of run
+         * @param callback called when request done
+         * @return id of request counted from 1, 0 if queue full
+         */
+        uint64_t submit(const std::vector<Tensor> &inputs, const Callback &callback);
+
+        /**
+         * @param request id of request
+         * @return if request cancelled, false if request is running or done
+         * @note callback of cancelled request is called in calling thread before return
+         */
+        bool cancel(uint64_t request);
+
+        /**
+         * @return number of requests waiting
+         */
+        int waiting() const;
+
+        /**
+         * @return if calling thread is dispatching thread of this queue
+         */
+        bool dispatching() const;
+
+        int threads() const { return m_threads; }
+
+        int capacity() const { return m_capacity; }
+
+    private:
+        struct Request {
+            uint64_t id;
+            std::vector<Tensor> inputs;
+            Callback callback;
+        };
+
+        void dispatch();
+
+        static void finish(Request &request, std::vector<Tensor> &outputs, const std::exception_ptr &error);
+
+        Runner m_runner;
+        int m_threads;
+        int m_capacity;
+
+        std::deque<Request> m_requests;
+        Serial m_serial;
+        bool m_stopped = false;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::vector<std::thread> m_dispatchers;
+    };
+}
+
+#endif //TENSORSTACK_RUNTIME_RUN_QUEUE_H
@@ -9,6 +9,7 @@
 #include "inside/thread_pool.h"
 
 #include "core/sync/sync_controller.h"
+#include "memory/budget.h"
 
 #include "utils/ctxmgr_lite.h"
 
@@ -34,8 +35,48 @@ namespace ts {
 
         self clone() const;
 
+        /**
+         * @return runtime sharing thread pool, NUMA placement, dynamic memory and budget of this one,
+         *     with no flow memory bound
+         * @note parallel tasks of the two runtimes run on same threads one by one
+         */
+        self share() const;
+
         ThreadPool &thread_pool();
 
+        /**
+         * share thread pool with other runtime, then parallel tasks of them run on same threads one by one.
+         * @param thread_pool thread pool to share
+         * @note computing thread number is changed into size of thread pool
+         */
+        void bind_thread_pool(ThreadPool::shared thread_pool);
+
+        ThreadPool::shared shared_thread_pool() const;
+
+        /**
+         * pin computing threads to given cpus, thread i run on cpu_ids[i % cpu_ids.size()]
+         * @param cpu_ids cpus to use, empty for no pinning
+         * @return false if pinning not supported or failed
+         * @note the calling thread, which joins parallel tasks as thread 0, is not pinned
+         */
+        bool set_cpu_affinity(const std::vector<int> &cpu_ids);
+
+        const std::vector<int> &get_cpu_affinity() const;
+
+        /**
+         * place runtime on NUMA node: pin computing threads to cpus of node,
+         *     and prefer memory allocated on CPU in this runtime being on node.
+         * @param node NUMA node id, -1 for no placement
+         * @return false if node not exists or pinning failed
+         * @note memory allocated before placing is not moved
+         */
+        bool set_numa_node(int node);
+
+        /**
+         * @return placed NUMA node, -1 if not placed
+         */
+        int get_numa_node() const;
+
          void bind_flow(SyncMemoryController::shared flow);
 
          void bind_dynamic(SyncMemoryController::shared dynamic);
@@ -44,20 +85,37 @@ namespace ts {
 
         SyncMemoryController::shared dynamic() const;
 
+        /**
+         * bind budget which flow and dynamic memory charged to, so operators can choose lower memory way
+         * @param budget memory budget, nullptr for no limit
+         */
+        void bind_memory_budget(MemoryBudget::shared budget);
+
+        MemoryBudget::shared memory_budget() const;
+
         static SyncMemoryController::shared FlowMemory();
 
         static SyncMemoryController::shared DynamicMemory();
 
     private:
         /**
-         * Computing threads number. Used in OpenMP
+         * runtime using given thread pool, with no memory bound
+         */
+        explicit RuntimeContext(ThreadPool::shared thread_pool);
+
+        /**
+         * Computing threads number. Used in parallel_for
          */
         int m_computing_thread_number = 1;
 
         ThreadPool::shared m_thread_pool;
 
+        int m_numa_node = -1;
+
         SyncMemoryController::shared m_flow;
         SyncMemoryController::shared m_dynamic;
+
+        MemoryBudget::shared m_memory_budget;
     };
 }
 
@@ -344,6 +344,21 @@ namespace ts {
          */
         HardConverter::function converter() const;
 
+        /**
+         * preset output tensors of next operator called on top of this stack.
+         * tensors[i] is only returned by make with the same dtype, shape and device,
+         *     in the operator's own frame, when stack holds exactly the arguments and outputs before i,
+         *     that is making the i-th output. Each preset tensor will be returned at most once.
+         * @param tensors preset tensors, empty tensor for not preset output
+         * @note used to write outputs into given memory directly
+         */
+        void preset(const std::vector<Tensor> &tensors);
+
+        /**
+         * clear all preset tensors
+         */
+        void clear_preset() { m_preset.clear(); }
+
         std::deque<Tensor>::const_iterator begin() const {
             return m_stack.begin() + m_base;
         }
@@ -370,6 +385,9 @@ namespace ts {
         std::stack<size_t> m_base_stack;          ///< save each call base
 
         mutable HardConverter::function m_converter = nullptr;    ///< convert memory in stack
+        std::vector<Tensor> m_preset;             ///< preset output tensors, taken by make of its slot
+        size_t m_preset_index = 0;                ///< absolute index of first output slot
+        size_t m_preset_depth = 0;                ///< number of saved bases in operator's frame
     };
 }
 
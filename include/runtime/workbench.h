@@ -22,12 +22,17 @@
 #include "runtime/runtime.h"
 #include "image_filter.h"
 #include "board/profiler.h"
+#include "board/hook.h"
 
 #include "utils/ctxmgr_lite.h"
 #include "utils/cpu.h"
 
 #include "program.h"
 #include "runtime/switcher.h"
+#include "runtime/capture.h"
+#include "runtime/run_queue.h"
+
+#include <future>
 
 namespace ts {
     class TS_DEBUG_API Workbench : public SetupContext<Workbench> {
@@ -80,6 +85,60 @@ namespace ts {
         // run graph
         void run();
 
+        /**
+         * run graph with given inputs, can be called from many threads at same time.
+         * Each call borrows an execution context, with its own stack and flow memory, from pool of workbench.
+         * Program and its data segment are shared by all contexts, only operators not reentrant are copied.
+         * @param inputs tensor of each input slot
+         * @return outputs, copied out of execution context
+         * @note parallel operators run on thread pool of workbench, one call at a time
+         * @note do not call at same time with setup, bind_filter or set_operator_param
+         */
+        std::vector<Tensor> run(const std::vector<Tensor> &inputs);
+
+        /**
+         * run graph, and write output i into outputs[i]
+         * @param outputs output tensors, given by caller, empty tensor for not given output
+         * @note if program ends with operator, it writes its outputs into given tensors directly,
+         *       when dtype, shape and device match, otherwise output will be copied.
+         *       output(i) returns outputs[i] after run.
+         */
+        void run_into(const std::vector<Tensor> &outputs);
+
+        /**
+         * set queue of asynchronous run, waiting requests of old queue are cancelled
+         * @param threads number of runs at same time, each runs like concurrent run
+         * @param capacity max number of requests waiting to run
+         * @note queue is created with 1 thread and capacity 16 at first run_async if not set
+         * @note throws if called in callback of run_async, which runs in dispatching thread of old queue
+         */
+        void set_async(int threads, int capacity);
+
+        /**
+         * submit run with given inputs, return without waiting
+         * @param inputs tensor of each input slot
+         * @param callback called in dispatching thread with outputs, or error if failed or cancelled
+         * @return id of request, for cancelling
+         * @note throws if queue is full, retry after some request done
+         * @note operators run in dispatching thread, computing threads are used like run(inputs)
+         */
+        uint64_t run_async(const std::vector<Tensor> &inputs, const RunQueue::Callback &callback);
+
+        /**
+         * submit run with given inputs, return without waiting
+         * @param inputs tensor of each input slot
+         * @param [out] request id of request for cancelling, if not null
+         * @return future of outputs, which throws RunCancelledException if cancelled
+         */
+        std::future<std::vector<Tensor>> run_async(const std::vector<Tensor> &inputs, uint64_t *request = nullptr);
+
+        /**
+         * cancel request of run_async not started
+         * @param request id of request
+         * @return false if request is running or done
+         */
+        bool cancel(uint64_t request);
+
         // get output
         const Tensor &output(const std::string &name) const;
 
@@ -110,6 +169,14 @@ namespace ts {
 
         const Profiler &profiler() const { return m_profiler; }
 
+        /**
+         * time statistics of profiler, including each operator and whole run, named "run".
+         * @param reset if clear statistics after summary, for polling periodically
+         * @return json string, @see Profiler::summary
+         * @note concurrent runs are also profiled into this profiler
+         */
+        const std::string &profile_summary(bool reset = false);
+
         /**
          *
          * @param [in] bubble parameter
@@ -223,6 +290,13 @@ namespace ts {
 
         Program::shared compile(const Module::shared &module);
 
+        /**
+         * compile module on this workbench, independent const nodes and weight transforms run on its threads
+         * @param module
+         * @param options compile options
+         * @return compiled program
+         * @note if do_profile, time of each compiling phase is in profiler, named "compile/..."
+         */
         Program::shared compile(const Module::shared &module, const std::string &options);
 
         /**
@@ -236,10 +310,49 @@ namespace ts {
         void setup_runtime();
 
         /**
-         *
+         * run once, and keep outputs of given nodes, which can be got by output(name)
+         * @param node_names names of hooked nodes
          */
         void run_hook(const std::vector<std::string> &node_names);
 
+        /**
+         * capture outputs of given nodes in sampled runs of run and run_into, kept in ring buffer of slots.
+         * Nodes are resolved to instructions here, running instructions not captured has no more cost.
+         * @param node_names names of captured nodes, empty for stopping capture
+         * @param slots number of latest sampled runs kept
+         * @param interval sample one run in every interval runs, 0 for pausing
+         * @note capture is reset by setup, runs of concurrent run are not captured
+         */
+        void set_capture(const std::vector<std::string> &node_names, int slots = 1, int interval = 1);
+
+        /**
+         * @param interval sample one run in every interval runs, 0 for pausing
+         */
+        void set_capture_interval(int interval);
+
+        /**
+         * @return number of sampled runs kept
+         */
+        int captured_count() const;
+
+        /**
+         * @param age 0 for latest sampled run, 1 for the one before it, and so on
+         * @param name node name
+         * @return captured value on CPU, empty if not captured, overwritten by later sampled runs
+         */
+        Tensor captured(int age, const std::string &name) const;
+
+        /**
+         * @param age 0 for latest sampled run
+         * @return serial number of sampled run, counted by runs since set_capture from 1, 0 if not captured
+         */
+        uint64_t captured_serial(int age) const;
+
+        /**
+         * @return hook bound when program launched, instructions emit to it
+         */
+        Hook *running_hook() const { return m_running_hook; }
+
         const std::string &summary();
 
         /**
@@ -250,9 +363,67 @@ namespace ts {
         */
         bool set_cpu_power_mode(CpuEnable::CpuPowerMode cpu_mode);
 
+        /**
+         * pin computing threads to given cpus
+         * @param cpu_ids cpus to use, empty for no pinning
+         * @return false if pinning not supported or failed
+         */
+        bool set_cpu_affinity(const std::vector<int> &cpu_ids);
+
+        /**
+         * place workbench on NUMA node, computing threads are pinned to cpus of node,
+         *     and memory on CPU is allocated on node.
+         * @param node NUMA node id, -1 for no placement
+         * @param replicate_data if use copy of program's data segment on node,
+         *     copies are shared by workbenches cloned from same one
+         * @return false if node not exists or pinning failed
+         * @note call before first run, memory already allocated is not moved
+         */
+        bool set_numa_node(int node, bool replicate_data = false);
+
+        /**
+         * release idle flow memory kept for reusing, until flow memory on each device is not more than high_water.
+         * Memory still in use, like outputs of last run, is kept.
+         * @param high_water bytes of flow memory to keep, 0 for releasing all idle memory
+         * @return released bytes, including idle contexts of concurrent run
+         * @note do not call at same time with run
+         */
+        uint64_t trim(uint64_t high_water = 0);
+
+        /**
+         * trim to high_water after each run, so one large input does not hold memory forever
+         * @param high_water bytes of flow memory to keep, negative for never trimming, which is default
+         */
+        void set_trim_policy(int64_t high_water) { m_trim_high_water = high_water; }
+
+        int64_t get_trim_policy() const { return m_trim_high_water; }
+
+        /**
+         * limit memory allocated by this workbench on its device, including flow, dynamic and static memory,
+         *     and memory of contexts for concurrent run.
+         * When limit reached, idle memory is released first, then computing degrades to lower memory way,
+         *     like smaller im2col tiles or running batch sample by sample, before OutOfMemoryException thrown.
+         * @param limit bytes of memory, 0 for unlimited, which is default
+         * @note data segment of program, shared by cloned workbenches, is not counted
+         * @note counters of budget are in summary
+         */
+        void set_memory_budget(uint64_t limit);
+
+        uint64_t get_memory_budget() const;
+
         SwitchControll::shared switch_controller();
 
     private:
+        class ContextPool;
+
+        /**
+         * execution context of concurrent run, with stack and flow memory of its own,
+         *     sharing device, runtime, thread pool and memory budget of owner
+         * @param owner workbench running program
+         * @param program fork of owner's program
+         */
+        Workbench(const Workbench &owner, Program::shared program);
+
         // size_t m_pointer = 0;   // pointer to running function
         // std::vector<Instruction::shared> m_program; // running function, program area
         SyncMemoryController::shared m_static_memory;
@@ -266,6 +437,8 @@ namespace ts {
         // map tensor, means <tensor's index in stack, tensor>
         std::vector<Tensor> m_inputs;
         std::vector<Tensor> m_outputs;
+        // preset output tensors, given by run_into
+        std::vector<Tensor> m_output_presets;
         // input and output dtype type
         // std::vector<DTYPE> m_input_dtypes;
         // std::vector<DTYPE> m_output_dtypes;
@@ -278,20 +451,65 @@ namespace ts {
         // runtime setting, shared in working thread
         RuntimeContext m_runtime_context;
 
+        // if use data segment copied on NUMA node
+        bool m_replicate_data_segment = false;
+
         bool m_do_profile = false;
         Profiler m_profiler;
 
+        // trim flow memory to it after each run, negative for never
+        int64_t m_trim_high_water = -1;
+
+        void auto_trim();
+
+        // shared by memory controllers of this workbench and its contexts
+        MemoryBudget::shared m_memory_budget;
+
+        /**
+         * create memory controllers charged to budget, and bind them to runtime
+         */
+        void setup_memory(MemoryBudget::shared budget);
+
+        /**
+         * launch_offline, but run sample by sample if budget refused whole batch
+         * @note budget refusing is thrown if any output is not batched as args
+         */
+        std::vector<Tensor> launch_in_budget(Program::shared program, const std::vector<Tensor> &args);
+
         // std::shared_ptr<std::mutex> m_mutex;
 
         std::stack<ProgramEnv> m_env;
 
         Program::shared m_desktop;
 
+        // execution contexts for concurrent run, running forked desktop
+        std::shared_ptr<ContextPool> m_contexts;
+
         std::map<std::string, Tensor> m_hooked_tensor;
 
+        Capture::shared m_capture;
+        // capture of running desktop, null if this run not sampled
+        Capture *m_running_capture = nullptr;
+        Hook *m_running_hook = nullptr;
+
+        /**
+         * sample capture for this run of desktop
+         * @return capture kept alive in this run, null if not sampled
+         */
+        Capture::shared sample_capture();
+
         std::string m_summary;
 
+        std::string m_profile_summary;
+
         SwitchControll::shared m_switch_controller;
+
+        // queue of run_async, reset first in destructor as its threads run this workbench
+        RunQueue::shared m_async;
+        std::mutex m_async_mutex;
+        // ids of requests counted across queues, so old id never cancels request of new queue
+        RunQueue::Serial m_async_serial = std::make_shared<std::atomic<uint64_t>>(0);
+
     private:
         Operator::shared m_cast_op; ///< for input cast
 
@@ -53,8 +53,9 @@ namespace ts {
 #define TS_CHECK_LT(lhs, rhs) TS_CHECK((lhs) < (rhs))
 #define TS_CHECK_GT(lhs, rhs) TS_CHECK((lhs) > (rhs))
 
-#define TS_AUTO_ASSERT(condition) (TS_LOG((condition) ? ts::LOG_NONE : ts::LOG_FATAL)("Assertion failed: (")(#condition)(").") << ts::fatal)
-#define TS_AUTO_CHECK(condition) (TS_LOG((condition) ? ts::LOG_NONE : ts::LOG_ERROR)("Check failed: (")(#condition)(").") << ts::eject)
+// no log stream built if condition passed, these are used in hot path
+#define TS_AUTO_ASSERT(condition) ((condition) ? (void)(0) : (void)(TS_LOG(ts::LOG_FATAL)("Assertion failed: (")(#condition)(").") << ts::fatal))
+#define TS_AUTO_CHECK(condition) ((condition) ? (void)(0) : (void)(TS_LOG(ts::LOG_ERROR)("Check failed: (")(#condition)(").") << ts::eject))
 
 #define TS_AUTO_CHECK_EQ(lhs, rhs) TS_AUTO_CHECK((lhs) == (rhs))
 #define TS_AUTO_CHECK_NQ(lhs, rhs) TS_AUTO_CHECK((lhs) != (rhs))
@@ -3,6 +3,9 @@
 
 #include "platform.h"
 #include "api.h"
+
+#include <string>
+
 #if TS_PLATFORM_OS_WINDOWS
 #include <intrin.h>
 #endif
@@ -20,6 +23,7 @@ namespace ts{
         AVX = 12,
         AVX2 = 14,
         FMA = 15,
+        AES = 16,
     };
 
     inline const char *cpu_feature_str(CPUFeature feature) {
@@ -34,6 +38,7 @@ namespace ts{
         case ts::AVX: return "AVX";
         case ts::AVX2: return "AVX2";
         case ts::FMA: return "FMA";
+        case ts::AES: return "AES";
         default:break;
         }
         return "Unknown";
@@ -41,6 +46,11 @@ namespace ts{
 
     bool TS_DEBUG_API check_cpu_feature(CPUFeature feature);
 
+    /**
+     * @return cpu model name, like "Intel(R) Core(TM) i7-8700 CPU @ 3.20GHz", "unknown" if not known
+     */
+    TS_DEBUG_API std::string cpu_model_name();
+
 }
 
 
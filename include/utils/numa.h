@@ -0,0 +1,46 @@
+#ifndef TENSORSTACK_UTILS_NUMA_H
+#define TENSORSTACK_UTILS_NUMA_H
+
+#include "platform.h"
+#include "utils/api.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace ts {
+    /**
+     * NUMA topology and memory placement, read from /sys and set by mbind.
+     * Only support linux now, other platforms are treated as no NUMA node.
+     */
+    class TS_DEBUG_API NumaEnable {
+    public:
+        /**
+         * @return number of NUMA nodes, 0 if NUMA not supported
+         */
+        static int get_node_num();
+
+        /**
+         * @param node NUMA node id
+         * @return cpu ids on given node, empty if node not exists
+         */
+        static std::vector<int> get_node_cpus(int node);
+
+        /**
+         * @param cpu cpu id
+         * @return NUMA node of cpu, -1 if unknown
+         */
+        static int get_cpu_node(int cpu);
+
+        /**
+         * prefer pages fully covered by [data, data + size) to be placed on node, touched pages are moved.
+         * @param data memory start
+         * @param size memory size in bytes
+         * @param node NUMA node id
+         * @return false if not supported or failed
+         * @note pages shared with memory out of range are not changed
+         */
+        static bool bind_memory(void *data, size_t size, int node);
+    };
+}
+
+#endif //TENSORSTACK_UTILS_NUMA_H
@@ -8,6 +8,8 @@
 #include "declare_tensor.h"
 #include "declare_program.h"
 
+#include "compiler/tuner.h"
+
 using namespace ts;
 
 ts_Program *ts_Program_Compile(const ts_Module *module, const ts_Device *device) {
@@ -57,6 +59,12 @@ ts_Program *ts_Program_Compile_v2(const ts_Module *module, const ts_Device *devi
     RETURN_OR_CATCH(program.release(), nullptr)
 }
 
+ts_bool ts_set_tuning_cache(const char *path) {
+    TRY_HEAD
+        Tuner::SetCacheFile(path ? path : "");
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
 ts_bool
 ts_Program_set_operator_param(ts_Program *program, const char *node_name, const char *param, const ts_Tensor *value) {
     TRY_HEAD
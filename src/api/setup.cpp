@@ -6,6 +6,7 @@
 #include "declaration.h"
 
 #include "global/setup.h"
+#include "kernels/cpu/memory_cpu.h"
 
 using namespace ts;
 
@@ -15,3 +16,11 @@ ts_bool ts_setup() {
     RETURN_OR_CATCH(ts_true, ts_false);
 }
 
+ts_bool ts_set_cpu_allocator(int32_t alignment, ts_HugePageMode huge_page, int64_t large_block_size) {
+    TRY_HEAD
+        if (large_block_size <= 0) throw Exception("large_block_size must be positive");
+        CPUAllocator::SetAlignment(size_t(alignment));
+        CPUAllocator::SetHugePage(CPUAllocator::HugePage(huge_page));
+        CPUAllocator::SetLargeBlockSize(size_t(large_block_size));
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
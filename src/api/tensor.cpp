@@ -210,3 +210,22 @@ ts_Tensor *ts_Tensor_load(const char *path) {
     RETURN_OR_CATCH(dolly.release(), nullptr)
 }
 
+ts_Tensor *ts_new_Tensor_borrowed(const int32_t *shape, int32_t shape_len, ts_DTYPE dtype, void *data,
+                                  ts_Tensor_release *release, void *userdata) {
+    TRY_HEAD
+        if (shape == nullptr) shape_len = 0;
+        if (!data) throw Exception("NullPointerException: @param: 4");
+        Tensor::Prototype proto(DTYPE(dtype), Shape(shape, shape + shape_len));
+        auto bytes = size_t(proto.type_bytes()) * proto.count();
+        MemoryDevice device(CPU);
+        HardMemory::shared hard;
+        if (release) {
+            hard = std::make_shared<HardMemory>(device, data, bytes, [release, userdata](void *ptr) {
+                release(ptr, userdata);
+            });
+        } else {
+            hard = std::make_shared<HardMemory>(device, data, bytes);
+        }
+        std::unique_ptr<ts_Tensor> tensor(new ts_Tensor(Tensor(Memory(hard), proto)));
+    RETURN_OR_CATCH(tensor.release(), nullptr)
+}
@@ -10,6 +10,8 @@
 #include "declare_image_filter.h"
 #include "declare_program.h"
 
+#include <algorithm>
+
 using namespace ts;
 
 ts_Workbench *ts_Workbench_Load(const ts_Module *module, const ts_Device *device) {
@@ -82,6 +84,24 @@ ts_bool ts_Workbench_set_computing_thread_number(ts_Workbench *workbench, int32_
     RETURN_OR_CATCH(ts_true, ts_false)
 }
 
+ts_bool ts_Workbench_share_computing_threads(ts_Workbench *workbench, const ts_Workbench *src) {
+    TRY_HEAD
+    if (!workbench) throw Exception("NullPointerException: @param: 1");
+    if (!src) throw Exception("NullPointerException: @param: 2");
+    (*workbench)->runtime().bind_thread_pool((*src)->runtime().shared_thread_pool());
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+ts_bool ts_Workbench_set_thread_wait_policy(ts_Workbench *workbench,
+                                            ts_ThreadWaitPolicy policy, int32_t spin_time) {
+    TRY_HEAD
+    if (!workbench) throw Exception("NullPointerException: @param: 1");
+    auto &thread_pool = (*workbench)->runtime().thread_pool();
+    thread_pool.set_wait_policy(ThreadPool::WaitPolicy(policy));
+    thread_pool.set_spin_time(spin_time);
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
 ts_bool ts_Workbench_bind_filter(ts_Workbench *workbench, int32_t i, const ts_ImageFilter *filter) {
     TRY_HEAD
         if (!workbench) throw Exception("NullPointerException: @param: 1");
@@ -216,3 +236,186 @@ ts_bool ts_Workbench_set_cpu_mode(ts_Workbench *workbench, ts_CpuPowerMode mode)
         auto set = (*workbench)->set_cpu_power_mode(CpuEnable::CpuPowerMode(mode));
     RETURN_OR_CATCH(ts_bool(set), ts_false)
 }
+
+ts_bool ts_Workbench_set_cpu_affinity(ts_Workbench *workbench, const int32_t *cpu_ids, int32_t count) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        if (!cpu_ids && count > 0) throw Exception("NullPointerException: @param: 2");
+        std::vector<int> ids(cpu_ids, cpu_ids + std::max<int32_t>(count, 0));
+        auto set = (*workbench)->set_cpu_affinity(ids);
+    RETURN_OR_CATCH(ts_bool(set), ts_false)
+}
+
+ts_bool ts_Workbench_set_numa_node(ts_Workbench *workbench, int32_t node, ts_bool replicate_data) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        auto set = (*workbench)->set_numa_node(node, bool(replicate_data));
+    RETURN_OR_CATCH(ts_bool(set), ts_false)
+}
+
+ts_bool ts_Workbench_run_into(ts_Workbench *workbench, ts_Tensor **outputs, int32_t count) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        if (!outputs && count > 0) throw Exception("NullPointerException: @param: 2");
+        std::vector<Tensor> given(count);
+        for (int32_t i = 0; i < count; ++i) {
+            if (outputs[i]) given[i] = **outputs[i];
+        }
+        (*workbench)->run_into(given);
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+ts_bool ts_Workbench_run_concurrent(ts_Workbench *workbench,
+                                    const ts_Tensor **inputs, int32_t input_count,
+                                    ts_Tensor **outputs, int32_t output_count) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        if (!inputs && input_count > 0) throw Exception("NullPointerException: @param: 2");
+        if (!outputs && output_count > 0) throw Exception("NullPointerException: @param: 4");
+        if (output_count != (*workbench)->output_count()) {
+            throw Exception("Output number must be " + std::to_string((*workbench)->output_count()) +
+                            " vs. " + std::to_string(output_count) + " got.");
+        }
+        std::vector<Tensor> args(input_count);
+        for (int32_t i = 0; i < input_count; ++i) {
+            if (!inputs[i]) throw Exception("NullPointerException: @param: 2, at index " + std::to_string(i));
+            args[i] = **inputs[i];
+        }
+        auto results = (*workbench)->run(args);
+        for (int32_t i = 0; i < output_count; ++i) {
+            if (outputs[i]) **outputs[i] = results[i];
+        }
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+ts_bool ts_Workbench_trim(ts_Workbench *workbench, int64_t high_water) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        (*workbench)->trim(uint64_t(std::max<int64_t>(high_water, 0)));
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+ts_bool ts_Workbench_set_trim_policy(ts_Workbench *workbench, int64_t high_water) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        (*workbench)->set_trim_policy(high_water);
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+ts_bool ts_Workbench_set_memory_budget(ts_Workbench *workbench, int64_t limit) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        (*workbench)->set_memory_budget(uint64_t(std::max<int64_t>(limit, 0)));
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+ts_bool ts_Workbench_do_profile(ts_Workbench *workbench, ts_bool profile) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        (*workbench)->do_profile(bool(profile));
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+const char *ts_Workbench_profile(ts_Workbench *workbench, ts_bool reset) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        auto profile = (*workbench)->profile_summary(bool(reset)).c_str();
+    RETURN_OR_CATCH(profile, nullptr)
+}
+
+ts_bool ts_Workbench_set_capture(ts_Workbench *workbench, const char **node_names, int32_t count,
+                                 int32_t slots, int32_t interval) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        if (!node_names) count = 0;
+        (*workbench)->set_capture(std::vector<std::string>(node_names, node_names + count), slots, interval);
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+ts_bool ts_Workbench_set_capture_interval(ts_Workbench *workbench, int32_t interval) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        (*workbench)->set_capture_interval(interval);
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+int32_t ts_Workbench_captured_count(ts_Workbench *workbench) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        auto count = int32_t((*workbench)->captured_count());
+    RETURN_OR_CATCH(count, -1)
+}
+
+ts_bool ts_Workbench_captured(ts_Workbench *workbench, int32_t age, const char *node_name, ts_Tensor *tensor) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        if (!node_name) throw Exception("NullPointerException: @param: 3");
+        if (!tensor) throw Exception("NullPointerException: @param: 4");
+        auto value = (*workbench)->captured(age, node_name);
+        if (value.empty()) {
+            throw Exception(std::string("Node \"") + node_name + "\" not captured in run of age " + std::to_string(age));
+        }
+        **tensor = value;
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+ts_bool ts_Workbench_set_async(ts_Workbench *workbench, int32_t threads, int32_t capacity) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        (*workbench)->set_async(threads, capacity);
+    RETURN_OR_CATCH(ts_true, ts_false)
+}
+
+int64_t ts_Workbench_run_async(ts_Workbench *workbench,
+                               const ts_Tensor **inputs, int32_t input_count,
+                               ts_Tensor **outputs, int32_t output_count,
+                               ts_Workbench_run_callback *callback, void *user_data) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        if (!inputs && input_count > 0) throw Exception("NullPointerException: @param: 2");
+        if (!outputs && output_count > 0) throw Exception("NullPointerException: @param: 4");
+        if (output_count != (*workbench)->output_count()) {
+            throw Exception("Output number must be " + std::to_string((*workbench)->output_count()) +
+                            " vs. " + std::to_string(output_count) + " got.");
+        }
+        std::vector<Tensor> args(input_count);
+        for (int32_t i = 0; i < input_count; ++i) {
+            if (!inputs[i]) throw Exception("NullPointerException: @param: 2, at index " + std::to_string(i));
+            args[i] = **inputs[i];
+        }
+        std::vector<ts_Tensor *> results(outputs, outputs + output_count);
+        auto request = (*workbench)->run_async(args,
+                [results, callback, user_data](uint64_t request, std::vector<Tensor> &values,
+                                               const std::exception_ptr &error) {
+            auto status = TS_RUN_SUCCEED;
+            api::ClearLEM();
+            if (error) {
+                try {
+                    std::rethrow_exception(error);
+                } catch (const RunCancelledException &e) {
+                    status = TS_RUN_CANCELLED;
+                    api::SetLEM(e.what());
+                } catch (const std::exception &e) {
+                    status = TS_RUN_FAILED;
+                    api::SetLEM(e.what());
+                } catch (...) {
+                    status = TS_RUN_FAILED;
+                    api::SetLEM("Unknown exception");
+                }
+            } else {
+                for (size_t i = 0; i < results.size(); ++i) {
+                    if (results[i]) **results[i] = values[i];
+                }
+            }
+            if (callback) callback(user_data, int64_t(request), status);
+        });
+    RETURN_OR_CATCH(int64_t(request), 0)
+}
+
+ts_bool ts_Workbench_cancel(ts_Workbench *workbench, int64_t request) {
+    TRY_HEAD
+        if (!workbench) throw Exception("NullPointerException: @param: 1");
+        if (request <= 0) return ts_false;
+        auto cancelled = (*workbench)->cancel(uint64_t(request));
+    RETURN_OR_CATCH(cancelled ? ts_true : ts_false, ts_false)
+}
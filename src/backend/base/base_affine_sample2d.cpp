@@ -6,6 +6,7 @@
 
 #include <utils/assert.h>
 #include <numeric>
+#include <functional>
 
 #include <backend/name.h>
 #include <core/tensor_builder.h>
@@ -68,6 +69,20 @@ namespace ts {
             input_shape[dim] = pdata[0];
             input_shape[dim +1] = pdata[1];
 
+            auto &affine_shape = stack[2].sizes();
+            if (affine_shape.size() == 3) {
+                // batch affine on one image: [K, 3, 3] gives [K, height, width, ...]
+                TS_AUTO_CHECK(affine_shape[1] == 3 && affine_shape[2] == 3);
+                auto number = std::accumulate(input_shape.begin(), input_shape.begin() + dim, 1, std::multiplies<int>());
+                if (number != 1) {
+                    TS_LOG_ERROR << "Batch affine only support single image, got x=" << to_string(x.sizes())
+                                 << ", dim=" << dim << eject;
+                }
+                Shape batch_shape = {affine_shape[0]};
+                batch_shape.insert(batch_shape.end(), input_shape.begin() + dim, input_shape.end());
+                input_shape = batch_shape;
+            }
+
             output.resize(1);
             output[0] = Tensor::Prototype(x.dtype(), input_shape);
 
@@ -103,14 +118,34 @@ namespace ts {
 
             Shape affine_shape = affine_tensor.sizes();
             
-            TS_AUTO_CHECK((affine_shape.size() == 2) && (affine_shape[0] == 3) && (affine_shape[1] == 3));
-
             // int * pdata = size_tensor.data<int32_t>();
             float * paffine = affine_tensor.data<float>(); 
+
+            if (affine_shape.size() == 3) {
+                affine_sample_batch_run((const Tensor &)x, paffine, affine_shape[0],
+                                        m_type, dim, m_outer_mode, m_outer_value, out);
+                return 1;
+            }
+
+            TS_AUTO_CHECK((affine_shape.size() == 2) && (affine_shape[0] == 3) && (affine_shape[1] == 3));
             
             affine_sample_run((const Tensor &)x, paffine[0], paffine[1], paffine[2], paffine[3], paffine[4], paffine[5], paffine[6], paffine[7], paffine[8],
                               m_type, dim, m_outer_mode, m_outer_value, out);
             return 1;
         }
+
+        void Affine_Sample2D::affine_sample_batch_run(const Tensor &x, const float *affine, int number,
+                                                      Affine_Sample2DType type, int dim,
+                                                      AffineOuterMode outer_mode, float outer_value,
+                                                      Tensor &out) {
+            auto &input_shape = x.sizes();
+            auto image = x.reshape(Shape(input_shape.begin() + dim, input_shape.end()));
+            for (int k = 0; k < number; ++k) {
+                auto crop = out.slice(k);
+                auto rz = affine + 9 * k;
+                affine_sample_run(image, rz[0], rz[1], rz[2], rz[3], rz[4], rz[5], rz[6], rz[7], rz[8],
+                                  type, 0, outer_mode, outer_value, crop);
+            }
+        }
     }
 }
@@ -17,6 +17,7 @@ namespace ts {
             field(name::padding, REQUIRED);
             field(name::padding_value, OPTIONAL, tensor::from(0.0f));
             field(name::kernel_winograd_transformed, OPTIONAL, tensor::from<bool>(false));
+            field(name::winograd_mode, OPTIONAL);
         }
 
         static std::string to_string(const std::valarray<int> &arr) {
@@ -41,6 +42,19 @@ namespace ts {
                 m_kernel_transformed = tensor::to_bool(get(name::kernel_winograd_transformed));
             }
 
+            m_winograd_mode_fixed = false;
+            if (has(name::winograd_mode)) {
+                auto winograd_mode = tensor::to_string(get(name::winograd_mode));
+                if (winograd_mode == name::winograd_f63) {
+                    m_winograd_mode = F6X6_3X3;
+                } else if (winograd_mode == name::winograd_f23) {
+                    m_winograd_mode = F2X2_3X3;
+                } else {
+                    TS_LOG_ERROR << this->op() << " do not support winograd mode: " << winograd_mode << eject;
+                }
+                m_winograd_mode_fixed = true;
+            }
+
             TS_AUTO_CHECK(padding_tensor.has_shape({ 4, 2 }));
 
             if (format == name::NCHW) {
@@ -143,11 +157,21 @@ namespace ts {
             }
 
             //warm up
+            if (m_kernel_transformed && m_k_transformed.empty()) {
+                // kernel transformed before running, like folded winograd_transform_kernel, tile size tells mode
+                TS_AUTO_CHECK(kernel_tensor.size(2) == kernel_tensor.size(3));
+                TS_AUTO_CHECK(kernel_tensor.size(2) == 4 || kernel_tensor.size(2) == 8);
+                m_winograd_mode = kernel_tensor.size(2) == 4 ? F2X2_3X3 : F6X6_3X3;
+                m_k_transformed = kernel_tensor;
+            }
             if(!m_kernel_transformed || m_k_transformed.empty()){
-                //select winograd mode
-                WinogradConv2DMode winograd_mode;
-                KernelCommonFunc<float>::winograd_mode_select_on_arm(x_tensor.sizes(), kernel_tensor.size(0), winograd_mode);
-                m_winograd_mode = winograd_mode;
+                //select winograd mode, if not given
+                if (!m_winograd_mode_fixed) {
+                    WinogradConv2DMode winograd_mode;
+                    KernelCommonFunc<float>::winograd_mode_select_on_arm(x_tensor.sizes(), kernel_tensor.size(0), winograd_mode);
+                    m_winograd_mode = winograd_mode;
+                }
+                auto winograd_mode = m_winograd_mode;
 
                 Shape kernel_shape = kernel_tensor.sizes();
                 Shape kernel_transformed_shape;
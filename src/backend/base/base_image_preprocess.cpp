@@ -0,0 +1,119 @@
+#include <backend/base/base_image_preprocess.h>
+
+#include "backend/name.h"
+#include "core/tensor_builder.h"
+
+namespace ts {
+    namespace base {
+        ImagePreprocess::ImagePreprocess() {
+            field(name::size, OPTIONAL);
+            field(name::type, OPTIONAL, tensor::from(int32_t(Resize2DType::LINEAR)));
+            field(name::dtype, OPTIONAL);
+            field(name::cast_after_resize, OPTIONAL, tensor::from<bool>(false));
+            field(name::shuffle, OPTIONAL);
+            field(name::scale, OPTIONAL);
+            field(name::shift, OPTIONAL);
+            field(name::format, OPTIONAL, tensor::from(name::NHWC));
+        }
+
+        void ImagePreprocess::init() {
+            supper::init();
+
+            m_resize = has(name::size);
+            if (m_resize) {
+                auto size = tensor::array::to_int(get(name::size));
+                if (size.size() != 2 || size[0] <= 0 || size[1] <= 0) {
+                    TS_LOG_ERROR << this->op() << " do not support size: " << to_string(size) << eject;
+                }
+                m_height = size[0];
+                m_width = size[1];
+            }
+
+            m_type = Resize2DType(tensor::to_int(get(name::type)));
+            if (m_type != Resize2DType::LINEAR && m_type != Resize2DType::NEAREST) {
+                TS_LOG_ERROR << this->op() << " only support LINEAR or NEAREST resize, got: " << int(m_type) << eject;
+            }
+
+            m_dtype = has(name::dtype) ? DTYPE(tensor::to_int(get(name::dtype))) : VOID;
+            m_cast_after_resize = tensor::to_bool(get(name::cast_after_resize));
+
+            m_shuffle = has(name::shuffle) ? tensor::array::to_int(get(name::shuffle)) : std::vector<int32_t>();
+            m_scale = has(name::scale) ? tensor::array::to_float(get(name::scale)) : std::vector<float>();
+            m_shift = has(name::shift) ? tensor::array::to_float(get(name::shift)) : std::vector<float>();
+
+            if ((!m_scale.empty() || !m_shift.empty()) && m_dtype != FLOAT32) {
+                TS_LOG_ERROR << this->op() << " only support scale and shift with FLOAT32 output" << eject;
+            }
+
+            auto format = tensor::to_string(get(name::format));
+            if (format == name::NCHW) {
+                m_chw = true;
+            } else if (format == name::NHWC) {
+                m_chw = false;
+            } else {
+                TS_LOG_ERROR << this->op() << " do not support format: " << format << eject;
+            }
+        }
+
+        Tensor::Prototype ImagePreprocess::infer_output(const Tensor &x, bool &resize) const {
+            if (x.dims() != 4) {
+                TS_LOG_ERROR << this->op() << " only support NHWC image, got: " << to_string(x.sizes()) << eject;
+            }
+            auto number = x.size(0);
+            auto height = x.size(1);
+            auto width = x.size(2);
+            auto channels = x.size(3);
+
+            for (auto c : m_shuffle) {
+                if (c < 0 || c >= channels) {
+                    TS_LOG_ERROR << this->op() << " can not shuffle channel " << c
+                                 << " of " << to_string(x.sizes()) << eject;
+                }
+            }
+            int out_channels = m_shuffle.empty() ? channels : int(m_shuffle.size());
+
+            for (auto *affine : {&m_scale, &m_shift}) {
+                if (affine->size() > 1 && int(affine->size()) != out_channels) {
+                    TS_LOG_ERROR << this->op() << " can not normalize " << out_channels << " channels with "
+                                 << affine->size() << " values" << eject;
+                }
+            }
+
+            resize = m_resize && (m_height != height || m_width != width);
+            if (m_resize) {
+                height = m_height;
+                width = m_width;
+            }
+
+            auto dtype = m_dtype == VOID ? x.dtype() : m_dtype;
+            if (m_chw) return Tensor::Prototype(dtype, {number, out_channels, height, width});
+            return Tensor::Prototype(dtype, {number, height, width, out_channels});
+        }
+
+        int ImagePreprocess::infer(Stack &stack, std::vector<Tensor::Prototype> &output) {
+            TS_AUTO_CHECK(stack.size() == 1);
+
+            bool resize;
+            output.resize(1);
+            output[0] = infer_output(stack[0], resize);
+
+            return 1;
+        }
+
+        int ImagePreprocess::run(Stack &stack) {
+            TS_AUTO_CHECK(stack.size() == 1);
+
+            bool resize;
+            auto proto = infer_output(stack[0], resize);
+
+            auto memory_device = running_memory_device();
+
+            auto x = stack[0].view(memory_device);
+            auto out = *stack.push(proto, memory_device);
+
+            image_preprocess(x, resize, out);
+
+            return 1;
+        }
+    }
+}
@@ -125,6 +125,8 @@ namespace ts {
             const string &proposal() TS_NOEXCEPT { static string str = "proposal"; return str; }
 
             const string &conv2d_winograd_v2() TS_NOEXCEPT { static string str = "conv2d_winograd_v2"; return str; }
+
+            const string &image_preprocess() TS_NOEXCEPT { static string str = "_image_preprocess"; return str; }
         }
 
         namespace typo {
@@ -212,5 +214,6 @@ namespace ts {
         string transpose = "transpose";
 
         string kernel_winograd_transformed = "kernel_winograd_transformed";
+        string cast_after_resize = "cast_after_resize";
     }
 }
@@ -13,6 +13,10 @@
 #include "core/device_context.h"
 #include "runtime/stack.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 namespace ts {
     namespace zoo {
         Divided::Divided() {
@@ -35,8 +39,16 @@ namespace ts {
                 m_size[i] = size_data[i];
             }
 
+            m_padding_value = 0;
+            if (has(name::padding_value)) {
+                m_padding_value = tensor::to_float(get(name::padding_value));
+            }
+
             auto &context = ctx::ref<DeviceContext>();
 
+            m_pad_op = nullptr;
+            if (context.computing_device.type() == CPU) return;
+
             m_pad_op = OperatorCreator::Create(context.computing_device.type(), name::layer::pad(), false);
 
             TS_CHECK_NQ(m_pad_op, nullptr) << "Can not find operator: " << name::layer::pad();
@@ -80,28 +92,94 @@ namespace ts {
             return 1;
         }
 
+        /**
+         * fill count values of width bytes, memset if value is all zero
+         */
+        static void divided_fill(uint8_t *dst, int64_t count, const uint8_t *value, size_t width) {
+            if (count <= 0) return;
+            if (std::all_of(value, value + width, [](uint8_t b) { return b == 0; })) {
+                std::memset(dst, 0, size_t(count) * width);
+                return;
+            }
+            auto total = size_t(count) * width;
+            std::memcpy(dst, value, width);
+            for (size_t filled = width; filled < total; filled *= 2) {
+                std::memcpy(dst + filled, dst, std::min(filled, total - filled));
+            }
+        }
+
+        /**
+         * copy x into head of each dim of y, tail padded, each value of y written once
+         * @param src_step elements of x in each dim
+         * @param dst_step elements of y in each dim
+         */
+        static void divided_copy(const uint8_t *src, uint8_t *dst, size_t dim,
+                                 const Shape &x_shape, const Shape &shape,
+                                 const std::vector<int64_t> &src_step, const std::vector<int64_t> &dst_step,
+                                 const uint8_t *value, size_t width) {
+            if (dim + 1 == shape.size()) {
+                std::memcpy(dst, src, size_t(x_shape[dim]) * width);
+                divided_fill(dst + x_shape[dim] * width, shape[dim] - x_shape[dim], value, width);
+                return;
+            }
+            for (int i = 0; i < x_shape[dim]; ++i) {
+                divided_copy(src + i * src_step[dim] * width, dst + i * dst_step[dim] * width, dim + 1,
+                             x_shape, shape, src_step, dst_step, value, width);
+            }
+            divided_fill(dst + x_shape[dim] * dst_step[dim] * width,
+                         (shape[dim] - x_shape[dim]) * dst_step[dim], value, width);
+        }
+
         int Divided::run(Stack &stack) {
             TS_AUTO_CHECK(stack.size() == 1);
 
-            auto x = *stack.index(0);
+            // not on CPU, pad tail of each dim by pad operator on computing device
+            if (m_pad_op != nullptr) {
+                auto x_shape = stack.index(0)->sizes();
+                auto shape = x_shape;
+                divided_shape(shape, m_size);
+
+                if (m_padding.size(0) != int(shape.size())) {
+                    m_padding = Tensor(INT32, {int(shape.size()), 2});
+                }
+
+                auto padding = m_padding.data<int32_t>();
+
+                for (size_t i = 0; i < shape.size(); ++i) {
+                    padding[i * 2] = 0;
+                    padding[i * 2 + 1] = shape[i] - x_shape[i];
+                }
+
+                stack.push(m_padding);
+
+                TS_AUTO_CHECK(1 == RunOperator(m_pad_op, stack, 2));
+
+                return 1;
+            }
+
+            auto x = stack[0].view(MemoryDevice(CPU));
             auto shape = x.sizes();
             divided_shape(shape, m_size);
-            auto x_shape = x.sizes();
+            auto &x_shape = x.sizes();
 
-            if (m_padding.size(0) != shape.size()) {
-                m_padding = Tensor(INT32, {int(shape.size()), 2});
+            if (shape == x_shape) {
+                stack.push(x);
+                return 1;
             }
 
-            auto padding = m_padding.data<int32_t>();
+            auto &out = *stack.push(x.dtype(), shape, MemoryDevice(CPU));
 
-            for (size_t i = 0; i < shape.size(); ++i) {
-                padding[i * 2] = 0;
-                padding[i * 2 + 1] = shape[i] - x_shape[i];
+            auto dims = shape.size();
+            std::vector<int64_t> src_step(dims, 1);
+            std::vector<int64_t> dst_step(dims, 1);
+            for (size_t i = dims - 1; i > 0; --i) {
+                src_step[i - 1] = src_step[i] * x_shape[i];
+                dst_step[i - 1] = dst_step[i] * shape[i];
             }
 
-            stack.push(m_padding);
-
-            TS_AUTO_CHECK(1 == RunOperator(m_pad_op, stack, 2));
+            auto value = tensor::build(x.dtype(), m_padding_value);
+            divided_copy(x.data<uint8_t>(), out.data<uint8_t>(), 0, x_shape, shape, src_step, dst_step,
+                         value.data<uint8_t>(), size_t(type_bytes(x.dtype())));
 
             return 1;
         }
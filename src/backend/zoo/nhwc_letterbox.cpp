@@ -10,9 +10,12 @@
 #include "core/device_context.h"
 #include "utils/ctxmgr_lite.h"
 #include "runtime/stack.h"
-#include <algorithm>
+#include "runtime/inside/parallel.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
 
 namespace ts {
     namespace zoo {
@@ -38,6 +41,10 @@ namespace ts {
 
             auto &context = ctx::ref<DeviceContext>();
 
+            m_type = Affine_Sample2DType(tensor::to_int(get(name::type)));
+            m_outer_value = tensor::to_float(get(name::outer_value));
+            m_direct = context.computing_device.type() == CPU;
+
             m_sample_op = OperatorCreator::Create(context.computing_device.type(), name::layer::affine_sample2d(), false);
 
             TS_CHECK_NQ(m_sample_op, nullptr) << "Can not find operator: " << name::layer::affine_sample2d();
@@ -88,6 +95,188 @@ namespace ts {
             return 1;
         }
 
+        /**
+         * Source index of each dst index on one axis.
+         * Sampled index is increasing, so content is [0, content()) and the rest is border.
+         */
+        struct LetterBoxAxis {
+            std::vector<int> index;
+            std::vector<double> weight;     ///< weight of next source index, for linear only
+
+            int content() const { return int(index.size()); }
+        };
+
+        /**
+         * coordinate and weight computed as linear affine_sample2d does,
+         *     so direct letterbox gives the same image as sampled by affine.
+         */
+        static LetterBoxAxis letterbox_linear_axis(float inv_scale, int src, int dst) {
+            LetterBoxAxis axis;
+            for (int i = 0; i < dst; ++i) {
+                double coord = inv_scale * float(i);
+                if (coord >= src - 1) break;
+                auto index = int(coord);
+                axis.index.push_back(index);
+                axis.weight.push_back(coord - index);
+            }
+            return axis;
+        }
+
+        static LetterBoxAxis letterbox_nearest_axis(float inv_scale, int src, int dst, bool round) {
+            LetterBoxAxis axis;
+            for (int i = 0; i < dst; ++i) {
+                double coord = inv_scale * float(i);
+                auto index = round ? int(std::round(coord)) : int(coord);
+                if (index >= src - 1) break;
+                axis.index.push_back(index);
+            }
+            return axis;
+        }
+
+        /**
+         * fill count values of width bytes, memset if value is all zero
+         */
+        static void letterbox_fill(void *dst, int64_t count, const void *value, size_t width) {
+            if (count <= 0) return;
+            auto bytes = reinterpret_cast<const uint8_t *>(value);
+            if (std::all_of(bytes, bytes + width, [](uint8_t b) { return b == 0; })) {
+                std::memset(dst, 0, size_t(count) * width);
+                return;
+            }
+            auto data = reinterpret_cast<uint8_t *>(dst);
+            auto total = size_t(count) * width;
+            std::memcpy(data, value, width);
+            for (size_t filled = width; filled < total; filled *= 2) {
+                std::memcpy(data + filled, data, std::min(filled, total - filled));
+            }
+        }
+
+        template<typename TO, typename FROM>
+        static TO letterbox_clamp(FROM from) {
+            constexpr auto MAX = FROM(std::numeric_limits<TO>::max());
+            constexpr auto MIN = FROM(std::numeric_limits<TO>::lowest());
+            return TO(std::max(MIN, std::min(MAX, from)));
+        }
+
+        /**
+         * linear letterbox on rows of images, blending in double as affine_sample2d does,
+         *     without transforming coordinate and checking border of each pixel.
+         * @param number number of images
+         */
+        template<typename T>
+        static void letterbox_linear(const T *src, T *dst, int number,
+                                     int src_height, int src_width, int dst_height, int dst_width, int channels,
+                                     const LetterBoxAxis &y, const LetterBoxAxis &x, T outer_value) {
+            const int64_t src_row = int64_t(src_width) * channels;
+            const int64_t dst_row = int64_t(dst_width) * channels;
+            const int64_t content = int64_t(x.content()) * channels;
+
+            parallel_for(0, number * dst_height, [&](int task) {
+                int n = task / dst_height;
+                int i = task % dst_height;
+                T *dst_data = dst + int64_t(task) * dst_row;
+                if (i >= y.content()) {
+                    letterbox_fill(dst_data, dst_row, &outer_value, sizeof(T));
+                    return;
+                }
+                auto top = src + (int64_t(n) * src_height + y.index[i]) * src_row;
+                auto bottom = top + src_row;
+                double wy = y.weight[i];
+                for (int j = 0; j < x.content(); ++j, dst_data += channels) {
+                    auto left = x.index[j] * channels;
+                    auto right = left + channels;
+                    double wx = x.weight[j];
+                    for (int c = 0; c < channels; ++c) {
+                        dst_data[c] = letterbox_clamp<T, double>(
+                                (1 - wy) * (1 - wx) * top[left + c] +
+                                (1 - wy) * wx * top[right + c] +
+                                wy * (1 - wx) * bottom[left + c] +
+                                wy * wx * bottom[right + c]);
+                    }
+                }
+                letterbox_fill(dst_data, dst_row - content, &outer_value, sizeof(T));
+            });
+        }
+
+        /**
+         * nearest letterbox copies pixels in bytes, so works for any dtype
+         */
+        static void letterbox_nearest(const uint8_t *src, uint8_t *dst, int number,
+                                      int src_height, int src_width, int dst_height, int dst_width, size_t pixel,
+                                      const LetterBoxAxis &y, const LetterBoxAxis &x,
+                                      const void *outer_value, size_t width) {
+            const int64_t src_row = int64_t(src_width) * pixel;
+            const int64_t dst_row = int64_t(dst_width) * pixel;
+            const int64_t content = int64_t(x.content()) * pixel;
+
+            parallel_for(0, number * dst_height, [&](int task) {
+                int n = task / dst_height;
+                int i = task % dst_height;
+                auto dst_data = dst + int64_t(task) * dst_row;
+                if (i >= y.content()) {
+                    letterbox_fill(dst_data, dst_row / width, outer_value, width);
+                    return;
+                }
+                auto src_data = src + (int64_t(n) * src_height + y.index[i]) * src_row;
+                for (int j = 0; j < x.content(); ++j) {
+                    std::memcpy(dst_data + j * pixel, src_data + x.index[j] * pixel, pixel);
+                }
+                letterbox_fill(dst_data + content, (dst_row - content) / width, outer_value, width);
+            });
+        }
+
+        bool NHWCLetterBox::letterbox(Stack &stack, const Size2D &y_size, float inv_scale) {
+            if (!m_direct) return false;
+
+            auto &x = stack[0];
+            auto dtype = x.dtype();
+            int number = x.size(0);
+            int src_height = x.size(1);
+            int src_width = x.size(2);
+            int channels = x.size(3);
+
+            switch (m_type) {
+                default:
+                    return false;
+                case Affine_Sample2DType::LINEAR:
+                    // 1 pixel wide image is left to affine_sample2d
+                    if (dtype != UINT8 && dtype != FLOAT32) return false;
+                    if (src_height < 2 || src_width < 2) return false;
+                    break;
+                case Affine_Sample2DType::NEAREST:
+                case Affine_Sample2DType::HARD:
+                    break;
+            }
+
+            auto x_data = x.view(MemoryDevice(CPU));
+            auto &out = *stack.push(dtype, {number, y_size.height, y_size.width, channels}, MemoryDevice(CPU));
+            auto outer_value = tensor::build(dtype, m_outer_value);
+
+            if (m_type == Affine_Sample2DType::LINEAR) {
+                auto y_axis = letterbox_linear_axis(inv_scale, src_height, y_size.height);
+                auto x_axis = letterbox_linear_axis(inv_scale, src_width, y_size.width);
+                if (dtype == UINT8) {
+                    letterbox_linear<uint8_t>(x_data.data<uint8_t>(), out.data<uint8_t>(), number,
+                                              src_height, src_width, y_size.height, y_size.width, channels,
+                                              y_axis, x_axis, outer_value.data<uint8_t>()[0]);
+                } else {
+                    letterbox_linear<float>(x_data.data<float>(), out.data<float>(), number,
+                                            src_height, src_width, y_size.height, y_size.width, channels,
+                                            y_axis, x_axis, outer_value.data<float>()[0]);
+                }
+            } else {
+                auto round = m_type == Affine_Sample2DType::NEAREST;
+                auto y_axis = letterbox_nearest_axis(inv_scale, src_height, y_size.height, round);
+                auto x_axis = letterbox_nearest_axis(inv_scale, src_width, y_size.width, round);
+                auto width = size_t(type_bytes(dtype));
+                letterbox_nearest(x_data.data<uint8_t>(), out.data<uint8_t>(), number,
+                                  src_height, src_width, y_size.height, y_size.width, width * channels,
+                                  y_axis, x_axis, outer_value.data(), width);
+            }
+
+            return true;
+        }
+
         int NHWCLetterBox::run(Stack &stack) {
             TS_AUTO_CHECK(stack.size() == 1);
 
@@ -102,6 +291,8 @@ namespace ts {
             auto y_scale = float(y_size.height) / x_size.height;
             auto scale = std::min(x_scale, y_scale);
 
+            if (letterbox(stack, y_size, 1 / scale)) return 1;
+
             m_sample_affine.data<float>(0) = 1 / scale;
             m_sample_affine.data<float>(4) = 1 / scale;
 
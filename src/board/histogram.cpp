@@ -0,0 +1,153 @@
+#include "board/histogram.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+namespace ts {
+    static inline uint64_t double_bits(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static inline double bits_double(uint64_t bits) {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    static const uint64_t EmptyMin = double_bits(std::numeric_limits<double>::infinity());
+    static const uint64_t EmptyMax = double_bits(0.0);
+
+    Histogram::Histogram()
+            : m_count(0), m_sum(double_bits(0.0)), m_min(EmptyMin), m_max(EmptyMax) {
+        for (auto &bucket : m_buckets) bucket = 0;
+    }
+
+    Histogram::Histogram(const self &other)
+            : self() {
+        this->merge(other);
+    }
+
+    Histogram::self &Histogram::operator=(const self &other) {
+        if (this == &other) return *this;
+        this->clear();
+        this->merge(other);
+        return *this;
+    }
+
+    int Histogram::index_of(double value) {
+        if (!(value > 0)) return 0;
+        int exponent = 0;
+        // value = fraction * 2^exponent, fraction in [0.5, 1)
+        auto fraction = std::frexp(value, &exponent);
+        exponent -= 1;
+        if (exponent < MinExponent) return 0;
+        if (exponent >= MaxExponent) return BucketCount - 1;
+        auto sub = int((fraction * 2 - 1) * SubBuckets);
+        sub = std::min(sub, SubBuckets - 1);
+        return 1 + (exponent - MinExponent) * SubBuckets + sub;
+    }
+
+    double Histogram::value_of(int index) {
+        if (index <= 0) return 0;
+        auto exponent = MinExponent + (index - 1) / SubBuckets;
+        auto sub = (index - 1) % SubBuckets;
+        return std::ldexp(1 + (sub + 0.5) / SubBuckets, exponent);
+    }
+
+    template <typename FUNC>
+    static inline void atomic_update(std::atomic<uint64_t> &target, FUNC func) {
+        uint64_t old_value = target;
+        while (!target.compare_exchange_weak(old_value, func(old_value)));
+    }
+
+    void Histogram::record(double value) {
+        if (!(value > 0)) value = 0;    // also NaN
+        auto bits = double_bits(value);
+
+        ++m_buckets[index_of(value)];
+        ++m_count;
+        atomic_update(m_sum, [value](uint64_t sum) { return double_bits(bits_double(sum) + value); });
+        atomic_update(m_min, [bits](uint64_t min) { return std::min(min, bits); });
+        atomic_update(m_max, [bits](uint64_t max) { return std::max(max, bits); });
+    }
+
+    uint64_t Histogram::count() const {
+        return m_count;
+    }
+
+    double Histogram::sum() const {
+        return bits_double(m_sum);
+    }
+
+    double Histogram::min() const {
+        uint64_t min = m_min;
+        return min == EmptyMin ? 0 : bits_double(min);
+    }
+
+    double Histogram::max() const {
+        return bits_double(m_max);
+    }
+
+    double Histogram::mean() const {
+        auto count = this->count();
+        return count ? this->sum() / count : 0;
+    }
+
+    double Histogram::percentile(double q) const {
+        uint64_t total = 0;
+        for (auto &bucket : m_buckets) total += bucket;
+        if (total == 0) return 0;
+
+        q = std::max(0.0, std::min(1.0, q));
+        auto rank = std::max<uint64_t>(1, uint64_t(std::ceil(q * total)));
+        uint64_t seen = 0;
+        int index = BucketCount - 1;
+        for (int i = 0; i < BucketCount; ++i) {
+            seen += m_buckets[i];
+            if (seen >= rank) {
+                index = i;
+                break;
+            }
+        }
+        // first and last bucket hold out of range values, min and max are exact
+        auto value = value_of(index);
+        return std::max(this->min(), std::min(this->max(), value));
+    }
+
+    void Histogram::clear() {
+        for (auto &bucket : m_buckets) bucket = 0;
+        m_count = 0;
+        m_sum = double_bits(0.0);
+        m_min = EmptyMin;
+        m_max = EmptyMax;
+    }
+
+    Histogram::self Histogram::snapshot(bool reset) {
+        if (!reset) return *this;
+        self copy;
+        for (int i = 0; i < BucketCount; ++i) copy.m_buckets[i] = m_buckets[i].exchange(0);
+        copy.m_count = m_count.exchange(0);
+        copy.m_sum = m_sum.exchange(double_bits(0.0));
+        copy.m_min = m_min.exchange(EmptyMin);
+        copy.m_max = m_max.exchange(EmptyMax);
+        return copy;
+    }
+
+    void Histogram::merge(const self &other) {
+        for (int i = 0; i < BucketCount; ++i) {
+            uint64_t count = other.m_buckets[i];
+            if (count) m_buckets[i] += count;
+        }
+        m_count += other.m_count;
+        auto other_sum = other.sum();
+        uint64_t other_min = other.m_min;
+        uint64_t other_max = other.m_max;
+        atomic_update(m_sum, [other_sum](uint64_t sum) { return double_bits(bits_double(sum) + other_sum); });
+        atomic_update(m_min, [other_min](uint64_t min) { return std::min(min, other_min); });
+        atomic_update(m_max, [other_max](uint64_t max) { return std::max(max, other_max); });
+    }
+}
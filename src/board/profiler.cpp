@@ -19,6 +19,7 @@
 namespace ts {
 
     int32_t Profiler::serial_of(const std::string &name) {
+        std::unique_lock<std::mutex> _lock(this->m_serial_mutex);
         auto it = this->m_serial.find(name);
         if (it != this->m_serial.end()) return it->second;
         auto next_serial = int32_t(this->m_serial.size() + 1);
@@ -28,9 +29,9 @@ namespace ts {
 
     Later Profiler::timer(const std::string &name) {
         using namespace std::chrono;
-        auto _start = system_clock::now();
+        auto _start = steady_clock::now();
         Later _action([=]() -> void{
-            auto _end = system_clock::now();
+            auto _end = steady_clock::now();
             auto _duration = std::chrono::duration_cast<microseconds>(_end - _start);
             this->m_board.append(name, _duration.count() / 1000.0f);
         });
@@ -45,6 +46,36 @@ namespace ts {
         return m_board;
     }
 
+    Board<float> Profiler::snapshot(bool reset) {
+        return m_board.snapshot(reset);
+    }
+
+    std::string Profiler::summary(bool reset) {
+        auto board = this->snapshot(reset);
+        std::map<Board<float>::key_type, Board<float>::value_type> sorted_board(board.begin(), board.end());
+        std::ostringstream oss;
+        oss << "{";
+        bool comma = false;
+        for (auto &key_value : sorted_board) {
+            auto &statistics = key_value.second;
+            if (statistics.count() == 0) continue;
+            if (comma) oss << ", ";
+            else comma = true;
+            oss << "\"" << key_value.first << "\": {"
+                << "\"count\": " << statistics.count()
+                << ", \"avg\": " << statistics.avg()
+                << ", \"min\": " << statistics.min()
+                << ", \"max\": " << statistics.max()
+                << ", \"p50\": " << statistics.percentile(0.5)
+                << ", \"p90\": " << statistics.percentile(0.9)
+                << ", \"p99\": " << statistics.percentile(0.99)
+                << ", \"p999\": " << statistics.percentile(0.999)
+                << "}";
+        }
+        oss << "}";
+        return oss.str();
+    }
+
     template <typename T>
     static std::string to_string(const T* ptr) {
         std::ostringstream oss;
@@ -57,7 +88,11 @@ namespace ts {
                 sorted_board(this->board().begin(), this->board().end());
         out << "============= " << "Profiler(" << to_string(this) << ")" << " timer" << " =============" << std::endl;
         for (auto &key_value : sorted_board) {
-            out << "[" << key_value.first << "]: avg spent = " << key_value.second.avg() << "ms" << std::endl;
+            auto &statistics = key_value.second;
+            out << "[" << key_value.first << "]: avg spent = " << statistics.avg() << "ms"
+                << ", p50 = " << statistics.percentile(0.5) << "ms"
+                << ", p99 = " << statistics.percentile(0.99) << "ms"
+                << ", count = " << statistics.count() << std::endl;
         }
     }
 
@@ -0,0 +1,43 @@
+#include "compiler/compile_jobs.h"
+
+#include "runtime/inside/thread_pool.h"
+#include "core/device_context.h"
+#include "utils/ctxmgr_lite_support.h"
+
+#include <exception>
+
+namespace ts {
+    void CompileJobs::push(const Job &job) {
+        m_jobs.push_back(job);
+    }
+
+    void CompileJobs::run(ThreadPool *pool) {
+        std::vector<Job> jobs;
+        jobs.swap(m_jobs);
+        if (jobs.empty()) return;
+
+        if (pool == nullptr || pool->size() <= 1 || jobs.size() == 1) {
+            for (auto &job : jobs) job(0);
+            return;
+        }
+
+        auto device_context = ctx::get<DeviceContext>();
+        std::vector<std::exception_ptr> exceptions(jobs.size());
+        pool->parallel(0, int64_t(jobs.size()), 1, [&](int thread_id, int64_t begin, int64_t end) {
+            ctx::bind<DeviceContext> _bind_device_context(device_context);
+            for (auto i = begin; i < end; ++i) {
+                try {
+                    jobs[i](thread_id);
+                } catch (...) {
+                    exceptions[i] = std::current_exception();
+                }
+            }
+        });
+
+        for (auto &exception : exceptions) {
+            if (exception) std::rethrow_exception(exception);
+        }
+    }
+}
+
+TS_LITE_CONTEXT(ts::CompileJobs)
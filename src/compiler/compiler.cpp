@@ -28,6 +28,10 @@
 #include "frontend/intime.h"
 #include "compiler/zipper.h"
 #include "compiler/translater.h"
+#include "compiler/compile_jobs.h"
+#include "runtime/workbench.h"
+#include "runtime/inside/thread_pool.h"
+#include "board/profiler.h"
 
 
 
@@ -42,26 +46,50 @@ namespace ts {
             : m_computing_device(computing_device) {
     }
 
-    // TODO: speed this function up
-    static map<Node, set<Node>> build_node_refs(const std::vector<Node> &nodes) {
-        auto computation_schedule = Module::list_reference_nodes(nodes);
-
-        // build refs
-        map<Node, set<Node>> map_node_refs;
-        for (auto &node : computation_schedule) {
-            set<Node> refs;
-            for (auto &input : node.first.inputs()) {
-                refs.insert(input);
-                auto &input_refs = map_node_refs[input];
-                refs.insert(input_refs.begin(), input_refs.end());
+    /**
+     * count references of each node needed by given nodes,
+     *     each input of node counted once, so node uses same input twice counts 2.
+     * @param nodes output nodes
+     * @return map of node to reference count, walked in O(V + E)
+     */
+    static map<Node, size_t> build_node_ref_count(const std::vector<Node> &nodes) {
+        map<Node, size_t> map_node_ref_count;
+        std::vector<Node> walker;
+        for (auto &node : nodes) {
+            if (map_node_ref_count.insert(std::make_pair(node, 0)).second) walker.push_back(node);
+        }
+        while (!walker.empty()) {
+            auto node = walker.back();
+            walker.pop_back();
+            for (auto &input : node.inputs()) {
+                auto it = map_node_ref_count.find(input);
+                if (it == map_node_ref_count.end()) {
+                    map_node_ref_count.insert(std::make_pair(input, 1));
+                    walker.push_back(input);
+                } else {
+                    ++it->second;
+                }
             }
-            map_node_refs.insert(std::make_pair(node.first, std::move(refs)));
         }
+        return map_node_ref_count;
+    }
 
-        return map_node_refs;
+    /**
+     * @return thread pool to run compiling jobs on, nullptr if run one by one
+     * @note only CPU operators are run in parallel
+     */
+    static ThreadPool *parallel_pool(const ComputingDevice &device) {
+        if (device.type() != CPU) return nullptr;
+        auto pool = ctx::ptr<ThreadPool>();
+        if (pool == nullptr || pool->size() <= 1) return nullptr;
+        return pool;
     }
 
     std::vector<Instruction::shared> Compiler::convert_operator_instruction(const Node &node) {
+        return convert_operator_instruction(node, nullptr);
+    }
+
+    std::vector<Instruction::shared> Compiler::convert_operator_instruction(const Node &node, CompileJobs *init_jobs) {
         auto &bubble = node.bubble();
 
         // step 1: check inner InstructionCreator
@@ -79,10 +107,17 @@ namespace ts {
         for (auto &param : bubble.params()) {
             op->set(param.first, param.second);
         }
-        try {
-            op->init();
-        } catch (const Exception &e) {
-            TS_LOG_ERROR << "While initializing " << bubble.op() << ":" << bubble.name() << " got Exception: " << e.what() << eject;
+        auto init = [op, node](int) {
+            try {
+                op->init();
+            } catch (const Exception &e) {
+                TS_LOG_ERROR << "While initializing " << node->op() << ":" << node->name() << " got Exception: " << e.what() << eject;
+            }
+        };
+        if (init_jobs) {
+            init_jobs->push(init);
+        } else {
+            init(0);
         }
         std::vector<Instruction::shared> instructions;
         auto op_inst = std::make_shared<OperatorInstruction>(op, int(node.inputs().size()), int(bubble.output_count()), description);
@@ -110,17 +145,22 @@ namespace ts {
         
         // zip graph
         {
+            auto _timer = profiler_timer("compile/zip");
             Zipper zipper(m_computing_device, options);
             outputs = zipper.zip(outputs);
         }
 
         // const graph
         {
+            auto _timer = profiler_timer("compile/fold");
             std::vector<Node> const_outputs;
             run_const_nodes(outputs, const_outputs);
             outputs = const_outputs;
         }
 
+        // operators' init may transform weights, run them together after all operators created
+        CompileJobs init_jobs;
+
         // std::cout << "+++++++++++++++++ const graph ++++++++++++++++++++++" << std::endl;
         // plot_graph(std::cout, outputs);
 
@@ -136,14 +176,20 @@ namespace ts {
         // 考虑处理inplace操作符，加入copy节点，保证inplace操作不会对其他节点造成影响
 
         // build refs
-        // save if compile a node, whose nodes needed directly or indirectly
-        map<Node, set<Node>> map_node_refs = build_node_refs(outputs);
+        // count of references not computed yet, node can be computed after all nodes referencing it computed
+        map<Node, size_t> map_node_ref_count = build_node_ref_count(outputs);
+        // nodes whose references all computed, may be not computed itself
+        std::vector<Node> ready_nodes;
+        for (auto &node : outputs) {
+            if (map_node_ref_count[node] == 0) ready_nodes.push_back(node);
+        }
 
         map<Node, int> map_node_data_sagment_index;
 
         // convert graph to instructions
         std::deque<Node> simulator;
-        map<Node, size_t> working_nodes;
+        // indices of each node in simulator, in ascending order
+        map<Node, std::vector<size_t>> working_nodes;
         size_t unsolved_node_count = 0;
 
         /**
@@ -174,12 +220,7 @@ namespace ts {
         auto simulator_push = [&](Node node) {
             auto &bubble = node.bubble();
             size_t i = simulator.size();
-            auto it = working_nodes.find(node);
-            if (it == working_nodes.end()) {
-                working_nodes.insert(std::make_pair(node, i));
-            } else {
-                if (i < it->second) it->second = i;
-            }
+            working_nodes[node].push_back(i);
             if (bubble.op() != Bubble::Parameter) {
                 ++unsolved_node_count;
             }
@@ -193,10 +234,10 @@ namespace ts {
             if (simulator.empty()) return;
             auto node = simulator.back();
             auto &bubble = node.bubble();
-            size_t i = simulator.size() - 1;
             auto it = working_nodes.find(node);
-            if (it != working_nodes.end() && it->second == i) {
-                working_nodes.erase(node);
+            if (it != working_nodes.end()) {
+                it->second.pop_back();  // top is the last index
+                if (it->second.empty()) working_nodes.erase(it);
             }
             if (bubble.op() != Bubble::Parameter) {
                 --unsolved_node_count;
@@ -204,6 +245,17 @@ namespace ts {
             simulator.pop_back();
         };
 
+        /**
+         * \brief move index of node in working_nodes
+         */
+        auto working_nodes_move = [&](const Node &node, size_t from, size_t to) {
+            auto &indices = working_nodes[node];
+            auto it = std::find(indices.begin(), indices.end(), from);
+            if (it == indices.end()) return;
+            *it = to;
+            std::sort(indices.begin(), indices.end());
+        };
+
         /**
          * \brief swap nodes at i and j
          * \param i
@@ -218,13 +270,9 @@ namespace ts {
             auto nodei = simulator[index_i];
             auto nodej = simulator[index_j];
 
-            auto nodei_it = working_nodes.find(nodei);
-            if (nodei_it != working_nodes.end() && nodei_it->second == index_i) {
-                nodei_it->second = index_j;
-            }
-            auto nodej_it = working_nodes.find(nodej);
-            if (nodej_it != working_nodes.end() && nodej_it->second == index_j) {
-                nodej_it->second = index_i;
+            if (nodei != nodej) {
+                working_nodes_move(nodei, index_i, index_j);
+                working_nodes_move(nodej, index_j, index_i);
             }
 
             simulator[index_i] = nodej;
@@ -248,18 +296,15 @@ namespace ts {
         };
 
         /**
-         * \brief find last node ref the given node `ref`
-         * \param ref give node
+         * \brief find last index of any node can be computed now
          * \return found index
          * \note return -1 if failed
          */
-        auto simulator_find_last_ref_node_index = [&](Node ref) -> int64_t {
-            int64_t i = int64_t(simulator.size()) - 1;
-            while (i >= 0) {
-                auto &node = simulator[size_t(i)];
-                auto &refs = map_node_refs[node];
-                if (refs.find(ref) != refs.end()) return i;
-                --i;
+        auto simulator_find_ready_node_index = [&]() -> int64_t {
+            while (!ready_nodes.empty()) {
+                auto it = working_nodes.find(ready_nodes.back());
+                if (it != working_nodes.end()) return int64_t(it->second.back());
+                ready_nodes.pop_back(); // already computed
             }
             return -1;
         };
@@ -275,8 +320,9 @@ namespace ts {
             auto i = simulator.size() - 1;
             auto it = working_nodes.find(node);
             if (it != working_nodes.end()) {
-                if (it->second < i) {
-                    block.instructions.push_back(instruction::Stack::push(int(it->second)));
+                auto first = it->second.front();
+                if (first < i) {
+                    block.instructions.push_back(instruction::Stack::push(int(first)));
                     simulator_pop();
                     continue;
                 }
@@ -304,23 +350,33 @@ namespace ts {
                 continue;
             }
 
-            // case3: check if this node will be compute later, if true, then swap it's son to top
-            auto last_ref_node_index = simulator_find_last_ref_node_index(node);
-            if (last_ref_node_index >= 0) {
-                auto j = last_ref_node_index;
+            // case3: check if this node will be compute later, if true, then swap a ready node to top
+            if (map_node_ref_count[node] > 0) {
+                auto j = simulator_find_ready_node_index();
+                TS_AUTO_CHECK(j >= 0);
                 block.instructions.push_back(instruction::Stack::swap(int(i), int(j)));
                 simulator_swap(int(i), int(j));
                 continue;
             }
 
             // case4: found a node need to be compute. query operator
-            auto operator_instructions = convert_operator_instruction(node);
+            auto operator_instructions = convert_operator_instruction(node, &init_jobs);
             for (auto inst_it = operator_instructions.rbegin(); inst_it != operator_instructions.rend(); ++inst_it) {
                 block.instructions.push_back(*inst_it);
             }
             simulator_pop();
-            for (auto &input : node.inputs()) simulator_push(input);
+            for (auto &input : node.inputs()) {
+                if (--map_node_ref_count[input] == 0 && input->op() != Bubble::Parameter) {
+                    ready_nodes.push_back(input);
+                }
+                simulator_push(input);
+            }
         }
+        {
+            auto _timer = profiler_timer("compile/init");
+            init_jobs.run(parallel_pool(m_computing_device));
+        }
+
         // check inputs
         set<Node> have_inputs(inputs.begin(), inputs.end());
         for (auto &node : simulator) {
@@ -364,85 +420,174 @@ namespace ts {
     }
 
     /**
-     *
-     * @param [in] node
-     * @param [out] const_node
-     * @return true if node if const node
+     * walk graph in post order without recursion, so very deep graph won't overflow the stack
+     * @param nodes output nodes
+     * @return each node once, after all its inputs
      */
-    static bool run_const_node(const Node &node, Node &const_node,
+    static std::vector<Node> walk_post_order(const std::vector<Node> &nodes) {
+        std::vector<Node> order;
+        set<Node> walked;
+        // node and if its inputs pushed
+        std::vector<std::pair<Node, bool>> walker;
+        for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) walker.emplace_back(*it, false);
+        while (!walker.empty()) {
+            auto top = walker.back().first;
+            if (walked.find(top) != walked.end()) {
+                walker.pop_back();
+                continue;
+            }
+            if (!walker.back().second) {
+                walker.back().second = true;
+                auto inputs = top.inputs();
+                for (auto it = inputs.rbegin(); it != inputs.rend(); ++it) {
+                    if (walked.find(*it) == walked.end()) walker.emplace_back(*it, false);
+                }
+                continue;
+            }
+            walker.pop_back();
+            walked.insert(top);
+            order.emplace_back(top);
+        }
+        return order;
+    }
+
+    /**
+     * fold const nodes whose inputs are all folded, so nodes are independent.
+     * Run on thread pool if more than one node, each thread with its own workbench.
+     * @param nodes nodes to fold, results are in order of nodes, whichever thread runs them
+     * @param ready_const map of folded nodes
+     * @param workers workbench of each thread, created if empty, [0] is nullptr for context workbench
+     */
+    static void fold_const_nodes(const ComputingDevice &device, const std::vector<Node> &nodes,
             std::unordered_map<Node, Node> &ready_const,
-            std::unordered_map<Node, Node> &ready_nonconst) {
-        // check ready nonconst
-        auto nonconst_it = ready_nonconst.find(node);
-        if (nonconst_it != ready_nonconst.end()) {
-            const_node = nonconst_it->second;
-            return false;
+            std::vector<Workbench::shared> &workers) {
+        std::vector<std::vector<Tensor>> const_inputs(nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            for (const auto &input : nodes[i].inputs()) {
+                const_inputs[i].emplace_back(ready_const.at(input)->get(name::value));
+            }
         }
-        // check ready const
-        auto const_it = ready_const.find(node);
-        if (const_it != ready_const.end()) {
-            const_node = const_it->second;
-            return true;
+
+        auto pool = nodes.size() > 1 ? parallel_pool(device) : nullptr;
+        if (pool && workers.empty()) {
+            workers.resize(pool->size());
+            for (size_t i = 1; i < workers.size(); ++i) {
+                workers[i] = std::make_shared<Workbench>(device, 1);
+            }
         }
 
-        // check endpoints
-        if(node->op() == Bubble::Variable) {
-            TS_LOG_ERROR << "Not support " << Bubble::Variable << " in this version" << eject;
-        } else if (node->op() == Bubble::Const) {
-            const_node = node;
-            ready_const.insert(std::make_pair(node, node));
-            return true;
-        } else if (node->op() == Bubble::Parameter) {
+        std::vector<Tensor> const_data(nodes.size());
+        CompileJobs jobs;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            jobs.push([&, i](int thread_id) {
+                auto worker = thread_id > 0 && size_t(thread_id) < workers.size() ? workers[thread_id] : nullptr;
+                if (worker) {
+                    // worker's memory is released with it
+                    const_data[i] = intime::run(*worker, nodes[i].bubble(), const_inputs[i]).clone();
+                } else {
+                    const_data[i] = intime::run(nodes[i].bubble(), const_inputs[i]);
+                }
+            });
+        }
+        jobs.run(pool);
+
+        // set const node
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            auto const_node = ts::bubble::data(nodes[i].bubble().name(), const_data[i]);
+            ready_const.insert(std::make_pair(nodes[i], const_node));
+        }
+    }
+
+    /**
+     * fold node whose inputs not all const, link to folded inputs
+     * @param [in] node
+     * @param [out] const_node
+     */
+    static void fold_nonconst_node(const Node &node, Node &const_node,
+            std::unordered_map<Node, Node> &ready_const,
+            std::unordered_map<Node, Node> &ready_nonconst) {
+        if (node->op() == Bubble::Parameter) {
             const_node = node;
             ready_nonconst.insert(std::make_pair(node, node));
-            return false;
+            return;
         }
 
-        // check if each input is const or new
-        std::vector<Tensor> const_inputs;
+        // check if each input is new
         std::vector<Node> const_input_nodes;
-        bool input_are_const = true;
         bool build_new_node = false;
         for (const auto &input : node.inputs()) {
-            auto const_input = input;
-            if (!run_const_node(input, const_input, ready_const, ready_nonconst)) {
-                input_are_const = false;
-            } else {
-                const_inputs.emplace_back(const_input->get(name::value));
-            }
+            auto const_it = ready_const.find(input);
+            auto const_input = const_it == ready_const.end() ? ready_nonconst.at(input) : const_it->second;
             build_new_node = build_new_node || const_input != input;
             const_input_nodes.emplace_back(const_input);
         }
 
-        if (!input_are_const) {
-            if (!build_new_node) {
-                const_node = node;
-            } else {
-                const_node = ts::bubble::bubble(node.bubble());
-                Node::Link(const_node, const_input_nodes);
-            }
-            ready_nonconst.insert(std::make_pair(node, const_node));
-            return false;
+        if (!build_new_node) {
+            const_node = node;
+        } else {
+            const_node = ts::bubble::bubble(node.bubble());
+            Node::Link(const_node, const_input_nodes);
         }
-
-        // set const node
-        Tensor const_data = intime::run(node.bubble(), const_inputs);
-        const_node = ts::bubble::data(node.bubble().name(), const_data);
-        ready_const.insert(std::make_pair(node, const_node));
-        // walking on origin graph, no need to map new node
-        // ready_const.insert(std::make_pair(const_node, const_node));
-
-        return true;
+        ready_nonconst.insert(std::make_pair(node, const_node));
     }
 
-
     void Compiler::run_const_nodes(const std::vector<Node> &nodes, std::vector<Node> &const_nodes) {
         const_nodes.clear();
+        auto order = walk_post_order(nodes);
+
+        // level of each const node, 0 for Const, or 1 + max level of inputs.
+        // Nodes in same level only use nodes in lower levels, so fold them together
+        std::unordered_map<Node, int> const_levels;
+        std::vector<std::vector<Node>> levels;
         std::unordered_map<Node, Node> ready_const;
+        for (auto &node : order) {
+            if (node->op() == Bubble::Variable) {
+                TS_LOG_ERROR << "Not support " << Bubble::Variable << " in this version" << eject;
+            } else if (node->op() == Bubble::Const) {
+                const_levels.insert(std::make_pair(node, 0));
+                ready_const.insert(std::make_pair(node, node));
+                continue;
+            } else if (node->op() == Bubble::Parameter) {
+                continue;
+            }
+            int level = 0;
+            bool input_are_const = true;
+            for (auto &input : node.inputs()) {
+                auto it = const_levels.find(input);
+                if (it == const_levels.end()) {
+                    input_are_const = false;
+                    break;
+                }
+                level = std::max(level, it->second);
+            }
+            if (!input_are_const) continue;
+            const_levels.insert(std::make_pair(node, level + 1));
+            if (levels.size() <= size_t(level)) levels.resize(size_t(level) + 1);
+            levels[level].emplace_back(node);
+        }
+
+        if (!levels.empty()) {
+            auto bench = ctx::get<Workbench>();
+            if (bench == nullptr) {
+                TS_LOG_ERROR << "Must bind Workbench before run const nodes" << eject;
+            }
+            auto computing_device = bench->device().computing_device;
+            std::vector<Workbench::shared> workers;
+            for (auto &level : levels) {
+                fold_const_nodes(computing_device, level, ready_const, workers);
+            }
+        }
+
         std::unordered_map<Node, Node> ready_nonconst;
-        for (auto node : nodes) {
-            run_const_node(node, node, ready_const, ready_nonconst);
-            const_nodes.emplace_back(node);
+        for (auto &node : order) {
+            if (ready_const.find(node) != ready_const.end()) continue;
+            auto folded = node;
+            fold_nonconst_node(node, folded, ready_const, ready_nonconst);
+        }
+
+        for (auto &node : nodes) {
+            auto const_it = ready_const.find(node);
+            const_nodes.emplace_back(const_it == ready_const.end() ? ready_nonconst.at(node) : const_it->second);
         }
     }
 
@@ -9,6 +9,8 @@
 #include "global/operator_factory.h"
 #include "kernels/common/function.h"
 #include "compiler/argparse.h"
+#include "compiler/tuner.h"
+#include "compiler/compile_jobs.h"
 
 static bool has_defined_op(const ts::ComputingDevice &device, const std::string &op) {
     auto creator = ts::OperatorCreator::Query(device.type(), op, true);
@@ -143,22 +145,28 @@ bool ts::PackTranslatorOption::translate(const ComputingDevice &device, const No
     }
 
     auto kernel_tensor = kernel_node.bubble().get(name::value);
-    auto kernel_shape = kernel_tensor.sizes();
-    auto kernel_type = kernel_tensor.dtype();
+
+    // tuned layer only packed if packed gemm won
+    auto tuning = ctx::get<TuningTable>();
+    auto algorithm = tuning ? tuning->get(node.bubble().name()) : TuningTable::DEFAULT;
+    if (algorithm != TuningTable::DEFAULT && algorithm != TuningTable::GEMM_PACKED) {
+        Node::Link(translated_node, node.inputs());
+        return true;
+    }
 
     //winograd_check
 #ifdef TS_ON_ARM
     ArgParser parser;
     parser.add({"--winograd", "-win"}, {"--no-winograd", "-no-win"}, true);
     parser.parse(params);
-    if (parser.get("--winograd")) {
+    if (algorithm == TuningTable::DEFAULT && parser.get("--winograd")) {
         if(op_name == name::layer::conv2d() || op_name == name::layer::conv2d_v2()){
             Tensor stride_tensor = tensor::cast(INT32, node.bubble().get(name::stride));
             Stride2D stride_size(stride_tensor.data<int>()[2], stride_tensor.data<int>()[3]);
             Tensor dilation_tensor = tensor::cast(INT32, node.bubble().get(name::dilation));
             Dilation2D dilation_size(dilation_tensor.data<int>()[2], dilation_tensor.data<int>()[3]);
             bool winograd_flag = false;
-            winograd_flag = KernelCommonFunc<float>::winograd_check(kernel_shape, stride_size, dilation_size);
+            winograd_flag = KernelCommonFunc<float>::winograd_check(kernel_tensor.sizes(), stride_size, dilation_size);
             if(winograd_flag){
                 Node::Link(translated_node, node.inputs());
                 return true;
@@ -167,10 +175,63 @@ bool ts::PackTranslatorOption::translate(const ComputingDevice &device, const No
     }
 #endif
 
+    bool need_transpose = false;
+    if (node.bubble().has("transpose")) {
+        need_transpose = tensor::to_bool(node.bubble().get("transpose"));
+    }
+
+    auto kernel_shape = kernel_tensor.sizes();
+    if (op_name == name::layer::inner_prod() && need_transpose) {
+        kernel_shape = Shape({kernel_shape[1], kernel_shape[0]});
+    }
+    Tensor kernel_packed(kernel_tensor.dtype(), kernel_shape);
+
+    // packed later with other kernels if jobs bound, tensor shares memory, so value set now is filled then
+    auto pack = [op_name, kernel_tensor, need_transpose, kernel_packed](int) mutable {
+        PackKernel(op_name, kernel_tensor, need_transpose, kernel_packed);
+    };
+    auto jobs = ctx::get<CompileJobs>();
+    if (jobs) {
+        jobs->push(pack);
+    } else {
+        pack(0);
+    }
+
+    Node kernel_packed_node = kernel_node;
+    kernel_packed_node.bubble().set(name::value, kernel_packed);
+    translated_node.bubble().set(name::kernel_packed, tensor::from<bool>(true));
+
+    if (op_name == name::layer::inner_prod()) {
+        translated_node.bubble().set("transpose", tensor::from<bool>(false));
+    }
+
+    if(op_name == name::layer::conv2d() || op_name == name::layer::inner_prod())
+        Node::Link(translated_node, { inputs[0], kernel_packed_node });
+    else
+        Node::Link(translated_node, { inputs[0], inputs[1], kernel_packed_node });
+
+    return true;
+}
+
+ts::Tensor ts::PackTranslatorOption::PackKernel(const std::string &op, const Tensor &kernel, bool transpose) {
+    auto kernel_shape = kernel.sizes();
+    if (op == name::layer::inner_prod() && transpose) {
+        kernel_shape = Shape({kernel_shape[1], kernel_shape[0]});
+    }
+    Tensor kernel_packed(kernel.dtype(), kernel_shape);
+    PackKernel(op, kernel, transpose, kernel_packed);
+    return kernel_packed;
+}
+
+void ts::PackTranslatorOption::PackKernel(const std::string &op, const Tensor &kernel, bool transpose,
+                                          Tensor &kernel_packed) {
+    auto kernel_shape = kernel.sizes();
+    auto kernel_type = kernel.dtype();
+
     int kernel_size_width;
     int kernel_size_height;
 
-    if (op_name == name::layer::conv2d() || op_name == name::layer::conv2d_v2()) {
+    if (op == name::layer::conv2d() || op == name::layer::conv2d_v2()) {
         kernel_size_height = kernel_shape[0];
         kernel_size_width = kernel_shape[1] * kernel_shape[2] * kernel_shape[3];
     }
@@ -179,18 +240,10 @@ bool ts::PackTranslatorOption::translate(const ComputingDevice &device, const No
         kernel_size_width = kernel_shape[1];
     }
 
-
-    bool need_transpose = false;
-    if (node.bubble().has("transpose")) {
-        need_transpose = tensor::to_bool(node.bubble().get("transpose"));
-    }
-
-    Tensor kernel_packed(kernel_type, kernel_shape);
-
-    if (op_name == name::layer::conv2d() || op_name == name::layer::conv2d_v2()) {
+    if (op == name::layer::conv2d() || op == name::layer::conv2d_v2()) {
         switch (kernel_type) {
 #define DECLARE_COMPUTE_RUN(DTYPE, TYPE) \
-            case DTYPE: { cpu::math<TYPE, TYPE>::pack8_A(kernel_size_height, kernel_size_width, kernel_tensor.data<TYPE>(), kernel_size_width, kernel_packed.data<TYPE>()); break; }
+            case DTYPE: { cpu::math<TYPE, TYPE>::pack8_A(kernel_size_height, kernel_size_width, kernel.data<TYPE>(), kernel_size_width, kernel_packed.data<TYPE>()); break; }
             DECLARE_COMPUTE_RUN(FLOAT32, float);
 #undef DECLARE_COMPUTE_RUN
             default: {
@@ -203,17 +256,15 @@ bool ts::PackTranslatorOption::translate(const ComputingDevice &device, const No
         switch (kernel_type) {
 #define DECLARE_COMPUTE_RUN(DTYPE, TYPE) \
             case DTYPE: { \
-                if(need_transpose){ \
+                if(transpose){ \
                     Shape transposed_shape({kernel_size_width, kernel_size_height}); \
                     Tensor transposed(kernel_type, transposed_shape); \
-                    Tensor packed_transposed(kernel_type, transposed_shape); \
-                    cpu::math<TYPE, TYPE>::matrix_transpose(kernel_tensor.data<TYPE>(), transposed.data<TYPE>(), kernel_size_height, kernel_size_width); \
-                    cpu::math<TYPE, TYPE>::pack8_B(kernel_size_width, kernel_size_height, transposed.data<TYPE>(), kernel_size_height, packed_transposed.data<TYPE>()); \
-                    kernel_packed = packed_transposed; \
+                    cpu::math<TYPE, TYPE>::matrix_transpose(kernel.data<TYPE>(), transposed.data<TYPE>(), kernel_size_height, kernel_size_width); \
+                    cpu::math<TYPE, TYPE>::pack8_B(kernel_size_width, kernel_size_height, transposed.data<TYPE>(), kernel_size_height, kernel_packed.data<TYPE>()); \
                 } \
                 else{ \
-                    cpu::math<TYPE, TYPE>::pack8_B(kernel_size_height, kernel_size_width, kernel_tensor.data<TYPE>(), kernel_size_width, kernel_packed.data<TYPE>()); \
-                } break;}         
+                    cpu::math<TYPE, TYPE>::pack8_B(kernel_size_height, kernel_size_width, kernel.data<TYPE>(), kernel_size_width, kernel_packed.data<TYPE>()); \
+                } break;}
             DECLARE_COMPUTE_RUN(FLOAT32, float);
 #undef DECLARE_COMPUTE_RUN
             default: {
@@ -222,22 +273,4 @@ bool ts::PackTranslatorOption::translate(const ComputingDevice &device, const No
             }
         }
     }
-
-
-    Node kernel_packed_node = kernel_node;
-    kernel_packed_node.bubble().set(name::value, kernel_packed);
-    translated_node.bubble().set(name::kernel_packed, tensor::from<bool>(true));
-
-    if (op_name == name::layer::inner_prod()) {
-        translated_node.bubble().set("transpose", tensor::from<bool>(false));
-    }
-
-    if(op_name == name::layer::conv2d() || op_name == name::layer::inner_prod())
-        Node::Link(translated_node, { inputs[0], kernel_packed_node });
-    else
-        Node::Link(translated_node, { inputs[0], inputs[1], kernel_packed_node });
-
-    return true;
 }
-
-
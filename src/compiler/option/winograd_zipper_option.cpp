@@ -11,6 +11,7 @@
 #include <valarray>
 #include "kernels/common/function.h"
 #include "backend/common_function.h"
+#include "compiler/tuner.h"
 
 namespace ts {
     bool Conv2dZipperOption::zip(const ComputingDevice &device, Node node, Node &zipped_node) const {
@@ -94,6 +95,54 @@ namespace ts {
 
         return true;
     }
+
+    bool TunedConv2dZipperOption::zip(const ComputingDevice &device, Node node, Node &zipped_node) const {
+        if (device.type() != CPU)
+            return false;
+
+        auto tuning = ctx::get<TuningTable>();
+        if (tuning == nullptr)
+            return false;
+
+        auto bubble = node.bubble();
+        if (bubble.op() != name::layer::conv2d())
+            return false;
+
+        auto algorithm = tuning->get(bubble.name());
+        if (algorithm == TuningTable::DEFAULT)
+            return false;
+
+        if (algorithm != TuningTable::WINOGRAD_F23 && algorithm != TuningTable::WINOGRAD_F63) {
+            zipped_node = node;
+            return true;
+        }
+
+        auto inputs = node.inputs();
+        TS_AUTO_CHECK(inputs.size() == 2);
+
+        auto winograd_mode = tensor::from(
+                algorithm == TuningTable::WINOGRAD_F63 ? name::winograd_f63 : name::winograd_f23);
+
+        // const kernel transformed by const folding, so not in first run
+        auto kernel = inputs[1];
+        bool kernel_transformed = kernel->op() == Bubble::Const;
+        if (kernel_transformed) {
+            kernel = bubble::op(bubble.name() + "_kernel_transformed",
+                    name::layer::winograd_transform_kernel(), { inputs[1] });
+            kernel.bubble().set(name::winograd_mode, winograd_mode);
+        }
+
+        zipped_node = bubble::op(bubble.name(), name::layer::conv2d_winograd(), { inputs[0], kernel });
+        zipped_node.bubble().set(name::padding, bubble.get(name::padding));
+        zipped_node.bubble().set(name::format, bubble.get(name::format));
+        if (bubble.has(name::padding_value)) {
+            zipped_node.bubble().set(name::padding_value, bubble.get(name::padding_value));
+        }
+        zipped_node.bubble().set(name::winograd_mode, winograd_mode);
+        zipped_node.bubble().set(name::kernel_winograd_transformed, tensor::from<bool>(kernel_transformed));
+
+        return true;
+    }
 }
 
 //#ifdef TS_USE_WINOGRAD
@@ -8,8 +8,11 @@
 
 #include "compiler/option/fp16_translator_option.h"
 #include "compiler/option/pack_translator_option.h"
+#include "compiler/compile_jobs.h"
 
 #include "module/menu.h"
+#include "runtime/inside/thread_pool.h"
+#include "board/profiler.h"
 
 namespace ts {
     Translator::Translator(const ComputingDevice &device)
@@ -30,29 +33,59 @@ namespace ts {
             return ready_it->second;
         }
 
-        auto translated_node = node;
-        for (auto option : options) {
-            if (option->translate(device, node, translated_node, params, output_flag)) {
-                break;
+        // walk in post order without recursion, so very deep graph won't overflow the stack
+        struct Frame {
+            Frame(const Node &node, bool output_flag)
+                : node(node), translated_node(node), output_flag(output_flag) {}
+
+            Node node;
+            Node translated_node;
+            bool output_flag;
+            bool translated = false;
+        };
+
+        std::vector<Frame> walker;
+        walker.emplace_back(node, output_flag);
+        while (!walker.empty()) {
+            if (ready_map.find(walker.back().node) != ready_map.end()) {
+                walker.pop_back();
+                continue;
             }
-        }
 
-        std::vector<Node> translated_inputs;
-        auto input_nodes = translated_node.inputs();
-        for (auto &input : input_nodes) {
-            auto translated_input = translate_node(input, ready_map, device, options, params, false);
-            translated_inputs.emplace_back(translated_input);
-        }
+            if (!walker.back().translated) {
+                auto &frame = walker.back();
+                frame.translated = true;
+                for (auto option : options) {
+                    if (option->translate(device, frame.node, frame.translated_node, params, frame.output_flag)) {
+                        break;
+                    }
+                }
+                auto input_nodes = frame.translated_node.inputs();
+                for (auto it = input_nodes.rbegin(); it != input_nodes.rend(); ++it) {
+                    if (ready_map.find(*it) == ready_map.end()) walker.emplace_back(*it, false);
+                }
+                continue;
+            }
 
-        if (translated_node == node) {
-            translated_node = bubble::bubble(node.bubble());
-        }
+            auto frame = walker.back();
+            walker.pop_back();
+
+            std::vector<Node> translated_inputs;
+            auto input_nodes = frame.translated_node.inputs();
+            for (auto &input : input_nodes) {
+                translated_inputs.emplace_back(ready_map.at(input));
+            }
 
-        ready_map.insert(std::make_pair(node, translated_node));
+            if (frame.translated_node == frame.node) {
+                frame.translated_node = bubble::bubble(frame.node.bubble());
+            }
+
+            ready_map.insert(std::make_pair(frame.node, frame.translated_node));
 
-        Node::Link(translated_node, translated_inputs);
+            Node::Link(frame.translated_node, translated_inputs);
+        }
 
-        return translated_node;
+        return ready_map.at(node);
     }
 
     Module::shared Translator::translate(const Module::shared& module) const {
@@ -81,11 +114,20 @@ namespace ts {
         std::vector<Node> traslated_nodes;
         std::unordered_map<Node, Node> ready_map;
 
-        auto output_nodes = new_module->outputs();
-        for (auto & node : output_nodes)
+        // options push weight transforms as jobs, run them on thread pool after all nodes translated
+        CompileJobs jobs;
+        {
+            ctx::bind<CompileJobs> _bind_jobs(jobs);
+            auto output_nodes = new_module->outputs();
+            for (auto & node : output_nodes)
+            {
+                auto translated_node = translate_node(node, ready_map, m_device, options, m_params, true);
+                traslated_nodes.emplace_back(translated_node);
+            }
+        }
         {
-            auto translated_node = translate_node(node, ready_map, m_device, options, m_params, true);
-            traslated_nodes.emplace_back(translated_node);
+            auto _timer = profiler_timer("compile/translate/weights");
+            jobs.run(ctx::ptr<ThreadPool>());
         }
 
         //std::cout << "+++++++++++++++++ translated graph ++++++++++++++++++++++" << std::endl;
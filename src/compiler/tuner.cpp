@@ -0,0 +1,487 @@
+#include "compiler/tuner.h"
+#include "compiler/option/pack_translator_option.h"
+
+#include "runtime/workbench.h"
+#include "runtime/inferer.h"
+#include "runtime/inside/thread_pool.h"
+#include "module/menu.h"
+#include "backend/name.h"
+#include "core/tensor_builder.h"
+#include "utils/cpu_info.h"
+#include "utils/except.h"
+#include "utils/log.h"
+#include "utils/ctxmgr_lite_support.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+namespace ts {
+    std::string TuningTable::Name(Algorithm algorithm) {
+        switch (algorithm) {
+            case GEMM: return "gemm";
+            case GEMM_PACKED: return "gemm_packed";
+            case WINOGRAD_F23: return "winograd_f23";
+            case WINOGRAD_F63: return "winograd_f63";
+            default: return "default";
+        }
+    }
+
+    TuningTable::Algorithm TuningTable::Parse(const std::string &name) {
+        for (auto algorithm : {GEMM, GEMM_PACKED, WINOGRAD_F23, WINOGRAD_F63}) {
+            if (Name(algorithm) == name) return algorithm;
+        }
+        return DEFAULT;
+    }
+
+    void TuningTable::set(const std::string &node, Algorithm algorithm) {
+        m_choices[node] = algorithm;
+    }
+
+    TuningTable::Algorithm TuningTable::get(const std::string &node) const {
+        auto it = m_choices.find(node);
+        if (it == m_choices.end()) return DEFAULT;
+        return it->second;
+    }
+
+    static std::mutex tuning_cache_mutex;
+    static std::string tuning_cache_file;
+
+    void Tuner::SetCacheFile(const std::string &path) {
+        std::unique_lock<std::mutex> _lock(tuning_cache_mutex);
+        tuning_cache_file = path;
+    }
+
+    std::string Tuner::GetCacheFile() {
+        std::unique_lock<std::mutex> _lock(tuning_cache_mutex);
+        if (!tuning_cache_file.empty()) return tuning_cache_file;
+        auto env = std::getenv("TS_TUNING_CACHE");
+        if (env != nullptr && env[0] != '\0') return env;
+        return "";
+    }
+
+    Tuner::Tuner(const ComputingDevice &device)
+            : m_device(device) {
+    }
+
+    namespace {
+        /**
+         * winner of one layer signature on one cpu
+         */
+        struct TuningRecord {
+            std::string algorithm;
+            double milliseconds = 0;
+        };
+
+        /**
+         * Cache file is text, line by line:
+         *     cpu model \t threads \t layer signature \t algorithm \t milliseconds
+         * lines starting with # are comments.
+         */
+        class TuningCache {
+        public:
+            using Records = std::map<std::string, TuningRecord>;
+
+            static std::string Key(const std::string &cpu, int threads, const std::string &signature) {
+                return cpu + "\t" + std::to_string(threads) + "\t" + signature;
+            }
+
+            static Records Load(const std::string &path) {
+                Records records;
+                std::ifstream in(path);
+                std::string line;
+                while (std::getline(in, line)) {
+                    if (line.empty() || line[0] == '#') continue;
+                    auto fields = Split(line, "\t");
+                    if (fields.size() != 5) continue;
+                    TuningRecord record;
+                    record.algorithm = fields[3];
+                    record.milliseconds = std::atof(fields[4].c_str());
+                    records[Key(fields[0], std::atoi(fields[1].c_str()), fields[2])] = record;
+                }
+                return records;
+            }
+
+            /**
+             * merge records into file, records of other cpus in file are kept
+             */
+            static bool Save(const std::string &path, const Records &records) {
+                auto merged = Load(path);
+                for (auto &record : records) merged[record.first] = record.second;
+
+                std::ofstream out(path);
+                if (!out.is_open()) return false;
+                out << "# TenniS kernel tuning cache" << std::endl;
+                out << "# cpu\tthreads\tlayer\talgorithm\tms" << std::endl;
+                for (auto &record : merged) {
+                    out << record.first << "\t" << record.second.algorithm << "\t"
+                        << record.second.milliseconds << std::endl;
+                }
+                return bool(out);
+            }
+        };
+
+        /**
+         * one candidate kernel of layer
+         */
+        struct Candidate {
+            TuningTable::Algorithm algorithm;
+            Bubble bubble;
+            std::vector<Tensor> inputs;
+        };
+
+        template <typename T>
+        std::string join(const std::vector<T> &values) {
+            std::ostringstream oss;
+            oss << "[";
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (i) oss << ",";
+                oss << values[i];
+            }
+            oss << "]";
+            return oss.str();
+        }
+
+        std::string join(const Shape &shape) {
+            return join(std::vector<int32_t>(shape.begin(), shape.end()));
+        }
+
+        bool known_shape(const TensorPrototype &proto) {
+            if (proto.dtype() != FLOAT32 || proto.fields_count() != 1) return false;
+            for (auto dim : proto.sizes()) {
+                if (dim <= 0) return false;
+            }
+            return true;
+        }
+
+        Tensor random_tensor(const Shape &shape) {
+            std::mt19937 engine(4399);
+            std::uniform_real_distribution<float> uniform(-1, 1);
+            Tensor tensor(FLOAT32, shape);
+            auto data = tensor.data<float>();
+            auto count = tensor.count();
+            for (int i = 0; i < count; ++i) data[i] = uniform(engine);
+            return tensor;
+        }
+
+        /**
+         * copy graph into Context<Graph>, so shape inference writes no #shape into given module
+         * @param outputs output nodes
+         * @param [out] dolly_of map node to its copy
+         * @param [out] walked nodes in post order
+         * @return copy of outputs
+         */
+        std::vector<Node> clone_graph(const std::vector<Node> &outputs,
+                                      std::unordered_map<Node, Node> &dolly_of,
+                                      std::vector<Node> &walked) {
+            // walk in post order without recursion, same as translator
+            std::vector<std::pair<Node, bool>> walker;
+            for (auto it = outputs.rbegin(); it != outputs.rend(); ++it) walker.emplace_back(*it, false);
+            while (!walker.empty()) {
+                auto frame = walker.back();
+                walker.pop_back();
+                if (dolly_of.find(frame.first) != dolly_of.end()) continue;
+                auto inputs = frame.first.inputs();
+                if (!frame.second) {
+                    walker.emplace_back(frame.first, true);
+                    for (auto it = inputs.rbegin(); it != inputs.rend(); ++it) {
+                        if (dolly_of.find(*it) == dolly_of.end()) walker.emplace_back(*it, false);
+                    }
+                    continue;
+                }
+                auto dolly = bubble::bubble(frame.first.bubble());
+                std::vector<Node> dolly_inputs;
+                for (auto &input : inputs) dolly_inputs.emplace_back(dolly_of.at(input));
+                Node::Link(dolly, dolly_inputs);
+                dolly_of.insert(std::make_pair(frame.first, dolly));
+                walked.emplace_back(frame.first);
+            }
+            std::vector<Node> dolly_outputs;
+            for (auto &output : outputs) dolly_outputs.emplace_back(dolly_of.at(output));
+            return dolly_outputs;
+        }
+
+        Bubble copy_params(const Bubble &from, const std::string &op) {
+            Bubble bubble(op, from.name());
+            for (auto &param : from.params()) {
+                if (!param.first.empty() && param.first[0] == '#') continue;
+                bubble.set(param.first, param.second);
+            }
+            return bubble;
+        }
+
+        /**
+         * @param [out] signature layer signature
+         * @return candidates, empty if layer can not be tuned
+         */
+        std::vector<Candidate> conv2d_candidates(const Node &node, const TensorPrototype &x, std::string &signature) {
+            auto &bubble = node.bubble();
+            if (!bubble.has(name::format) || tensor::to_string(bubble.get(name::format)) != name::NCHW) return {};
+
+            auto kernel_node = node.input(1);
+            if (kernel_node->op() != Bubble::Const) return {};
+            auto kernel = kernel_node->get(name::value);
+            if (kernel.dtype() != FLOAT32 || kernel.dims() != 4) return {};
+
+            Tensor dilation_tensor;
+            if (bubble.has(name::dilation)) {
+                dilation_tensor = bubble.get(name::dilation);
+            } else if (bubble.has(name::typo::dialations)) {
+                dilation_tensor = bubble.get(name::typo::dialations);
+            } else {
+                return {};
+            }
+            auto padding = tensor::array::to_int(bubble.get(name::padding));
+            auto stride = tensor::array::to_int(bubble.get(name::stride));
+            auto dilation = tensor::array::to_int(dilation_tensor);
+            if (padding.size() != 8 || stride.size() != 4 || dilation.size() != 4) return {};
+
+            signature = "conv2d x=" + join(x.sizes()) + " w=" + join(kernel.sizes()) +
+                        " padding=" + join(padding) + " stride=" + join(stride) + " dilation=" + join(dilation);
+
+            auto input = random_tensor(x.sizes());
+
+            std::vector<Candidate> candidates;
+
+            auto gemm = copy_params(bubble, name::layer::conv2d());
+            gemm.set(name::kernel_packed, tensor::from<bool>(false));
+            candidates.push_back({TuningTable::GEMM, gemm, {input, kernel}});
+
+#ifndef TS_USE_CBLAS
+            auto gemm_packed = copy_params(bubble, name::layer::conv2d());
+            gemm_packed.set(name::kernel_packed, tensor::from<bool>(true));
+            auto packed_kernel = PackTranslatorOption::PackKernel(name::layer::conv2d(), kernel, false);
+            candidates.push_back({TuningTable::GEMM_PACKED, gemm_packed, {input, packed_kernel}});
+#endif
+
+            bool winograd = kernel.size(2) == 3 && kernel.size(3) == 3 &&
+                            stride[2] == 1 && stride[3] == 1 &&
+                            dilation[2] == 1 && dilation[3] == 1 &&
+                            padding[0] == 0 && padding[1] == 0 && padding[2] == 0 && padding[3] == 0;
+            if (winograd) {
+                for (auto algorithm : {TuningTable::WINOGRAD_F23, TuningTable::WINOGRAD_F63}) {
+                    Bubble conv2d_winograd(name::layer::conv2d_winograd(), bubble.name());
+                    conv2d_winograd.set(name::format, bubble.get(name::format));
+                    conv2d_winograd.set(name::padding, bubble.get(name::padding));
+                    if (bubble.has(name::padding_value)) {
+                        conv2d_winograd.set(name::padding_value, bubble.get(name::padding_value));
+                    }
+                    conv2d_winograd.set(name::winograd_mode, tensor::from(
+                            algorithm == TuningTable::WINOGRAD_F63 ? name::winograd_f63 : name::winograd_f23));
+                    candidates.push_back({algorithm, conv2d_winograd, {input, kernel}});
+                }
+            }
+
+            return candidates;
+        }
+
+        std::vector<Candidate> inner_prod_candidates(const Node &node, const TensorPrototype &x, std::string &signature) {
+            auto &bubble = node.bubble();
+
+            auto kernel_node = node.input(1);
+            if (kernel_node->op() != Bubble::Const) return {};
+            auto kernel = kernel_node->get(name::value);
+            if (kernel.dtype() != FLOAT32 || kernel.dims() != 2) return {};
+
+            bool transpose = false;
+            if (bubble.has("transpose")) transpose = tensor::to_bool(bubble.get("transpose"));
+
+            signature = "inner_prod x=" + join(x.sizes()) + " w=" + join(kernel.sizes()) +
+                        " transpose=" + std::to_string(int(transpose));
+
+            auto input = random_tensor(x.sizes());
+
+            std::vector<Candidate> candidates;
+
+            auto gemm = copy_params(bubble, name::layer::inner_prod());
+            gemm.set(name::kernel_packed, tensor::from<bool>(false));
+            candidates.push_back({TuningTable::GEMM, gemm, {input, kernel}});
+
+#ifndef TS_USE_CBLAS
+            auto gemm_packed = copy_params(bubble, name::layer::inner_prod());
+            gemm_packed.set(name::kernel_packed, tensor::from<bool>(true));
+            gemm_packed.set("transpose", tensor::from<bool>(false));
+            auto packed_kernel = PackTranslatorOption::PackKernel(name::layer::inner_prod(), kernel, transpose);
+            candidates.push_back({TuningTable::GEMM_PACKED, gemm_packed, {input, packed_kernel}});
+#endif
+
+            return candidates;
+        }
+
+        /**
+         * @return max absolute difference divided by max absolute value of expected
+         */
+        float relative_error(const Tensor &expected, const Tensor &got) {
+            if (expected.sizes() != got.sizes()) return INFINITY;
+            auto a = expected.data<float>();
+            auto b = got.data<float>();
+            auto count = expected.count();
+            float max_value = 0;
+            float max_diff = 0;
+            for (int i = 0; i < count; ++i) {
+                max_value = std::max(max_value, std::fabs(a[i]));
+                max_diff = std::max(max_diff, std::fabs(a[i] - b[i]));
+            }
+            return max_value > 0 ? max_diff / max_value : max_diff;
+        }
+
+        /**
+         * run candidate until enough time spent
+         * @param [out] output output of candidate, on CPU
+         * @return median milliseconds of each run, negative if candidate failed
+         */
+        double benchmark(Workbench &bench, const Candidate &candidate, Tensor &output) {
+            using clock = std::chrono::steady_clock;
+            static const int MIN_TIMES = 3;
+            static const int MAX_TIMES = 50;
+            static const double MAX_MILLISECONDS = 200;
+
+            try {
+                auto op = bench.offline_create(candidate.bubble, true);
+                if (op == nullptr) return -1;
+
+                std::vector<Tensor> outputs;
+                // warm up, also do kernel transform in first run
+                bench.offline_run(op, candidate.inputs, outputs);
+                if (outputs.size() != 1) return -1;
+                output = outputs[0].view(MemoryDevice(CPU)).clone();
+
+                std::vector<double> spent;
+                double total = 0;
+                while (int(spent.size()) < MIN_TIMES ||
+                       (int(spent.size()) < MAX_TIMES && total < MAX_MILLISECONDS)) {
+                    auto start = clock::now();
+                    bench.offline_run(op, candidate.inputs, outputs);
+                    std::chrono::duration<double, std::milli> duration = clock::now() - start;
+                    spent.push_back(duration.count());
+                    total += duration.count();
+                }
+                std::sort(spent.begin(), spent.end());
+                return spent[spent.size() / 2];
+            } catch (const Exception &) {
+                return -1;
+            }
+        }
+    }
+
+    TuningTable Tuner::tune(const Module::shared &module) const {
+        TuningTable table;
+        if (m_device.type() != CPU) {
+            TS_LOG_STATUS << "Tuning only support CPU, " << m_device << " is not tuned.";
+            return table;
+        }
+
+        auto bench = ctx::get<Workbench>();
+        if (bench == nullptr) {
+            TS_LOG_ERROR << "Context<Workbench> need, but not bind." << eject;
+        }
+
+        for (auto &input : module->inputs()) {
+            if (!input->has(Bubble::RetentionParam::shape)) {
+                TS_LOG_STATUS << "Tuning skipped, input " << input->name() << " has no " << Bubble::RetentionParam::shape;
+                return table;
+            }
+        }
+
+        // infer shapes on cloned graph
+        Graph temp_graph;
+        ctx::bind<Graph> _bind_graph(temp_graph);
+
+        std::unordered_map<Node, Node> dolly_of;
+        std::vector<Node> walked;
+        auto dolly_outputs = clone_graph(module->outputs(), dolly_of, walked);
+        std::unordered_map<Node, TensorPrototype> shapes;
+        try {
+            infer(dolly_outputs, shapes);
+        } catch (const Exception &) {
+            TS_LOG_STATUS << "Tuning skipped, failed to infer shapes.";
+            return table;
+        }
+
+        auto cpu = cpu_model_name();
+        auto pool = ctx::ptr<ThreadPool>();
+        int threads = pool == nullptr ? 1 : int(pool->size());
+
+        auto cache_file = GetCacheFile();
+        TuningCache::Records cached;
+        if (!cache_file.empty()) {
+            std::unique_lock<std::mutex> _lock(tuning_cache_mutex);
+            cached = TuningCache::Load(cache_file);
+        }
+        TuningCache::Records tuned;
+
+        for (auto &node : walked) {
+            auto op = node->op();
+            if (op != name::layer::conv2d() && op != name::layer::inner_prod()) continue;
+            if (node.inputs().size() != 2) continue;
+
+            auto x_it = shapes.find(dolly_of.at(node.input(0)));
+            if (x_it == shapes.end() || !known_shape(x_it->second)) continue;
+
+            std::string signature;
+            auto candidates = op == name::layer::conv2d()
+                              ? conv2d_candidates(node, x_it->second, signature)
+                              : inner_prod_candidates(node, x_it->second, signature);
+            if (candidates.size() < 2) continue;
+
+            auto key = TuningCache::Key(cpu, threads, signature);
+            auto cached_it = cached.find(key);
+            if (cached_it != cached.end()) {
+                auto algorithm = TuningTable::Parse(cached_it->second.algorithm);
+                if (algorithm != TuningTable::DEFAULT) {
+                    table.set(node->name(), algorithm);
+                    continue;
+                }
+            }
+
+            Tensor expected;
+            TuningRecord winner;
+            auto winner_algorithm = TuningTable::DEFAULT;
+            for (auto &candidate : candidates) {
+                Tensor output;
+                auto milliseconds = benchmark(*bench, candidate, output);
+                if (milliseconds < 0) continue;
+                // first candidate is reference, others must give same result
+                if (expected.empty()) {
+                    expected = output;
+                } else if (relative_error(expected, output) > 1e-3f) {
+                    TS_LOG_INFO << "Tuning " << op << ":" << node->name() << ", "
+                                << TuningTable::Name(candidate.algorithm) << " got wrong result.";
+                    continue;
+                }
+                if (winner_algorithm == TuningTable::DEFAULT || milliseconds < winner.milliseconds) {
+                    winner_algorithm = candidate.algorithm;
+                    winner.algorithm = TuningTable::Name(candidate.algorithm);
+                    winner.milliseconds = milliseconds;
+                }
+            }
+            if (winner_algorithm == TuningTable::DEFAULT) continue;
+
+            TS_LOG_INFO << "Tuned " << op << ":" << node->name() << " => "
+                        << winner.algorithm << " (" << winner.milliseconds << "ms)";
+            table.set(node->name(), winner_algorithm);
+            cached[key] = winner;
+            tuned[key] = winner;
+        }
+
+        if (!tuned.empty() && !cache_file.empty()) {
+            std::unique_lock<std::mutex> _lock(tuning_cache_mutex);
+            if (!TuningCache::Save(cache_file, tuned)) {
+                TS_LOG_ERROR << "Can not write tuning cache: " << cache_file;
+            }
+        }
+
+        TS_LOG_STATUS << "Tuned " << table.size() << " layers, " << tuned.size()
+                      << " benchmarked on " << cpu << " with " << threads << " threads.";
+
+        return table;
+    }
+}
+
+TS_LITE_CONTEXT(ts::TuningTable)
@@ -11,6 +11,7 @@
 #include <compiler/argparse.h>
 
 #include "compiler/option/winograd_zipper_option.h"
+#include "compiler/tuner.h"
 
 namespace ts {
 
@@ -85,6 +86,11 @@ namespace ts {
 
     Zipper::Zipper(const ComputingDevice &device, const std::string &params)
         : m_device(device) {
+        // tuned choices come first, before heuristic options
+        auto tuning = ctx::get<TuningTable>();
+        if (tuning != nullptr && !tuning->empty()) {
+            m_options.push_back(new TunedConv2dZipperOption);
+        }
         ArgParser parser;
         //NOTE:Winograd conv was only used on arm device now
 #ifdef TS_ON_ARM
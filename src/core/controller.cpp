@@ -17,6 +17,11 @@ namespace ts {
         TS_CHECK(m_allocator != nullptr) << "Can not found memory controller for " << device.type() << eject;
     }
 
+    DynamicMemoryController::DynamicMemoryController(const MemoryBudget::shared &budget, const MemoryDevice &device)
+            : self(device) {
+        if (budget) m_allocator = budget->wrap(device, m_allocator);
+    }
+
     Memory DynamicMemoryController::alloc(size_t size) {
         return Memory(std::make_shared<HardMemory>(m_device, m_allocator, size));
     }
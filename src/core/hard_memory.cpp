@@ -36,6 +36,17 @@ namespace ts {
             : m_device(device), m_capacity(size), m_data(data) {
     }
 
+    HardMemory::HardMemory(const MemoryDevice &device, void *data, size_t size,
+                           const std::function<void(void *)> &release)
+            : m_device(device), m_capacity(size), m_data(data) {
+        if (release == nullptr) return;
+        m_allocator = [release](int, size_t new_size, void *mem, size_t) -> void * {
+            if (new_size != 0) TS_LOG_ERROR("Borrowed memory can not be resized.") << eject;
+            if (mem != nullptr) release(mem);
+            return nullptr;
+        };
+    }
+
     HardMemory::~HardMemory() {
         if (m_allocator) m_allocator(m_device.id(), 0, m_data, 0);
     }
@@ -240,7 +240,7 @@ namespace ts {
 
     void Tensor::pack(const std::vector<Tensor::self> &fields) {
         if (fields.empty()) {
-            this->m_memory = make_smart<TensorMemory>();
+            this->m_memory = empty_memory();
             this->m_proto = Prototype();
             return;
         }
@@ -388,7 +388,8 @@ namespace ts {
         return read_size;
     }
 
-    Tensor::Tensor(Tensor::self &&other) TS_NOEXCEPT {
+    Tensor::Tensor(Tensor::self &&other) TS_NOEXCEPT
+            : m_memory(empty_memory()) {
         this->operator=(std::move(other));
     }
 
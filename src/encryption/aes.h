@@ -2,6 +2,7 @@
 #define TENSORSTACK_ENCRYPTION_AES_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 // #define the macros below to 1/0 to enable/disable the mode of operation.
 //
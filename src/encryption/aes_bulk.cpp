@@ -0,0 +1,149 @@
+#include "aes_bulk.h"
+
+#include "utils/platform.h"
+#include "utils/cpu_info.h"
+
+#include <cstring>
+#include <algorithm>
+
+#if TS_PLATFORM_IS_X86 && (TS_PLATFORM_CC_GCC || TS_PLATFORM_CC_MINGW || TS_PLATFORM_CC_MSVC)
+#define TS_USE_AES_NI 1
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#if TS_PLATFORM_CC_MSVC
+#define TS_AES_NI_TARGET
+#else
+// only functions use AES-NI are compiled with it, others still run on old cpu
+#define TS_AES_NI_TARGET __attribute__((target("aes,sse2")))
+#endif
+#endif
+
+namespace ts {
+    namespace aes {
+        static const int ROUNDS = AES_keyExpSize / AES_BLOCKLEN - 1;
+
+#if TS_USE_AES_NI
+        TS_AES_NI_TARGET
+        static void ni_load_keys(const AES_ctx &ctx, __m128i *keys, bool decrypt) {
+            auto round_key = [&](int i) {
+                return _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctx.RoundKey + i * AES_BLOCKLEN));
+            };
+            if (!decrypt) {
+                for (int i = 0; i <= ROUNDS; ++i) keys[i] = round_key(i);
+                return;
+            }
+            // equivalent inverse cipher
+            keys[0] = round_key(ROUNDS);
+            for (int i = 1; i < ROUNDS; ++i) keys[i] = _mm_aesimc_si128(round_key(ROUNDS - i));
+            keys[ROUNDS] = round_key(0);
+        }
+
+        template <bool DECRYPT, int N>
+        TS_AES_NI_TARGET
+        static inline void ni_cipher(const __m128i *keys, uint8_t *buf) {
+            __m128i x[N];
+            for (int j = 0; j < N; ++j) {
+                x[j] = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(buf) + j), keys[0]);
+            }
+            for (int r = 1; r < ROUNDS; ++r) {
+                for (int j = 0; j < N; ++j) {
+                    x[j] = DECRYPT ? _mm_aesdec_si128(x[j], keys[r]) : _mm_aesenc_si128(x[j], keys[r]);
+                }
+            }
+            for (int j = 0; j < N; ++j) {
+                x[j] = DECRYPT ? _mm_aesdeclast_si128(x[j], keys[ROUNDS]) : _mm_aesenclast_si128(x[j], keys[ROUNDS]);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(buf) + j, x[j]);
+            }
+        }
+
+        template <bool DECRYPT>
+        TS_AES_NI_TARGET
+        static void ni_ecb(const AES_ctx &ctx, uint8_t *buf, size_t blocks) {
+            __m128i keys[ROUNDS + 1];
+            ni_load_keys(ctx, keys, DECRYPT);
+            size_t i = 0;
+            // 8 blocks in flight to hide latency of aesenc/aesdec
+            for (; i + 8 <= blocks; i += 8) {
+                ni_cipher<DECRYPT, 8>(keys, buf + i * AES_BLOCKLEN);
+            }
+            for (; i < blocks; ++i) {
+                ni_cipher<DECRYPT, 1>(keys, buf + i * AES_BLOCKLEN);
+            }
+        }
+#endif
+
+        bool hardware_support() {
+#if TS_USE_AES_NI
+            static const bool support = check_cpu_feature(AES) && check_cpu_feature(SSE2);
+            return support;
+#else
+            return false;
+#endif
+        }
+
+        void ecb_encrypt(const AES_ctx &ctx, uint8_t *buf, size_t blocks) {
+#if TS_USE_AES_NI
+            if (hardware_support()) {
+                ni_ecb<false>(ctx, buf, blocks);
+                return;
+            }
+#endif
+            // portable cipher only read ctx
+            auto &portable_ctx = const_cast<AES_ctx &>(ctx);
+            for (size_t i = 0; i < blocks; ++i) {
+                AES_ECB_encrypt(&portable_ctx, buf + i * AES_BLOCKLEN);
+            }
+        }
+
+        void ecb_decrypt(const AES_ctx &ctx, uint8_t *buf, size_t blocks) {
+#if TS_USE_AES_NI
+            if (hardware_support()) {
+                ni_ecb<true>(ctx, buf, blocks);
+                return;
+            }
+#endif
+            auto &portable_ctx = const_cast<AES_ctx &>(ctx);
+            for (size_t i = 0; i < blocks; ++i) {
+                AES_ECB_decrypt(&portable_ctx, buf + i * AES_BLOCKLEN);
+            }
+        }
+
+        /**
+         * block = iv + index, as 128-bit big-endian integer
+         */
+        static void counter_block(const uint8_t *iv, uint64_t index, uint8_t *block) {
+            std::memcpy(block, iv, AES_BLOCKLEN);
+            uint64_t carry = index;
+            for (int i = AES_BLOCKLEN - 1; i >= 0 && carry; --i) {
+                uint64_t sum = uint64_t(block[i]) + (carry & 0xff);
+                block[i] = uint8_t(sum);
+                carry = (carry >> 8) + (sum >> 8);
+            }
+        }
+
+        static void xor_bytes(uint8_t *buf, const uint8_t *stream, size_t size) {
+            for (size_t i = 0; i < size; ++i) buf[i] ^= stream[i];
+        }
+
+        void ctr_xcrypt(const AES_ctx &ctx, const uint8_t *iv, uint64_t offset, uint8_t *buf, size_t size) {
+            static const size_t BATCH = 64;
+            uint8_t stream[BATCH * AES_BLOCKLEN];
+
+            auto index = offset / AES_BLOCKLEN;
+            auto skip = size_t(offset % AES_BLOCKLEN);
+            while (size) {
+                auto blocks = std::min<size_t>(BATCH, (skip + size + AES_BLOCKLEN - 1) / AES_BLOCKLEN);
+                for (size_t i = 0; i < blocks; ++i) {
+                    counter_block(iv, index + i, stream + i * AES_BLOCKLEN);
+                }
+                ecb_encrypt(ctx, stream, blocks);
+                auto n = std::min(size, blocks * AES_BLOCKLEN - skip);
+                xor_bytes(buf, stream + skip, n);
+                buf += n;
+                size -= n;
+                index += blocks;
+                skip = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef TENSORSTACK_ENCRYPTION_AES_BULK_H
+#define TENSORSTACK_ENCRYPTION_AES_BULK_H
+
+#include "aes.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ts {
+    /**
+     * Bulk AES on many blocks, using AES-NI if cpu supported, or the portable code in aes.h.
+     * The ctx is only read, so one ctx can be used in many threads at same time.
+     */
+    namespace aes {
+        /**
+         * @return if AES-NI used
+         */
+        bool hardware_support();
+
+        /**
+         * encrypt blocks in place
+         * @param ctx inited by AES_init_ctx
+         * @param buf data of blocks * AES_BLOCKLEN bytes
+         * @param blocks number of blocks
+         */
+        void ecb_encrypt(const AES_ctx &ctx, uint8_t *buf, size_t blocks);
+
+        /**
+         * decrypt blocks in place
+         * @param ctx inited by AES_init_ctx
+         * @param buf data of blocks * AES_BLOCKLEN bytes
+         * @param blocks number of blocks
+         */
+        void ecb_decrypt(const AES_ctx &ctx, uint8_t *buf, size_t blocks);
+
+        /**
+         * xor buf with CTR key stream starting at byte offset, encrypt and decrypt are same.
+         * Counter of block i is iv + i, as 128-bit big-endian integer, same as AES_CTR_xcrypt_buffer.
+         * @param ctx inited by AES_init_ctx
+         * @param iv initial counter of AES_BLOCKLEN bytes
+         * @param offset byte offset of buf in whole stream, any alignment
+         * @param buf data
+         * @param size bytes of data
+         */
+        void ctr_xcrypt(const AES_ctx &ctx, const uint8_t *iv, uint64_t offset, uint8_t *buf, size_t size);
+    }
+}
+
+#endif //TENSORSTACK_ENCRYPTION_AES_BULK_H
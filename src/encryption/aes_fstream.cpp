@@ -4,123 +4,201 @@
 
 #include <module/io/fstream.h>
 #include "aes_fstream.h"
+#include "aes_bulk.h"
 #include <string.h>
 #include <utils/assert.h>
 #include <utils/log.h>
+#include <runtime/inside/parallel.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
 
 namespace ts {
+    static const char CTR_MAGIC[8] = {'T', 'S', 'A', 'E', 'S', 'C', 'T', 'R'};
+    static const size_t CTR_HEADER_SIZE = sizeof(CTR_MAGIC) + AES_BLOCKLEN + sizeof(uint64_t);
+    static const size_t CACHE_SIZE = 64 * 1024;
+    // bytes decrypted in each parallel task
+    static const size_t PARALLEL_CHUNK = 256 * 1024;
+
+    static void encode_uint64(uint64_t value, uint8_t *data) {
+        for (int i = 0; i < 8; ++i) data[i] = uint8_t(value >> (8 * i));
+    }
+
+    static uint64_t decode_uint64(const uint8_t *data) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= uint64_t(data[i]) << (8 * i);
+        return value;
+    }
+
+    static void random_iv(uint8_t *iv) {
+        std::random_device device;
+        auto now = uint64_t(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+        for (int i = 0; i < AES_BLOCKLEN; i += 4) {
+            auto value = uint32_t(device()) ^ uint32_t(now >> (i * 2));
+            memcpy(iv + i, &value, 4);
+        }
+    }
+
     bool AESFileStreamReader::is_open() const {
         return m_stream.is_open();
     }
 
     size_t AESFileStreamReader::read(void *buffer, size_t size) {
-        if(m_master_datalen - m_master_offset >= size) {
-            memcpy(buffer, m_master + m_master_offset, size);
-            m_master_offset += int(size);
-            return size; 
+        if (!m_valid) {
+            TS_LOG_ERROR << "mode file read format is error!" << eject;
         }
-
-        bool iseof = false;
-        int buffer_offset= 0;
-        if(m_master_datalen - m_master_offset > 0) {
-            memcpy(buffer, m_master + m_master_offset, m_master_datalen - m_master_offset);
-            buffer_offset = m_master_datalen - m_master_offset;
-            m_master_offset = 0;
-            m_master_datalen = 0;
+        if (size == 0) return 0;
+        if (m_position >= m_size) {
+            TS_LOG_ERROR << "mode file is eof!" << eject;
         }
+        size = size_t(std::min<uint64_t>(size, m_size - m_position));
 
-        if(m_stream.eof()) {
-            if(buffer_offset > 0) {
-                return size_t(buffer_offset);
-            }else
-            {
-                TS_LOG_ERROR << "mode file is eof!" << eject;
-                return 0;
-            }
-        }
- 
-        while(buffer_offset < size) {    
-            if(m_second_datalen == 0 ) {
-                m_stream.read(reinterpret_cast<char *>(m_second), AES_BLOCKLEN);
-                m_second_datalen = int(m_stream.gcount());
-                if(m_second_datalen == 0 ) {
-                    if(m_stream.eof()) {
-                        break;
-                    }else {
-                        TS_LOG_ERROR << "mode file read format is error!" << eject;
-                        return 0;
-                    }
-                }else {
-                    if(m_second_datalen != AES_BLOCKLEN) {
-                        TS_LOG_ERROR << "mode file read format is error!" << eject;
-                        return 0;
-                    }
-                    AES_ECB_decrypt(&m_ctx, m_second);  
-                }
+        auto data = reinterpret_cast<uint8_t *>(buffer);
+        size_t done = 0;
+        while (done < size) {
+            if (m_position >= m_cache_begin && m_position < m_cache_end) {
+                auto n = size_t(std::min<uint64_t>(size - done, m_cache_end - m_position));
+                memcpy(data + done, m_cache.data() + (m_position - m_cache_begin), n);
+                done += n;
+                m_position += n;
+                continue;
             }
-
-            memcpy(m_master, m_second, AES_BLOCKLEN);
-            m_master_datalen = AES_BLOCKLEN;
-            m_master_offset = 0;
-
-            m_second_datalen = 0; 
-            m_stream.read(reinterpret_cast<char *>(m_second), AES_BLOCKLEN);
-            m_second_datalen = int(m_stream.gcount());
-            if(m_second_datalen == 0 ) {
-                if(m_stream.eof()) {
-                    iseof = true;
-                }else {
-                    TS_LOG_ERROR << "mode file read format is error!" << eject;
-                    return 0;
+            auto left = size - done;
+            if (left >= CACHE_SIZE) {
+                // big read, like tensor data, decrypted in caller's buffer directly
+                auto end = m_position + left;
+                if (m_mode == EncryptionMode::AES_ECB) {
+                    // padding block always go through cache
+                    end = m_position % AES_BLOCKLEN
+                          ? m_position
+                          : std::min(end, m_size) / AES_BLOCKLEN * AES_BLOCKLEN;
                 }
-            }else {
-                if(m_second_datalen != AES_BLOCKLEN) {
-                    TS_LOG_ERROR << "mode file read format is error!" << eject;
-                    return 0;
+                if (end > m_position) {
+                    auto n = size_t(end - m_position);
+                    load(m_position, data + done, n);
+                    done += n;
+                    m_position += n;
+                    continue;
                 }
-                AES_ECB_decrypt(&m_ctx, m_second);  
             }
- 
-            if(iseof) {
-                m_master_datalen -= (int)(m_master[AES_BLOCKLEN - 1]); 
-            } 
-
-            
-            if(buffer_offset + m_master_datalen >= size) {
-                memcpy(reinterpret_cast<char*>(buffer) + buffer_offset, m_master, size - buffer_offset);
-                m_master_offset = int(size) - buffer_offset;
-                buffer_offset += m_master_offset;
-                break;
-            }else {
-                memcpy(reinterpret_cast<char*>(buffer) + buffer_offset, m_master, m_master_datalen);
-                buffer_offset += m_master_datalen;
-                m_master_offset = 0;
-                m_master_datalen = 0;
-            } 
-
-            if(iseof){
-                break;
+            fill(m_position / AES_BLOCKLEN * AES_BLOCKLEN);
+        }
+
+        return size;
+    }
+
+    void AESFileStreamReader::load(uint64_t offset, uint8_t *data, size_t size) {
+        m_stream.clear();
+        m_stream.seekg(std::streamoff(m_content_begin + offset));
+        m_stream.read(reinterpret_cast<char *>(data), std::streamsize(size));
+        if (size_t(m_stream.gcount()) != size) {
+            TS_LOG_ERROR << "mode file read format is error!" << eject;
+        }
+        decrypt(offset, data, size);
+    }
+
+    void AESFileStreamReader::decrypt(uint64_t offset, uint8_t *data, size_t size) {
+        auto solve = [&](int64_t begin, int64_t end) {
+            auto chunk_begin = size_t(begin) * PARALLEL_CHUNK;
+            auto chunk_size = std::min(size, size_t(end) * PARALLEL_CHUNK) - chunk_begin;
+            if (m_mode == EncryptionMode::AES_ECB) {
+                aes::ecb_decrypt(m_ctx, data + chunk_begin, chunk_size / AES_BLOCKLEN);
+            } else {
+                aes::ctr_xcrypt(m_ctx, m_iv, offset + chunk_begin, data + chunk_begin, chunk_size);
             }
+        };
+        auto chunks = int64_t((size + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK);
+        auto gun = pool(chunks);
+        if (gun == nullptr) {
+            solve(0, chunks);
+            return;
+        }
+        gun->parallel(0, chunks, 1, [&](int, int64_t begin, int64_t end) {
+            solve(begin, end);
+        });
+    }
+
+    void AESFileStreamReader::fill(uint64_t offset) {
+        auto size = size_t(std::min<uint64_t>(CACHE_SIZE, m_content_size - offset));
+        m_cache.resize(CACHE_SIZE);
+        m_cache_begin = m_cache_end = 0;
+        load(offset, m_cache.data(), size);
+        m_cache_begin = offset;
+        m_cache_end = std::min(offset + size, m_size);
+    }
+
+    ThreadPool *AESFileStreamReader::pool(int64_t task_number) {
+        // use pool in context first, like loading in workbench
+        auto gun = try_parallel(task_number);
+        if (gun != nullptr) return gun;
+        if (task_number <= 1 || m_computing_thread_number <= 1) return nullptr;
+        if (m_pool == nullptr || int(m_pool->size()) != m_computing_thread_number) {
+            m_pool.reset(new ThreadPool(size_t(m_computing_thread_number)));
         }
-        
-        return size_t(buffer_offset);
+        return m_pool.get();
+    }
+
+    bool AESFileStreamReader::seek(size_t offset) {
+        if (!m_valid || offset > m_size) return false;
+        m_position = offset;
+        return true;
+    }
+
+    void AESFileStreamReader::set_computing_thread_number(int number) {
+        m_computing_thread_number = std::max(number, 1);
     }
 
     AESFileStreamReader::AESFileStreamReader(const std::string &path, const std::string &key)
             : m_stream(path, std::ios::binary) {
-         m_master_offset = 0;
-         m_master_datalen = 0;
-         m_second_datalen = 0;
+        m_computing_thread_number = std::max<int>(int(std::thread::hardware_concurrency()), 1);
 
         if (key.length() > AES_KEYLEN) {
             TS_LOG_ERROR << "Using key over " << AES_KEYLEN << " will be ignored.";
         }
 
-         AES_init_ctx(&m_ctx, (uint8_t*)key.c_str(), uint32_t(key.length()));
+        AES_init_ctx(&m_ctx, (uint8_t*)key.c_str(), uint32_t(key.length()));
+
+        if (!m_stream.is_open()) return;
+
+        m_stream.seekg(0, std::ios::end);
+        auto file_size = uint64_t(m_stream.tellg());
+        m_stream.seekg(0, std::ios::beg);
+
+        uint8_t header[CTR_HEADER_SIZE];
+        if (file_size >= CTR_HEADER_SIZE &&
+            m_stream.read(reinterpret_cast<char *>(header), CTR_HEADER_SIZE) &&
+            memcmp(header, CTR_MAGIC, sizeof(CTR_MAGIC)) == 0) {
+            m_mode = EncryptionMode::AES_CTR;
+            memcpy(m_iv, header + sizeof(CTR_MAGIC), AES_BLOCKLEN);
+            m_content_begin = CTR_HEADER_SIZE;
+            m_content_size = file_size - CTR_HEADER_SIZE;
+            m_size = decode_uint64(header + sizeof(CTR_MAGIC) + AES_BLOCKLEN);
+            m_valid = m_size <= m_content_size;
+            m_content_size = m_size;
+            return;
+        }
+
+        // ECB, get content size from padding in last block
+        m_mode = EncryptionMode::AES_ECB;
+        m_content_begin = 0;
+        m_content_size = file_size;
+        if (file_size == 0 || file_size % AES_BLOCKLEN != 0) return;
+        uint8_t last[AES_BLOCKLEN];
+        m_stream.clear();
+        m_stream.seekg(std::streamoff(file_size - AES_BLOCKLEN));
+        if (!m_stream.read(reinterpret_cast<char *>(last), AES_BLOCKLEN)) return;
+        aes::ecb_decrypt(m_ctx, last, 1);
+        auto padding = last[AES_BLOCKLEN - 1];
+        if (padding == 0 || padding > AES_BLOCKLEN) return;
+        m_size = file_size - padding;
+        m_valid = true;
     }
 
     void AESFileStreamReader::close() {
         m_stream.close();
+        m_pool.reset();
     }
 
     AESFileStreamReader::~AESFileStreamReader() {
@@ -134,37 +212,49 @@ namespace ts {
     }
 
     size_t AESFileStreamWriter::write(const void *buffer, size_t size) {
-
+        auto data = reinterpret_cast<const uint8_t *>(buffer);
         size_t nwrite = 0;
-        while(nwrite < size ) {
-            if(AES_BLOCKLEN - m_master_datalen  >= size - nwrite) {
-                memcpy(m_master + m_master_datalen, reinterpret_cast<const char *>(buffer) + nwrite, size - nwrite);
-                m_master_datalen += int(size - nwrite);
-                nwrite = size;
-                return nwrite; 
-            }else {
-                memcpy(m_master + m_master_datalen, reinterpret_cast<const char *>(buffer) + nwrite, AES_BLOCKLEN - m_master_datalen);
-                AES_ECB_encrypt(&m_ctx, m_master);  
-                m_stream.write(reinterpret_cast<const char *>(m_master), AES_BLOCKLEN);
-                nwrite += AES_BLOCKLEN - m_master_datalen; 
-                m_master_datalen = 0;
-                if(m_stream.bad()) {
-                    return 0;
-                }
+        while (nwrite < size) {
+            auto n = std::min(CACHE_SIZE - m_buffer.size(), size - nwrite);
+            m_buffer.insert(m_buffer.end(), data + nwrite, data + nwrite + n);
+            nwrite += n;
+            if (m_buffer.size() == CACHE_SIZE && !flush()) {
+                return 0;
             }
         }
         return nwrite;
     }
 
-    AESFileStreamWriter::AESFileStreamWriter(const std::string &path, const std::string &key)
-            : m_stream(path, std::ios::binary) {
-         m_master_datalen = 0;
+    bool AESFileStreamWriter::flush() {
+        if (m_buffer.empty()) return true;
+        if (m_mode == EncryptionMode::AES_ECB) {
+            aes::ecb_encrypt(m_ctx, m_buffer.data(), m_buffer.size() / AES_BLOCKLEN);
+        } else {
+            aes::ctr_xcrypt(m_ctx, m_iv, m_size, m_buffer.data(), m_buffer.size());
+        }
+        m_stream.write(reinterpret_cast<const char *>(m_buffer.data()), std::streamsize(m_buffer.size()));
+        m_size += m_buffer.size();
+        m_buffer.clear();
+        return !m_stream.bad();
+    }
 
+    AESFileStreamWriter::AESFileStreamWriter(const std::string &path, const std::string &key, EncryptionMode mode)
+            : m_stream(path, std::ios::binary), m_mode(mode) {
          if (key.length() > AES_KEYLEN) {
              TS_LOG_ERROR << "Using key over " << AES_KEYLEN << " will be ignored.";
          }
 
          AES_init_ctx(&m_ctx, (uint8_t*)key.c_str(), uint32_t(key.length()));
+         m_buffer.reserve(CACHE_SIZE + AES_BLOCKLEN);
+
+         if (m_mode == EncryptionMode::AES_CTR) {
+             // iv must not be reused with the same key
+             random_iv(m_iv);
+             uint8_t header[CTR_HEADER_SIZE] = {0};
+             memcpy(header, CTR_MAGIC, sizeof(CTR_MAGIC));
+             memcpy(header + sizeof(CTR_MAGIC), m_iv, AES_BLOCKLEN);
+             m_stream.write(reinterpret_cast<const char *>(header), CTR_HEADER_SIZE);
+         }
     }
 
     AESFileStreamWriter::~AESFileStreamWriter() {
@@ -176,23 +266,20 @@ namespace ts {
             return;
         }
 
-        if(m_master_datalen == AES_BLOCKLEN) {
-            AES_ECB_encrypt(&m_ctx, m_master);  
-            m_stream.write(reinterpret_cast<const char *>(m_master), AES_BLOCKLEN);
-            m_master_datalen = 0;
-            if(m_stream.bad()) {
-                TS_LOG_ERROR << "write mode file failed!" << eject;
-                return;
-            }
-        } 
-        uint8_t npadding = (uint8_t)(AES_BLOCKLEN - m_master_datalen);
-        uint8_t buf[AES_BLOCKLEN];
-        memset(buf, npadding, AES_BLOCKLEN);
-        memcpy(buf, m_master, m_master_datalen);
-        AES_ECB_encrypt(&m_ctx, buf);  
-        
-        m_stream.write(reinterpret_cast<const char *>(buf), AES_BLOCKLEN);
-        m_master_datalen = 0;
+        if (m_mode == EncryptionMode::AES_ECB) {
+            auto npadding = uint8_t(AES_BLOCKLEN - m_buffer.size() % AES_BLOCKLEN);
+            m_buffer.insert(m_buffer.end(), npadding, npadding);
+        }
+        if (!flush()) {
+            TS_LOG_ERROR << "write mode file failed!" << eject;
+            return;
+        }
+        if (m_mode == EncryptionMode::AES_CTR) {
+            uint8_t size[8];
+            encode_uint64(m_size, size);
+            m_stream.seekp(std::streamoff(sizeof(CTR_MAGIC) + AES_BLOCKLEN));
+            m_stream.write(reinterpret_cast<const char *>(size), sizeof(size));
+        }
         m_stream.close();
     }
 
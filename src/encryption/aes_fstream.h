@@ -6,12 +6,20 @@
 #define TENSORSTACK_ENCRYPTION_AES_FSTREAM_H
 
 #include "module/io/stream.h"
+#include "encryption/encrypted_fstream.h"
+#include "runtime/inside/thread_pool.h"
 #include <fstream>
 #include <vector>
 #include <memory>
 #include "aes.h"
 
 namespace ts {
+    /**
+     * File formats:
+     * ECB: AES-ECB of whole content with PKCS7 padding.
+     * CTR: 32 bytes header {"TSAESCTR", iv[16], uint64 content size in little-endian}, then AES-CTR of content.
+     * Blocks are independent in both formats, so reader decrypts big reads in parallel, directly in caller's buffer.
+     */
     class AESFileStreamReader : public StreamReader {
     public:
         using self = AESFileStreamReader;
@@ -36,20 +44,53 @@ namespace ts {
 
         size_t read(void *buffer, size_t size) final;
 
+        EncryptionMode mode() const { return m_mode; }
+
+        size_t size() const { return size_t(m_size); }
+
+        size_t tell() const { return size_t(m_position); }
+
+        bool seek(size_t offset);
+
+        void set_computing_thread_number(int number);
+
         std_stream &stream() { return m_stream; }
 
         const std_stream &stream() const { return m_stream; }
 
     private:
-        std_stream m_stream;
-        uint8_t m_master[AES_BLOCKLEN];
-        uint8_t m_second[AES_BLOCKLEN];
+        /**
+         * read content [offset, offset + size) from file and decrypt to data,
+         * offset and size must be aligned to AES_BLOCKLEN in ECB mode
+         */
+        void load(uint64_t offset, uint8_t *data, size_t size);
+
+        void decrypt(uint64_t offset, uint8_t *data, size_t size);
+
+        /**
+         * load content from aligned offset to cache
+         */
+        void fill(uint64_t offset);
 
-        int        m_master_datalen;
-        int        m_master_offset;
+        ThreadPool *pool(int64_t task_number);
 
-        int        m_second_datalen;
+        std_stream m_stream;
         struct AES_ctx m_ctx;
+        EncryptionMode m_mode = EncryptionMode::AES_ECB;
+        bool m_valid = false;
+        uint8_t m_iv[AES_BLOCKLEN];
+
+        uint64_t m_content_begin = 0;   ///< file offset of encrypted content
+        uint64_t m_content_size = 0;    ///< bytes of encrypted content, with padding
+        uint64_t m_size = 0;            ///< bytes of decrypted content
+        uint64_t m_position = 0;
+
+        std::vector<uint8_t> m_cache;
+        uint64_t m_cache_begin = 0;
+        uint64_t m_cache_end = 0;
+
+        int m_computing_thread_number;
+        std::unique_ptr<ThreadPool> m_pool;
     };
 
 
@@ -65,7 +106,8 @@ namespace ts {
 
         AESFileStreamWriter() = delete;
 
-        explicit AESFileStreamWriter(const std::string &path, const std::string &key);
+        explicit AESFileStreamWriter(const std::string &path, const std::string &key,
+                                     EncryptionMode mode = EncryptionMode::AES_ECB);
 
         ~AESFileStreamWriter();
         //void open(const std::string &path);
@@ -81,12 +123,18 @@ namespace ts {
         const std_stream &stream() const { return m_stream; }
 
     private:
-        std_stream m_stream;
-        uint8_t m_master[AES_BLOCKLEN];
-
-        int        m_master_datalen;
+        /**
+         * encrypt and write m_buffer
+         */
+        bool flush();
 
+        std_stream m_stream;
         struct AES_ctx m_ctx;
+        EncryptionMode m_mode;
+        uint8_t m_iv[AES_BLOCKLEN];
+
+        std::vector<uint8_t> m_buffer;
+        uint64_t m_size = 0;    ///< bytes of content written to file
     };
 
 }
@@ -32,19 +32,44 @@ namespace ts {
         return m_impl->stream.read(buffer, size);
     }
 
+    EncryptionMode EncryptedFileStreamReader::mode() const {
+        return m_impl->stream.mode();
+    }
+
+    size_t EncryptedFileStreamReader::size() const {
+        return m_impl->stream.size();
+    }
+
+    size_t EncryptedFileStreamReader::tell() const {
+        return m_impl->stream.tell();
+    }
+
+    bool EncryptedFileStreamReader::seek(size_t offset) {
+        return m_impl->stream.seek(offset);
+    }
+
+    void EncryptedFileStreamReader::set_computing_thread_number(int number) {
+        m_impl->stream.set_computing_thread_number(number);
+    }
+
     EncryptedFileStreamReader::~EncryptedFileStreamReader() {
         // do nothing
     }
 
     class EncryptedFileStreamWriter::Implement {
     public:
-        Implement(const std::string &path, const std::string &key) : stream(path, key) {}
+        Implement(const std::string &path, const std::string &key, EncryptionMode mode)
+                : stream(path, key, mode) {}
 
         AESFileStreamWriter stream;
     };
 
     EncryptedFileStreamWriter::EncryptedFileStreamWriter(const std::string &path, const std::string &key)
-            : m_impl(path, key) {}
+            : m_impl(path, key, EncryptionMode::AES_ECB) {}
+
+    EncryptedFileStreamWriter::EncryptedFileStreamWriter(const std::string &path, const std::string &key,
+                                                         EncryptionMode mode)
+            : m_impl(path, key, mode) {}
 
     bool EncryptedFileStreamWriter::is_open() const {
         return m_impl->stream.is_open();
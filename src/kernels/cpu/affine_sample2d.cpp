@@ -5,11 +5,11 @@
 #include <backend/name.h>
 #include <utils/assert.h>
 #include <core/device.h>
+#include <kernels/common/simd.h>
 #include <vector>
 #include <algorithm>
-#ifdef TS_USE_OPENMP
+#include <cmath>
 #include <kernels/common/openmp.h>
-#endif
 
 
 namespace ts {
@@ -57,14 +57,7 @@ namespace ts {
             const T *src_im = x->data<T>() + x_offset;
             T *dst_im = y->data<T>() + y_offset;
 
-#ifdef TS_USE_OPENMP
-//Note:Using both openmp and neon on armv7 could cause crashes.
-#ifdef TS_ON_ARMV7
-#else
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-#endif
-            for (int n_y_d = 0; n_y_d < dst_height; n_y_d++) {
+            parallel_for(0, dst_height, [&](int n_y_d) {
                 for (int n_x_d = 0; n_x_d < dst_width; n_x_d++) {
                     vec3d<float> cur(n_x_d, n_y_d, 1);
                     auto location = transform<float>(rz00, rz01, rz02, rz10, rz11, rz12, rz20, rz21, rz22, cur);
@@ -106,7 +99,7 @@ namespace ts {
 
                     } //end for c
                 }
-            }
+            });
         }
 
         template<typename T>
@@ -120,14 +113,7 @@ namespace ts {
             const T *src_im = x->data<T>() + x_offset;
             T *dst_im = y->data<T>() + y_offset;
 
-#ifdef TS_USE_OPENMP
-//Note:Using both openmp and neon on armv7 could cause crashes.
-#ifdef TS_ON_ARMV7
-#else
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-#endif
-            for (int n_y_d = 0; n_y_d < dst_height; n_y_d++) {
+            parallel_for(0, dst_height, [&](int n_y_d) {
                 for (int n_x_d = 0; n_x_d < dst_width; n_x_d++) {
 
                     vec3d<float> cur(n_x_d, n_y_d, 1);
@@ -159,7 +145,7 @@ namespace ts {
                                 src_im[(n_y_s * src_width + n_x_s) * channels + c];
                     }//end for c
                 }
-            }
+            });
 
         }
 
@@ -174,14 +160,7 @@ namespace ts {
             const T *src_im = x->data<T>() + x_offset;
             T *dst_im = y->data<T>() + y_offset;
 
-#ifdef TS_USE_OPENMP
-//Note:Using both openmp and neon on armv7 could cause crashes.
-#ifdef TS_ON_ARMV7
-#else
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-#endif
-            for (int n_y_d = 0; n_y_d < dst_height; n_y_d++) {
+            parallel_for(0, dst_height, [&](int n_y_d) {
                 for (int n_x_d = 0; n_x_d < dst_width; n_x_d++) {
 
                     vec3d<float> cur(n_x_d, n_y_d, 1);
@@ -213,7 +192,7 @@ namespace ts {
                                 src_im[(n_y_s * src_width + n_x_s) * channels + c];
                     }//end for c
                 }
-            }
+            });
 
         }
 
@@ -231,14 +210,7 @@ namespace ts {
             const int srcrows = x_width * channels;
             const int dstrows = y_width * channels;
 
-#ifdef TS_USE_OPENMP
-//Note:Using both openmp and neon on armv7 could cause crashes.
-#ifdef TS_ON_ARMV7
-#else
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-#endif
-            for (int m = 0; m < y_height; m++) {
+            parallel_for(0, y_height, [&](int m) {
                 double coeffsY[4];
                 double coeffsX[4];
                 for (int n = 0; n < y_width; n++) {
@@ -314,9 +286,150 @@ namespace ts {
                         }
                     }
                 }
+            });
+        }
+
+
+        /**
+         * Fixed point coordinate for linear sample of batch crops,
+         *     each dst row computes its first coordinate, then walks by adding the fixed step.
+         * @note single affine_sample_run keeps per-pixel float coordinates, so its outputs are unchanged
+         */
+        static const int AFFINE_SHIFT = 20;
+        static const int64_t AFFINE_ONE = int64_t(1) << AFFINE_SHIFT;
+        static const int AFFINE_WEIGHT_SHIFT = 11;
+
+        static inline int64_t affine_fixed(double value) {
+            return int64_t(std::floor(value * AFFINE_ONE + 0.5));
+        }
+
+        /**
+         * blend 2x2 neighbors of pixel, each pixel has channels continuous values
+         * @param src0 top-left pixel
+         * @param src1 bottom-left pixel
+         * @param fx fraction of x in fixed point
+         * @param fy fraction of y in fixed point
+         */
+        template<typename T>
+        static inline void affine_linear_blend(const T *src0, const T *src1, int channels,
+                                               int32_t fx, int32_t fy, T *dst) {
+            double lf_weight_x = double(fx) / AFFINE_ONE;
+            double lf_weight_y = double(fy) / AFFINE_ONE;
+            double w00 = (1 - lf_weight_y) * (1 - lf_weight_x);
+            double w01 = (1 - lf_weight_y) * lf_weight_x;
+            double w10 = lf_weight_y * (1 - lf_weight_x);
+            double w11 = lf_weight_y * lf_weight_x;
+            for (int c = 0; c < channels; ++c) {
+                dst[c] = clamp<T, double>(w00 * src0[c] + w01 * src0[c + channels] +
+                                          w10 * src1[c] + w11 * src1[c + channels]);
+            }
+        }
+
+        template<>
+        inline void affine_linear_blend<uint8_t>(const uint8_t *src0, const uint8_t *src1, int channels,
+                                                 int32_t fx, int32_t fy, uint8_t *dst) {
+            // 11 bits weights, 255 * (1 << 22) still fits int32
+            const int32_t ONE = 1 << AFFINE_WEIGHT_SHIFT;
+            int32_t wx = fx >> (AFFINE_SHIFT - AFFINE_WEIGHT_SHIFT);
+            int32_t wy = fy >> (AFFINE_SHIFT - AFFINE_WEIGHT_SHIFT);
+            int32_t w00 = (ONE - wy) * (ONE - wx);
+            int32_t w01 = (ONE - wy) * wx;
+            int32_t w10 = wy * (ONE - wx);
+            int32_t w11 = wy * wx;
+            for (int c = 0; c < channels; ++c) {
+                dst[c] = uint8_t((w00 * src0[c] + w01 * src0[c + channels] +
+                                  w10 * src1[c] + w11 * src1[c + channels]) >> (2 * AFFINE_WEIGHT_SHIFT));
+            }
+        }
+
+        template<>
+        inline void affine_linear_blend<float>(const float *src0, const float *src1, int channels,
+                                               int32_t fx, int32_t fy, float *dst) {
+            float lf_weight_x = float(fx) / AFFINE_ONE;
+            float lf_weight_y = float(fy) / AFFINE_ONE;
+            float w00 = (1 - lf_weight_y) * (1 - lf_weight_x);
+            float w01 = (1 - lf_weight_y) * lf_weight_x;
+            float w10 = lf_weight_y * (1 - lf_weight_x);
+            float w11 = lf_weight_y * lf_weight_x;
+            int c = 0;
+            if (channels >= 4) {
+                float32x4 w00x4(w00), w01x4(w01), w10x4(w10), w11x4(w11);
+                for (; c + 3 < channels; c += 4) {
+                    float32x4 value = float32x4(src0 + c) * w00x4;
+                    value = fmadd(float32x4(src0 + c + channels), w01x4, value);
+                    value = fmadd(float32x4(src1 + c), w10x4, value);
+                    value = fmadd(float32x4(src1 + c + channels), w11x4, value);
+                    value.store(dst + c);
+                }
+            }
+            for (; c < channels; ++c) {
+                dst[c] = w00 * src0[c] + w01 * src0[c + channels] +
+                         w10 * src1[c] + w11 * src1[c + channels];
             }
         }
 
+        /**
+         * linear sample for non-projective affine, number of dst images done in one parallel loop
+         * @param src_step step between src images, 0 means all dst images sample from the same src
+         * @param affine number of 3x3 matrix if affine_step is 9, or just one if affine_step is 0
+         * @note src_height and src_width must be at least 2
+         */
+        template<typename T>
+        static void affine_sample2d_linear_fixed(const T *src, int64_t src_step, T *dst, int number,
+                                                 const float *affine, int affine_step,
+                                                 int src_height, int src_width,
+                                                 int dst_height, int dst_width, int channels,
+                                                 base::AffineOuterMode outer_mode, T outer_value) {
+            const int64_t dst_step = int64_t(dst_height) * dst_width * channels;
+            const int64_t src_row = int64_t(src_width) * channels;
+            const int64_t x_limit = int64_t(src_width - 1) << AFFINE_SHIFT;
+            const int64_t y_limit = int64_t(src_height - 1) << AFFINE_SHIFT;
+            const int tasks = number * dst_height;
+
+            parallel_for(0, tasks, [&](int task) {
+                int n = task / dst_height;
+                int n_y_d = task % dst_height;
+                const float *rz = affine + n * affine_step;
+                const T *src_im = src + n * src_step;
+                T *dst_pixel = dst + n * dst_step + int64_t(n_y_d) * dst_width * channels;
+
+                int64_t x = affine_fixed(double(rz[1]) * n_y_d + rz[2]);
+                int64_t y = affine_fixed(double(rz[4]) * n_y_d + rz[5]);
+                const int64_t dx = affine_fixed(rz[0]);
+                const int64_t dy = affine_fixed(rz[3]);
+
+                for (int n_x_d = 0; n_x_d < dst_width; ++n_x_d, x += dx, y += dy, dst_pixel += channels) {
+                    auto cx = x;
+                    auto cy = y;
+                    auto inner = x >= 0 && x < x_limit && y >= 0 && y < y_limit;
+                    if (!inner) {
+                        if (outer_mode == base::AffineOuterMode::VALUE) {
+                            std::fill(dst_pixel, dst_pixel + channels, outer_value);
+                            continue;
+                        }
+                        cx = std::max<int64_t>(0, std::min<int64_t>(x_limit - 1, cx));
+                        cy = std::max<int64_t>(0, std::min<int64_t>(y_limit - 1, cy));
+                    }
+                    auto n_x_s = int(cx >> AFFINE_SHIFT);
+                    auto n_y_s = int(cy >> AFFINE_SHIFT);
+                    auto src0 = src_im + n_y_s * src_row + n_x_s * channels;
+                    affine_linear_blend<T>(src0, src0 + src_row, channels,
+                                           int32_t(cx & (AFFINE_ONE - 1)), int32_t(cy & (AFFINE_ONE - 1)),
+                                           dst_pixel);
+                }
+            });
+        }
+
+        static bool affine_linear_fixed_supported(const float *affine, int number,
+                                                  Affine_Sample2DType type, int src_height, int src_width) {
+            if (type != Affine_Sample2DType::LINEAR) return false;
+            if (src_height < 2 || src_width < 2) return false;
+            for (int k = 0; k < number; ++k) {
+                auto rz = affine + 9 * k;
+                if (rz[6] != 0 || rz[7] != 0 || rz[8] != 1) return false;
+            }
+            return true;
+        }
 
         template<typename T>
         static void batch_affine_sample2d(int number, const Tensor *x, Tensor *y, int x_height, int x_width,
@@ -359,6 +472,37 @@ namespace ts {
             }
         }
 
+        static void affine_sample2d_linear_fixed_run(const Tensor &x, int64_t src_step, Tensor &out, int number,
+                                                     const float *affine, int affine_step,
+                                                     int src_height, int src_width,
+                                                     int dst_height, int dst_width, int channels,
+                                                     base::AffineOuterMode outer_mode, float outer_value) {
+            auto dtype = out.dtype();
+            switch (dtype) {
+#define DECLARE_COMPUTE_RUN(DTYPE, TYPE) \
+        case DTYPE: { affine_sample2d_linear_fixed<TYPE>( \
+                        x.data<TYPE>(), src_step, out.data<TYPE>(), number, affine, affine_step, \
+                        src_height, src_width, dst_height, dst_width, channels, \
+                        outer_mode, TYPE(outer_value)); break; }
+                DECLARE_COMPUTE_RUN(INT8, int8_t);
+                DECLARE_COMPUTE_RUN(UINT8, uint8_t);
+                DECLARE_COMPUTE_RUN(INT16, int16_t);
+                DECLARE_COMPUTE_RUN(UINT16, uint16_t);
+                DECLARE_COMPUTE_RUN(INT32, int32_t);
+                DECLARE_COMPUTE_RUN(UINT32, uint32_t);
+                DECLARE_COMPUTE_RUN(INT64, int64_t);
+                DECLARE_COMPUTE_RUN(UINT64, uint64_t);
+                DECLARE_COMPUTE_RUN(FLOAT32, float);
+                DECLARE_COMPUTE_RUN(FLOAT64, double);
+#undef DECLARE_COMPUTE_RUN
+                default: {
+                    TS_LOG_ERROR << name::layer::affine_sample2d() << " not support data type(" << dtype << "): "
+                                 << type_str(dtype) << eject;
+                    break;
+                }
+            }
+        }
+
         void Affine_Sample2D::affine_sample_run(const Tensor &x, float rz00, float rz01, float rz02, float rz10,
                                                 float rz11, float rz12, float rz20, float rz21, float rz22,
                                                 Affine_Sample2DType type, int dim,
@@ -420,6 +564,31 @@ namespace ts {
             }
 
         }
+        void Affine_Sample2D::affine_sample_batch_run(const Tensor &x, const float *affine, int number,
+                                                      Affine_Sample2DType type, int dim,
+                                                      base::AffineOuterMode outer_mode, float outer_value,
+                                                      Tensor &out) {
+            auto &input_shape = x.sizes();
+            int x_height = input_shape[dim];
+            int x_width = input_shape[dim + 1];
+            int y_height = out.size(1);
+            int y_width = out.size(2);
+
+            if (!affine_linear_fixed_supported(affine, number, type, x_height, x_width)) {
+                supper::affine_sample_batch_run(x, affine, number, type, dim, outer_mode, outer_value, out);
+                return;
+            }
+
+            int channels = 1;
+            for (size_t k = dim + 2; k < input_shape.size(); k++) {
+                channels *= input_shape[k];
+            }
+
+            // all crops sample from the same image, parallel on crops and rows together
+            affine_sample2d_linear_fixed_run(x, 0, out, number, affine, 9,
+                                             x_height, x_width, y_height, y_width, channels,
+                                             outer_mode, outer_value);
+        }
     }
 }
 
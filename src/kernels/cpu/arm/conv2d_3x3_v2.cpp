@@ -6,9 +6,7 @@
 #include "kernels/common/simd_def/simd_neon_def.h"
 #include "kernels/cpu/pad2d_algorithm.h"
 #include "kernels/common/function.h"
-#ifdef TS_USE_OPENMP
 #include "kernels/common/openmp.h"
-#endif
 
 #include <array>
 
@@ -76,10 +74,7 @@ namespace arm {
          for (int n = 0; n < num; ++n) {
              int out_channel_bound = out_channel >> 1;
              int remain_out_channel = out_channel_bound << 1;
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-             for (int m = 0; m < out_channel_bound; ++m) {
+             parallel_for(0, out_channel_bound, [&](int m) {
                  int mm = m * 2;
                  float *out_at = out_ptr + n * output_number_offset + mm * out_channel_offset;
                  float *out_ptr_0 = out_at;
@@ -267,11 +262,8 @@ namespace arm {
                          out_at_1 += out_width;out_at_1n += out_width;
                      } //h
                  } //c
-             } //m
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-             for (int m = remain_out_channel; m < out_channel; ++m) {
+             }); //m
+             parallel_for(remain_out_channel, out_channel, [&](int m) {
                    float *out_at = out_ptr + n * output_number_offset + m * out_channel_offset;
                    float *out_ptr_0 = out_at;
 
@@ -413,7 +405,7 @@ namespace arm {
                            out_at_0 += out_width;out_at_0n += out_width;
                        } //h
                    } //c
-              } //m
+              }); //m
          } //n
 
          if (out_padded_flag) {
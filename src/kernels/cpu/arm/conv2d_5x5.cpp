@@ -6,9 +6,7 @@
 #include "kernels/cpu/pad2d_algorithm.h"
 #include "kernels/common/simd.h"
 #include "kernels/common/function.h"
-#ifdef TS_USE_OPENMP
 #include "kernels/common/openmp.h"
-#endif
 
 #include <array>
 
@@ -77,10 +75,7 @@ namespace arm {
         for (int n = 0; n < num; ++n) {
             int out_channel_bound = out_channel >> 2;
             int remain_out_channel = out_channel_bound << 2;
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int m = 0; m < out_channel_bound; ++m) {
+            parallel_for(0, out_channel_bound, [&](int m) {
                 int mm = m * 4;
                 float *out_at = out_ptr + n * output_number_offset + mm * out_channel_offset;
                 float *out_ptr_0 = out_at;
@@ -173,11 +168,8 @@ namespace arm {
                         input_at_0 += 4;
                     } //h
                 } //c
-            } //m
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int m = remain_out_channel; m < out_channel; ++m) {
+            }); //m
+            parallel_for(remain_out_channel, out_channel, [&](int m) {
                 float *out_at = out_ptr + n * output_number_offset + m * out_channel_offset;
                 float *out_ptr_0 = out_at;
 
@@ -223,7 +215,7 @@ namespace arm {
                         input_at_0 += 4;
                     } //h
                 } //c
-            } //m
+            }); //m
         } //n
 
         if (out_padded_flag) {
@@ -291,10 +283,7 @@ namespace arm {
         for (int n = 0; n < num; ++n) {
             int out_channel_bound = out_channel >> 2;
             int remain_out_channel = out_channel_bound << 2;
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int m = 0; m < out_channel_bound; ++m) {
+            parallel_for(0, out_channel_bound, [&](int m) {
                 int mm = m * 4;
                 float *out_at = out_ptr + n * output_number_offset + mm * out_channel_offset;
                 float *out_ptr_0 = out_at;
@@ -390,11 +379,8 @@ namespace arm {
                         } //w
                     } //h
                 } //c
-            } //m
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int m = remain_out_channel; m < out_channel; ++m) {
+            }); //m
+            parallel_for(remain_out_channel, out_channel, [&](int m) {
                 float *out_at = out_ptr + n * output_number_offset + m * out_channel_offset;
                 float *out_ptr_0 = out_at;
 
@@ -441,7 +427,7 @@ namespace arm {
                         } //w
                     } //h
                 } //c
-            } //m
+            }); //m
         } //n
         if (out_padded_flag) {
             std::array<int, 2> pad_h = {0, src_output_shape[2] - out_height};
@@ -9,9 +9,7 @@
 #include <numeric>
 #include <kernels/cpu/operator_on_cpu.h>
 
-#ifdef TS_USE_OPENMP
 #include "kernels/common/openmp.h"
-#endif
 
 
 namespace ts {
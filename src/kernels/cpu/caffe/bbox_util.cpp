@@ -1790,7 +1790,7 @@ namespace ts {
                     continue;
                 }
                 int label = det_data[start_idx + 1];
-                        CHECK_NE(background_label_id, label)
+                        TS_CHECK_NQ(background_label_id, label)
                         << "Found background label in the detection results." << eject;
                 NormalizedBBox bbox;
                 bbox.set_score(det_data[start_idx + 2]);
@@ -1884,7 +1884,7 @@ namespace ts {
                       const float threshold, const int top_k, const bool reuse_overlaps,
                       map<int, map<int, float> > *overlaps, vector<int> *indices) {
             // Sanity check.
-                    CHECK_EQ(bboxes.size(), scores.size())
+                    TS_CHECK_EQ(bboxes.size(), scores.size())
                     << "bboxes and scores have different size." << eject;
 
             // Get top_k scores (with corresponding indices).
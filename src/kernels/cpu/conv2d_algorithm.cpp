@@ -1,8 +1,6 @@
 ﻿#include "kernels/cpu/conv2d_algorithm.h"
 
-#ifdef TS_USE_OPENMP
 #include "kernels/common/openmp.h"
-#endif
 
 #include "kernels/common/simd.h"
 
@@ -43,10 +41,7 @@ namespace ts {
             T* dst_data = dst.data<T>();
 
             for (int n = 0; n < num; n++) {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < channel; c++) {
+                parallel_for(0, channel, [&](int c) {
                     const T* src_at = src_data + n * src_num_offset + c * src_channel_offset;
                     T* dst_at = dst_data + n * dst_num_offset + c * dst_channel_offset;
 
@@ -66,7 +61,7 @@ namespace ts {
                         dst_at += out_w;
                         cut_at += src_w;
                     }
-                }
+                });
             }
         }
 
@@ -97,11 +92,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < channel; c++)
-                {
+                parallel_for(0, channel, [&](int c) {
                     const T* src_at = src_data + n * src_num_offset + c * src_channel_offset;
                     T* dst_at = dst_data + n * dst_num_offset + c * dst_channel_offset;
 
@@ -154,7 +145,7 @@ namespace ts {
                         }
                         dst_at += out_w;
                     }
-                }
+                });
             }
         }
 
@@ -522,11 +513,7 @@ namespace ts {
             T* dst_ptr = input_tm.data<T>();
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < input_channel; c++)
-                {
+                parallel_for(0, input_channel, [&](int c) {
                     const T* src_at = src_ptr + n * bordered_num_offset + c * bordered_c_offset;
                     T* dst_at = dst_ptr + n * tm_num_offset + c * tm_c_offset;
 
@@ -596,7 +583,7 @@ namespace ts {
 
                         }
                     }
-                }
+                });
 
             }
 
@@ -617,11 +604,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int cc = 0; cc < outch; cc++)
-                {
+                parallel_for(0, outch, [&](int cc) {
                     int c = cc * 4;
 
                     T* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
@@ -733,12 +716,8 @@ namespace ts {
                         }
 
                     }
-                }
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = remain_outch; c < output_channel; c++)
-                {
+                });
+                parallel_for(remain_outch, output_channel, [&](int c) {
                     T* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
 
                     const T* kernel_tm_ptr = k_tm.data<T>();
@@ -791,7 +770,7 @@ namespace ts {
                         }
 
                     }
-                }
+                });
             }
 
             //begin transform output
@@ -809,11 +788,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < output_channel; c++)
-                {
+                parallel_for(0, output_channel, [&](int c) {
                     T* output_tm_at = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
                     T* out_at = out_ptr + n * outbo_n_offset + c * outbo_c_offset;
 
@@ -867,7 +842,7 @@ namespace ts {
                             out_1 += 2;
                         }
                     }
-                }
+                });
             }
 
             inner_cut<T>(output_bordered, out, 0, output_h - out_shape[2], 0, output_w - out_shape[3]);
@@ -928,11 +903,7 @@ namespace ts {
             float* dst_ptr = input_tm.data<float>();
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < input_channel; c++)
-                {
+                parallel_for(0, input_channel, [&](int c) {
                     const float* src_at = src_ptr + n * bordered_num_offset + c * bordered_c_offset;
                     float* dst_at = dst_ptr + n * tm_num_offset + c * tm_c_offset;
 
@@ -982,7 +953,7 @@ namespace ts {
 
                         }
                     }
-                }
+                });
 
             }
 
@@ -1003,11 +974,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int cc = 0; cc < outch; cc++)
-                {
+                parallel_for(0, outch, [&](int cc) {
                     int c = cc * 4;
 
                     float* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
@@ -1183,12 +1150,8 @@ namespace ts {
                         sum30.store(out_3); sum31.store(out_3 + 4); sum32.store(out_3 + 8); sum33.store(out_3 + 12);
 
                     }
-                }
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = remain_outch; c < output_channel; c++)
-                {
+                });
+                parallel_for(remain_outch, output_channel, [&](int c) {
                     float* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
 
                     const float* kernel_tm_ptr = k_tm.data<float>();
@@ -1266,7 +1229,7 @@ namespace ts {
                         sum00.store(out_0); sum01.store(out_0 + 4); sum02.store(out_0 + 8); sum03.store(out_0 + 12);
 
                     }
-                }
+                });
             }
 
             //begin transform output
@@ -1284,11 +1247,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < output_channel; c++)
-                {
+                parallel_for(0, output_channel, [&](int c) {
                     float* output_tm_at = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
                     float* out_at = out_ptr + n * outbo_n_offset + c * outbo_c_offset;
 
@@ -1328,7 +1287,7 @@ namespace ts {
                             out_1 += 2;
                         }
                     }
-                }
+                });
             }
 
             inner_cut<float>(output_bordered, out, 0, output_h - out_shape[2], 0, output_w - out_shape[3]);
@@ -1390,11 +1349,7 @@ namespace ts {
             T* dst_ptr = input_tm.data<T>();
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < input_channel; c++)
-                {
+                parallel_for(0, input_channel, [&](int c) {
                     const T* src_at = src_ptr + n * bordered_num_offset + c * bordered_c_offset;
                     T* dst_at = dst_ptr + n * tm_num_offset + c * tm_c_offset;
 
@@ -1464,7 +1419,7 @@ namespace ts {
 
                         }
                     }
-                }
+                });
 
             }
 
@@ -1485,11 +1440,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int cc = 0; cc < outch; cc++)
-                {
+                parallel_for(0, outch, [&](int cc) {
                     int c = cc * 4;
 
                     T* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
@@ -1601,12 +1552,8 @@ namespace ts {
                         }
 
                     }
-                }
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = remain_outch; c < output_channel; c++)
-                {
+                });
+                parallel_for(remain_outch, output_channel, [&](int c) {
                     T* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
 
                     const T* kernel_tm_ptr = k_tm.data<T>();
@@ -1659,7 +1606,7 @@ namespace ts {
                         }
 
                     }
-                }
+                });
             }
 
             //begin transform output
@@ -1677,11 +1624,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < output_channel; c++)
-                {
+                parallel_for(0, output_channel, [&](int c) {
                     T* output_tm_at = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
                     T* out_at = out_ptr + n * outbo_n_offset + c * outbo_c_offset;
 
@@ -1735,7 +1678,7 @@ namespace ts {
                             out_1 += 2;
                         }
                     }
-                }
+                });
             }
 
             inner_cut<T>(output_bordered, out, 0, output_h - out_shape[2], 0, output_w - out_shape[3]);
@@ -2480,11 +2423,7 @@ namespace ts {
             T* dst_ptr = input_tm.data<T>();
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < input_channel; c++)
-                {
+                parallel_for(0, input_channel, [&](int c) {
                     const T* src_at = src_ptr + n * bordered_num_offset + c * bordered_c_offset;
                     T* dst_at = dst_ptr + n * tm_num_offset + c * tm_c_offset;
 
@@ -2569,7 +2508,7 @@ namespace ts {
                             }
                         }
                     }
-                }
+                });
 
             }
 
@@ -2590,11 +2529,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int cc = 0; cc < outch; cc++)
-                {
+                parallel_for(0, outch, [&](int cc) {
                     int c = cc * 4;
 
                     T* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
@@ -2706,12 +2641,8 @@ namespace ts {
                         }
 
                     }
-                }
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = remain_outch; c < output_channel; c++)
-                {
+                });
+                parallel_for(remain_outch, output_channel, [&](int c) {
                     T* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
 
                     const T* kernel_tm_ptr = k_tm.data<T>();
@@ -2764,7 +2695,7 @@ namespace ts {
                         }
 
                     }
-                }
+                });
             }
 
             //begin transform output
@@ -2795,11 +2726,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < output_channel; c++)
-                {
+                parallel_for(0, output_channel, [&](int c) {
                     T* output_tm_at = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
                     T* out_at = out_ptr + n * outbo_n_offset + c * outbo_c_offset;
 
@@ -2865,7 +2792,7 @@ namespace ts {
 
                         }
                     }
-                }
+                });
             }
 
             inner_cut<T>(output_bordered, out, 0, output_h - out_shape[2], 0, output_w - out_shape[3]);
@@ -2942,11 +2869,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < input_channel; c++)
-                {
+                parallel_for(0, input_channel, [&](int c) {
                     const float* src_at = src_ptr + n * bordered_num_offset + c * bordered_c_offset;
                     float* dst_at = dst_ptr + n * tm_num_offset + c * tm_c_offset;
 
@@ -3019,7 +2942,7 @@ namespace ts {
 
                         }
                     }
-                }
+                });
             }
 
             //begin dot
@@ -3040,11 +2963,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int cc = 0; cc < outch; cc++)
-                {
+                parallel_for(0, outch, [&](int cc) {
                     int c = cc * 4;
 
                     float* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
@@ -3220,12 +3139,8 @@ namespace ts {
                         sum34.store(out_3 + 32); sum35.store(out_3 + 40); sum36.store(out_3 + 48); sum37.store(out_3 + 56);
 
                     }
-                }
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = remain_outch; c < output_channel; c++)
-                {
+                });
+                parallel_for(remain_outch, output_channel, [&](int c) {
                     float* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
 
                     const float* kernel_tm_ptr = k_tm.data<float>();
@@ -3294,7 +3209,7 @@ namespace ts {
                         sum04.store(out_0 + 32); sum05.store(out_0 + 40); sum06.store(out_0 + 48); sum07.store(out_0 + 56);
 
                     }
-                }
+                });
             }
 
 
@@ -3326,11 +3241,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < output_channel; c++)
-                {
+                parallel_for(0, output_channel, [&](int c) {
                     float* output_tm_at = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
                     float* out_at = out_ptr + n * outbo_n_offset + c * outbo_c_offset;
 
@@ -3407,7 +3318,7 @@ namespace ts {
 
                         }
                     }
-                }
+                });
             }
 
             inner_cut<float>(output_bordered, out, 0, output_h - out_shape[2], 0, output_w - out_shape[3]);
@@ -3477,11 +3388,7 @@ namespace ts {
             T* dst_ptr = input_tm.data<T>();
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < input_channel; c++)
-                {
+                parallel_for(0, input_channel, [&](int c) {
                     const T* src_at = src_ptr + n * bordered_num_offset + c * bordered_c_offset;
                     T* dst_at = dst_ptr + n * tm_num_offset + c * tm_c_offset;
 
@@ -3566,7 +3473,7 @@ namespace ts {
                             }
                         }
                     }
-                }
+                });
 
             }
 
@@ -3587,11 +3494,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int cc = 0; cc < outch; cc++)
-                {
+                parallel_for(0, outch, [&](int cc) {
                     int c = cc * 4;
 
                     T* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
@@ -3703,12 +3606,8 @@ namespace ts {
                         }
 
                     }
-                }
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = remain_outch; c < output_channel; c++)
-                {
+                });
+                parallel_for(remain_outch, output_channel, [&](int c) {
                     T* out_tm_0 = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
 
                     const T* kernel_tm_ptr = k_tm.data<T>();
@@ -3761,7 +3660,7 @@ namespace ts {
                         }
 
                     }
-                }
+                });
             }
 
             //begin transform output
@@ -3792,11 +3691,7 @@ namespace ts {
 
             for (int n = 0; n < num; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < output_channel; c++)
-                {
+                parallel_for(0, output_channel, [&](int c) {
                     T* output_tm_at = out_tm_ptr + n * outtm_n_offset + c * outtm_c_offset;
                     T* out_at = out_ptr + n * outbo_n_offset + c * outbo_c_offset;
 
@@ -3862,7 +3757,7 @@ namespace ts {
 
                         }
                     }
-                }
+                });
             }
 
             inner_cut<T>(output_bordered, out, 0, output_h - out_shape[2], 0, output_w - out_shape[3]);
@@ -4812,11 +4707,7 @@ namespace ts {
 
             for (int n = 0; n < number; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int outc_index = 0; outc_index < out_channel; outc_index++)
-                {
+                parallel_for(0, out_channel, [&](int outc_index) {
                     T* out_at = poutput + n*out_num_offset + outc_index * out_channel_offset;
 
                     for (int inc_index = 0; inc_index < input_channel; inc_index++)
@@ -4915,7 +4806,7 @@ namespace ts {
                             r_2 += 2;
                         }
                     }
-                }
+                });
             }
         }
 
@@ -4945,11 +4836,7 @@ namespace ts {
 
             for (int n = 0; n < number; n++)
             {
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int outc_index = 0; outc_index < out_channel; outc_index++)
-                {
+                parallel_for(0, out_channel, [&](int outc_index) {
                     float* out_at = poutput + n*out_num_offset + outc_index * out_channel_offset;
 
                     for (int inc_index = 0; inc_index < input_channel; inc_index++)
@@ -5051,7 +4938,7 @@ namespace ts {
                             r_2 += 2;
                         }
                     }
-                }
+                });
             }
         }
 
@@ -5083,11 +4970,7 @@ namespace ts {
             {
                 int for_out_channel = out_channel >> 2;
                 int remain_out_channel = for_out_channel << 2;
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int outc_index = 0; outc_index < for_out_channel; outc_index++)
-                {
+                parallel_for(0, for_out_channel, [&](int outc_index) {
                     int p = outc_index * 4;
                     T *out_at = poutput + n * out_num_offset + p * out_channel_offset;
                     T *out_ptr_0 = out_at;
@@ -5322,12 +5205,8 @@ namespace ts {
                         k_2 += 9;
                         k_3 += 9;
                     }
-                }
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int p = remain_out_channel; p < out_channel; p++)
-                {
+                });
+                parallel_for(remain_out_channel, out_channel, [&](int p) {
                     T *out_at = poutput + n * out_num_offset + p * out_channel_offset;
 
                     const T* kernel_cur = pweight + p * input_channel * 9;
@@ -5428,7 +5307,7 @@ namespace ts {
 
                         kernel_cur += 9;
                     }
-                }
+                });
             }
         }
 
@@ -5460,11 +5339,7 @@ namespace ts {
             {
                 int for_out_channel = out_channel >> 2;
                 int remain_out_channel = for_out_channel << 2;
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int outc_index = 0; outc_index < for_out_channel; outc_index++)
-                {
+                parallel_for(0, for_out_channel, [&](int outc_index) {
                     int p = outc_index * 4;
                     float *out_at = poutput + n * out_num_offset + p * out_channel_offset;
                     float *out_ptr_0 = out_at;
@@ -5656,12 +5531,8 @@ namespace ts {
                         k_2 += 9;
                         k_3 += 9;
                     }
-                }
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int p = remain_out_channel; p < out_channel; p++)
-                {
+                });
+                parallel_for(remain_out_channel, out_channel, [&](int p) {
                     float *out_at = poutput + n * out_num_offset + p * out_channel_offset;
 
                     const float* kernel_cur = pweight + p * input_channel * 9;
@@ -5764,7 +5635,7 @@ namespace ts {
 
                         kernel_cur += 9;
                     }
-                }
+                });
             }
         }
 
@@ -5782,10 +5653,7 @@ namespace ts {
             int out_loop = kernel_num >> 2;
             int remain = out_loop << 2;
 
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int nn = 0; nn < out_loop; nn++){
+            parallel_for(0, out_loop, [&](int nn) {
                 int n = nn * 4;
 
                 const T* k0 = pkernel + n * num_offset;
@@ -5801,18 +5669,15 @@ namespace ts {
                     *kernel_packed_at++ = *k2++;
                     *kernel_packed_at++ = *k3++;
                 }
-            }
+            });
 
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int n = remain; n < kernel_num; n++){
+            parallel_for(remain, kernel_num, [&](int n) {
                 const T* k0 = pkernel + n * num_offset;
                 T* kernel_packed_at = pkernel_packed + n * num_offset;
                 for (int i = 0; i < num_offset; i++) {
                     *kernel_packed_at++ = *k0++;
                 }
-            }
+            });
         }
 
         template<typename T>
@@ -5823,10 +5688,7 @@ namespace ts {
             int out_loop = col_w >> 2;
             int remain = out_loop << 2;
 
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int nn = 0; nn < out_loop; nn++){
+            parallel_for(0, out_loop, [&](int nn) {
                 int n = nn * 4;
                 const T* col_at = pcol + n;
                 T* packed_at = pcol_packed + n * col_h;
@@ -5839,11 +5701,8 @@ namespace ts {
 
                     col_at += col_w;
                 }
-            }
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int n = remain; n < col_w; n++){
+            });
+            parallel_for(remain, col_w, [&](int n) {
                 const T* col_at = pcol + n;
                 T* packed_at = pcol_packed + n * col_h;
 
@@ -5851,7 +5710,7 @@ namespace ts {
                     *packed_at++ = col_at[0];
                     col_at += col_w;
                 }
-            }
+            });
         }
 
         template<>
@@ -5862,10 +5721,7 @@ namespace ts {
             int out_loop = col_w >> 2;
             int remain = out_loop << 2;
 
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int nn = 0; nn < out_loop; nn++) {
+            parallel_for(0, out_loop, [&](int nn) {
                 int n = nn * 4;
                 const float* col_at = pcol + n;
                 float* packed_at = pcol_packed + n * col_h;
@@ -5877,11 +5733,8 @@ namespace ts {
                     col_at += col_w;
                     packed_at += 4;
                 }
-            }
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int n = remain; n < col_w; n++) {
+            });
+            parallel_for(remain, col_w, [&](int n) {
                 const float* col_at = pcol + n;
                 float* packed_at = pcol_packed + n * col_h;
 
@@ -5889,7 +5742,7 @@ namespace ts {
                     *packed_at++ = col_at[0];
                     col_at += col_w;
                 }
-            }
+            });
         }
 
         template<typename T>
@@ -5909,10 +5762,7 @@ namespace ts {
             int out_loop = M >> 2;
             int remain = out_loop << 2;
             float* output_at = pout;
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int mm = 0; mm < out_loop; mm++){
+            parallel_for(0, out_loop, [&](int mm) {
                 int m = mm * 4;
                 float* output_row0 = output_at + m * out_channel_offset;
                 float* output_row1 = output_row0 + out_channel_offset;
@@ -6062,12 +5912,9 @@ namespace ts {
                     *output_row2++ = *(((float*)&sum_col.value) + 2);
                     *output_row3++ = *(((float*)&sum_col.value) + 3);
                 }
-            }
+            });
 
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int m = remain; m < M; m++){
+            parallel_for(remain, M, [&](int m) {
                 float* output_row0 = output_at + m * out_channel_offset;
                 const float* kernel_store = pkernel_packed + m * kernel_num_offset;
 
@@ -6147,7 +5994,7 @@ namespace ts {
                     *output_row0 = sum0;
                     output_row0++;
                 }
-            }
+            });
         }
 
         template<typename T>
@@ -6164,10 +6011,7 @@ namespace ts {
             int out_loop = shape[0] >> 3;
             int remain = out_loop << 3;
 
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int nn = 0; nn < out_loop; nn++){
+            parallel_for(0, out_loop, [&](int nn) {
                 int n = nn * 8;
                 const T* k0 = pkernel + n * num_offset;
                 const T* k1 = k0 + num_offset;
@@ -6190,18 +6034,15 @@ namespace ts {
                     *kernel_packed_at++ = *k6++;
                     *kernel_packed_at++ = *k7++;
                 }
-            }
+            });
             //NOTE:Maybe i should pack 4x4 on remain size
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int n = remain; n < kernel_num; n++){
+            parallel_for(remain, kernel_num, [&](int n) {
                 const T* k0 = pkernel + n * num_offset;
                 T* kernel_packed_at = pkernel_packed + n * num_offset;
                 for (int i = 0; i < num_offset; i++) {
                     *kernel_packed_at++ = *k0++;
                 }
-            }
+            });
         }
 
         template<typename T>
@@ -6212,10 +6053,7 @@ namespace ts {
             int out_loop = col_w >> 3;
             int remain = out_loop << 3;
 
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int nn = 0; nn < out_loop; nn++) {
+            parallel_for(0, out_loop, [&](int nn) {
                 int n = nn * 8;
                 const T* col_at = pcol + n;
                 T* packed_at = pcol_packed + n * col_h;
@@ -6232,11 +6070,8 @@ namespace ts {
 
                     col_at += col_w;
                 }
-            }
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int n = remain; n < col_w; n++){
+            });
+            parallel_for(remain, col_w, [&](int n) {
                 const T* col_at = pcol + n;
                 T* packed_at = pcol_packed + n * col_h;
 
@@ -6244,7 +6079,7 @@ namespace ts {
                     *packed_at++ = col_at[0];
                     col_at += col_w;
                 }
-            }
+            });
         }
 
         template<>
@@ -6255,10 +6090,7 @@ namespace ts {
             int out_loop = col_w >> 3;
             int remain = out_loop << 3;
 
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int nn = 0; nn < out_loop; nn++) {
+            parallel_for(0, out_loop, [&](int nn) {
                 int n = nn * 8;
                 const float* col_at = pcol + n;
                 float* packed_at = pcol_packed + n * col_h;
@@ -6269,11 +6101,8 @@ namespace ts {
                     col_at += col_w;
                     packed_at += 8;
                 }
-            }
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int n = remain; n < col_w; n++) {
+            });
+            parallel_for(remain, col_w, [&](int n) {
                 const float* col_at = pcol + n;
                 float* packed_at = pcol_packed + n * col_h;
 
@@ -6281,7 +6110,7 @@ namespace ts {
                     *packed_at++ = col_at[0];
                     col_at += col_w;
                 }
-            }
+            });
         }
 
         template<typename T>
@@ -6304,10 +6133,7 @@ namespace ts {
             int out_loop = M >> 3;
             int remain = out_loop << 3;
             float* output_at = pout;
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int mm = 0; mm < out_loop; mm++){
+            parallel_for(0, out_loop, [&](int mm) {
                 int m = mm * 8;
                 float* output_row0 = output_at + m * out_channel_offset;
                 float* output_row1 = output_row0 + out_channel_offset;
@@ -6522,12 +6348,9 @@ namespace ts {
                     *output_row6++ = *(((float*)&sum_col.value) + 6);
                     *output_row7++ = *(((float*)&sum_col.value) + 7);
                 }
-            }
+            });
 
-#ifdef TS_USE_OPENMP
-            #pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int m = remain; m < M; m++){
+            parallel_for(remain, M, [&](int m) {
                 float* output_row0 = output_at + m * out_channel_offset;
                 const float* kernel_store = pkernel_packed + m * kernel_num_offset;
 
@@ -6609,7 +6432,7 @@ namespace ts {
                     *output_row0 = sum0;
                     output_row0++;
                 }
-            }
+            });
         }
     }
 }
@@ -10,9 +10,142 @@
 #include <kernels/cblas/math_cblas.h>
 #endif
 #include "kernels/cpu/conv2d_algorithm.h"
+#include "memory/budget.h"
+
+#include <algorithm>
 
 namespace ts {
     namespace cpu {
+        /**
+         * im2col on tiles of output rows, so workspace is limited by tile_rows, used when memory budget not enough.
+         * Input rows of tile, including top and bottom padding, are copied into slab first.
+         */
+        template<typename T>
+        static void cpu_conv2d_nchw_tiled_run(const Tensor &x, const Padding2D &padding, float padding_value,
+                                              const Tensor &w, const Stride2D &stride, const Dilation2D &dilation,
+                                              Tensor &out, Stack &stack, bool kernel_packed, int tile_rows) {
+            auto weight_shape = w.sizes();
+            auto output_shape = out.sizes();
+            auto x_shape = x.sizes();
+            int kernel_dims = weight_shape[1] * weight_shape[2] * weight_shape[3];
+            int conv_out_spatial_dim = output_shape[2] * output_shape[3];
+            int output_number_offset = output_shape[1] * conv_out_spatial_dim;
+            int input_number_offset = x_shape[1] * x_shape[2] * x_shape[3];
+
+            auto number = x_shape[0];
+            auto input_channels = x_shape[1];
+            auto out_channels = output_shape[1];
+            auto out_height = output_shape[2];
+            auto out_width = output_shape[3];
+            Size2D ksize(weight_shape[2], weight_shape[3]);
+            Size2D input(x_shape[2], x_shape[3]);
+
+            int extent = dilation.height * (ksize.height - 1) + 1;
+            int slab_height = (tile_rows - 1) * stride.height + extent;
+
+            auto slab_tensor = stack.make(out.dtype(), {input_channels * slab_height * input.width}, MemoryDevice(CPU));
+            auto col_tensor = stack.make(out.dtype(), {kernel_dims * tile_rows * out_width}, MemoryDevice(CPU));
+            auto tile_tensor = stack.make(out.dtype(), {out_channels * tile_rows * out_width}, MemoryDevice(CPU));
+            T *slab = slab_tensor.data<T>();
+            T *col_buffer = col_tensor.data<T>();
+            T *tile = tile_tensor.data<T>();
+#ifndef TS_USE_CBLAS
+            auto packed_col = stack.make(out.dtype(), col_tensor.sizes(), MemoryDevice(CPU));
+            Tensor packed_tensor;
+            if (!kernel_packed) {
+                packed_tensor = stack.make(w.dtype(), w.sizes(), MemoryDevice(CPU));
+            }
+            // kernel packed once, then reused by all tiles
+            bool kernel_need_pack = !kernel_packed;
+            const T *pweight = kernel_packed ? w.data<T>() : packed_tensor.data<T>();
+#endif
+
+            const T *pinput = x.data<T>();
+            T *poutput = out.data<T>();
+
+            for (int i = 0; i < number; i++) {
+                for (int top = 0; top < out_height; top += tile_rows) {
+                    int rows = std::min(tile_rows, out_height - top);
+                    int input_top = top * stride.height - padding.top;
+                    int input_rows = (rows - 1) * stride.height + extent;
+
+                    for (int c = 0; c < input_channels; ++c) {
+                        auto src = pinput + c * input.height * input.width;
+                        auto dst = slab + c * input_rows * input.width;
+                        for (int r = 0; r < input_rows; ++r) {
+                            auto y = input_top + r;
+                            if (y >= 0 && y < input.height) {
+                                std::memcpy(dst + r * input.width, src + y * input.width, input.width * sizeof(T));
+                            } else {
+                                std::fill(dst + r * input.width, dst + (r + 1) * input.width, T(padding_value));
+                            }
+                        }
+                    }
+
+                    int tile_spatial_dim = rows * out_width;
+                    ::memset(col_buffer, 0, kernel_dims * tile_spatial_dim * sizeof(T));
+                    im2col_cpu(slab, input_channels, input_rows, input.width,
+                               ksize.height, ksize.width,
+                               0, 0,
+                               padding.left, padding.right,
+                               stride.height, stride.width,
+                               dilation.height, dilation.width,
+                               col_buffer, T(padding_value));
+
+#ifdef TS_USE_CBLAS
+                    cblas::math<T>::gemm(ts::blas::NoTrans, ts::blas::NoTrans, out_channels, tile_spatial_dim,
+                                         kernel_dims, 1.0, w.data<T>(), col_buffer, 0, tile);
+#else
+                    cpu::math<T, T>::gemm(out_channels, tile_spatial_dim, kernel_dims, (T)1,
+                                          kernel_need_pack ? w.data<T>() : pweight, packed_tensor.data<T>(),
+                                          col_buffer, packed_col.data<T>(), T(0), tile, kernel_need_pack, true);
+                    kernel_need_pack = false;
+#endif
+
+                    for (int k = 0; k < out_channels; ++k) {
+                        std::memcpy(poutput + k * conv_out_spatial_dim + top * out_width,
+                                    tile + k * tile_spatial_dim, tile_spatial_dim * sizeof(T));
+                    }
+                }
+
+                pinput += input_number_offset;
+                poutput += output_number_offset;
+            }
+        }
+
+        /**
+         * @return rows of output in each tile, 0 if whole im2col workspace fits in memory budget
+         */
+        template<typename T>
+        static int cpu_conv2d_tile_rows(const Tensor &x, const Tensor &w, const Stride2D &stride,
+                                        const Dilation2D &dilation, const Tensor &out) {
+            auto budget = MemoryBudget::Running();
+            if (!budget || !budget->limited()) return 0;
+
+            auto weight_shape = w.sizes();
+            auto output_shape = out.sizes();
+            auto x_shape = x.sizes();
+#ifdef TS_USE_CBLAS
+            uint64_t col_copies = 1;
+#else
+            uint64_t col_copies = 2;    // col and packed col
+#endif
+            uint64_t col_row = uint64_t(x_shape[1]) * weight_shape[2] * weight_shape[3] * output_shape[3] * sizeof(T);
+            uint64_t workspace = col_row * output_shape[2] * col_copies;
+            auto available = budget->available();
+            if (workspace <= available) return 0;
+
+            // half of available memory left for outputs and kernels
+            uint64_t input_row = uint64_t(x_shape[1]) * x_shape[3] * sizeof(T);
+            uint64_t fixed = input_row * (dilation.height * (weight_shape[2] - 1) + 1);
+            uint64_t each_row = col_row * col_copies + input_row * stride.height +
+                                uint64_t(weight_shape[0]) * output_shape[3] * sizeof(T);
+            uint64_t usable = available / 2 > fixed ? available / 2 - fixed : 0;
+            auto tile_rows = std::max<uint64_t>(1, usable / each_row);
+            tile_rows = std::min<uint64_t>(tile_rows, uint64_t(output_shape[2]));
+            budget->degrade();
+            return int(tile_rows);
+        }
 
         template<typename T>
         static void cpu_conv2d_nchw_compute_run(const Tensor &x, const Padding2D &padding, float padding_value,
@@ -45,6 +178,16 @@ namespace ts {
                                padding.top == 0 && padding.bottom == 0 &&
                                padding.left == 0 && padding.right == 0;
 
+            // im2col on tiles of output rows, if memory budget not enough
+            if (!is_1x1_conv) {
+                auto tile_rows = cpu_conv2d_tile_rows<T>(x, w, stride, dilation, out);
+                if (tile_rows > 0) {
+                    cpu_conv2d_nchw_tiled_run<T>(x, padding, padding_value, w, stride, dilation,
+                                                 out, stack, kernel_packed, tile_rows);
+                    return;
+                }
+            }
+
             // 1x1 conv do not need im2col
             if (!is_1x1_conv) {
                 Shape col_shape;
@@ -55,11 +198,21 @@ namespace ts {
                 col_buffer = col_tensor.data<T>();
             }
 
+#ifndef TS_USE_CBLAS
+            // workspace of gemm, reused by all samples
+            if (is_1x1_conv) packed_shape = {input_number_offset};
+            packed_col = stack.make(x.dtype(), packed_shape, MemoryDevice(CPU));
+            Tensor packed_tensor;
+            auto kernel_need_pack = !kernel_packed;
+            if (kernel_need_pack) {
+                packed_tensor = stack.make(w.dtype(), w.sizes(), MemoryDevice(CPU));
+            }
+#endif
+
             for (int i = 0; i < number; i++) {
                 if (is_1x1_conv) {
                     //std::memcpy(col_buffer,pinput,sizeof(T)*col_buffer_size);
                     col_buffer = const_cast<T *>(pinput);
-                    packed_shape = x_shape;
                 } else {
                     ::memset(col_buffer, 0, col_buffer_size * sizeof(T));
                     im2col_cpu(pinput, input_channels, input.height, input.width,
@@ -76,12 +229,6 @@ namespace ts {
                 cblas::math<T>::gemm(ts::blas::NoTrans, ts::blas::NoTrans, weight_shape[0], conv_out_spatial_dim,
                                      kernel_dims, 1.0, pweight, col_buffer, 0, poutput);
 #else
-                packed_col = stack.make(x.dtype(), packed_shape, MemoryDevice(CPU));
-                Tensor packed_tensor;
-                auto kernel_need_pack = !kernel_packed;
-                if (kernel_need_pack) {
-                    packed_tensor = stack.make(w.dtype(), w.sizes(), MemoryDevice(CPU));
-                }
                 cpu::math<T, T>::gemm(weight_shape[0], conv_out_spatial_dim, kernel_dims, (T)1, w.data<T>(), packed_tensor.data<T>(),
                                       col_buffer, packed_col.data<T>(), T(0), poutput, kernel_need_pack, true);
 
@@ -6,13 +6,14 @@
 #define TENSORSTACK_KERNELS_CPU_DCN_DCN_V2_H
 
 #include "core/tensor.h"
+#include "utils/api.h"
 
 /**
  * @see [DCNv2](https://github.com/CharlesShang/DCNv2)
  */
 
 namespace ts {
-    Tensor dcn_v2_cpu_forward(const Tensor &input,
+    TS_DEBUG_API Tensor dcn_v2_cpu_forward(const Tensor &input,
                    const Tensor &weight,
                    const Tensor &bias,
                    const Tensor &offset,
@@ -1,4 +1,3 @@
-
 #include "dcn_v2.h"
 #include "dcn_v2_im2col_cpu.h"
 
@@ -6,31 +5,25 @@
 #include "core/device_context.h"
 
 #include "utils/ctxmgr_lite.h"
+#include "kernels/common/openmp.h"
+
+#include <vector>
 
 using scalar_t = float;
 
 namespace ts {
-    static void createBatchGemmBuffer(const float **input_b, float **output_b,
-                               const float **columns_b, const float **ones_b,
-                               const float **weight_b, const float **bias_b,
-                               const float *input, float *output,
-                               const float *columns, const float *ones,
-                               const float *weight, const float *bias,
-                               const int input_stride, const int output_stride,
-                               const int columns_stride, const int ones_stride,
-                               const int num_batches) {
-        // const int idx = blockIdx.x * blockDim.x + threadIdx.x;
-        int idx = 0;
-        while (idx < num_batches) {
-            input_b[idx] = input + idx * input_stride;
-            output_b[idx] = output + idx * output_stride;
-            columns_b[idx] = columns + idx * columns_stride;
-            ones_b[idx] = ones + idx * ones_stride;
-            // share weights and bias within a Mini-Batch
-            weight_b[idx] = weight;
-            bias_b[idx] = bias;
-            ++idx;
-        }
+    /**
+     * columns of each tile, make sampled columns [kernel_dims, tile] stay in L2 cache,
+     *     and leave at least one tile for each thread.
+     */
+    static int dcn_tile_size(int kernel_dims, int spatial, int batch, int threads) {
+        static const int TILE_BUFFER = 64 * 1024;   // floats
+        int tile = std::max(16, TILE_BUFFER / std::max(kernel_dims, 1));
+        int balanced = (int64_t(spatial) * batch + threads - 1) / threads;
+        balanced = (balanced + 7) / 8 * 8;
+        tile = std::min(tile, std::max(16, balanced));
+        tile = (tile + 7) / 8 * 8;
+        return std::min(tile, spatial);
     }
 
     Tensor
@@ -62,24 +55,17 @@ namespace ts {
         const int kernel_h_ = weight.size(2);
         const int kernel_w_ = weight.size(3);
 
-        // printf("Kernels: %d %d %d %d\n", kernel_h_, kernel_w_, kernel_w, kernel_h);
-        // printf("Channels: %d %d\n", channels, channels_kernel);
-        // printf("Channels: %d %d\n", channels_out, channels_kernel);
-
-        TS_AUTO_CHECK(kernel_h_ == kernel_h && kernel_w_ == kernel_w)
+        TS_CHECK(kernel_h_ == kernel_h && kernel_w_ == kernel_w)
                 ("Input shape and kernel shape wont match: (")
-                (kernel_h_)(" x ")(kernel_w)(" vs. ")(kernel_h_)(" x ")(kernel_w_)(").");
+                (kernel_h_)(" x ")(kernel_w)(" vs. ")(kernel_h_)(" x ")(kernel_w_)(").") << eject;
 
-        TS_AUTO_CHECK(channels == channels_kernel)
+        TS_CHECK(channels == channels_kernel)
                 ("Input shape and kernel channels wont match: (")
-                (channels)(" vs. ")(channels_kernel)(").");
+                (channels)(" vs. ")(channels_kernel)(").") << eject;
 
         const int height_out = (height + 2 * pad_h - (dilation_h * (kernel_h - 1) + 1)) / stride_h + 1;
         const int width_out = (width + 2 * pad_w - (dilation_w * (kernel_w - 1) + 1)) / stride_w + 1;
 
-        auto ones = dcn::cpu::ones(input.dtype(), {batch, height_out, width_out});
-        auto columns = dcn::cpu::empty(input.dtype(),
-                                       {batch, channels * kernel_h * kernel_w, 1 * height_out * width_out});
         Tensor output;
         if (buffer_output != nullptr) {
             output = *buffer_output;
@@ -91,72 +77,79 @@ namespace ts {
             output = dcn::cpu::empty(input.dtype(), {batch, channels_out, height_out, width_out});
         }
 
-        // prepare for batch-wise computing, which is significantly faster than instance-wise computing
-        // when batch size is large.
-        // launch batch threads
-        int matrices_size = batch * sizeof(float *);
-        std::vector<SyncMemory> bufer_b(6);
-        auto input_b = static_cast<const float **>(dcn::cpu::CPUMalloc(input.device(), matrices_size, bufer_b[0]));
-        auto output_b = static_cast<float **>(dcn::cpu::CPUMalloc(input.device(), matrices_size, bufer_b[1]));
-        auto columns_b = static_cast<const float **>(dcn::cpu::CPUMalloc(input.device(), matrices_size, bufer_b[2]));
-        auto ones_b = static_cast<const float **>(dcn::cpu::CPUMalloc(input.device(), matrices_size, bufer_b[3]));
-        auto weight_b = static_cast<const float **>(dcn::cpu::CPUMalloc(input.device(), matrices_size, bufer_b[4]));
-        auto bias_b = static_cast<const float **>(dcn::cpu::CPUMalloc(input.device(), matrices_size, bufer_b[5]));
-
-        createBatchGemmBuffer(
-                input_b, output_b,
-                columns_b, ones_b,
-                weight_b, bias_b,
-                input.data<scalar_t>(),
-                output.data<scalar_t>(),
-                columns.data<scalar_t>(),
-                ones.data<scalar_t>(),
-                weight.data<scalar_t>(),
-                bias.data<scalar_t>(),
-                channels * width * height,
-                channels_out * width_out * height_out,
-                channels * kernel_h * kernel_w * height_out * width_out,
-                height_out * width_out,
-                batch);
-
-        long m_ = channels_out;
-        long n_ = height_out * width_out;
-        long k_ = 1;
-        dcn::cpu::CBlas_SgemmBatched('t',
-                                     'n',
-                                     n_,
-                                     m_,
-                                     k_,
-                                     1.0f,
-                                     ones_b, k_,
-                                     bias_b, k_,
-                                     0.0f,
-                                     output_b, n_,
-                                     batch);
-
-        modulated_deformable_im2col_cpu(input.data<scalar_t>(),
-                                        offset.data<scalar_t>(),
-                                        mask.data<scalar_t>(),
-                                        batch, channels, height, width,
-                                        height_out, width_out, kernel_h, kernel_w,
-                                        pad_h, pad_w, stride_h, stride_w, dilation_h, dilation_w,
-                                        deformable_group,
-                                        columns.data<scalar_t>());
-
-        long m = channels_out;
-        long n = height_out * width_out;
-        long k = channels * kernel_h * kernel_w;
-        dcn::cpu::CBlas_SgemmBatched('n',
-                                     'n',
-                                     n,
-                                     m,
-                                     k,
-                                     1.0f,
-                                     (const float **) columns_b, n,
-                                     weight_b, k,
-                                     1.0f,
-                                     output_b, n,
-                                     batch);
+        const int m = channels_out;
+        const int k = channels * kernel_h * kernel_w;
+        const int spatial = height_out * width_out;
+
+        const int threads = openmp_threads();
+        const int tile = dcn_tile_size(k, spatial, batch, threads);
+        const int tiles = (spatial + tile - 1) / tile;
+        const int tasks = batch * tiles;
+
+        const scalar_t *input_data = input.data<scalar_t>();
+        const scalar_t *offset_data = offset.data<scalar_t>();
+        const scalar_t *mask_data = mask.data<scalar_t>();
+        const scalar_t *weight_data = weight.data<scalar_t>();
+        const scalar_t *bias_data = bias.data<scalar_t>();
+        scalar_t *output_data = output.data<scalar_t>();
+
+        const int input_step = channels * height * width;
+        const int offset_step = deformable_group * 2 * kernel_h * kernel_w * spatial;
+        const int mask_step = deformable_group * kernel_h * kernel_w * spatial;
+        const int output_step = channels_out * spatial;
+
+#ifndef TS_USE_CBLAS
+        // weight packed once, shared by all tiles
+        std::vector<scalar_t> weight_packed(size_t(m) * k);
+        ts::cpu::math<scalar_t, scalar_t>::pack8_A(m, k, weight_data, k, weight_packed.data());
+        const scalar_t *weight_packed_data = weight_packed.data();
+#endif
+
+        // each tile: sample columns [k, tile] with offset and mask, then [m, k] x [k, tile] into output
+        parallel_run([&](int, int task_begin, int task_end) {
+            std::vector<scalar_t> columns(size_t(k) * tile);
+            std::vector<scalar_t> columns_packed(size_t(k) * tile);
+            std::vector<scalar_t> product(size_t(m) * tile);
+            std::vector<int> plan_index(4 * tile);
+            std::vector<scalar_t> plan_weight(4 * tile);
+
+            for (int task = task_begin; task < task_end; ++task) {
+                const int b = task / tiles;
+                const int tile_begin = (task % tiles) * tile;
+                const int tile_size = std::min(tile, spatial - tile_begin);
+
+                modulated_deformable_im2col_tile_cpu(input_data + b * input_step,
+                                                     offset_data + b * offset_step,
+                                                     mask_data + b * mask_step,
+                                                     channels, height, width,
+                                                     height_out, width_out, kernel_h, kernel_w,
+                                                     pad_h, pad_w, stride_h, stride_w, dilation_h, dilation_w,
+                                                     deformable_group,
+                                                     tile_begin, tile_size,
+                                                     plan_index.data(), plan_weight.data(), columns.data());
+
+#ifdef TS_USE_CBLAS
+                cblas::math<scalar_t>::gemm(blas::NoTrans, blas::NoTrans, m, tile_size, k,
+                                            1.0f, weight_data, columns.data(), 0.0f, product.data());
+#else
+                ts::cpu::math<scalar_t, scalar_t>::gemm(m, tile_size, k, 1.0f,
+                                                        weight_packed_data, nullptr,
+                                                        columns.data(), columns_packed.data(),
+                                                        0.0f, product.data(), false, true);
+#endif
+
+                scalar_t *output_at = output_data + b * output_step + tile_begin;
+                for (int i = 0; i < m; ++i) {
+                    const scalar_t *product_at = product.data() + i * tile_size;
+                    scalar_t *output_row = output_at + i * spatial;
+                    const scalar_t bias_value = bias_data[i];
+                    for (int j = 0; j < tile_size; ++j) {
+                        output_row[j] = product_at[j] + bias_value;
+                    }
+                }
+            }
+        }, 0, tasks);
+
         return output;
     }
-}
\ No newline at end of file
+}
@@ -8,9 +8,6 @@
 
 #include <kernels/common/openmp.h>
 
-#define CPU_KERNEL_LOOP(i, n)                          \
-  for (int i = 0; i < (n); ++i)
-
 static float dmcn_im2col_bilinear(const float *bottom_data, const int data_width,
                            const int height, const int width, float h, float w) {
     int h_low = int(floor(h));
@@ -55,12 +52,7 @@ static void modulated_deformable_im2col_gpu_kernel(const int n,
     // launch channels * batch_size * height_col * width_col cores
 
 
-    // add openmp
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(ts::openmp_threads())
-#endif
-    CPU_KERNEL_LOOP(index, n)
-    {
+    ts::parallel_for(0, n, [&](int index) {
         // NOTE(CharlesShang): different from Dai Jifeng's MXNet implementation, col_buffer is of shape (c*kw*kh, N, oh, ow)
         // here columns is of shape (N, c*kw*kh, oh * ow), need to adapt axis
 
@@ -116,7 +108,7 @@ static void modulated_deformable_im2col_gpu_kernel(const int n,
                 data_col_ptr += height_col * width_col;
             }
         }
-    }
+    });
 }
 
 void modulated_deformable_im2col_cpu(const float* data_im, const float* data_offset, const float* data_mask,
@@ -133,4 +125,92 @@ void modulated_deformable_im2col_cpu(const float* data_im, const float* data_off
             num_kernels, data_im, data_offset, data_mask, height_im, width_im, kernel_h, kernel_w,
             pad_h, pad_w, stride_h, stride_w, dilation_h, dilation_w, channel_per_deformable_group,
             batch_size, channels, deformable_group, height_col, width_col, data_col);
-}
\ No newline at end of file
+}
+
+void modulated_deformable_im2col_tile_cpu(const float *data_im, const float *data_offset, const float *data_mask,
+                                          const int channels, const int height_im, const int width_im,
+                                          const int height_col, const int width_col, const int kernel_h, const int kernel_w,
+                                          const int pad_h, const int pad_w, const int stride_h, const int stride_w,
+                                          const int dilation_h, const int dilation_w,
+                                          const int deformable_group,
+                                          const int tile_begin, const int tile_size,
+                                          int *plan_index, float *plan_weight, float *data_col) {
+    const int channel_per_deformable_group = channels / deformable_group;
+    const int kernel_size = kernel_h * kernel_w;
+    const int spatial = height_col * width_col;
+    const int image_size = height_im * width_im;
+
+    int *index0 = plan_index;
+    int *index1 = index0 + tile_size;
+    int *index2 = index1 + tile_size;
+    int *index3 = index2 + tile_size;
+    float *weight0 = plan_weight;
+    float *weight1 = weight0 + tile_size;
+    float *weight2 = weight1 + tile_size;
+    float *weight3 = weight2 + tile_size;
+
+    for (int g = 0; g < deformable_group; ++g) {
+        for (int i = 0; i < kernel_h; ++i) {
+            for (int j = 0; j < kernel_w; ++j) {
+                const int k = i * kernel_w + j;
+                const float *offset_h_ptr = data_offset + (g * 2 * kernel_size + 2 * k) * spatial + tile_begin;
+                const float *offset_w_ptr = offset_h_ptr + spatial;
+                const float *mask_ptr = data_mask + (g * kernel_size + k) * spatial + tile_begin;
+
+                // plan the 4 neighbors of each column, invalid neighbor has index 0 and weight 0
+                int h_col = tile_begin / width_col;
+                int w_col = tile_begin % width_col;
+                for (int p = 0; p < tile_size; ++p) {
+                    const float h_im = h_col * stride_h - pad_h + i * dilation_h + offset_h_ptr[p];
+                    const float w_im = w_col * stride_w - pad_w + j * dilation_w + offset_w_ptr[p];
+                    if (++w_col == width_col) {
+                        w_col = 0;
+                        ++h_col;
+                    }
+
+                    index0[p] = index1[p] = index2[p] = index3[p] = 0;
+                    weight0[p] = weight1[p] = weight2[p] = weight3[p] = 0;
+                    if (!(h_im > -1 && w_im > -1 && h_im < height_im && w_im < width_im)) continue;
+
+                    const int h_low = int(floor(h_im));
+                    const int w_low = int(floor(w_im));
+                    const int h_high = h_low + 1;
+                    const int w_high = w_low + 1;
+                    const float lh = h_im - h_low;
+                    const float lw = w_im - w_low;
+                    const float hh = 1 - lh, hw = 1 - lw;
+                    const float mask = mask_ptr[p];
+
+                    if (h_low >= 0 && w_low >= 0) {
+                        index0[p] = h_low * width_im + w_low;
+                        weight0[p] = hh * hw * mask;
+                    }
+                    if (h_low >= 0 && w_high <= width_im - 1) {
+                        index1[p] = h_low * width_im + w_high;
+                        weight1[p] = hh * lw * mask;
+                    }
+                    if (h_high <= height_im - 1 && w_low >= 0) {
+                        index2[p] = h_high * width_im + w_low;
+                        weight2[p] = lh * hw * mask;
+                    }
+                    if (h_high <= height_im - 1 && w_high <= width_im - 1) {
+                        index3[p] = h_high * width_im + w_high;
+                        weight3[p] = lh * lw * mask;
+                    }
+                }
+
+                // apply plan on every channel of this group
+                const int c_begin = g * channel_per_deformable_group;
+                const int c_end = c_begin + channel_per_deformable_group;
+                for (int c = c_begin; c < c_end; ++c) {
+                    const float *im = data_im + c * image_size;
+                    float *col = data_col + (c * kernel_size + k) * tile_size;
+                    for (int p = 0; p < tile_size; ++p) {
+                        col[p] = weight0[p] * im[index0[p]] + weight1[p] * im[index1[p]] +
+                                 weight2[p] * im[index2[p]] + weight3[p] * im[index3[p]];
+                    }
+                }
+            }
+        }
+    }
+}
@@ -5,17 +5,37 @@
 #ifndef TENSORSTACK_KERNELS_CPU_DCN_DCN_V2_IM2COL_CPU_H
 #define TENSORSTACK_KERNELS_CPU_DCN_DCN_V2_IM2COL_CPU_H
 
+#include "utils/api.h"
+
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-void modulated_deformable_im2col_cpu(const float *data_im, const float *data_offset, const float *data_mask,
-                                     const int batch_size, const int channels, const int height_im, const int width_im,
-                                     const int height_col, const int width_col, const int kernel_h, const int kenerl_w,
-                                     const int pad_h, const int pad_w, const int stride_h, const int stride_w,
-                                     const int dilation_h, const int dilation_w,
-                                     const int deformable_group, float *data_col);
+TS_DEBUG_API void modulated_deformable_im2col_cpu(const float *data_im, const float *data_offset, const float *data_mask,
+                                                  const int batch_size, const int channels, const int height_im, const int width_im,
+                                                  const int height_col, const int width_col, const int kernel_h, const int kenerl_w,
+                                                  const int pad_h, const int pad_w, const int stride_h, const int stride_w,
+                                                  const int dilation_h, const int dilation_w,
+                                                  const int deformable_group, float *data_col);
+
+/**
+ * Sample columns [tile_begin, tile_begin + tile_size) of one image, into data_col in shape [channels * kernel_h * kernel_w, tile_size]
+ * @param data_im image in [channels, height_im, width_im]
+ * @param data_offset offset in [deformable_group * 2 * kernel_h * kernel_w, height_col, width_col]
+ * @param data_mask mask in [deformable_group * kernel_h * kernel_w, height_col, width_col]
+ * @param plan_index buffer of 4 * tile_size ints
+ * @param plan_weight buffer of 4 * tile_size floats
+ * @note sample position and weights of each kernel point are computed once and shared by all channels in deformable group
+ */
+TS_DEBUG_API void modulated_deformable_im2col_tile_cpu(const float *data_im, const float *data_offset, const float *data_mask,
+                                                       const int channels, const int height_im, const int width_im,
+                                                       const int height_col, const int width_col, const int kernel_h, const int kernel_w,
+                                                       const int pad_h, const int pad_w, const int stride_h, const int stride_w,
+                                                       const int dilation_h, const int dilation_w,
+                                                       const int deformable_group,
+                                                       const int tile_begin, const int tile_size,
+                                                       int *plan_index, float *plan_weight, float *data_col);
 
 #ifdef __cplusplus
 }
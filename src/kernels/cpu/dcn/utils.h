@@ -60,82 +60,6 @@ namespace ts {
                 buffer = RuntimeContext::FlowMemory()->alloc(device, size);
                 return buffer.data();
             }
-
-            inline void
-            adjustLdLevel3(char transa, char transb, int64_t m, int64_t n, int64_t k, int64_t *lda, int64_t *ldb,
-                           int64_t *ldc) {
-                int transa_ = ((transa == 't') || (transa == 'T'));
-                int transb_ = ((transb == 't') || (transb == 'T'));
-
-                // Note: leading dimensions generally are checked that they are > 0 and at least as big the result
-                // requires (even if the value won't be used).
-                if (n <= 1)
-                    *ldc = std::max<int64_t>(m, 1);
-
-                if (transa_) {
-                    if (m <= 1)
-                        *lda = std::max<int64_t>(k, 1);
-                } else {
-                    if (k <= 1)
-                        *lda = std::max<int64_t>(m, 1);
-                }
-
-                if (transb_) {
-                    if (k <= 1)
-                        *ldb = std::max<int64_t>(n, 1);
-                } else {
-                    if (n <= 1)
-                        *ldb = std::max<int64_t>(k, 1);
-                }
-
-            }
-
-            static blas::Transpose convertTransToCublasOperation(char trans) {
-                if (trans == 't') return blas::Trans;
-                else if (trans == 'n') return blas::NoTrans;
-                else {
-                    TS_LOG_ERROR("trans must be one of: t, n, c") << eject;
-                    return blas::Trans;
-                }
-            }
-
-            void CBlas_SgemmBatched(blas::Transpose transa, blas::Transpose transb, int64_t m, int64_t n, int64_t k,
-                                    float alpha, const float *a[], int64_t lda, const float *b[], int64_t ldb,
-                                    float beta, float *c[], int64_t ldc, int64_t batchCount) {
-				for (int i = 0; i < batchCount; ++i) {
-#ifdef TS_USE_CBLAS
-					cblas::math<float>::gemm(blas::ColMajor, transa, transb,
-						int(m), int(n), int(k),
-						alpha, a[i], int(lda),
-						b[i], int(ldb),
-						beta, c[i], int(ldc));
-#else
-					ts::cpu::math<float, float>::gemm(blas::ColMajor, transa, transb,
-						int(m), int(n), int(k),
-						alpha, a[i], int(lda),
-						b[i], int(ldb),
-						beta, c[i], int(ldc));
-#endif
-				}
-            }
-
-            static void CBlas_SgemmBatched(char transa, char transb, int64_t m, int64_t n, int64_t k,
-                                           float alpha, const float *a[], int64_t lda, const float *b[], int64_t ldb,
-                                           float beta, float *c[], int64_t ldc, int64_t batchCount) {
-                if ((m >= INT_MAX) || (n >= INT_MAX) || (k >= INT_MAX) ||
-                    (lda >= INT_MAX) || (ldb >= INT_MAX) || (ldc >= INT_MAX) || (batchCount >= INT_MAX)) {
-                    TS_LOG_ERROR << "CBlas_SgemmBatched only supports m, n, k, lda, ldb, ldc, batchCount"
-                                    "with the bound [val] <= " << INT_MAX << eject;
-                }
-
-                adjustLdLevel3(transa, transb, m, n, k, &lda, &ldb, &ldc);
-                blas::Transpose opa = convertTransToCublasOperation(transa);
-                blas::Transpose opb = convertTransToCublasOperation(transb);
-
-                CBlas_SgemmBatched(opa, opb, (int) m, (int) n, (int) k,
-                                   alpha, a, (int) lda, b, (int) ldb, beta, c, (int) ldc,
-                                   (int) batchCount);
-            }
         }
     }
 }
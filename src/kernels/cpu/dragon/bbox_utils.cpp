@@ -1,5 +1,7 @@
 #include "bbox_utils.h"
 
+#include "kernels/common/openmp.h"
+
 namespace ts {
 
 namespace dragon {
@@ -22,33 +24,34 @@ template <> void GenerateProposals<float, CPUContext>(
     const float*            anchors,
     float*                  proposals,
     CPUContext*             ctx) {
-    float* proposal = proposals;
     const int K = feat_h * feat_w;
-    for (int h = 0; h < feat_h; ++h) {
-        for (int w = 0; w < feat_w; ++w) {
-            const float x = (float)w * stride;
-            const float y = (float)h * stride;
+    // proposals: [feat_h, feat_w, A, 5], rows are independent
+    parallel_for(0, feat_h, [&](int h) {
+        const float y = (float)h * stride;
+        // decode one anchor of the whole row, so deltas and scores are read contiguously
+        for (int a = 0; a < A; ++a) {
             // bbox_deltas: [1, A, 4, K]
-            const float* bbox_delta = bbox_deltas + h * feat_w + w;
+            const float* dx = bbox_deltas + (a * 4 + 0) * K + h * feat_w;
+            const float* dy = bbox_deltas + (a * 4 + 1) * K + h * feat_w;
+            const float* d_log_w = bbox_deltas + (a * 4 + 2) * K + h * feat_w;
+            const float* d_log_h = bbox_deltas + (a * 4 + 3) * K + h * feat_w;
             // scores: [1, A, K]
-            const float* score = scores + h * feat_w + w;
-            for (int a = 0; a < A; ++a) {
-                const float dx = bbox_delta[(a * 4 + 0) * K];
-                const float dy = bbox_delta[(a * 4 + 1) * K];
-                const float d_log_w = bbox_delta[(a * 4 + 2) * K];
-                const float d_log_h = bbox_delta[(a * 4 + 3) * K];
+            const float* score = scores + a * K + h * feat_w;
+            float* proposal = proposals + ((int64_t)h * feat_w * A + a) * 5;
+            for (int w = 0; w < feat_w; ++w) {
+                const float x = (float)w * stride;
                 proposal[0] = x + anchors[a * 4 + 0];
                 proposal[1] = y + anchors[a * 4 + 1];
                 proposal[2] = x + anchors[a * 4 + 2];
                 proposal[3] = y + anchors[a * 4 + 3];
                 proposal[4] = BBoxTransform<float>(
-                    dx, dy, d_log_w, d_log_h,
+                    dx[w], dy[w], d_log_w[w], d_log_h[w],
                         im_w, im_h, min_box_w, min_box_h,
-                            proposal) * score[a * K];
-                proposal += 5;
+                            proposal) * score[w];
+                proposal += A * 5;
             }
         }
-    }
+    });
 }
 
 template <> void GenerateProposals_v2<float, CPUContext>(
@@ -61,8 +64,8 @@ template <> void GenerateProposals_v2<float, CPUContext>(
     const float*            bbox_deltas,
     float*                  proposals,
     CPUContext*             ctx) {
-    float* proposal = proposals;
-    for (int i = 0; i < total_anchors; ++i) {
+    parallel_for(0, total_anchors, [&](int i) {
+        float* proposal = proposals + (int64_t)i * 5;
         // bbox_deltas: [1, 4, total_anchors]
         // scores: [1, total_anchors]
         const float dx = bbox_deltas[i];
@@ -73,29 +76,18 @@ template <> void GenerateProposals_v2<float, CPUContext>(
             dx, dy, d_log_w, d_log_h,
                 im_w, im_h, min_box_w, min_box_h,
                     proposal) * scores[i];
-        proposal += 5;
-    }
+    });
 }
 
 /******************** NMS ********************/
 
-template <typename T>
-T iou(const T A[], const T B[]) {
-    if (A[0] > B[2] || A[1] > B[3] ||
-        A[2] < B[0] || A[3] < B[1]) return 0;
-    const T x1 = std::max(A[0], B[0]);
-    const T y1 = std::max(A[1], B[1]);
-    const T x2 = std::min(A[2], B[2]);
-    const T y2 = std::min(A[3], B[3]);
-    const T width = std::max((T)0, x2 - x1 + 1);
-    const T height = std::max((T)0, y2 - y1 + 1);
-    const T area = width * height;
-    const T A_area = (A[2] - A[0] + 1) * (A[3] - A[1] + 1);
-    const T B_area = (B[2] - B[0] + 1) * (B[3] - B[1] + 1);
-    return area / (A_area + B_area - area);
-}
-
-template <> void ApplyNMS<float, CPUContext>(
+/*!
+ * Boxes are sorted by score, every kept box suppresses all the later boxes.
+ * Coordinates and areas are loaded into SoA once, the suppress loop is branch free and
+ *     selects IoU of overlapped boxes, so it is vectorized and split on threads.
+ * IoU is divided rather than comparing inter > thresh * union, whose rounding differs for IoU exactly at thresh.
+ */
+template <> TS_DEBUG_API void ApplyNMS<float, CPUContext>(
     const int               num_boxes,
     const int               max_keeps,
     const float             thresh,
@@ -103,17 +95,35 @@ template <> void ApplyNMS<float, CPUContext>(
     int*                    keep_indices,
     int&                    num_keep,
     CPUContext*             ctx) {
+    std::vector<float> x1(num_boxes), y1(num_boxes), x2(num_boxes), y2(num_boxes), area(num_boxes);
+    for (int i = 0; i < num_boxes; ++i) {
+        x1[i] = boxes[i * 5 + 0];
+        y1[i] = boxes[i * 5 + 1];
+        x2[i] = boxes[i * 5 + 2];
+        y2[i] = boxes[i * 5 + 3];
+        area[i] = (x2[i] - x1[i] + 1) * (y2[i] - y1[i] + 1);
+    }
+    std::vector<char> is_dead(num_boxes, 0);
+    const float *px1 = x1.data(), *py1 = y1.data(), *px2 = x2.data(), *py2 = y2.data();
+    const float *parea = area.data();
+    char *dead = is_dead.data();
+
     int count = 0;
-    std::vector<char> is_dead(num_boxes);
-    for (int i = 0; i < num_boxes; ++i) is_dead[i] = 0;
     for (int i = 0; i < num_boxes; ++i) {
-        if (is_dead[i]) continue;
+        if (dead[i]) continue;
         keep_indices[count++] = i;
         if (count == max_keeps) break;
-        for (int j = i + 1; j < num_boxes; ++j)
-            if (!is_dead[j] && iou(&boxes[i * 5],
-                                   &boxes[j * 5]) > thresh)
-                is_dead[j] = 1;
+        const float ix1 = px1[i], iy1 = py1[i], ix2 = px2[i], iy2 = py2[i], iarea = parea[i];
+        parallel_for(i + 1, num_boxes, [&](int j) {
+            const float xx1 = std::max(ix1, px1[j]);
+            const float yy1 = std::max(iy1, py1[j]);
+            const float xx2 = std::min(ix2, px2[j]);
+            const float yy2 = std::min(iy2, py2[j]);
+            const float inter = std::max(0.f, xx2 - xx1 + 1) * std::max(0.f, yy2 - yy1 + 1);
+            const bool overlap = (ix1 <= px2[j]) & (iy1 <= py2[j]) & (ix2 >= px1[j]) & (iy2 >= py1[j]);
+            const float iou = overlap ? inter / (iarea + parea[j] - inter) : 0.f;
+            dead[j] |= char(iou > thresh);
+        }, 4096);
     }
     num_keep = count;
 }
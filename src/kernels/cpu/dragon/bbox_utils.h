@@ -248,7 +248,7 @@ inline void DistributeRoIs(
 /******************** NMS ********************/
 
 template <typename T, class Context>
-void ApplyNMS(
+TS_DEBUG_API void ApplyNMS(
     const int                       num_boxes,
     const int                       max_keeps,
     const T                         thresh,
@@ -5,12 +5,14 @@
 #ifndef DRAGON_UTILS_OP_KERNEL_H
 #define DRAGON_UTILS_OP_KERNEL_H
 
+#include "utils/api.h"
+
 namespace ts {
     namespace dragon {
         namespace kernel {
 /*! vision.roi_align */
             template<typename T, class Context>
-            void ROIAlign(
+            TS_DEBUG_API void ROIAlign(
                     const int C,
                     const int H,
                     const int W,
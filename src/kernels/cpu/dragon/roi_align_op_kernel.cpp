@@ -6,6 +6,9 @@
 #include "core/ieee754_float.h"
 
 #include "kernels/common/third/dragon.h"
+#include "kernels/common/openmp.h"
+
+#include <vector>
 
 namespace ts {
 
@@ -15,50 +18,120 @@ namespace ts {
 
 /*! ROIAlign <T = float32, Device = CPU> */
 
-            template<typename T>
-            T _ROIAlignInterpolate(
-                    const T *Xdata,
-                    const int height,
-                    const int width,
-                    T y,
-                    T x) {
-                if (y < -1.0 || y > height || x < -1.0 || x > width) return 0;
-                if (y <= 0) y = 0;
-                if (x <= 0) x = 0;
-
-                int y_low = (int) y;
-                int x_low = (int) x;
-                int y_high;
-                int x_high;
-
-                if (y_low >= height - 1) {
-                    y_high = y_low = height - 1;
-                    y = (T) y_low;
+            /**
+             * Bilinear sampling of one axis, the 2D weights are product of the two axes.
+             * Weight is 0 if sample is out of range, and pre-divided by the grid count of this axis.
+             */
+            struct _ROIAlignAxis {
+                int low;
+                int high;
+                float w_low;
+                float w_high;
+            };
+
+            /**
+             * Sample is dropped if out of [-1, size], and clamped into [0, size - 1].
+             */
+            static inline _ROIAlignAxis _ROIAlignAxisAt(float v, int size, float scale) {
+                _ROIAlignAxis axis = {0, 0, 0, 0};
+                if (v < -1.0 || v > size) return axis;
+                if (v <= 0) v = 0;
+                axis.low = (int) v;
+                if (axis.low >= size - 1) {
+                    axis.high = axis.low = size - 1;
+                    v = (float) axis.low;
                 } else {
-                    y_high = y_low + 1;
+                    axis.high = axis.low + 1;
                 }
+                float l = v - axis.low;
+                axis.w_low = (1 - l) * scale;
+                axis.w_high = l * scale;
+                return axis;
+            }
 
-                if (x_low >= width - 1) {
-                    x_high = x_low = width - 1;
-                    x = (T) x_low;
-                } else {
-                    x_high = x_low + 1;
+            /**
+             * Sampling positions and weights of one RoI, shared by all channels.
+             */
+            struct _ROIAlignPreCalc {
+                int grid_h;
+                int grid_w;
+                // [pool_h * grid_h]
+                std::vector<_ROIAlignAxis> ys;
+                // [pool_w * grid_w]
+                std::vector<_ROIAlignAxis> xs;
+
+                void calc(const float *R, int H, int W, int pool_h, int pool_w,
+                          float spatial_scale, int sampling_ratio) {
+                    float roi_start_w = R[1] * spatial_scale;
+                    float roi_start_h = R[2] * spatial_scale;
+                    float roi_end_w = R[3] * spatial_scale;
+                    float roi_end_h = R[4] * spatial_scale;
+
+                    float roi_width = std::max(roi_end_w - roi_start_w, 1.f);
+                    float roi_height = std::max(roi_end_h - roi_start_h, 1.f);
+                    float bin_size_h = (float) roi_height / (float) pool_h;
+                    float bin_size_w = (float) roi_width / (float) pool_w;
+
+                    grid_h = (sampling_ratio > 0) ?
+                             sampling_ratio : (int) ceil(roi_height / pool_h);
+                    grid_w = (sampling_ratio > 0) ?
+                             sampling_ratio : (int) ceil(roi_width / pool_w);
+
+                    ys.resize(pool_h * grid_h);
+                    xs.resize(pool_w * grid_w);
+                    for (int ph = 0; ph < pool_h; ++ph) {
+                        for (int iy = 0; iy < grid_h; ++iy) {
+                            const float y = roi_start_h + ph * bin_size_h +
+                                            static_cast<float>(iy + .5f) * bin_size_h /
+                                            static_cast<float>(grid_h);
+                            ys[ph * grid_h + iy] = _ROIAlignAxisAt(y, H, 1.0f / grid_h);
+                        }
+                    }
+                    for (int pw = 0; pw < pool_w; ++pw) {
+                        for (int ix = 0; ix < grid_w; ++ix) {
+                            const float x = roi_start_w + pw * bin_size_w +
+                                            static_cast<float>(ix + .5f) * bin_size_w /
+                                            static_cast<float>(grid_w);
+                            xs[pw * grid_w + ix] = _ROIAlignAxisAt(x, W, 1.0f / grid_w);
+                        }
+                    }
                 }
 
-                T ly = y - y_low;
-                T lx = x - x_low;
-                T hy = (T) 1 - ly, hx = (T) 1 - lx;
-                T v1 = Xdata[y_low * width + x_low];
-                T v2 = Xdata[y_low * width + x_high];
-                T v3 = Xdata[y_high * width + x_low];
-                T v4 = Xdata[y_high * width + x_high];
-                T w1 = hy * hx, w2 = hy * lx, w3 = ly * hx, w4 = ly * lx;
-                T val = (w1 * v1 + w2 * v2 + w3 * v3 + w4 * v4);
-                return val;
-            }
+                /**
+                 * pool channels [c_begin, c_end) of X into Y
+                 */
+                void pool(const float *X, float *Y, int W, int pool_h, int pool_w,
+                          int64_t X_offset, int64_t Y_offset, int c_begin, int c_end) const {
+                    for (int c = c_begin; c < c_end; ++c) {
+                        const float *X_c = X + c * X_offset;
+                        float *Y_c = Y + c * Y_offset;
+                        std::fill(Y_c, Y_c + Y_offset, 0.f);
+                        for (int ph = 0; ph < pool_h; ++ph) {
+                            float *Y_row = Y_c + ph * pool_w;
+                            for (int iy = 0; iy < grid_h; ++iy) {
+                                auto &y = ys[ph * grid_h + iy];
+                                if (y.w_low == 0 && y.w_high == 0) continue;
+                                const float *row_low = X_c + y.low * W;
+                                const float *row_high = X_c + y.high * W;
+                                for (int pw = 0; pw < pool_w; ++pw) {
+                                    auto *x = &xs[pw * grid_w];
+                                    float val = 0;
+                                    for (int ix = 0; ix < grid_w; ++ix) {
+                                        val += y.w_low * (x[ix].w_low * row_low[x[ix].low] +
+                                                          x[ix].w_high * row_low[x[ix].high]) +
+                                               y.w_high * (x[ix].w_low * row_high[x[ix].low] +
+                                                           x[ix].w_high * row_high[x[ix].high]);
+                                    }
+                                    Y_row[pw] += val;
+                                }
+                            }
+                        }
+                    }
+                }
+            };
 
             template<>
-            void ROIAlign<float, CPUContext>(
+            TS_DEBUG_API void ROIAlign<float, CPUContext>(
                     const int C,
                     const int H,
                     const int W,
@@ -74,6 +147,32 @@ namespace ts {
                 const int64_t X_offset = H * W, Y_offset = pool_h * pool_w;
                 const int64_t x_offset = C * X_offset, y_offset = C * Y_offset;
 
+                const int threads = openmp_threads();
+
+                if (num_rois >= threads) {
+                    // parallel on RoIs, each thread computes sampling table once per RoI
+                    parallel_run([&](int, int roi_begin, int roi_end) {
+                        _ROIAlignPreCalc pre_calc;
+                        for (int n = roi_begin; n < roi_end; ++n) {
+                            auto *R = rois + n * 5;
+                            int roi_batch_ind = (int) R[0];
+                            auto *Y = y + n * y_offset;
+
+                            if (roi_batch_ind < 0) {
+                                std::memset(Y, 0, sizeof(float) * y_offset);
+                                continue;
+                            }
+
+                            pre_calc.calc(R, H, W, pool_h, pool_w, spatial_scale, sampling_ratio);
+                            pre_calc.pool(x + roi_batch_ind * x_offset, Y, W, pool_h, pool_w,
+                                          X_offset, Y_offset, 0, C);
+                        }
+                    }, 0, num_rois);
+                    return;
+                }
+
+                // few RoIs, parallel on channels
+                _ROIAlignPreCalc pre_calc;
                 for (int n = 0; n < num_rois; ++n) {
                     auto *R = rois + n * 5;
                     int roi_batch_ind = (int) R[0];
@@ -84,49 +183,12 @@ namespace ts {
                         continue;
                     }
 
-                    float roi_start_w = R[1] * spatial_scale;
-                    float roi_start_h = R[2] * spatial_scale;
-                    float roi_end_w = R[3] * spatial_scale;
-                    float roi_end_h = R[4] * spatial_scale;
-
-                    float roi_width = std::max(roi_end_w - roi_start_w, 1.f);
-                    float roi_height = std::max(roi_end_h - roi_start_h, 1.f);
-                    float bin_size_h = (float) roi_height / (float) pool_h;
-                    float bin_size_w = (float) roi_width / (float) pool_w;
-
-                    int roi_bin_grid_h = (sampling_ratio > 0) ?
-                                         sampling_ratio : (int) ceil(roi_height / pool_h);
-                    int roi_bin_grid_w = (sampling_ratio > 0) ?
-                                         sampling_ratio : (int) ceil(roi_width / pool_w);
-
-                    const float num_bin_grids = (float) roi_bin_grid_h * roi_bin_grid_w;
+                    pre_calc.calc(R, H, W, pool_h, pool_w, spatial_scale, sampling_ratio);
                     const float *X = x + roi_batch_ind * x_offset;
-
-                    for (int c = 0; c < C; ++c) {
-                        for (int ph = 0; ph < pool_h; ++ph) {
-                            for (int pw = 0; pw < pool_w; ++pw) {
-                                float output_val = 0.f;
-                                const int pool_idx = ph * pool_w + pw;
-                                for (int iy = 0; iy < roi_bin_grid_h; iy++) {
-                                    const float y = roi_start_h + ph * bin_size_h +
-                                                    static_cast<float>(iy + .5f) * bin_size_h /
-                                                    static_cast<float>(roi_bin_grid_h);
-                                    for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-                                        const float x = roi_start_w + pw * bin_size_w +
-                                                        static_cast<float>(ix + .5f) * bin_size_w /
-                                                        static_cast<float>(roi_bin_grid_w);
-                                        output_val += _ROIAlignInterpolate<float>(X, H, W, y, x);
-                                    }  // End ix
-                                }  // End iy
-                                output_val /= num_bin_grids;
-                                Y[pool_idx] = output_val;
-                            }  // End pw
-                        }  // End ph
-                        // Offset according to C
-                        X += X_offset;
-                        Y += Y_offset;
-                    }  // End c
-                }  // End n
+                    parallel_for(0, C, [&](int c) {
+                        pre_calc.pool(X, Y, W, pool_h, pool_w, X_offset, Y_offset, c, c + 1);
+                    });
+                }
             }
 
 /*! ROIAlign <T = float16, Device = CPU> */
@@ -3,9 +3,7 @@
 
 #include "backend/name.h"
 #include "global/operator_factory.h"
-#ifdef TS_USE_OPENMP
 #include <kernels/common/openmp.h>
-#endif
 
 
 namespace ts {
@@ -19,12 +17,9 @@ namespace ts {
             int count = out.count();
 
 //            std::memcpy(output_data, input_data, count * sizeof(T));
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int i = 0; i < count; i++) {
+            parallel_for(0, count, [&](int i) {
                 output_data[i] = exp(input_data[i]);
-            }
+            });
         }
 
 
@@ -1,8 +1,47 @@
 #include <kernels/cpu/global_pooling2d.h>
+#include <kernels/cpu/reduce_algorithm.h>
 #include <global/operator_factory.h>
 #include <backend/name.h>
 
+namespace ts {
+    namespace cpu {
+        template<typename T>
+        static void cpu_global_pooling2d_compute_run(const Tensor &x, Pooling2DType type,
+                                                     Conv2DFormat format, Tensor &out) {
+            auto reduce_type = type == Pooling2DType::MAX ? ReduceType::MAX : ReduceType::MEAN;
+            if (format == FORMAT_NCHW) {
+                ReduceAlgorithm<T>::reduce(x, {2, 3}, reduce_type, out);
+            } else {
+                ReduceAlgorithm<T>::reduce(x, {1, 2}, reduce_type, out);
+            }
+        }
+
+        void GlobalPooling2DCore::pooling2d(const Tensor &x, Pooling2DType type,
+                                            const Padding2D &padding, Padding2DType padding_type,
+                                            const Size2D &ksize, const Stride2D &stride,
+                                            Conv2DFormat format, Tensor &out) {
+            if (format != FORMAT_NCHW && format != FORMAT_NHWC) {
+                TS_LOG_ERROR << "GlobalPooling2D only support NCHW and NHWC" << eject;
+            }
+            if (type != Pooling2DType::MAX && type != Pooling2DType::AVG) {
+                TS_LOG_ERROR << "GlobalPooling2D only support MAX and AVG" << eject;
+            }
+            DTYPE dtype = out.dtype();
+            switch (dtype) {
+#define DECLARE_COMPUTE_RUN(DTYPE, TYPE) \
+        case DTYPE: { cpu_global_pooling2d_compute_run<TYPE>(x, type, format, out); break; }
+                DECLARE_COMPUTE_RUN(FLOAT32, float);
+                DECLARE_COMPUTE_RUN(FLOAT64, double);
+#undef DECLARE_COMPUTE_RUN
+                default: {
+                    TS_LOG_ERROR << "GlobalPooling2D not support data type(" << dtype << "): " << type_str(dtype) << eject;
+                    break;
+                }
+            }
+        }
+    }
+}
+
 using namespace ts;
 using namespace cpu;
 TS_REGISTER_OPERATOR(GlobalPooling2D, CPU, name::layer::global_pooling2d())
-
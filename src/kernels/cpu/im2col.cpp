@@ -47,40 +47,8 @@ void im2col_cpu(const Dtype* data_im, const int channels,
                                      (dilation_w * (kernel_w - 1) + 1)) / stride_w + 1));
     const int channel_size = height * width;
 
-#ifndef TS_USE_OPENMP
-    for (int channel = channels; channel--; data_im += channel_size) {
-        for (int kernel_row = 0; kernel_row < kernel_h; kernel_row++) {
-            for (int kernel_col = 0; kernel_col < kernel_w; kernel_col++) {
-                int input_row = -pad_h_top + kernel_row * dilation_h;
-                for (int output_rows = output_h; output_rows; output_rows--) {
-                    if (!is_a_ge_zero_and_a_lt_b(input_row, height)) {
-                        for (int output_cols = output_w; output_cols; output_cols--) {
-                            *(data_col++) = padding_value;//0;
-                        }
-                    } else {
-                        int input_col = -pad_w_left + kernel_col * dilation_w;
-                        for (int output_col = output_w; output_col; output_col--) {
-                            if (is_a_ge_zero_and_a_lt_b(input_col, width)) {
-                                *(data_col++) = data_im[input_row * width + input_col];
-                            } else {
-                                *(data_col++) = padding_value;//0;
-                            }
-                            input_col += stride_w;
-                        }
-                    }
-                    input_row += stride_h;
-                }
-            }
-        }
-    }
-#else
     auto col_size = kernel_h * kernel_w * output_h * output_w;
-    //Note:Using both openmp and neon on armv7 could cause crashes.
-#ifdef TS_ON_ARMV7
-#else
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-    for (int channel = 0; channel < channels; ++channel) {
+    parallel_for(0, channels, [&](int channel) {
         auto local_data_im = data_im + channel * channel_size;
         auto local_data_col = data_col + channel * col_size;
         for (int kernel_row = 0; kernel_row < kernel_h; kernel_row++) {
@@ -106,8 +74,7 @@ void im2col_cpu(const Dtype* data_im, const int channels,
                 }
             }
         }
-    }
-#endif
+    });
 }
 
 // Explicit instantiation
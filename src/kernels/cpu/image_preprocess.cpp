@@ -0,0 +1,182 @@
+#include "backend/base/base_image_preprocess.h"
+#include "kernels/cpu/operator_on_cpu.h"
+
+#include "backend/name.h"
+#include "global/operator_factory.h"
+#include "kernels/common/openmp.h"
+#include "kernels/common/simd.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace ts {
+    namespace cpu {
+        class ImagePreprocess : public OperatorOnCPU<base::ImagePreprocess> {
+        public:
+            using self = ImagePreprocess;
+            using supper = OperatorOnCPU<base::ImagePreprocess>;
+
+            void image_preprocess(const Tensor &x, bool resize, Tensor &out) override;
+
+        private:
+            template<typename T, typename O>
+            void compute(const Tensor &x, bool resize, Tensor &out);
+        };
+    }
+}
+
+namespace ts {
+    namespace cpu {
+        /**
+         * source pixels of one output row or column, interpolated as weight between index and next
+         */
+        struct ResizeSample {
+            int index;
+            int next;
+            double weight;
+        };
+
+        /**
+         * same coordinates as resize2d, so fused filter gives same result as unfused one
+         */
+        static std::vector<ResizeSample> resize_samples(int src, int dst, bool resize, Resize2DType type) {
+            std::vector<ResizeSample> samples(size_t(dst), ResizeSample{0, 0, 0});
+            if (!resize) {
+                for (int i = 0; i < dst; ++i) samples[i] = ResizeSample{i, i, 0};
+                return samples;
+            }
+
+            double scl = double(src) / dst;
+            double bias = scl / 2 - 0.5;
+
+            for (int i = 0; i < dst; ++i) {
+                double lf = scl * i + bias;
+                if (type == Resize2DType::NEAREST) {
+                    auto n = int(std::round(lf));
+                    n = n >= 0 ? n : 0;
+                    n = n < src - 1 ? n : src - 1;
+                    samples[i] = ResizeSample{n, n, 0};
+                } else {
+                    lf = lf >= 0 ? lf : 0;
+                    lf = lf < src - 1 ? lf : src - 1 - 1e-5;
+                    auto n = int(lf);
+                    samples[i] = ResizeSample{n, std::min(n + 1, src - 1), lf - n};
+                }
+            }
+            return samples;
+        }
+
+        template<typename O>
+        static inline void store_plane(const O *plane, O *dst, int width, int stride, float, float) {
+            if (stride == 1) {
+                std::memcpy(dst, plane, width * sizeof(O));
+                return;
+            }
+            for (int x = 0; x < width; ++x) dst[x * stride] = plane[x];
+        }
+
+        static inline void store_plane(const float *plane, float *dst, int width, int stride,
+                                       float scale, float shift) {
+            int x = 0;
+            if (stride == 1) {
+                float32x4 scale_x4(scale);
+                float32x4 shift_x4(shift);
+                for (; x + 3 < width; x += 4) {
+                    fmadd(float32x4(plane + x), scale_x4, shift_x4).store(dst + x);
+                }
+            }
+            for (; x < width; ++x) dst[x * stride] = plane[x] * scale + shift;
+        }
+
+        template<typename T, typename O>
+        void ImagePreprocess::compute(const Tensor &x, bool resize, Tensor &out) {
+            auto number = x.size(0);
+            auto src_height = x.size(1);
+            auto src_width = x.size(2);
+            auto src_channels = x.size(3);
+
+            auto dst_channels = m_shuffle.empty() ? src_channels : int(m_shuffle.size());
+            auto dst_height = m_chw ? out.size(2) : out.size(1);
+            auto dst_width = m_chw ? out.size(3) : out.size(2);
+
+            auto rows = resize_samples(src_height, dst_height, resize, m_type);
+            auto cols = resize_samples(src_width, dst_width, resize, m_type);
+            bool linear = resize && m_type == Resize2DType::LINEAR;
+            bool cast_after_resize = m_cast_after_resize;
+
+            std::vector<int> shuffle(m_shuffle.begin(), m_shuffle.end());
+            if (shuffle.empty()) {
+                for (int c = 0; c < dst_channels; ++c) shuffle.push_back(c);
+            }
+            std::vector<float> scale(size_t(dst_channels), 1.0f);
+            std::vector<float> shift(size_t(dst_channels), 0.0f);
+            for (int c = 0; c < dst_channels; ++c) {
+                if (!m_scale.empty()) scale[c] = m_scale.size() == 1 ? m_scale[0] : m_scale[c];
+                if (!m_shift.empty()) shift[c] = m_shift.size() == 1 ? m_shift[0] : m_shift[c];
+            }
+
+            auto src_data = x.data<T>();
+            auto dst_data = out.data<O>();
+            auto src_row_step = src_width * src_channels;
+            auto chw = m_chw;
+
+            parallel_range([&](int, const Range &range) {
+                std::vector<O> plane(static_cast<size_t>(dst_width));
+                for (int r = range.first; r < range.second; ++r) {
+                    auto n = r / dst_height;
+                    auto y = r % dst_height;
+                    auto &row = rows[y];
+                    auto src0 = src_data + (size_t(n) * src_height + row.index) * src_row_step;
+                    auto src1 = src_data + (size_t(n) * src_height + row.next) * src_row_step;
+                    double wy = row.weight;
+
+                    for (int c = 0; c < dst_channels; ++c) {
+                        auto s = shuffle[c];
+                        if (linear) {
+                            for (int i = 0; i < dst_width; ++i) {
+                                auto &col = cols[i];
+                                double wx = col.weight;
+                                double value = (1 - wy) * (1 - wx) * src0[col.index * src_channels + s] +
+                                               (1 - wy) * wx * src0[col.next * src_channels + s] +
+                                               wy * (1 - wx) * src1[col.index * src_channels + s] +
+                                               wy * wx * src1[col.next * src_channels + s];
+                                plane[i] = cast_after_resize ? O(T(value)) : O(value);
+                            }
+                        } else {
+                            for (int i = 0; i < dst_width; ++i) {
+                                plane[i] = O(src0[cols[i].index * src_channels + s]);
+                            }
+                        }
+
+                        if (chw) {
+                            auto dst = dst_data + ((size_t(n) * dst_channels + c) * dst_height + y) * dst_width;
+                            store_plane(plane.data(), dst, dst_width, 1, scale[c], shift[c]);
+                        } else {
+                            auto dst = dst_data + (size_t(n) * dst_height + y) * dst_width * dst_channels + c;
+                            store_plane(plane.data(), dst, dst_width, dst_channels, scale[c], shift[c]);
+                        }
+                    }
+                }
+            }, 0, number * dst_height);
+        }
+
+        void ImagePreprocess::image_preprocess(const Tensor &x, bool resize, Tensor &out) {
+            auto in_dtype = x.dtype();
+            auto out_dtype = out.dtype();
+            if (in_dtype == UINT8 && out_dtype == UINT8) {
+                compute<uint8_t, uint8_t>(x, resize, out);
+            } else if (in_dtype == UINT8 && out_dtype == FLOAT32) {
+                compute<uint8_t, float>(x, resize, out);
+            } else if (in_dtype == FLOAT32 && out_dtype == FLOAT32) {
+                compute<float, float>(x, resize, out);
+            } else {
+                TS_LOG_ERROR << this->op() << " not support data type " << type_str(in_dtype)
+                             << " to " << type_str(out_dtype) << eject;
+            }
+        }
+    }
+}
+
+using namespace ts;
+using namespace cpu;
+TS_REGISTER_OPERATOR(ImagePreprocess, ts::CPU, name::layer::image_preprocess())
@@ -8,6 +8,8 @@
 #include <math.h>
 
 #include <kernels/common/simd.h>
+#include <kernels/common/openmp.h>
+#include <kernels/cpu/reduce_algorithm.h>
 
 namespace ts {
     namespace cpu {
@@ -23,6 +25,24 @@ namespace ts {
 
 namespace ts {
 	namespace cpu {
+        template<typename T>
+        static inline void l2_norm_divide(const T *x, const T *norm, int width, T *out) {
+            for (int i = 0; i < width; ++i) {
+                out[i] = x[i] / norm[i];
+            }
+        }
+
+        template<>
+        inline void l2_norm_divide<float>(const float *x, const float *norm, int width, float *out) {
+            int i = 0;
+            for (; i + 3 < width; i += 4) {
+                (float32x4(x + i) / float32x4(norm + i)).store(out + i);
+            }
+            for (; i < width; ++i) {
+                out[i] = x[i] / norm[i];
+            }
+        }
+
         template<typename T>
         void cpu_l2_normalize_compute_run(const Tensor &x, int m_dim, float epsilon, Tensor &out) {
             auto &output_shape = out.sizes();
@@ -49,38 +69,21 @@ namespace ts {
             }
 
 
-            HypeShape hype({head_num, body_num, tail_num});
+            // sum of square of each [n, :, w]
+            std::vector<T> norm(size_t(head_num) * tail_num);
+            ReduceAlgorithm<T>::reduce(input_data, head_num, body_num, tail_num, ReduceType::SUM_SQUARE, norm.data());
 
             auto this_epsilon = T(epsilon);
+            for (auto &value : norm) {
+                value = T(std::sqrt(value + this_epsilon));
+            }
 
             // as NCW format
-            for (int n = 0; n < head_num; ++n) {
-                for (int w = 0; w < tail_num; ++w) {
-                    auto channel_index = hype.to_index(n, 0, w);
-                    const T *input_channel_data = &input_data[channel_index];
-                    T *output_channel_data = &output_data[channel_index];
-                    const T *loop_in = input_channel_data;
-                    T *loop_out = output_channel_data;
-                    T sum = 0;
-                    for (int i = 0; i < body_num; ++i) {
-                        T data = T(*loop_in * *loop_in);
-                        sum += data;
-                        // *loop_out = *loop_in;
-
-                        loop_in += tail_num;
-                        loop_out += tail_num;
-                    }
-                    T norm = T(std::sqrt(sum + this_epsilon));
-                    loop_in = input_channel_data;
-                    loop_out = output_channel_data;
-                    for (int i = 0; i < body_num; ++i) {
-                        *loop_out = *loop_in / norm;
-
-                        loop_in += tail_num;
-                        loop_out += tail_num;
-                    }
-                }
-            }
+            parallel_for(0, head_num * body_num, [&](int t) {
+                auto local_norm = norm.data() + size_t(t / body_num) * tail_num;
+                auto offset = size_t(t) * tail_num;
+                l2_norm_divide<T>(input_data + offset, local_norm, tail_num, output_data + offset);
+            });
         }
 
 		template<typename T>
@@ -12,6 +12,8 @@
 #include <iostream>
 
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
 #include <runtime/inside/parallel.h>
 
@@ -125,18 +127,29 @@ namespace ts {
         }
 
 
+        /**
+         * sum reduce(begin, count) of fixed chunks in [0, N) in chunk order,
+         * so result not depends on which thread or how many threads run each chunk
+         */
+        template<typename T, typename FUNC>
+        inline T chunk_reduce(int N, const FUNC &reduce) {
+            static const int chunk = 4096;
+            const int chunks = (N + chunk - 1) / chunk;
+            std::vector<T> chunk_sum(chunks, T(0));
+            parallel_for(0, chunks, [&](int64_t i) {
+                const int begin = int(i) * chunk;
+                chunk_sum[i] = reduce(begin, std::min(N - begin, chunk));
+            });
+            T sum = 0;
+            for (auto value : chunk_sum) sum += value;
+            return sum;
+        }
+
         template<typename T_IN,typename T_OUT>
         T_OUT math<T_IN,T_OUT>::dot(int N, const T_IN *x, int incx, const T_IN *y, int incy) {
-            std::vector<T_OUT> parallel_sum(TS_PARALLEL_SIZE, T_OUT(0));
-            TS_PARALLEL_RANGE_BEGIN(range, 0, N)
-                    auto xx = x + range.first * incx;
-                    auto yy = y + range.first * incy;
-                    const auto count = range.second - range.first;
-                    parallel_sum[__parallel_id] += inline_dot<T_IN,T_OUT>(count, xx, incx, yy, incy);
-            TS_PARALLEL_RANGE_END()
-            T_OUT sum = 0;
-            for (auto value : parallel_sum) sum += value;
-            return sum;
+            return chunk_reduce<T_OUT>(N, [&](int begin, int count) {
+                return inline_dot<T_IN,T_OUT>(count, x + begin * incx, incx, y + begin * incy, incy);
+            });
         }
 
         template<typename T_IN,typename T_OUT>
@@ -249,10 +262,7 @@ namespace ts {
             int remain = out_loop << 3;
 
             //T_OUT* to_at = to;
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int nn = 0; nn < out_loop; nn++) {
+            parallel_for(0, out_loop, [&](int nn) {
                 int n = nn * 8;
                 const T_IN* k0 = from + n * lda;
                 const T_IN* k1 = k0 + lda;
@@ -275,20 +285,17 @@ namespace ts {
                     *to_at++ = *k6++;
                     *to_at++ = *k7++;
                 }
-            }
+            });
 
             //NOTE:Maybe i should pack 4x4 on remain size
             //to_at = to + remain * col;
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int n = remain; n < row; n++) {
+            parallel_for(remain, row, [&](int n) {
                 const T_IN* k0 = from + n * lda;
                 T_IN* to_at = to + n * col;
                 for (int i = 0; i < col; i++) {
                     *to_at++ = *k0++;
                 }
-            }
+            });
         }
 
         template<typename T_IN, typename T_OUT>
@@ -297,10 +304,7 @@ namespace ts {
             int remain = out_loop << 3;
 
             //T_OUT* to_at = to;
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int nn = 0; nn < out_loop; nn++) {
+            parallel_for(0, out_loop, [&](int nn) {
                 int n = nn * 8;
                 const T_IN* from_at = from + n;
                 T_IN* to_at = to + n * row;
@@ -317,13 +321,10 @@ namespace ts {
 
                     from_at += ldb;
                 }
-            }
+            });
 
             //to_at = to + remain * row;
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int n = remain; n < col; n++) {
+            parallel_for(remain, col, [&](int n) {
                 const T_IN* from_at = from + n;
                 T_IN* to_at = to + n * row;
 
@@ -331,7 +332,7 @@ namespace ts {
                     *to_at++ = from_at[0];
                     from_at += ldb;
                 }
-            }
+            });
         }
 
         template<>
@@ -340,10 +341,7 @@ namespace ts {
             int remain = out_loop << 3;
 
             //float* to_at = to;
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int nn = 0; nn < out_loop; nn++) {
+            parallel_for(0, out_loop, [&](int nn) {
                 int n = nn * 8;
                 const float* from_at = from + n;
                 float* to_at = to + n * row;
@@ -355,13 +353,10 @@ namespace ts {
                     from_at += ldb;
                     to_at += 8;
                 }
-            }
+            });
 
             //to_at = to + remain * row;
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int n = remain; n < col; n++) {
+            parallel_for(remain, col, [&](int n) {
                 const float* from_at = from + n;
                 float* to_at = to + n * row;
 
@@ -369,7 +364,7 @@ namespace ts {
                     *to_at++ = from_at[0];
                     from_at += ldb;
                 }
-            }
+            });
         }
 
         template<typename T_IN, typename T_OUT>
@@ -391,10 +386,7 @@ namespace ts {
             int out_loop = M >> 3;
             int remain = out_loop << 3;
             float* output_at = p_C;
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int mm = 0; mm < out_loop; mm++) {
+            parallel_for(0, out_loop, [&](int mm) {
                 int m = mm * 8;
                 float* output_row0 = output_at + m * ldc;
                 float* output_row1 = output_row0 + ldc;
@@ -609,12 +601,9 @@ namespace ts {
                     *output_row6++ = *(((float*)&sum_col.value) + 6);
                     *output_row7++ = *(((float*)&sum_col.value) + 7);
                 }
-            }
+            });
 
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int m = remain; m < M; m++) {
+            parallel_for(remain, M, [&](int m) {
                 float* output_row0 = output_at + m * ldc;
                 const float* A_store = p_A + m * K;
 
@@ -696,7 +685,7 @@ namespace ts {
                     *output_row0 = sum0;
                     output_row0++;
                 }
-            }
+            });
         }
 
         template<typename T_IN, typename T_OUT>
@@ -764,15 +753,9 @@ namespace ts {
 
         template<typename T_IN, typename T_OUT>
         T_OUT math<T_IN, T_OUT>::asum(int N, const T_IN *x, int incx) {
-            std::vector<T_OUT> parallel_sum(TS_PARALLEL_SIZE, T_OUT(0));
-            TS_PARALLEL_RANGE_BEGIN(range, 0, N)
-                    const T_IN *xx = x + range.first * incx;
-                    const auto count = range.second - range.first;
-                    parallel_sum[__parallel_id] += inline_asum<T_IN, T_OUT>(count, xx, incx);
-            TS_PARALLEL_RANGE_END()
-            T_OUT sum = 0;
-            for (auto value : parallel_sum) sum += value;
-            return sum;
+            return chunk_reduce<T_OUT>(N, [&](int begin, int count) {
+                return inline_asum<T_IN, T_OUT>(count, x + begin * incx, incx);
+            });
         }
 
         template<typename T_IN, typename T_OUT>
@@ -1,6 +1,7 @@
 #include "kernels/cpu/max.h"
 #include "global/operator_factory.h"
 #include "backend/name.h"
+#include "kernels/cpu/reduce_algorithm.h"
 
 #include <numeric>
 
@@ -10,41 +11,7 @@ namespace ts {
 
         template <typename T>
         static void cpu_max_compute_run(const Tensor &x, int axis,  Tensor &out) {
-            auto &x_shape = x.sizes();
-            if(axis < 0) {
-                axis += int(x_shape.size());
-            }
-
-            auto number = std::accumulate(x_shape.begin(), x_shape.begin() + axis, 1, std::multiplies<int>());
-            auto width = std::accumulate(x_shape.begin() + axis + 1, x_shape.end(), 1, std::multiplies<int>());
-            int input_width = width * x_shape[axis];
-
-
-            const T* x_data = x.data<T>();
-            T* out_data = out.data<T>();
-
-            T* ptr = out_data; 
-            T tmp = T(0);
-
-            int cur_input_width = 0;
-            for (int i = 0; i < number; ++i) {
-                ptr = out_data + i* width;
-                cur_input_width = i * input_width; 
-                
-                for(int k=0; k<width; k++) {
-                    for(int m = 0; m < x_shape[axis]; m++) {
-                        int cur_step = m * width;
-                        if(m == 0) {
-                            tmp = *(x_data + k + cur_step + cur_input_width);
-                        }else if(*(x_data + k + cur_step + cur_input_width) > tmp) {
-                            tmp = *(x_data + k + cur_step + cur_input_width);
-                        }
-                    }
-                    
-                    *(ptr + k) = tmp;
-                } 
-                
-            }
+            ReduceAlgorithm<T>::reduce(x, {axis}, ReduceType::MAX, out);
         }
 
 
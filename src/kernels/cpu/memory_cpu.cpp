@@ -7,27 +7,161 @@
 #include "global/memory_device.h"
 
 #include "utils/assert.h"
+#include "utils/numa.h"
+#include "utils/platform.h"
+#include "utils/log.h"
+#include "runtime/runtime.h"
 
 #include <cstring>
+#include <atomic>
+#include <algorithm>
+
+#if TS_PLATFORM_OS_LINUX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace ts {
+    /**
+     * memory smaller than this is left to malloc's placement, as it shares pages with others
+     */
+    static const size_t NUMA_BIND_MIN_SIZE = 1 << 20;
+
+    /**
+     * place memory on the NUMA node of running RuntimeContext
+     */
+    static void numa_local(void *mem, size_t size) {
+        if (size < NUMA_BIND_MIN_SIZE) return;
+        auto runtime = ctx::get<RuntimeContext>();
+        if (runtime == nullptr || runtime->get_numa_node() < 0) return;
+        NumaEnable::bind_memory(mem, size, runtime->get_numa_node());
+    }
+
+    static std::atomic<size_t> cpu_alignment(64);
+    static std::atomic<int32_t> cpu_huge_page(int32_t(CPUAllocator::HugePage::NONE));
+    static std::atomic<size_t> cpu_large_block_size(size_t(2) << 20);
+
+    void CPUAllocator::SetAlignment(size_t alignment) {
+        if (alignment < 16 || (alignment & (alignment - 1)) != 0) {
+            TS_LOG_ERROR << "CPU memory alignment must be power of 2 and at least 16, got " << alignment << eject;
+        }
+        cpu_alignment = alignment;
+    }
+
+    size_t CPUAllocator::GetAlignment() {
+        return cpu_alignment;
+    }
+
+    void CPUAllocator::SetHugePage(HugePage mode) {
+        cpu_huge_page = int32_t(mode);
+    }
+
+    CPUAllocator::HugePage CPUAllocator::GetHugePage() {
+        return HugePage(int32_t(cpu_huge_page));
+    }
+
+    void CPUAllocator::SetLargeBlockSize(size_t size) {
+        cpu_large_block_size = size;
+    }
+
+    size_t CPUAllocator::GetLargeBlockSize() {
+        return cpu_large_block_size;
+    }
+
+    /**
+     * saved just before each block, to free it
+     */
+    struct CPUBlockHeader {
+        void *base;     ///< malloc or mmap returned pointer
+        size_t length;  ///< mapped length, 0 if from malloc
+    };
+
+    static inline size_t align_up(size_t size, size_t alignment) {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    static inline CPUBlockHeader *block_header(void *mem) {
+        return reinterpret_cast<CPUBlockHeader *>(mem) - 1;
+    }
+
+#if TS_PLATFORM_OS_LINUX
+    static const size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+    static void *map_block(size_t size, size_t alignment) {
+        auto huge_page = CPUAllocator::GetHugePage();
+        auto offset = align_up(sizeof(CPUBlockHeader), alignment);
+        auto length = align_up(size + offset, size_t(sysconf(_SC_PAGESIZE)));
+
+        void *base = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+        if (huge_page == CPUAllocator::HugePage::HUGETLB) {
+            auto huge_length = align_up(size + offset, HUGE_PAGE_SIZE);
+            base = mmap(nullptr, huge_length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (base != MAP_FAILED) length = huge_length;
+        }
+#endif
+        if (base == MAP_FAILED) {
+            base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (base == MAP_FAILED) return nullptr;
+#if defined(MADV_HUGEPAGE)
+            if (huge_page != CPUAllocator::HugePage::NONE) madvise(base, length, MADV_HUGEPAGE);
+#endif
+        }
+
+        auto mem = reinterpret_cast<char *>(base) + offset;
+        *block_header(mem) = CPUBlockHeader{base, length};
+        return mem;
+    }
+#endif
+
+    static void *alloc_block(size_t size) {
+        size_t alignment = cpu_alignment;
+#if TS_PLATFORM_OS_LINUX
+        if (size >= cpu_large_block_size) return map_block(size, alignment);
+#endif
+        auto base = std::malloc(size + sizeof(CPUBlockHeader) + alignment - 1);
+        if (base == nullptr) return nullptr;
+        auto mem = reinterpret_cast<void *>(
+                align_up(reinterpret_cast<size_t>(base) + sizeof(CPUBlockHeader), alignment));
+        *block_header(mem) = CPUBlockHeader{base, 0};
+        return mem;
+    }
+
+    static void free_block(void *mem) {
+        if (mem == nullptr) return;
+        auto header = *block_header(mem);
+#if TS_PLATFORM_OS_LINUX
+        if (header.length) {
+            munmap(header.base, header.length);
+            return;
+        }
+#endif
+        std::free(header.base);
+    }
+
     void *cpu_allocator(int id, size_t new_size, void *mem, size_t mem_size) {
         if (new_size == 0 && mem == nullptr) return nullptr;
         void *new_mem = nullptr;
         if (new_size == 0) {
-            std::free(mem);
+            free_block(mem);
             return nullptr;
         } else if (mem != nullptr) {
             if (mem_size) {
-                new_mem = std::realloc(mem, new_size);
+                new_mem = alloc_block(new_size);
+                if (new_mem != nullptr) {
+                    std::memcpy(new_mem, mem, std::min(mem_size, new_size));
+                    free_block(mem);
+                }
             } else {
-                std::free(mem);
-                new_mem = std::malloc(new_size);
+                free_block(mem);
+                new_mem = alloc_block(new_size);
             }
         } else {
-            new_mem = std::malloc(new_size);
+            new_mem = alloc_block(new_size);
         }
         if (new_mem == nullptr) throw OutOfMemoryException(MemoryDevice(CPU, id), new_size);
+        numa_local(new_mem, new_size);
         return new_mem;
     }
 
@@ -1,7 +1,5 @@
 #include <kernels/cpu/pad2d_algorithm.h>
-#ifdef TS_USE_OPENMP
 #include <kernels/common/openmp.h>
-#endif
 #include <array>
 
 namespace ts{
@@ -55,10 +53,7 @@ namespace ts{
             std::fill(out_ptr, out_ptr + out.count(), value);
 
             for (int n = 0; n < num; ++n) {
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int i = 0; i < dim1; ++i) {
+                parallel_for(0, dim1, [&](int i) {
                     for (int j = 0; j < dim2; ++j) {
                         const int input_offset = (n + input_padding[0]) * in_num_offset
                                                  + (i + input_padding[1]) * input_dim1_offset
@@ -81,7 +76,7 @@ namespace ts{
                                         tile * sizeof(T));
                         }
                     }
-                }
+                });
             }
         };
 
@@ -122,10 +117,7 @@ namespace ts{
             // auto x_device = x.device();
 
             for (int n = 0; n < num; n++){
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < channel; c++){
+                parallel_for(0, channel, [&](int c) {
                     const T* src_at = src_data + n * src_num_offset + c * src_channel_offset;
                     T* dst_at = dst_data + n * dst_num_offset + c * dst_channel_offset;
 
@@ -174,7 +166,7 @@ namespace ts{
                         }
                         dst_at += out_w;
                     }
-                }
+                });
             }
         }
 
@@ -212,10 +204,7 @@ namespace ts{
             T* dst_data = out.data<T>();
 
             for (int n = 0; n < num; n++) {
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < channel; c++) {
+                parallel_for(0, channel, [&](int c) {
                     const T* src_at = src_data + n * src_num_offset + c * src_channel_offset;
                     T* dst_at = dst_data + n * dst_num_offset + c * dst_channel_offset;
 
@@ -242,7 +231,7 @@ namespace ts{
                         dst_at += out_w;
                         cut_at += src_w;
                     }
-                }
+                });
             }
         }
 
@@ -8,9 +8,7 @@
 #include <core/memory.h>
 #include <numeric>
 
-#ifdef TS_USE_OPENMP
 #include "kernels/common/openmp.h"
-#endif
 
 #include <kernels/cpu/pad2d_algorithm.h>
 
@@ -44,147 +44,6 @@ namespace ts {
             return pooling_kernel;
         }
 
-        template<typename T>
-        static bool cpu_max_pooling(
-                const T *input_data, T *output_data,
-                const Shape &input_shape, const Shape &output_shape,
-                const KSize2D &ksize, const Stride2D &stride,
-                const Padding2D &m_padding) {
-            int input_h = input_shape[2];
-            int input_w = input_shape[3];
-            int output_h = output_shape[2];
-            int output_w = output_shape[3];
-            int input_channel_size = input_h * input_w;
-            int output_channel_size = output_h * output_w;
-            for (int n = 0; n < output_shape[0]; n++) {
-                for (int c = 0; c < output_shape[1]; c++) {
-                    for (int oh = 0; oh < output_shape[2]; oh++) {
-                        int ihStart = oh * stride.height - m_padding.top;
-                        int ihEnd = std::min<int>(ihStart + ksize.height, input_h);
-                        for (int ow = 0; ow < output_shape[3]; ow++) {
-                            int iwStart = ow * stride.width - m_padding.left;
-                            int iwEnd = std::min<int>(iwStart + ksize.width, input_w);
-                            ihStart = std::max<int>(ihStart, 0);
-                            iwStart = std::max<int>(iwStart, 0);
-                            int outIndex = oh * output_w + ow;
-                            //T maxVlue = 0;
-                            T maxVlue = input_data[ihStart * input_w + iwStart];
-                            //int count = 0;
-                            for (int ih = ihStart; ih < ihEnd; ih++) {
-                                for (int iw = iwStart; iw < iwEnd; iw++) {
-                                    int input_index = ih * input_w + iw;
-                                    if (input_data[input_index] > maxVlue) {
-                                        maxVlue = input_data[input_index];
-                                    }
-                                }
-                                //count++;
-                            }
-                            output_data[outIndex] = maxVlue;
-                            //if (count == m_kernel_h * m_kernel_w)
-                            //	output_data[outIndex] = maxVlue;
-                            //else
-                            //	output_data[outIndex] = std::max<T>(maxVlue, padding_value);
-                        }
-                    }
-                    input_data += input_channel_size;
-                    output_data += output_channel_size;
-                }
-            }
-            return true;
-        }
-
-        template<typename T>
-        static bool cpu_average_pooling(
-                const T *input_data, T *output_data,
-                const Shape &input_shape, const Shape &output_shape,
-                const KSize2D &ksize, const Stride2D &stride,
-                const Padding2D &m_padding) {
-            int input_h = input_shape[2];
-            int input_w = input_shape[3];
-            int output_h = output_shape[2];
-            int output_w = output_shape[3];
-            int input_channel_size = input_h * input_w;
-            int output_channel_size = output_h * output_w;
-            for (int n = 0; n < output_shape[0]; n++) {
-                for (int c = 0; c < output_shape[1]; c++) {
-                    for (int oh = 0; oh < output_shape[2]; oh++) {
-                        int ihStart = oh * stride.height - m_padding.top;
-                        int ihEnd = std::min<int>(ihStart + ksize.height, input_h);
-                        for (int ow = 0; ow < output_shape[3]; ow++) {
-                            int iwStart = ow * stride.width - m_padding.left;
-                            int iwEnd = std::min<int>(iwStart + ksize.width, input_w);
-                            ihStart = std::max<int>(ihStart, 0);
-                            iwStart = std::max<int>(iwStart, 0);
-                            int outIndex = oh * output_w + ow;
-                            T sumValue = 0.0;
-                            int count = 0;
-                            for (int ih = ihStart; ih < ihEnd; ih++) {
-                                for (int iw = iwStart; iw < iwEnd; iw++) {
-                                    int input_index = ih * input_w + iw;
-                                    sumValue += input_data[input_index];
-                                    count++;
-                                }
-                            }
-                            if (count == 0)
-                                output_data[outIndex] = 0;
-                            else
-                                output_data[outIndex] = sumValue / count;
-                            //if (count == 0)
-                            //	output_data[outIndex] = 0;
-                            //else if (count == m_kernel_h * m_kernel_w)
-                            //	output_data[outIndex] = sumValue / count;
-                            //else
-                            //	output_data[outIndex] = (sumValue + (m_kernel_h * m_kernel_w - count) * padding_value) / (m_kernel_h * m_kernel_w);
-                        }
-                    }
-                    input_data += input_channel_size;
-                    output_data += output_channel_size;
-                }
-            }
-            return true;
-        }
-
-        template<typename T>
-        static bool cpu_average_pooling_white(
-                const T *input_data, T *output_data,
-                const Shape &input_shape, const Shape &output_shape,
-                const KSize2D &ksize, const Stride2D &stride,
-                const Padding2D &m_padding) {
-            int input_h = input_shape[2];
-            int input_w = input_shape[3];
-            int output_h = output_shape[2];
-            int output_w = output_shape[3];
-            int input_channel_size = input_h * input_w;
-            int output_channel_size = output_h * output_w;
-            const int count = ksize.height * ksize.width;
-            for (int n = 0; n < output_shape[0]; n++) {
-                for (int c = 0; c < output_shape[1]; c++) {
-                    for (int oh = 0; oh < output_shape[2]; oh++) {
-                        int ihStart = oh * stride.height - m_padding.top;
-                        int ihEnd = std::min<int>(ihStart + ksize.height, input_h);
-                        for (int ow = 0; ow < output_shape[3]; ow++) {
-                            int iwStart = ow * stride.width - m_padding.left;
-                            int iwEnd = std::min<int>(iwStart + ksize.width, input_w);
-                            ihStart = std::max<int>(ihStart, 0);
-                            iwStart = std::max<int>(iwStart, 0);
-                            int outIndex = oh * output_w + ow;
-                            T sumValue = 0.0;
-                            for (int ih = ihStart; ih < ihEnd; ih++) {
-                                for (int iw = iwStart; iw < iwEnd; iw++) {
-                                    int input_index = ih * input_w + iw;
-                                    sumValue += input_data[input_index];
-                                }
-                            }
-                            output_data[outIndex] = sumValue / count;
-                        }
-                    }
-                    input_data += input_channel_size;
-                    output_data += output_channel_size;
-                }
-            }
-            return true;
-        }
-
         template<typename T>
         static void cpu_pooling2d_compute_run(
                 const Tensor &x, Pooling2DType type, const Padding2D &padding,
@@ -199,28 +58,15 @@ namespace ts {
 
             auto pooling_kernel = get_pooling_kernel<T>(padding, ksize, stride, type);
 
-            if (code == BLACK_MAX) {
-                if(pooling_kernel){
-                    pooling_kernel(x, out, padding);
-                }
-                else{
-                    cpu_max_pooling(x.data<T>(), out.data<T>(), x.sizes(), out.sizes(),
-                                    ksize, stride, padding);
-                }
-            } else if (code == BLACK_AVG) {
-                cpu_average_pooling(x.data<T>(), out.data<T>(), x.sizes(), out.sizes(),
-                                    ksize, stride, padding);
-            } else if (code == WHITE_MAX) {
+            if (code == BLACK_MAX || code == WHITE_MAX) {
                 if(pooling_kernel){
                     pooling_kernel(x, out, padding);
                 }
                 else{
-                    cpu_max_pooling(x.data<T>(), out.data<T>(), x.sizes(), out.sizes(),
-                                    ksize, stride, padding);
+                    PoolingAlgorithm<T>::max_pooling(x, out, padding, ksize, stride);
                 }
-            } else if (code == WHITE_AVG) {
-                cpu_average_pooling_white(x.data<T>(), out.data<T>(), x.sizes(), out.sizes(),
-                                          ksize, stride, padding);
+            } else if (code == BLACK_AVG || code == WHITE_AVG) {
+                PoolingAlgorithm<T>::avg_pooling(x, out, padding, ksize, stride, padding_type);
             } else {
                 TS_LOG_ERROR << "Pooling type only support MAX and AVG with BLACK and WHITE padding" << eject;
             }
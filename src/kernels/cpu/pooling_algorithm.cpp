@@ -4,7 +4,11 @@
 
 #include <kernels/cpu/pooling_algorithm.h>
 #include <kernels/common/simd.h>
+#include <kernels/common/openmp.h>
 #include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
 
 namespace ts{
     namespace cpu{
@@ -493,6 +497,219 @@ namespace ts{
             }
         }
 
+        /**
+         * Row helpers of separable pooling, float version use SIMD.
+         */
+        template<typename T>
+        struct PoolingRow {
+            // out[i] = max(a[i], b[i])
+            static void max(const T *a, const T *b, int width, T *out) {
+                for (int i = 0; i < width; ++i) out[i] = std::max(a[i], b[i]);
+            }
+
+            // out[i] = a[i] + b[i]
+            static void add(const T *a, const T *b, int width, T *out) {
+                for (int i = 0; i < width; ++i) out[i] = a[i] + b[i];
+            }
+
+            // out[i] = (a[i] - b[i]) * scale
+            static void sub_scale(const T *a, const T *b, T scale, int width, T *out) {
+                for (int i = 0; i < width; ++i) out[i] = (a[i] - b[i]) * scale;
+            }
+        };
+
+        template<>
+        struct PoolingRow<float> {
+            static void max(const float *a, const float *b, int width, float *out) {
+                int i = 0;
+                for (; i + 3 < width; i += 4) {
+                    max_float32x4(float32x4(a + i), float32x4(b + i)).store(out + i);
+                }
+                for (; i < width; ++i) out[i] = std::max(a[i], b[i]);
+            }
+
+            static void add(const float *a, const float *b, int width, float *out) {
+                int i = 0;
+                for (; i + 3 < width; i += 4) {
+                    (float32x4(a + i) + float32x4(b + i)).store(out + i);
+                }
+                for (; i < width; ++i) out[i] = a[i] + b[i];
+            }
+
+            static void sub_scale(const float *a, const float *b, float scale, int width, float *out) {
+                float32x4 scale_x4(scale);
+                int i = 0;
+                for (; i + 3 < width; i += 4) {
+                    ((float32x4(a + i) - float32x4(b + i)) * scale_x4).store(out + i);
+                }
+                for (; i < width; ++i) out[i] = (a[i] - b[i]) * scale;
+            }
+        };
+
+        /**
+         * Sliding window max of every window [p, p + ksize) in padded array x with stride 1,
+         *     using prefix and suffix max in blocks of ksize (van Herk/Gil-Werman),
+         *     so each window costs O(1) no matter how big the kernel is.
+         * @param x padded input, in [width, step]
+         * @param prefix, suffix buffer in [width, step]
+         * @param step number of values in each position, used to vectorize vertical pass
+         */
+        template<typename T>
+        static void running_max(const T *x, int width, int step, int ksize, T *prefix, T *suffix) {
+            auto row_bytes = sizeof(T) * step;
+            for (int begin = 0; begin < width; begin += ksize) {
+                auto end = std::min(width, begin + ksize);
+                std::memcpy(prefix + begin * step, x + begin * step, row_bytes);
+                for (int i = begin + 1; i < end; ++i) {
+                    PoolingRow<T>::max(prefix + (i - 1) * step, x + i * step, step, prefix + i * step);
+                }
+                std::memcpy(suffix + (end - 1) * step, x + (end - 1) * step, row_bytes);
+                for (int i = end - 2; i >= begin; --i) {
+                    PoolingRow<T>::max(suffix + (i + 1) * step, x + i * step, step, suffix + i * step);
+                }
+            }
+        }
+
+        template<typename T>
+        void PoolingAlgorithm<T>::max_pooling(const Tensor &input, Tensor &out,
+                                              const Padding2D &padding,
+                                              const KSize2D &ksize,
+                                              const Stride2D &stride) {
+            auto &input_shape = input.sizes();
+            auto &output_shape = out.sizes();
+
+            int planes = input_shape[0] * input_shape[1];
+            int input_height = input_shape[2];
+            int input_width = input_shape[3];
+            int output_height = output_shape[2];
+            int output_width = output_shape[3];
+
+            // padded size, pad value is lowest, so it acts as the window is clamped in the input
+            int padded_width = std::max(padding.left + input_width,
+                                        (output_width - 1) * stride.width + ksize.width);
+            int padded_height = std::max(padding.top + input_height,
+                                         (output_height - 1) * stride.height + ksize.height);
+
+            const T *input_data = input.data<T>();
+            T *output_data = out.data<T>();
+            const T lowest = std::numeric_limits<T>::lowest();
+
+            parallel_run([&](int, int plane_begin, int plane_end) {
+                std::vector<T> row(padded_width, lowest);
+                std::vector<T> row_prefix(padded_width);
+                std::vector<T> row_suffix(padded_width);
+                // horizontal result of each padded row, in [padded_height, output_width]
+                std::vector<T> plane(size_t(padded_height) * output_width, lowest);
+                std::vector<T> plane_prefix(plane.size());
+                std::vector<T> plane_suffix(plane.size());
+
+                for (int p = plane_begin; p < plane_end; ++p) {
+                    auto input_at = input_data + size_t(p) * input_height * input_width;
+                    auto output_at = output_data + size_t(p) * output_height * output_width;
+
+                    // horizontal pass
+                    for (int h = 0; h < input_height; ++h) {
+                        std::memcpy(row.data() + padding.left, input_at + h * input_width, input_width * sizeof(T));
+                        running_max(row.data(), padded_width, 1, ksize.width, row_prefix.data(), row_suffix.data());
+                        auto plane_at = plane.data() + size_t(padding.top + h) * output_width;
+                        if (stride.width == 1) {
+                            PoolingRow<T>::max(row_suffix.data(), row_prefix.data() + ksize.width - 1,
+                                               output_width, plane_at);
+                        } else {
+                            for (int w = 0; w < output_width; ++w) {
+                                auto iw = w * stride.width;
+                                plane_at[w] = std::max(row_suffix[iw], row_prefix[iw + ksize.width - 1]);
+                            }
+                        }
+                    }
+
+                    // vertical pass, vectorized on output width
+                    running_max(plane.data(), padded_height, output_width, ksize.height,
+                                plane_prefix.data(), plane_suffix.data());
+                    for (int h = 0; h < output_height; ++h) {
+                        auto ih = h * stride.height;
+                        PoolingRow<T>::max(plane_suffix.data() + size_t(ih) * output_width,
+                                           plane_prefix.data() + size_t(ih + ksize.height - 1) * output_width,
+                                           output_width, output_at + h * output_width);
+                    }
+                }
+            }, 0, planes);
+        }
+
+        template<typename T>
+        void PoolingAlgorithm<T>::avg_pooling(const Tensor &input, Tensor &out,
+                                              const Padding2D &padding,
+                                              const KSize2D &ksize,
+                                              const Stride2D &stride,
+                                              Padding2DType padding_type) {
+            auto &input_shape = input.sizes();
+            auto &output_shape = out.sizes();
+
+            int planes = input_shape[0] * input_shape[1];
+            int input_height = input_shape[2];
+            int input_width = input_shape[3];
+            int output_height = output_shape[2];
+            int output_width = output_shape[3];
+            bool count_pad = padding_type == Padding2DType::WHITE;
+
+            // clamped window of each output, computed once for all planes
+            std::vector<int> w_begin(output_width), w_end(output_width);
+            for (int w = 0; w < output_width; ++w) {
+                auto iw = w * stride.width - padding.left;
+                w_begin[w] = std::min(input_width, std::max(0, iw));
+                w_end[w] = std::max(w_begin[w], std::min(input_width, iw + ksize.width));
+            }
+            std::vector<int> h_begin(output_height), h_end(output_height);
+            for (int h = 0; h < output_height; ++h) {
+                auto ih = h * stride.height - padding.top;
+                h_begin[h] = std::min(input_height, std::max(0, ih));
+                h_end[h] = std::max(h_begin[h], std::min(input_height, ih + ksize.height));
+            }
+
+            // horizontal scale, which merged into row sum, vertical scale applied at last
+            std::vector<T> w_scale(output_width);
+            for (int w = 0; w < output_width; ++w) {
+                auto count = count_pad ? ksize.width : w_end[w] - w_begin[w];
+                w_scale[w] = count ? T(1) / count : T(0);
+            }
+
+            const T *input_data = input.data<T>();
+            T *output_data = out.data<T>();
+
+            parallel_run([&](int, int plane_begin, int plane_end) {
+                std::vector<T> row_sum(input_width + 1);
+                // prefix sum of horizontal average rows, in [input_height + 1, output_width]
+                std::vector<T> plane(size_t(input_height + 1) * output_width, T(0));
+
+                for (int p = plane_begin; p < plane_end; ++p) {
+                    auto input_at = input_data + size_t(p) * input_height * input_width;
+                    auto output_at = output_data + size_t(p) * output_height * output_width;
+
+                    for (int h = 0; h < input_height; ++h) {
+                        auto row = input_at + h * input_width;
+                        row_sum[0] = 0;
+                        for (int w = 0; w < input_width; ++w) {
+                            row_sum[w + 1] = row_sum[w] + row[w];
+                        }
+                        auto plane_at = plane.data() + size_t(h + 1) * output_width;
+                        auto plane_last = plane_at - output_width;
+                        for (int w = 0; w < output_width; ++w) {
+                            plane_at[w] = (row_sum[w_end[w]] - row_sum[w_begin[w]]) * w_scale[w];
+                        }
+                        PoolingRow<T>::add(plane_last, plane_at, output_width, plane_at);
+                    }
+
+                    for (int h = 0; h < output_height; ++h) {
+                        auto count = count_pad ? ksize.height : h_end[h] - h_begin[h];
+                        auto scale = count ? T(1) / count : T(0);
+                        PoolingRow<T>::sub_scale(plane.data() + size_t(h_end[h]) * output_width,
+                                                 plane.data() + size_t(h_begin[h]) * output_width,
+                                                 scale, output_width, output_at + h * output_width);
+                    }
+                }
+            }, 0, planes);
+        }
+
     }//cpu
 }//ts
 
@@ -76,8 +76,8 @@ namespace ts {
                 if (max_sizes_.size() > 0) {
                     TS_AUTO_CHECK_EQ(max_sizes_.size(), min_sizes_.size());
                     for (size_t i = 0; i < max_sizes_.size(); ++i) {
-                        TS_AUTO_CHECK_GT(max_sizes_[i], min_sizes_[i])
-                                << "max_size must be greater than min_size.";
+                        TS_CHECK_GT(max_sizes_[i], min_sizes_[i])
+                                << "max_size must be greater than min_size." << eject;
                         num_priors_ += 1;
                     }
                 }
@@ -8,9 +8,7 @@
 #include <utils/assert.h>
 
 #include "kernels/common/simd.h"
-#ifdef TS_USE_OPENMP
 #include "kernels/common/openmp.h"
-#endif
 
 namespace ts {
     namespace cpu {
@@ -83,10 +81,7 @@ namespace ts {
             int channal_offset = out_shape[2] * out_shape[3];
             int num_offset = out_shape[1] * channal_offset;
             for (int n = 0; n < out_shape[0]; n++){
-#ifdef TS_USE_OPENMP
-                #pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < out_shape[1]; c++){
+                parallel_for(0, out_shape[1], [&](int c) {
                     auto input_cur = input_data + n * num_offset + c * channal_offset;
                     float dequantize_scale = dequantize_scales[c];
                     float32x4x2 dequantize_scale_x4x2(dequantize_scale);
@@ -103,7 +98,7 @@ namespace ts {
                     for (int i = remain; i < count; i++){
                         *poutput++ = input_cur[i] * dequantize_scale;
                     }
-                }
+                });
             }
 
 //            auto input_data = output_int32.data<int32_t>();
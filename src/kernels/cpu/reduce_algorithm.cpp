@@ -0,0 +1,381 @@
+#include "kernels/cpu/reduce_algorithm.h"
+
+#include "kernels/common/simd.h"
+#include "kernels/common/openmp.h"
+#include "utils/assert.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace ts {
+    namespace cpu {
+        /**
+         * Each reducer has:
+         *     init(): initial value of accumulator
+         *     step(acc, x): accumulate one input value
+         *     merge(a, b): merge two accumulator
+         * float specialization also supply float32x4 version for SIMD.
+         */
+        template<typename T>
+        struct ReduceSumOp {
+            static T init() { return T(0); }
+            static T step(T acc, T x) { return T(acc + x); }
+            static T merge(T a, T b) { return T(a + b); }
+        };
+
+        template<typename T>
+        struct ReduceSumSquareOp {
+            static T init() { return T(0); }
+            static T step(T acc, T x) { return T(acc + x * x); }
+            static T merge(T a, T b) { return T(a + b); }
+        };
+
+        template<typename T>
+        struct ReduceMaxOp {
+            static T init() { return std::numeric_limits<T>::lowest(); }
+            static T step(T acc, T x) { return std::max(acc, x); }
+            static T merge(T a, T b) { return std::max(a, b); }
+        };
+
+        template<typename T>
+        struct ReduceMinOp {
+            static T init() { return std::numeric_limits<T>::max(); }
+            static T step(T acc, T x) { return std::min(acc, x); }
+            static T merge(T a, T b) { return std::min(a, b); }
+        };
+
+        template<>
+        struct ReduceSumOp<float> {
+            static float init() { return 0; }
+            static float step(float acc, float x) { return acc + x; }
+            static float merge(float a, float b) { return a + b; }
+            static float32x4 step(const float32x4 &acc, const float32x4 &x) { return acc + x; }
+            static float32x4 merge(const float32x4 &a, const float32x4 &b) { return a + b; }
+        };
+
+        template<>
+        struct ReduceSumSquareOp<float> {
+            static float init() { return 0; }
+            static float step(float acc, float x) { return acc + x * x; }
+            static float merge(float a, float b) { return a + b; }
+            static float32x4 step(const float32x4 &acc, const float32x4 &x) { return fmadd(x, x, acc); }
+            static float32x4 merge(const float32x4 &a, const float32x4 &b) { return a + b; }
+        };
+
+        template<>
+        struct ReduceMaxOp<float> {
+            static float init() { return std::numeric_limits<float>::lowest(); }
+            static float step(float acc, float x) { return std::max(acc, x); }
+            static float merge(float a, float b) { return std::max(a, b); }
+            static float32x4 step(const float32x4 &acc, const float32x4 &x) { return max_float32x4(acc, x); }
+            static float32x4 merge(const float32x4 &a, const float32x4 &b) { return max_float32x4(a, b); }
+        };
+
+        template<>
+        struct ReduceMinOp<float> {
+            static float init() { return std::numeric_limits<float>::max(); }
+            static float step(float acc, float x) { return std::min(acc, x); }
+            static float merge(float a, float b) { return std::min(a, b); }
+            static float32x4 step(const float32x4 &acc, const float32x4 &x) { return min_float32x4(acc, x); }
+            static float32x4 merge(const float32x4 &a, const float32x4 &b) { return min_float32x4(a, b); }
+        };
+
+        /**
+         * Row kernels, the generic version use 4 independent scalar accumulators,
+         * so the compiler can keep them in registers and hide the latency of each add.
+         */
+        template<typename T, typename Op>
+        struct ReduceRow {
+            /**
+             * @return reduce of x[0:size]
+             */
+            static T contiguous(const T *x, int size) {
+                T acc0 = Op::init(), acc1 = Op::init(), acc2 = Op::init(), acc3 = Op::init();
+                int i = 0;
+                for (; i + 3 < size; i += 4) {
+                    acc0 = Op::step(acc0, x[i]);
+                    acc1 = Op::step(acc1, x[i + 1]);
+                    acc2 = Op::step(acc2, x[i + 2]);
+                    acc3 = Op::step(acc3, x[i + 3]);
+                }
+                for (; i < size; ++i) {
+                    acc0 = Op::step(acc0, x[i]);
+                }
+                return Op::merge(Op::merge(acc0, acc1), Op::merge(acc2, acc3));
+            }
+
+            /**
+             * out[0:width] = step(out[0:width], x[0:width])
+             */
+            static void accumulate(const T *x, int width, T *out) {
+                for (int i = 0; i < width; ++i) {
+                    out[i] = Op::step(out[i], x[i]);
+                }
+            }
+        };
+
+        template<typename Op>
+        struct ReduceRow<float, Op> {
+            static float contiguous(const float *x, int size) {
+                float32x4 acc0(Op::init()), acc1(Op::init()), acc2(Op::init()), acc3(Op::init());
+                int i = 0;
+                for (; i + 15 < size; i += 16) {
+                    acc0 = Op::step(acc0, float32x4(x + i));
+                    acc1 = Op::step(acc1, float32x4(x + i + 4));
+                    acc2 = Op::step(acc2, float32x4(x + i + 8));
+                    acc3 = Op::step(acc3, float32x4(x + i + 12));
+                }
+                for (; i + 3 < size; i += 4) {
+                    acc0 = Op::step(acc0, float32x4(x + i));
+                }
+                acc0 = Op::merge(Op::merge(acc0, acc1), Op::merge(acc2, acc3));
+                float buffer[4];
+                acc0.store(buffer);
+                float acc = Op::merge(Op::merge(buffer[0], buffer[1]), Op::merge(buffer[2], buffer[3]));
+                for (; i < size; ++i) {
+                    acc = Op::step(acc, x[i]);
+                }
+                return acc;
+            }
+
+            static void accumulate(const float *x, int width, float *out) {
+                int i = 0;
+                for (; i + 15 < width; i += 16) {
+                    Op::step(float32x4(out + i), float32x4(x + i)).store(out + i);
+                    Op::step(float32x4(out + i + 4), float32x4(x + i + 4)).store(out + i + 4);
+                    Op::step(float32x4(out + i + 8), float32x4(x + i + 8)).store(out + i + 8);
+                    Op::step(float32x4(out + i + 12), float32x4(x + i + 12)).store(out + i + 12);
+                }
+                for (; i + 3 < width; i += 4) {
+                    Op::step(float32x4(out + i), float32x4(x + i)).store(out + i);
+                }
+                for (; i < width; ++i) {
+                    out[i] = Op::step(out[i], x[i]);
+                }
+            }
+        };
+
+        /**
+         * Minimum number of elements each thread should reduce, avoid parallel on tiny workload.
+         */
+        static const int REDUCE_GRAIN = 4096;
+        /**
+         * Inner block of strided reduction, keep the accumulator row in L1 cache.
+         */
+        static const int REDUCE_INNER_BLOCK = 256;
+
+        template<typename T, typename Op>
+        static void reduce_contiguous(const T *x, int outer, int size, T *out) {
+            auto threads = openmp_threads();
+            auto chunks = std::min(threads, size / REDUCE_GRAIN);
+
+            if (outer >= threads || chunks <= 1) {
+                // each thread reduces REDUCE_GRAIN elements at least
+                auto grain = std::max(1, REDUCE_GRAIN / std::max(size, 1));
+                parallel_for(0, outer, [&](int o) {
+                    out[o] = ReduceRow<T, Op>::contiguous(x + int64_t(o) * size, size);
+                }, grain);
+                return;
+            }
+
+            // split reduced dim into chunks, then combine partial results as tree
+            std::vector<T> partial(size_t(outer) * chunks);
+            auto chunk_size = (size + chunks - 1) / chunks;
+            auto tasks = outer * chunks;
+            parallel_for(0, tasks, [&](int t) {
+                auto o = t / chunks;
+                auto c = t % chunks;
+                auto begin = c * chunk_size;
+                auto end = std::min(size, begin + chunk_size);
+                partial[t] = begin < end
+                             ? ReduceRow<T, Op>::contiguous(x + int64_t(o) * size + begin, end - begin)
+                             : Op::init();
+            });
+            for (int o = 0; o < outer; ++o) {
+                auto local = partial.data() + size_t(o) * chunks;
+                for (int step = 1; step < chunks; step <<= 1) {
+                    for (int i = 0; i + step < chunks; i += step << 1) {
+                        local[i] = Op::merge(local[i], local[i + step]);
+                    }
+                }
+                out[o] = local[0];
+            }
+        }
+
+        template<typename T, typename Op>
+        static void reduce_strided(const T *x, int outer, int size, int inner, T *out) {
+            auto blocks = (inner + REDUCE_INNER_BLOCK - 1) / REDUCE_INNER_BLOCK;
+            auto tasks = outer * blocks;
+            auto grain = std::max(1, REDUCE_GRAIN / std::max(size * std::min(inner, REDUCE_INNER_BLOCK), 1));
+            parallel_for(0, tasks, [&](int t) {
+                auto o = t / blocks;
+                auto begin = (t % blocks) * REDUCE_INNER_BLOCK;
+                auto width = std::min(inner - begin, REDUCE_INNER_BLOCK);
+                auto local_x = x + int64_t(o) * size * inner + begin;
+                auto local_out = out + int64_t(o) * inner + begin;
+                std::fill(local_out, local_out + width, Op::init());
+                for (int s = 0; s < size; ++s) {
+                    ReduceRow<T, Op>::accumulate(local_x, width, local_out);
+                    local_x += inner;
+                }
+            }, grain);
+        }
+
+        template<typename T, typename Op>
+        static void reduce_core(const T *x, int outer, int size, int inner, T *out) {
+            if (inner == 1) {
+                reduce_contiguous<T, Op>(x, outer, size, out);
+            } else {
+                reduce_strided<T, Op>(x, outer, size, inner, out);
+            }
+        }
+
+        template<typename T>
+        static void reduce_core(const T *x, int outer, int size, int inner, ReduceType type, T *out) {
+            switch (type) {
+                case ReduceType::SUM:
+                case ReduceType::MEAN:
+                    reduce_core<T, ReduceSumOp<T>>(x, outer, size, inner, out);
+                    break;
+                case ReduceType::MAX:
+                    reduce_core<T, ReduceMaxOp<T>>(x, outer, size, inner, out);
+                    break;
+                case ReduceType::MIN:
+                    reduce_core<T, ReduceMinOp<T>>(x, outer, size, inner, out);
+                    break;
+                case ReduceType::SUM_SQUARE:
+                    reduce_core<T, ReduceSumSquareOp<T>>(x, outer, size, inner, out);
+                    break;
+            }
+        }
+
+        template<typename T>
+        static void scale_mean(T *out, int64_t count, int size) {
+            for (int64_t i = 0; i < count; ++i) {
+                out[i] /= size;
+            }
+        }
+
+        template<>
+        void scale_mean<float>(float *out, int64_t count, int size) {
+            auto scale = 1.0f / size;
+            float32x4 scale_x4(scale);
+            int64_t i = 0;
+            for (; i + 3 < count; i += 4) {
+                (float32x4(out + i) * scale_x4).store(out + i);
+            }
+            for (; i < count; ++i) {
+                out[i] *= scale;
+            }
+        }
+
+        template<typename T>
+        void ReduceAlgorithm<T>::reduce(const T *x, int outer, int size, int inner, ReduceType type, T *out) {
+            reduce_core<T>(x, outer, size, inner, type, out);
+            if (type == ReduceType::MEAN) {
+                scale_mean<T>(out, int64_t(outer) * inner, size);
+            }
+        }
+
+        template<typename T>
+        void ReduceAlgorithm<T>::reduce(const T *x, const std::vector<int> &shape, const std::vector<int> &axes,
+                                        ReduceType type, T *out) {
+            auto dims = int(shape.size());
+            std::vector<bool> reduced(shape.size(), false);
+            for (auto axis : axes) {
+                auto fixed_axis = axis >= 0 ? axis : axis + dims;
+                TS_AUTO_CHECK(fixed_axis >= 0 && fixed_axis < dims);
+                reduced[fixed_axis] = true;
+            }
+
+            // merge adjacent axes with same reduce flag, and drop size 1 axes
+            std::vector<int> merged_size;
+            std::vector<bool> merged_reduced;
+            int reduce_count = 1;
+            for (int i = 0; i < dims; ++i) {
+                if (reduced[i]) reduce_count *= shape[i];
+                if (shape[i] == 1) continue;
+                if (!merged_size.empty() && merged_reduced.back() == reduced[i]) {
+                    merged_size.back() *= shape[i];
+                } else {
+                    merged_size.push_back(shape[i]);
+                    merged_reduced.push_back(reduced[i]);
+                }
+            }
+
+            int64_t out_count = 1;
+            for (int i = 0; i < dims; ++i) {
+                if (!reduced[i]) out_count *= shape[i];
+            }
+
+            if (reduce_count == 0) {
+                // reduce on empty set
+                std::fill(out, out + out_count, T(0));
+                return;
+            }
+
+            std::vector<int> groups;
+            for (size_t i = 0; i < merged_reduced.size(); ++i) {
+                if (merged_reduced[i]) groups.push_back(int(i));
+            }
+
+            if (groups.empty()) {
+                // nothing to reduce, every output comes from exactly one input
+                if (type == ReduceType::SUM_SQUARE) {
+                    for (int64_t i = 0; i < out_count; ++i) out[i] = T(x[i] * x[i]);
+                } else {
+                    std::copy(x, x + out_count, out);
+                }
+                return;
+            }
+
+            // reduce from the last group, so the leading layout is unchanged after each pass
+            std::vector<T> buffer[2];
+            auto current_shape = merged_size;
+            const T *current_input = x;
+            auto first_type = type == ReduceType::MEAN ? ReduceType::SUM : type;
+            auto rest_type = first_type == ReduceType::SUM_SQUARE ? ReduceType::SUM : first_type;
+            for (auto it = groups.rbegin(); it != groups.rend(); ++it) {
+                auto group = *it;
+                auto outer = std::accumulate(current_shape.begin(), current_shape.begin() + group,
+                                             1, std::multiplies<int>());
+                auto size = current_shape[group];
+                auto inner = std::accumulate(current_shape.begin() + group + 1, current_shape.end(),
+                                             1, std::multiplies<int>());
+                T *current_output = out;
+                if (it + 1 != groups.rend()) {
+                    auto &local_buffer = buffer[(it - groups.rbegin()) % 2];
+                    local_buffer.resize(size_t(outer) * inner);
+                    current_output = local_buffer.data();
+                }
+                reduce_core<T>(current_input, outer, size, inner,
+                               it == groups.rbegin() ? first_type : rest_type, current_output);
+                current_shape[group] = 1;
+                current_input = current_output;
+            }
+
+            if (type == ReduceType::MEAN) {
+                scale_mean<T>(out, out_count, reduce_count);
+            }
+        }
+
+        template<typename T>
+        void ReduceAlgorithm<T>::reduce(const Tensor &x, const std::vector<int> &axes, ReduceType type, Tensor &out) {
+            auto &sizes = x.sizes();
+            std::vector<int> shape(sizes.begin(), sizes.end());
+            reduce(x.data<T>(), shape, axes, type, out.data<T>());
+        }
+    }
+}
+
+template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::INT8>::declare>;
+template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::UINT8>::declare>;
+template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::INT16>::declare>;
+template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::UINT16>::declare>;
+template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::INT32>::declare>;
+template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::UINT32>::declare>;
+template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::INT64>::declare>;
+template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::UINT64>::declare>;
+template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::FLOAT32>::declare>;
+template class ts::cpu::ReduceAlgorithm<ts::dtype<ts::FLOAT64>::declare>;
@@ -8,7 +8,7 @@
 #include <math.h>
 #include <numeric>
 
-#include <kernels/common/simd.h>
+#include <kernels/cpu/reduce_algorithm.h>
 
 namespace ts {
     namespace cpu {
@@ -24,41 +24,9 @@ namespace ts {
 
 namespace ts {
 	namespace cpu {
-	    //NOTE:dims is must be continuous now
         template<typename T>
         void cpu_reduce_mean_compute_run(const Tensor &x, std::vector<int> dims, Tensor &out) {
-            int dims_size = int(dims.size());
-            auto &size = x.sizes();
-            auto number = std::accumulate(size.begin(), size.begin() + dims[0], 1, std::multiplies<int32_t>());
-            int channels = 1;
-            for (int i = 0; i < dims_size; i++){
-                channels *= size[dims[i]];
-            }
-            auto width = std::accumulate(size.begin() + dims[dims_size - 1] + 1, size.end(), 1, std::multiplies<int32_t>());
-
-            auto input_data = x.data<T>();
-            auto output_data = out.data<T>();
-            auto output_count = out.count();
-
-            std::memset(output_data, 0, output_count * out.proto().type_bytes());
-
-            for (int i = 0; i < number; ++i) {
-                for (int c = 0; c < channels; ++c) {
-                    auto local_input_data = input_data + (i * channels + c) * width;
-                    auto local_output_data = output_data + i * width;
-                    for (int w = 0; w < width; ++w) {
-                        *local_output_data += *local_input_data;
-                        ++local_input_data;
-                        ++local_output_data;
-                    }
-                }
-            }
-
-            auto local_output_data = output_data;
-            for (int i = 0; i < output_count; ++i) {
-                *local_output_data /= channels;
-                ++local_output_data;
-            }
+            ReduceAlgorithm<T>::reduce(x, dims, ReduceType::MEAN, out);
         }
 
         void ReduceMean::reduce(const Tensor &x, std::vector<int> dims, Tensor &out) {
@@ -8,7 +8,7 @@
 #include <math.h>
 #include <numeric>
 
-#include <kernels/common/simd.h>
+#include <kernels/cpu/reduce_algorithm.h>
 
 namespace ts {
     namespace cpu {
@@ -26,28 +26,7 @@ namespace ts {
 	namespace cpu {
         template<typename T>
         void cpu_reduce_sum_compute_run(const Tensor &x, int dim, Tensor &out) {
-            auto &size = x.sizes();
-            auto number = std::accumulate(size.begin(), size.begin() + dim, 1, std::multiplies<int32_t>());
-            auto channels = size[dim];
-            auto width = std::accumulate(size.begin() + dim + 1, size.end(), 1, std::multiplies<int32_t>());
-
-            auto input_data = x.data<T>();
-            auto output_data = out.data<T>();
-            auto output_count = out.count();
-
-            std::memset(output_data, 0, output_count * out.proto().type_bytes());
-
-            for (int i = 0; i < number; ++i) {
-                for (int c = 0; c < channels; ++c) {
-                    auto local_input_data = input_data + (i * channels + c) * width;
-                    auto local_output_data = output_data + i * width;
-                    for (int w = 0; w < width; ++w) {
-                        *local_output_data += *local_input_data;
-                        ++local_input_data;
-                        ++local_output_data;
-                    }
-                }
-            }
+            ReduceAlgorithm<T>::reduce(x, {dim}, ReduceType::SUM, out);
         }
 
         void ReduceSum::reduce(const Tensor &x, int dim, Tensor &out) {
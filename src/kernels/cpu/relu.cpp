@@ -5,9 +5,7 @@
 #include "global/operator_factory.h"
 
 #include "kernels/common/simd.h"
-#ifdef TS_USE_OPENMP
 #include <kernels/common/openmp.h>
-#endif
 
 namespace ts {
     namespace cpu {
@@ -34,16 +32,13 @@ namespace ts {
             int count = out.count();
             int count_4 = count / 4;
             float32x4 const_mul(float(0.0));
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int i = 0; i < count_4; ++i) {
+            parallel_for(0, count_4, [&](int i) {
                 auto input_at = input_data + i * 4;
                 auto output_at = output_data + i * 4;
                 float32x4 input_x4(input_at);
                 float32x4 output_x4 = max_float32x4(input_x4, const_mul);
                 output_x4.store(output_at);
-            }
+            });
             for (int i = count_4 * 4; i < count; i++)
             {
                 float val = input_data[i];
@@ -5,9 +5,19 @@
 #include <backend/name.h>
 #include <core/device.h>
 #include <utils/assert.h>
+#include <runtime/inside/parallel.h>
+
+#include <algorithm>
+#include <cstring>
 
 namespace ts {
     namespace cpu {
+        /**
+         * Each patch row is contiguous in both feature map and output,
+         *     so row is copied in one memcpy, with columns out of feature map set zero.
+         * Patch bases and valid columns are computed once for each landmark of each sample,
+         *     and patches of different landmarks and samples are copied on threads.
+         */
         template<typename T>
         static inline void cpu_sample_compute_run(const Tensor &x, const Tensor &pos,
                                                   const Size2D &origin_patch, const Size2D &origin,
@@ -15,7 +25,6 @@ namespace ts {
             auto &feat_blob = x;
             auto &pos_blob = pos;
 
-
             int feat_h = feat_blob.size(2);
             int feat_w = feat_blob.size(3);
 
@@ -28,39 +37,45 @@ namespace ts {
             const float r_w = (feat_patch_w - 1) / 2.0f;
             const int landmark_num = out.size(3);
 
-            HypeShape pos_offset({pos.size(0), pos.size(1)});
-            HypeShape feat_offset(feat_blob.sizes());
-            HypeShape out_offset(out.sizes());
+            const int pos_step = pos.size(1);
+            const int feat_channel_step = feat_h * feat_w;
+            const int out_row_step = landmark_num * feat_patch_w;  // step of ph in output
+            const int out_channel_step = feat_patch_h * out_row_step;
 
             // offset
             T *const buff = out.data<T>();
             auto pos_data = pos_blob.data<T>();
             auto feat_data = feat_blob.data<T>();
 
-            T zero = 0;
+            TS_PARALLEL_FOR_BEGIN(task, 0, num * landmark_num)
+                const int n = task / landmark_num;
+                const int i = task % landmark_num;
+                // x1, y1, ..., xn, yn
+                // coordinate of the first patch pixel, scale to the feature map coordinate
+                const int y = int(pos_data[n * pos_step + 2 * i + 1] * (feat_h - 1) - r_h + 0.5f);
+                const int x = int(pos_data[n * pos_step + 2 * i] * (feat_w - 1) - r_w + 0.5f);
 
-            for (int i = 0; i < landmark_num; i++) {
-                for (int n = 0; n < num; n++) { // x1, y1, ..., xn, yn
-                    // coordinate of the first patch pixel, scale to the feature map coordinate
-                    const int y = int(pos_data[pos_offset.to_index({n, 2 * i + 1})] * (feat_h - 1) - r_h + 0.5f);
-                    const int x = int(pos_data[pos_offset.to_index({n, 2 * i})] * (feat_w - 1) - r_w + 0.5f);
+                // rows [top, bottom) and columns [left, right) of patch are in feature map, others are zero
+                const int top = std::min(std::max(-y, 0), feat_patch_h);
+                const int bottom = std::max(std::min(feat_h - y, feat_patch_h), top);
+                const int left = std::min(std::max(-x, 0), feat_patch_w);
+                const int right = std::max(std::min(feat_w - x, feat_patch_w), left);
 
-                    for (int c = 0; c < channels; c++) {
-                        for (int ph = 0; ph < feat_patch_h; ph++) {
-                            for (int pw = 0; pw < feat_patch_w; pw++) {
-                                const int y_p = y + ph;
-                                const int x_p = x + pw;
-                                // set zero if exceed the img bound
-                                if (y_p < 0 || y_p >= feat_h || x_p < 0 || x_p >= feat_w)
-                                    buff[out_offset.to_index({n, c, ph, i, pw})] = zero;
-                                else
-                                    buff[out_offset.to_index({n, c, ph, i, pw})] =
-                                            feat_data[feat_offset.to_index({n, c, y_p, x_p})];
-                            }
+                for (int c = 0; c < channels; c++) {
+                    auto feat_channel = feat_data + (n * channels + c) * feat_channel_step;
+                    auto out_at = buff + (n * channels + c) * out_channel_step + i * feat_patch_w;
+                    for (int ph = 0; ph < feat_patch_h; ph++, out_at += out_row_step) {
+                        if (ph < top || ph >= bottom) {
+                            std::memset(out_at, 0, feat_patch_w * sizeof(T));
+                            continue;
                         }
+                        auto feat_row = feat_channel + (y + ph) * feat_w + x;
+                        std::memset(out_at, 0, left * sizeof(T));
+                        std::memcpy(out_at + left, feat_row + left, (right - left) * sizeof(T));
+                        std::memset(out_at + right, 0, (feat_patch_w - right) * sizeof(T));
                     }
                 }
-            }
+            TS_PARALLEL_FOR_END()
         }
 
         void ShapeIndexPatch::sample(const Tensor &x, const Tensor &pos,
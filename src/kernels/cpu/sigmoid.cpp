@@ -5,9 +5,7 @@
 #include "global/operator_factory.h"
 
 #include "kernels/common/simd.h"
-#ifdef TS_USE_OPENMP
 #include <kernels/common/openmp.h>
-#endif
 
 namespace ts {
     namespace cpu {
@@ -26,13 +24,10 @@ namespace ts {
             int count = out.count();
 
             //std::memcpy(output_data, input_data, count * sizeof(T));
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-            for (int i = 0; i < count; i++) {
+            parallel_for(0, count, [&](int i) {
 
                 output_data[i] = T(1. / (1. + exp(neg(input_data[i]))));
-            }
+            });
         }
 
 //#ifdef TS_USE_SSE
@@ -6,9 +6,7 @@
 #include <math.h>
 
 #include <kernels/common/simd.h>
-#ifdef TS_USE_OPENMP
 #include <kernels/common/openmp.h>
-#endif
 
 namespace ts {
 	namespace cpu {
@@ -42,10 +40,7 @@ namespace ts {
 
             // as NCW format
             for (int n = 0; n < head_num; ++n) {
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int w = 0; w < tail_num; ++w) {
+                parallel_for(0, tail_num, [&](int w) {
                     auto channel_index = hype.to_index(n, 0, w);
                     const T *input_channel_data = &input_data[channel_index];
                     T *output_channel_data = &output_data[channel_index];
@@ -68,7 +63,7 @@ namespace ts {
                         loop_in += tail_num;
                         loop_out += tail_num;
                     }
-                }
+                });
             }
         }
 
@@ -102,10 +97,7 @@ namespace ts {
 
             // as NCW format
             for (int n = 0; n < head_num; ++n) {
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int w = 0; w < tail_num; ++w) {
+                parallel_for(0, tail_num, [&](int w) {
                     auto channel_index = hype.to_index(n, 0, w);
                     const T *input_channel_data = &input_data[channel_index];
                     T *output_channel_data = &output_data[channel_index];
@@ -135,7 +127,7 @@ namespace ts {
                         loop_in += tail_num;
                         loop_out += tail_num;
                     }
-                }
+                });
             }
         }
 
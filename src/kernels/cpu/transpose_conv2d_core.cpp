@@ -10,8 +10,12 @@
 #include <kernels/cpu/math_cpu.h>
 #include <kernels/cpu/im2col.h>
 
-#include <fstream>
+#include <runtime/inside/parallel.h>
 #include <frontend/intime.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
 //#include "kernels/common/simd.h"
 #ifdef TS_USE_CBLAS
 #include <kernels/cblas/math_cblas.h>
@@ -20,15 +24,14 @@
 /////////////////////////////////////////////////
 namespace ts {
     namespace cpu {
+        /**
+         * gemm of each sample into columns of output, then col2im
+         */
         template<typename T>
         static void
-        cpu_transpose_conv2d_nchw_compute_run(const Tensor &x, const Padding2D &padding, float padding_value,
-                                              const Tensor &w, const Stride2D &stride, const Dilation2D &dilation,
-                                              Tensor &out, Stack &stack, bool kernel_packed) {
-            if (kernel_packed) {
-                TS_LOG_ERROR << "No transpose_conv2d packed method defined." << eject;
-            }
-
+        cpu_transpose_conv2d_nchw_col2im_run(const Tensor &x, const Padding2D &padding, float padding_value,
+                                             const Tensor &w, const Stride2D &stride, const Dilation2D &dilation,
+                                             Tensor &out, Stack &stack) {
             auto weight_shape = w.sizes();
             auto output_shape = out.sizes();
             auto x_shape = x.sizes();
@@ -100,6 +103,226 @@ namespace ts {
             }
         }
 
+        /**
+         * Output index o of transposed conv on one axis gets input i by kernel tap k,
+         *     if o + pad == i * stride + k * dilation.
+         * So outputs with same (o + pad) % stride, called phase, are got by same taps,
+         *     output j of phase gets input (first + base + j - shift) by tap of each shift, which is small conv.
+         * All phases share columns of input over union of their shifts, and their kernels are stacked in one gemm.
+         */
+        struct SubPixelAxis {
+            struct Phase {
+                int begin = 0;  ///< first output index of phase
+                int count = 0;  ///< number of outputs in phase, strided by stride
+                int base = 0;   ///< column of first output
+                std::vector<int> taps;  ///< tap of each shift
+            };
+            std::vector<Phase> phases;
+            std::vector<int> shifts;
+            int first = 0;      ///< input index of column 0 by shift 0
+            int count = 0;      ///< number of columns
+        };
+
+        /**
+         * @return false if phases have different shifts, so stacking them computes zero taps
+         */
+        static bool sub_pixel_axis(int out_size, int pad, int stride, int kernel, int dilation, SubPixelAxis &axis) {
+            struct Phase {
+                int begin, count, base;
+                std::vector<int> taps, shifts;
+            };
+            std::vector<Phase> phases(stride);
+            for (int r = 0; r < stride; ++r) {
+                auto &phase = phases[r];
+                phase.begin = ((r - pad) % stride + stride) % stride;
+                phase.count = phase.begin < out_size ? (out_size - phase.begin + stride - 1) / stride : 0;
+                phase.base = (phase.begin + pad - r) / stride;
+                for (int k = 0; k < kernel; ++k) {
+                    if (k * dilation % stride != r) continue;
+                    phase.taps.push_back(k);
+                    phase.shifts.push_back((k * dilation - r) / stride);
+                }
+                if (r > 0 && phase.shifts != phases[0].shifts) return false;
+            }
+
+            axis = SubPixelAxis();
+            axis.shifts = phases[0].shifts;
+            int first = INT_MAX, last = INT_MIN;
+            for (auto &phase : phases) {
+                if (phase.count == 0) continue;
+                first = std::min(first, phase.base);
+                last = std::max(last, phase.base + phase.count);
+            }
+            if (first > last) return true;
+            axis.first = first;
+            axis.count = last - first;
+            for (auto &phase : phases) {
+                if (phase.count == 0) continue;
+                SubPixelAxis::Phase sub;
+                sub.begin = phase.begin;
+                sub.count = phase.count;
+                sub.base = phase.base - first;
+                sub.taps = phase.taps;
+                axis.phases.push_back(sub);
+            }
+            return true;
+        }
+
+        /**
+         * Transposed conv of stride (sh, sw) is computed as conv on input with sh * sw stacked sub-pixel kernels,
+         *     whose result is written interleaved into output, so no col2im needed.
+         * Like kernel 4 stride 2 pad 1, it is one gemm with K = 4 * input_channels,
+         *     and kernel equals stride uses input as columns directly.
+         * Kernels are packed once for all samples, copying runs on threads across channels.
+         */
+        template<typename T>
+        static void
+        cpu_transpose_conv2d_nchw_sub_pixel_run(const Tensor &x, const SubPixelAxis &axis_y,
+                                                const SubPixelAxis &axis_x, const Tensor &w, const Stride2D &stride,
+                                                Tensor &out, Stack &stack) {
+            auto weight_shape = w.sizes();
+            auto output_shape = out.sizes();
+            auto x_shape = x.sizes();
+
+            auto number = x_shape[0];
+            auto input_channels = weight_shape[0];
+            auto output_channels = weight_shape[1];
+            Size2D ksize(weight_shape[2], weight_shape[3]);
+            Size2D input(x_shape[2], x_shape[3]);
+            Size2D output(output_shape[2], output_shape[3]);
+            int input_number_offset = input_channels * input.height * input.width;
+            int output_number_offset = output_channels * output.height * output.width;
+
+            auto phases_x = int(axis_x.phases.size());
+            auto shifts = int(axis_y.shifts.size() * axis_x.shifts.size());
+            // M, N, K of gemm
+            int rows = int(axis_y.phases.size()) * phases_x * output_channels;
+            int spatial = axis_y.count * axis_x.count;
+            int kernel_dims = input_channels * shifts;
+            if (rows == 0 || spatial == 0) return;
+
+            bool direct = shifts == 1 && axis_y.shifts[0] == 0 && axis_x.shifts[0] == 0 &&
+                          axis_y.first == 0 && axis_x.first == 0 &&
+                          axis_y.count == input.height && axis_x.count == input.width;
+
+            // stacked kernel, [phases_y, phases_x, output_channels, input_channels, shifts_y, shifts_x]
+            Tensor kernel_tensor = stack.make(w.dtype(), {rows, kernel_dims}, MemoryDevice(CPU));
+            auto pkernel = kernel_tensor.data<T>();
+            auto pweight = w.data<T>();
+            TS_PARALLEL_FOR_BEGIN(row, 0, rows)
+                auto oc = row % output_channels;
+                auto &py = axis_y.phases[row / output_channels / phases_x];
+                auto &px = axis_x.phases[row / output_channels % phases_x];
+                auto kernel_row = pkernel + row * kernel_dims;
+                for (int ic = 0; ic < input_channels; ++ic) {
+                    auto kernel_at = pweight + (ic * output_channels + oc) * ksize.height * ksize.width;
+                    for (auto ky : py.taps) {
+                        for (auto kx : px.taps) {
+                            *kernel_row++ = kernel_at[ky * ksize.width + kx];
+                        }
+                    }
+                }
+            TS_PARALLEL_FOR_END()
+
+            Tensor col_tensor;
+            if (!direct) col_tensor = stack.make(out.dtype(), {kernel_dims, spatial}, MemoryDevice(CPU));
+            Tensor sub_pixel_tensor = stack.make(out.dtype(), {rows, spatial}, MemoryDevice(CPU));
+            auto col_buffer = col_tensor.data<T>();
+            auto sub_pixel = sub_pixel_tensor.data<T>();
+
+#ifndef TS_USE_CBLAS
+            // kernel is packed once for all samples, columns are packed in each gemm
+            Tensor packed_kernel_tensor = stack.make(w.dtype(), {rows, kernel_dims}, MemoryDevice(CPU));
+            Tensor packed_col_tensor = stack.make(out.dtype(), {kernel_dims, spatial}, MemoryDevice(CPU));
+            auto packed_kernel = packed_kernel_tensor.data<T>();
+            auto packed_col = packed_col_tensor.data<T>();
+            cpu::math<T, T>::pack8_A(rows, kernel_dims, pkernel, kernel_dims, packed_kernel);
+#endif
+
+            const T *pinput = x.data<T>();
+            T *poutput = out.data<T>();
+
+            for (int n = 0; n < number; ++n) {
+                const T *columns = pinput;
+                if (!direct) {
+                    // columns, [input_channels, shifts_y, shifts_x, count_y, count_x]
+                    TS_PARALLEL_FOR_BEGIN(ic, 0, input_channels)
+                        auto input_channel = pinput + ic * input.height * input.width;
+                        auto col_at = col_buffer + ic * shifts * spatial;
+                        for (auto shift_y : axis_y.shifts) {
+                            for (auto shift_x : axis_x.shifts) {
+                                // columns [left, right) of row get input, others get 0
+                                auto left = std::min(std::max(shift_x - axis_x.first, 0), axis_x.count);
+                                auto right = std::max(std::min(input.width + shift_x - axis_x.first, axis_x.count), left);
+                                for (int j = 0; j < axis_y.count; ++j) {
+                                    auto iy = axis_y.first + j - shift_y;
+                                    if (iy < 0 || iy >= input.height) {
+                                        std::fill(col_at, col_at + axis_x.count, T(0));
+                                        col_at += axis_x.count;
+                                        continue;
+                                    }
+                                    auto input_row = input_channel + iy * input.width + axis_x.first - shift_x;
+                                    std::fill(col_at, col_at + left, T(0));
+                                    std::memcpy(col_at + left, input_row + left, (right - left) * sizeof(T));
+                                    std::fill(col_at + right, col_at + axis_x.count, T(0));
+                                    col_at += axis_x.count;
+                                }
+                            }
+                        }
+                    TS_PARALLEL_FOR_END()
+                    columns = col_buffer;
+                }
+
+#ifdef TS_USE_CBLAS
+                cblas::math<T>::gemm(ts::blas::NoTrans, ts::blas::NoTrans, rows, spatial, kernel_dims,
+                                     1.0, pkernel, columns, 0, sub_pixel);
+#else
+                cpu::math<T, T>::gemm(rows, spatial, kernel_dims, T(1), packed_kernel, nullptr,
+                                      columns, packed_col, T(0), sub_pixel, false, true);
+#endif
+
+                // interleave into output
+                TS_PARALLEL_FOR_BEGIN(row, 0, rows)
+                    auto oc = row % output_channels;
+                    auto &py = axis_y.phases[row / output_channels / phases_x];
+                    auto &px = axis_x.phases[row / output_channels % phases_x];
+                    auto sub_pixel_at = sub_pixel + row * spatial + py.base * axis_x.count + px.base;
+                    auto output_at = poutput + oc * output.height * output.width + py.begin * output.width + px.begin;
+                    for (int j = 0; j < py.count; ++j) {
+                        for (int k = 0; k < px.count; ++k) {
+                            output_at[k * stride.width] = sub_pixel_at[k];
+                        }
+                        sub_pixel_at += axis_x.count;
+                        output_at += stride.height * output.width;
+                    }
+                TS_PARALLEL_FOR_END()
+
+                pinput += input_number_offset;
+                poutput += output_number_offset;
+            }
+        }
+
+        template<typename T>
+        static void
+        cpu_transpose_conv2d_nchw_compute_run(const Tensor &x, const Padding2D &padding, float padding_value,
+                                              const Tensor &w, const Stride2D &stride, const Dilation2D &dilation,
+                                              Tensor &out, Stack &stack, bool kernel_packed) {
+            if (kernel_packed) {
+                TS_LOG_ERROR << "No transpose_conv2d packed method defined." << eject;
+            }
+
+            // sub-pixel when no zero taps stacked, like kernel is multiple of stride, which is usual upsampling
+            SubPixelAxis axis_y, axis_x;
+            if (stride.height * stride.width > 1 &&
+                sub_pixel_axis(out.size(2), padding.top, stride.height, w.size(2), dilation.height, axis_y) &&
+                sub_pixel_axis(out.size(3), padding.left, stride.width, w.size(3), dilation.width, axis_x)) {
+                cpu_transpose_conv2d_nchw_sub_pixel_run<T>(x, axis_y, axis_x, w, stride, out, stack);
+                return;
+            }
+
+            cpu_transpose_conv2d_nchw_col2im_run<T>(x, padding, padding_value, w, stride, dilation, out, stack);
+        }
+
         void Conv2DTransposeCore::conv2d_transpose(const Tensor &x, const Padding2D &padding, float padding_value,
                                                    const Tensor &w,
                                                    const Stride2D &stride, const Dilation2D &dilation,
@@ -7,9 +7,7 @@
 #include "kernels/common/function.h"
 #include "kernels/cpu/math_cpu.h"
 #include "kernels/cpu/pad2d_algorithm.h"
-#ifdef TS_USE_OPENMP
 #include "kernels/common/openmp.h"
-#endif
 #include <array>
 
 namespace ts{
@@ -75,11 +73,7 @@ namespace ts{
 
             for (int p = 0; p < out_channel; p++)
             {
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int q = 0; q < input_channel; q++)
-                {
+                parallel_for(0, input_channel, [&](int q) {
                     const float *kernel_at = p_kernel + p * kernel_num_offset + q * 9;
                     float *kernel_trans_at = p_kernel_trans + p * input_channel + q;
 
@@ -104,7 +98,7 @@ namespace ts{
                             kernel_trans_at[(i * 4 + j) * stride] = tmp[0][j] * G[i][0] + tmp[1][j] * G[i][1] + tmp[2][j] * G[i][2];
                         }
                     }
-                }
+                });
             }
 
             //gemm pack A
@@ -171,10 +165,7 @@ namespace ts{
             float *out_ptr = x_tm.data<float>();
 
             for (int n = 0; n < num; ++n) {
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < input_channel; ++c) {
+                parallel_for(0, input_channel, [&](int c) {
 
                     float t00,t01,t02,t03;
                     float t10,t11,t12,t13;
@@ -239,7 +230,7 @@ namespace ts{
                             ++tile_index;
                         }
                     }
-                }
+                });
             }
         }
 
@@ -291,10 +282,7 @@ namespace ts{
             float *out_ptr = out.data<float>();
 
             for (int n = 0; n < num; ++n) {
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < out_channel; ++c) {
+                parallel_for(0, out_channel, [&](int c) {
                     int tile_offset = 0;
                     const float *out_tm_cur = out_tm_ptr + n * out_tm_num_offset + c * tile_count;
                     float *out_cur = out_ptr + n * out_num_offset + c * out_channel_offset;
@@ -339,7 +327,7 @@ namespace ts{
                             ++tile_offset;
                         }
                     }
-                }
+                });
             }
         }
 
@@ -525,10 +513,7 @@ namespace ts{
             };
 
             for (int p = 0; p < out_channel; ++p) {
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int q = 0; q < input_channel; ++q) {
+                parallel_for(0, input_channel, [&](int q) {
                     const float *kernel_at = p_kernel + p * kernel_num_offset + q * 9;
                     float *kernel_trans_at = p_kernel_trans + p * input_channel + q;
 
@@ -550,7 +535,7 @@ namespace ts{
                             kernel_trans_at[(i * 8 + j) * stride] = tmp[0][j] * G[i][0] + tmp[1][j] * G[i][1] + tmp[2][j] * G[i][2];
                         }
                     }
-                }
+                });
             }
 
             //gemm pack A
@@ -620,10 +605,7 @@ namespace ts{
             float *out_ptr = x_tm.data<float>();
 
             for (int n = 0; n < num; ++n) {
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < input_channel; ++c) {
+                parallel_for(0, input_channel, [&](int c) {
                     const float *input_cur = input_ptr + n * input_num_offset + c * input_channel_offset;
                     float *out_cur = out_ptr + n * out_num_offset + c * tile_count;
 
@@ -694,7 +676,7 @@ namespace ts{
                             ++tile_index;
                         }
                     }
-                }
+                });
             }
         }
 
@@ -751,10 +733,7 @@ namespace ts{
             float *out_ptr = out.data<float>();
 
             for (int n = 0; n < num; ++n) {
-#ifdef TS_USE_OPENMP
-#pragma omp parallel for num_threads(openmp_threads())
-#endif
-                for (int c = 0; c < out_channel; ++c) {
+                parallel_for(0, out_channel, [&](int c) {
                     float tmpA[8][6];
                     int tile_offset = 0;
                     const float *out_tm_cur = out_tm_ptr + n * out_tm_num_offset + c * tile_count;
@@ -828,7 +807,7 @@ namespace ts{
                             ++tile_offset;
                         }
                     }
-                }
+                });
             }
         }
 
@@ -80,13 +80,13 @@ namespace ts {
         // printf("Channels: %d %d\n", channels, channels_kernel);
         // printf("Channels: %d %d\n", channels_out, channels_kernel);
 
-        TS_AUTO_CHECK(kernel_h_ == kernel_h && kernel_w_ == kernel_w)
+        TS_CHECK(kernel_h_ == kernel_h && kernel_w_ == kernel_w)
                 ("Input shape and kernel shape wont match: (")
-                (kernel_h_)(" x ")(kernel_w)(" vs. ")(kernel_h_)(" x ")(kernel_w_)(").");
+                (kernel_h_)(" x ")(kernel_w)(" vs. ")(kernel_h_)(" x ")(kernel_w_)(").") << eject;
 
-        TS_AUTO_CHECK(channels == channels_kernel)
+        TS_CHECK(channels == channels_kernel)
                 ("Input shape and kernel channels wont match: (")
-                (channels)(" vs. ")(channels_kernel)(").");
+                (channels)(" vs. ")(channels_kernel)(").") << eject;
 
         const int height_out = (height + 2 * pad_h - (dilation_h * (kernel_h - 1) + 1)) / stride_h + 1;
         const int width_out = (width + 2 * pad_w - (dilation_w * (kernel_w - 1) + 1)) / stride_w + 1;
@@ -0,0 +1,118 @@
+#include "memory/budget.h"
+#include "runtime/runtime.h"
+
+#include <unordered_map>
+#include <mutex>
+#include <sstream>
+
+namespace ts {
+    MemoryBudget::MemoryBudget(uint64_t limit)
+            : m_limit(limit), m_used(0), m_peak(0), m_refused(0), m_degraded(0) {
+    }
+
+    void MemoryBudget::set_limit(uint64_t limit) {
+        m_limit = limit;
+    }
+
+    uint64_t MemoryBudget::available() const {
+        uint64_t limit = m_limit;
+        if (limit == 0) return UINT64_MAX;
+        uint64_t used = m_used;
+        return used < limit ? limit - used : 0;
+    }
+
+    std::string MemoryBudget::summary() const {
+        std::ostringstream oss;
+        oss << "{\"limit\": \"" << (limited() ? memory_size_string(m_limit) : "unlimited") << "\""
+            << ", \"used\": \"" << memory_size_string(m_used) << "\""
+            << ", \"peak\": \"" << memory_size_string(m_peak) << "\""
+            << ", \"refused\": " << m_refused
+            << ", \"degraded\": " << m_degraded
+            << "}";
+        return oss.str();
+    }
+
+    bool MemoryBudget::acquire(uint64_t size) {
+        uint64_t used = m_used;
+        while (true) {
+            uint64_t limit = m_limit;
+            if (limit > 0 && used + size > limit) return false;
+            if (m_used.compare_exchange_weak(used, used + size)) break;
+        }
+        used += size;
+        uint64_t peak = m_peak;
+        while (peak < used && !m_peak.compare_exchange_weak(peak, used));
+        return true;
+    }
+
+    void MemoryBudget::release(uint64_t size) {
+        m_used -= size;
+    }
+
+    /**
+     * size of each block allocated by wrapped allocator, free gives no size
+     */
+    class BudgetBlocks {
+    public:
+        void insert(void *mem, uint64_t size) {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            m_blocks[mem] = size;
+        }
+
+        uint64_t erase(void *mem) {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            auto it = m_blocks.find(mem);
+            if (it == m_blocks.end()) return 0;
+            auto size = it->second;
+            m_blocks.erase(it);
+            return size;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::unordered_map<void *, uint64_t> m_blocks;
+    };
+
+    HardAllocator::function MemoryBudget::wrap(const MemoryDevice &device, const HardAllocator::function &allocator,
+                                               const reclaimer &reclaim) {
+        auto blocks = std::make_shared<BudgetBlocks>();
+        // memory could be freed after workbench released, so budget is kept by allocator
+        auto budget = shared_from_this();
+        auto charge = [budget, device, reclaim](uint64_t size) {
+            if (budget->acquire(size)) return;
+            if (reclaim && reclaim() > 0 && budget->acquire(size)) return;
+            ++budget->m_refused;
+            throw OutOfMemoryException(device, size);
+        };
+        return [budget, blocks, allocator, charge](int id, size_t new_size, void *mem, size_t mem_size) -> void * {
+            if (new_size == 0) {
+                allocator(id, 0, mem, 0);
+                budget->release(blocks->erase(mem));
+                return nullptr;
+            }
+            if (mem != nullptr && mem_size == 0) {
+                // free then malloc, content not kept
+                allocator(id, 0, mem, 0);
+                budget->release(blocks->erase(mem));
+                mem = nullptr;
+            }
+            charge(new_size);
+            void *new_mem = nullptr;
+            try {
+                new_mem = allocator(id, new_size, mem, mem_size);
+            } catch (...) {
+                budget->release(new_size);
+                throw;
+            }
+            if (mem != nullptr) budget->release(blocks->erase(mem));
+            blocks->insert(new_mem, new_size);
+            return new_mem;
+        };
+    }
+
+    MemoryBudget::shared MemoryBudget::Running() {
+        auto runtime = ctx::get<RuntimeContext>();
+        if (!runtime) return nullptr;
+        return runtime->memory_budget();
+    }
+}
@@ -21,10 +21,23 @@ namespace ts {
         std::shared_ptr<Vat> m_vat;
     };
 
-    VatMemoryController::VatMemoryController(const MemoryDevice &device) {
+    VatMemoryController::VatMemoryController(const MemoryDevice &device)
+            : self(nullptr, device) {
+    }
+
+    VatMemoryController::VatMemoryController(const MemoryBudget::shared &budget, const MemoryDevice &device) {
         TS_AUTO_CHECK(m_impl.get() != nullptr);
         auto hard_allocator = HardAllocator::Query(device.type());
         TS_CHECK(hard_allocator != nullptr) << "Can not found memory controller for " << device.type();
+        // vat created after its allocator, set later
+        auto weak_vat = std::make_shared<std::weak_ptr<Vat>>();
+        if (budget) {
+            // vat is not locked, only trimmed by allocation in same thread
+            hard_allocator = budget->wrap(device, hard_allocator, [weak_vat]() -> uint64_t {
+                auto vat = weak_vat->lock();
+                return vat ? vat->trim(0) : 0;
+            });
+        }
         using namespace std::placeholders;
         auto hard_free = std::bind(hard_allocator, device.id(), 0, _1, 0);
         auto pot_allocator = [hard_allocator, device, hard_free](size_t size) -> std::shared_ptr<void> {
@@ -33,6 +46,7 @@ namespace ts {
 
         m_impl->m_device = device;
         m_impl->m_vat = std::make_shared<Vat>(pot_allocator);
+        *weak_vat = m_impl->m_vat;
         auto &vat = m_impl->m_vat;
         m_impl->m_managed_allocator = [vat](int, size_t new_size, void *mem, size_t mem_size) -> void * {
             void *new_mem = nullptr;
@@ -68,6 +82,10 @@ namespace ts {
         return m_impl->m_vat->summary();
     }
 
+    uint64_t VatMemoryController::trim(uint64_t high_water) {
+        return m_impl->m_vat->trim(high_water);
+    }
+
     class StackMemoryBlock {
     public:
         using self = StackMemoryBlock;
@@ -22,6 +22,9 @@ namespace ts {
 
     void *Pot::malloc(size_t _size) {
         if (_size > m_capacity) {
+            // release old memory first, content is not kept, so only one block is held
+            m_data.reset();
+            m_capacity = 0;
             m_data = m_allocator(_size);
             m_capacity = _size;
         }
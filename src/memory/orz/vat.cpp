@@ -46,16 +46,20 @@ namespace ts {
 
     void *Vat::malloc(size_t _size) {
         if (_size == 0) return nullptr;
-        // find first small piece
-        Pot pot(m_allocator);
+        void *ptr = nullptr;
+        // find first small piece, pots are moved, for copying allocator of pot is not cheap
         if (!m_heap.empty())
         {
             auto i = binary_find(m_heap, _size);
-            pot = m_heap[i];
+            Pot pot = std::move(m_heap[i]);
             m_heap.erase(m_heap.begin() + i);
+            ptr = pot.malloc(_size);
+            m_dict.insert(std::make_pair(ptr, std::move(pot)));
+        } else {
+            Pot pot(m_allocator);
+            ptr = pot.malloc(_size);
+            m_dict.insert(std::make_pair(ptr, std::move(pot)));
         }
-        void *ptr = pot.malloc(_size);
-        m_dict.insert(std::pair<void *, Pot>(ptr, pot));
 
         return ptr;
     }
@@ -70,9 +74,10 @@ namespace ts {
 
         if (!m_deprecated) {
             auto &pot = it->second;
-            auto i = binary_find(m_heap, pot.capacity());
+            // insert before first bigger pot, or at end if none, keep heap sorted small first
+            auto i = binary_find(m_heap, pot.capacity(), 0, int(m_heap.size()));
             auto ind = m_heap.begin() + i;
-            m_heap.insert(ind, pot);
+            m_heap.insert(ind, std::move(pot));
         }
 
         m_dict.erase(it);
@@ -128,4 +133,17 @@ namespace ts {
         }
         return sum;
     }
+
+    uint64_t Vat::trim(uint64_t high_water) {
+        auto sum = this->summary();
+        uint64_t released = 0;
+        // heap is sorted small first
+        while (sum > high_water && !m_heap.empty()) {
+            auto capacity = m_heap.back().capacity();
+            m_heap.pop_back();
+            sum -= capacity;
+            released += capacity;
+        }
+        return released;
+    }
 }
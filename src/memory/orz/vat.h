@@ -6,13 +6,14 @@
 #define ORZ_MEM_VAT_H
 
 #include "pot.h"
+#include <utils/api.h>
 #include <vector>
 #include <map>
 #include <unordered_map>
 
 namespace ts {
 
-    class Vat {
+    class TS_DEBUG_API Vat {
     public:
         using self = Vat;
 
@@ -57,6 +58,14 @@ namespace ts {
         Vat &operator=(Vat &&that);
 
         uint64_t summary() const;
+
+        /**
+         * release free pots, biggest first, until summary not more than high_water
+         * @param high_water bytes to keep
+         * @return released bytes
+         * @note pots in use are never released
+         */
+        uint64_t trim(uint64_t high_water);
     private:
         Vat(const Vat &that) = delete;
 
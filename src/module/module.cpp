@@ -195,42 +195,53 @@ namespace ts {
     using set = std::unordered_set<K>;
 
     std::vector<std::pair<Node, int>> Module::list_reference_nodes(const std::vector<Node> &nodes) {
-        map<Node, int> map_node_depth;
-        std::deque<Node> node_walker; // top_down
-
+        // count references of each node, walk each node and edge once
+        map<Node, int> map_node_ref_count;
+        std::vector<Node> node_walker;
         for (auto &node : nodes) {
-            auto it = map_node_depth.find(node);
-            if (it != map_node_depth.end()) continue;
-            node_walker.push_back(node);
-            map_node_depth.insert(std::make_pair(node, 1));
+            if (map_node_ref_count.insert(std::make_pair(node, 0)).second) node_walker.push_back(node);
         }
-
         while (!node_walker.empty()) {
-            auto node = node_walker.front();
-            node_walker.pop_front();
-            auto depth = map_node_depth[node];
+            auto node = node_walker.back();
+            node_walker.pop_back();
             for (auto &input : node.inputs()) {
-                auto input_depth_pair = map_node_depth.find(input);
-                if (input_depth_pair == map_node_depth.end()) {
-                    map_node_depth.insert(std::make_pair(input, depth + 1));
+                auto it = map_node_ref_count.find(input);
+                if (it == map_node_ref_count.end()) {
+                    map_node_ref_count.insert(std::make_pair(input, 1));
                     node_walker.push_back(input);
                 } else {
-                    auto this_input_depth = depth + 1;
-                    if (input_depth_pair->second < this_input_depth) {
-                        input_depth_pair->second = this_input_depth;
-                        node_walker.push_back(input);   // re-walk nodes
-                    }
+                    ++it->second;
                 }
             }
         }
 
-        std::vector<std::pair<Node, int>> computation_schedule(map_node_depth.begin(), map_node_depth.end());
-        std::sort(computation_schedule.begin(), computation_schedule.end(),
+        // top_down, node's depth is final after all nodes referencing it walked
+        map<Node, int> map_node_depth;
+        for (auto &node : nodes) map_node_depth[node] = 1;
+        for (auto &pair : map_node_ref_count) {
+            if (pair.second == 0) node_walker.push_back(pair.first);
+        }
+
+        std::vector<std::pair<Node, int>> computation_schedule;
+        computation_schedule.reserve(map_node_ref_count.size());
+        while (!node_walker.empty()) {
+            auto node = node_walker.back();
+            node_walker.pop_back();
+            auto depth = map_node_depth[node];
+            computation_schedule.emplace_back(node, depth);
+            for (auto &input : node.inputs()) {
+                auto &input_depth = map_node_depth[input];
+                if (input_depth < depth + 1) input_depth = depth + 1;
+                if (--map_node_ref_count[input] == 0) node_walker.push_back(input);
+            }
+        }
+
+        std::stable_sort(computation_schedule.begin(), computation_schedule.end(),
                   [](const std::pair<Node, int> &lhs, const std::pair<Node, int> &rhs){
                       return lhs.second > rhs.second;
                   });
 
-        return std::move(computation_schedule);
+        return computation_schedule;
     }
 
     void Module::Save(StreamWriter &stream, Module::shared module, Module::SerializationFormat format) {
@@ -0,0 +1,115 @@
+#include "runtime/capture.h"
+#include "runtime/instruction.h"
+#include "core/memory.h"
+#include "utils/log.h"
+
+#include <unordered_map>
+
+namespace ts {
+    Capture::Capture(const Program &program, const std::vector<std::string> &node_names, int slots, int interval)
+            : m_names(node_names) {
+        if (slots < 1) {
+            TS_LOG_ERROR << "Capture slots must be positive, got " << slots << eject;
+        }
+        set_interval(interval);
+
+        std::unordered_map<std::string, int> ids;
+        for (size_t i = 0; i < m_names.size(); ++i) {
+            ids.insert(std::make_pair(m_names[i], int(i)));
+        }
+
+        auto length = program.length();
+        m_index.resize(length, -1);
+        m_nresults.resize(length, 0);
+        for (size_t i = 0; i < length; ++i) {
+            auto op = dynamic_cast<OperatorInstruction *>(program.instruction(i).get());
+            if (op == nullptr || op->nresults() < 1) continue;
+            auto it = ids.find(op->op()->name());
+            if (it == ids.end()) continue;
+            m_index[i] = it->second;
+            m_nresults[i] = op->nresults();
+        }
+
+        m_controller = std::make_shared<DynamicMemoryController>(MemoryDevice(CPU));
+        // one more slot for writing by running
+        m_slots.resize(size_t(slots) + 1);
+        for (auto &slot : m_slots) {
+            slot.values.resize(m_names.size());
+            slot.written.resize(m_names.size(), false);
+        }
+    }
+
+    void Capture::set_interval(int interval) {
+        if (interval < 0) {
+            TS_LOG_ERROR << "Capture interval must be non-negative, got " << interval << eject;
+        }
+        m_interval = interval;
+    }
+
+    bool Capture::sample() {
+        if (m_interval == 0) return false;
+        auto serial = ++m_serial;
+        if ((serial - 1) % uint64_t(m_interval) != 0) return false;
+        auto &slot = m_slots[m_writing];
+        slot.serial = serial;
+        std::fill(slot.written.begin(), slot.written.end(), false);
+        return true;
+    }
+
+    void Capture::capture(size_t instruction, const Stack &stack) {
+        auto id = index_of(instruction);
+        if (id < 0) return;
+        auto &slot = m_slots[m_writing];
+        auto value = *stack.index(-m_nresults[instruction]);
+        if (value.packed()) value = value.field(0);
+
+        auto &captured = slot.values[id];
+        if (captured.empty() || !(captured.proto() == value.proto())) {
+            captured = Tensor(m_controller, value.proto());
+        }
+        auto bytes = size_t(value.count()) * value.proto().type_bytes();
+        memcpy(captured.data(), captured.device(), bytes,
+               value.data(), value.device(), bytes);
+        slot.written[id] = true;
+    }
+
+    void Capture::commit() {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        m_ring.push_front(m_writing);
+        if (m_ring.size() < m_slots.size()) {
+            // unused slot left
+            m_writing = m_ring.size();
+            return;
+        }
+        // reuse the oldest slot
+        m_writing = m_ring.back();
+        m_ring.pop_back();
+    }
+
+    int Capture::count() const {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        return int(m_ring.size());
+    }
+
+    Tensor Capture::captured(int age, const std::string &name) const {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        if (age < 0 || size_t(age) >= m_ring.size()) return Tensor();
+        auto &slot = m_slots[m_ring[age]];
+        for (size_t i = 0; i < m_names.size(); ++i) {
+            if (m_names[i] == name && slot.written[i]) return slot.values[i];
+        }
+        return Tensor();
+    }
+
+    uint64_t Capture::serial(int age) const {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        if (age < 0 || size_t(age) >= m_ring.size()) return 0;
+        return m_slots[m_ring[age]].serial;
+    }
+
+    void Capture::clear() {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        m_ring.clear();
+        m_writing = 0;
+    }
+}
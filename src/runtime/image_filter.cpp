@@ -12,8 +12,10 @@
 #include "backend/name.h"
 #include "core/tensor_builder.h"
 #include "runtime/workbench.h"
+#include "backend/common_structure.h"
 
 #include <numeric>
+#include <algorithm>
 
 namespace ts {
 
@@ -42,11 +44,178 @@ namespace ts {
         m_impl->m_compiled = false;
     }
 
+    /**
+     * Part of filter chain lowered to one image_preprocess node:
+     *     [resize] [to_float] [channel_swap] [scale, sub_mean, div_std...] [to_chw]
+     * resize and channel_swap can be in any order before normalizing.
+     */
+    class FusedFilter {
+    public:
+        /**
+         * try fusing node after fused ones, nothing changed if node can not be fused
+         * @param node filter op node, input 0 is filter chain
+         * @return if node fused
+         */
+        bool fuse(const Node &node) {
+            auto &op = node->op();
+            if (op == name::layer::to_float()) {
+                m_float = true;
+            } else if (op == name::layer::resize2d()) {
+                if (m_resize || m_chw || !m_scale.empty() || !m_shift.empty()) return false;
+                if (node.inputs().size() != 2 || node.input(1)->op() != Bubble::Const) return false;
+                auto size = tensor::array::to_int(node.input(1)->get(name::value));
+                if (size.size() != 4 || size[0] >= 0 || size[3] >= 0 || size[1] <= 0 || size[2] <= 0) return false;
+                auto type = node->has(name::type)
+                            ? Resize2DType(tensor::to_int(node->get(name::type)))
+                            : Resize2DType::LINEAR;
+                if (type != Resize2DType::LINEAR && type != Resize2DType::NEAREST) return false;
+                m_resize = true;
+                m_height = size[1];
+                m_width = size[2];
+                m_type = type;
+                m_cast_after_resize = !m_float;
+            } else if (op == name::layer::dimshuffle()) {
+                if (m_chw || tensor::to_int(node->get(name::dim)) != 3) return false;
+                auto shuffle = tensor::array::to_int(node->get(name::shuffle));
+                std::vector<int32_t> fused_shuffle;
+                std::vector<float> scale, shift;
+                for (auto c : shuffle) {
+                    if (c < 0) return false;
+                    if (!m_shuffle.empty() && c >= int(m_shuffle.size())) return false;
+                    if (m_scale.size() > 1 && c >= int(m_scale.size())) return false;
+                    if (m_shift.size() > 1 && c >= int(m_shift.size())) return false;
+                    fused_shuffle.push_back(m_shuffle.empty() ? c : m_shuffle[c]);
+                    if (m_scale.size() > 1) scale.push_back(m_scale[c]);
+                    if (m_shift.size() > 1) shift.push_back(m_shift[c]);
+                }
+                m_shuffle = fused_shuffle;
+                if (m_scale.size() > 1) m_scale = scale;
+                if (m_shift.size() > 1) m_shift = shift;
+            } else if (op == name::layer::sub() || op == name::layer::mul()) {
+                if (!m_float || m_chw) return false;
+                if (node.inputs().size() != 2 || node.input(1)->op() != Bubble::Const) return false;
+                auto value = node.input(1)->get(name::value);
+                if (value.dtype() != FLOAT32 || value.dims() > 4) return false;
+                for (int i = 0; i + 1 < value.dims(); ++i) {
+                    if (value.size(i) != 1) return false;
+                }
+                auto operand = tensor::array::to_float(value);
+                auto channels = std::max(std::max(m_scale.size(), m_shift.size()), operand.size());
+                if (!fit(operand, channels) || !fit(m_scale, channels) || !fit(m_shift, channels)) return false;
+                if (!m_shuffle.empty() && channels > 1 && channels != m_shuffle.size()) return false;
+                auto scale = expand(m_scale, channels, 1.0f);
+                auto shift = expand(m_shift, channels, 0.0f);
+                for (size_t c = 0; c < channels; ++c) {
+                    auto v = operand.size() == 1 ? operand[0] : operand[c];
+                    if (op == name::layer::sub()) {
+                        shift[c] -= v;
+                    } else {
+                        scale[c] *= v;
+                        shift[c] *= v;
+                    }
+                }
+                m_scale = scale;
+                m_shift = shift;
+            } else if (op == name::layer::transpose()) {
+                if (m_chw) return false;
+                if (tensor::array::to_int(node->get(name::permute)) != std::vector<int32_t>({0, 3, 1, 2})) return false;
+                m_chw = true;
+            } else {
+                return false;
+            }
+            ++m_count;
+            return true;
+        }
+
+        int count() const { return m_count; }
+
+        Node make(const std::string &name, const Node &x) const {
+            auto node = bubble::op(name, name::layer::image_preprocess(), {x});
+            if (m_resize) {
+                node->set(name::size, tensor::build(INT32, {m_height, m_width}));
+                node->set(name::type, tensor::from(int32_t(m_type)));
+                node->set(name::cast_after_resize, tensor::from<bool>(m_cast_after_resize));
+            }
+            if (m_float) node->set(name::dtype, tensor::from(int32_t(FLOAT32)));
+            if (!m_shuffle.empty()) node->set(name::shuffle, tensor::build(INT32, m_shuffle));
+            if (!m_scale.empty()) node->set(name::scale, tensor::build(FLOAT32, m_scale));
+            if (!m_shift.empty()) node->set(name::shift, tensor::build(FLOAT32, m_shift));
+            node->set(name::format, tensor::from(m_chw ? name::NCHW : name::NHWC));
+            return node;
+        }
+
+    private:
+        static bool fit(const std::vector<float> &values, size_t channels) {
+            return values.size() <= 1 || values.size() == channels;
+        }
+
+        static std::vector<float> expand(const std::vector<float> &values, size_t channels, float identity) {
+            if (values.empty()) return std::vector<float>(channels, identity);
+            if (values.size() == 1) return std::vector<float>(channels, values[0]);
+            return values;
+        }
+
+        int m_count = 0;
+        bool m_float = false;
+        bool m_resize = false;
+        int m_height = -1;
+        int m_width = -1;
+        Resize2DType m_type = Resize2DType::LINEAR;
+        bool m_cast_after_resize = false;
+        std::vector<int32_t> m_shuffle;
+        std::vector<float> m_scale;
+        std::vector<float> m_shift;
+        bool m_chw = false;
+    };
+
+    /**
+     * lower fusible runs of filter chain to image_preprocess, each run makes one pass over image
+     * @param graph filter chain
+     * @return graph with fused filters, or given graph if nothing fused
+     */
+    static Graph fuse_filters(const Graph &graph) {
+        std::vector<Node> chain;
+        auto top = graph.nodes().back();
+        while (top->op() != Bubble::Parameter) {
+            chain.push_back(top);
+            if (top.inputs().empty()) return graph;
+            top = top.input(0);
+        }
+        std::reverse(chain.begin(), chain.end());
+
+        Graph fused;
+        ctx::bind<Graph> _bind_graph(fused);
+        auto x = fused.make(top.bubble());
+        bool changed = false;
+        for (size_t i = 0; i < chain.size();) {
+            FusedFilter filter;
+            size_t end = i;
+            while (end < chain.size() && filter.fuse(chain[end])) ++end;
+            if (filter.count() > 1) {
+                x = filter.make(chain[end - 1]->name(), x);
+                changed = true;
+                i = end;
+                continue;
+            }
+            auto &node = chain[i];
+            auto copied = fused.make(node.bubble());
+            std::vector<Node> inputs = {x};
+            auto node_inputs = node.inputs();
+            for (size_t j = 1; j < node_inputs.size(); ++j) {
+                inputs.push_back(fused.make(node_inputs[j].bubble()));
+            }
+            Node::Link(copied, inputs);
+            x = copied;
+            ++i;
+        }
+        return changed ? fused : graph;
+    }
+
     void ImageFilter::compile() {
         if (m_impl->m_compiled) return;
         if (m_impl->m_graph->nodes().size() > 1) {
             Module::shared module = std::make_shared<Module>();
-            module->load(*m_impl->m_graph);
+            module->load(fuse_filters(*m_impl->m_graph));
             m_impl->m_program = Program::Compile(module, m_impl->m_computing_device);
         }
         m_impl->m_compiled = true;
@@ -205,6 +374,10 @@ namespace ts {
         return dolly;
     }
 
+    const ComputingDevice &ImageFilter::device() const {
+        return m_impl->m_computing_device;
+    }
+
     ImageFilter::ImageFilter(const ImageFilter::Implement &other) {
         m_impl->m_computing_device = other.m_computing_device;
         this->clear();
@@ -4,6 +4,15 @@
 
 #include "runtime/inside/thread_pool.h"
 #include "utils/ctxmgr_lite_support.h"
+#include "utils/platform.h"
+
+#include <algorithm>
+#include <chrono>
+
+#if TS_PLATFORM_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace ts {
 
@@ -51,77 +60,260 @@ namespace ts {
         }
     }
 
+    /**
+     * id of thread in parallel task, 0 for threads not in pool
+     */
+    static TS_LITE_THREAD_LOCAL int tls_thread_id = 0;
+    /**
+     * if thread is running in pool, parallel in it will be run in calling thread
+     */
+    static TS_LITE_THREAD_LOCAL bool tls_in_parallel = false;
+
+    class ParallelGuard {
+    public:
+        explicit ParallelGuard(int signet)
+                : m_thread_id(tls_thread_id), m_in_parallel(tls_in_parallel) {
+            tls_thread_id = signet;
+            tls_in_parallel = true;
+        }
+
+        ~ParallelGuard() {
+            tls_thread_id = m_thread_id;
+            tls_in_parallel = m_in_parallel;
+        }
+
+    private:
+        int m_thread_id;
+        bool m_in_parallel;
+    };
+
     ThreadPool::ThreadPool(size_t pool_size)
-            : thread_pool(pool_size) {
-        for (int i = 0; i < static_cast<int>(pool_size); ++i) {
-            thread_pool[i] = new Thread();
-            running_core.push_back(i);   // push all cartridge into chest
+            : m_generation(0), m_sleeping(0)
+            , m_next_chunk(0), m_done_chunks(0), m_working(0)
+            , m_policy(int32_t(WaitPolicy::HYBRID)), m_spin_time(100) {
+        for (size_t i = 1; i < pool_size; ++i) {
+            m_threads.emplace_back(&ThreadPool::operating, this, int(i));
         }
     }
 
     ThreadPool::~ThreadPool() {
-        for (int i = 0; i < static_cast<int>(thread_pool.size()); ++i) {
-            delete thread_pool[i];
+        join();
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            m_stop = true;
+            ++m_generation;
+            m_cond.notify_all();
         }
+        for (auto &thread : m_threads) thread.join();
     }
 
     Thread *ThreadPool::run(const Thread::task_type &task) {
-        if (thread_pool.size() == 0) {
-            task(0);
-            return nullptr;
-        } else {
-            int signet = load();
-            Thread *cart = this->thread_pool[signet];
-            cart->run(signet, task,
-                      Thread::after_task_type(std::bind(&ThreadPool::recycling_thread, this, std::placeholders::_1)));
-            return cart;
-        }
-
+        return run(task, nullptr);
     }
 
     Thread *ThreadPool::run(const Thread::task_type &task, const Thread::after_task_type &after_task) {
-        if (thread_pool.size() == 0) {
+        if (m_threads.empty()) {
             task(0);
+            if (after_task) after_task(0);
             return nullptr;
-        } else {
-            int signet = load();
-            Thread *cart = this->thread_pool[signet];
-            cart->run(signet, task, [this, after_task](int id) -> void {
-                after_task(id);
-                this->recycling_thread(id);
-            });
-            return cart;
         }
-    }
-
-    int ThreadPool::load() {
-        std::unique_lock<std::mutex> locker(running_core_mutex);
-        while (this->running_core.empty()) running_core_cond.wait(locker);
-        int signet = this->running_core.front();
-        this->running_core.pop_front();
-        return signet;
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_queue.emplace_back(task, after_task);
+        ++m_generation;
+        m_cond.notify_all();
+        return nullptr;
     }
 
     void ThreadPool::join() {
-        std::unique_lock<std::mutex> locker(running_core_mutex);
-        while (this->running_core.size() != this->thread_pool.size()) running_core_cond.wait(locker);
+        std::unique_lock<std::mutex> locker(m_mutex);
+        while (!m_queue.empty() || m_running) m_done_cond.wait(locker);
     }
 
     bool ThreadPool::busy() {
-        if (!running_core_mutex.try_lock()) return false;
-        bool is_busy = this->running_core.size() != this->thread_pool.size();
-        running_core_mutex.unlock();
+        if (!m_mutex.try_lock()) return false;
+        bool is_busy = !m_queue.empty() || m_running;
+        m_mutex.unlock();
         return is_busy;
     }
 
     size_t ThreadPool::size() const {
-        return thread_pool.size();
+        return m_threads.size() + 1;
+    }
+
+    void ThreadPool::parallel(int64_t begin, int64_t end, int64_t grain, const range_task_type &task) {
+        if (end <= begin) return;
+        grain = std::max<int64_t>(grain, 1);
+        auto count = end - begin;
+        if (m_threads.empty() || tls_in_parallel || count <= grain) {
+            task(tls_thread_id, begin, end);
+            return;
+        }
+
+        std::unique_lock<std::mutex> parallel_locker(m_parallel_mutex);
+
+        // few more chunks than threads, so late waking threads won't block others
+        auto threads = int64_t(size());
+        auto chunk = std::max<int64_t>(grain, (count + threads * 4 - 1) / (threads * 4));
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            m_task = &task;
+            m_begin = begin;
+            m_end = end;
+            m_chunk = chunk;
+            m_chunks = (count + chunk - 1) / chunk;
+            m_next_chunk = 0;
+            m_done_chunks = 0;
+            m_exception = nullptr;
+            ++m_generation;
+            if (m_sleeping > 0) m_cond.notify_all();
+            ++m_working;
+        }
+
+        join_parallel(0);
+
+        // wait all chunks done
+        auto spin_end = std::chrono::steady_clock::now() + std::chrono::microseconds(m_spin_time.load());
+        while (m_done_chunks.load() < m_chunks) {
+            if (std::chrono::steady_clock::now() < spin_end) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> locker(m_mutex);
+            while (m_done_chunks.load() < m_chunks) m_done_cond.wait(locker);
+        }
+
+        std::exception_ptr exception;
+        {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            m_task = nullptr;
+            exception = m_exception;
+            m_exception = nullptr;
+        }
+        // threads took task must leave before next task set
+        while (m_working.load() > 0) std::this_thread::yield();
+
+        if (exception) std::rethrow_exception(exception);
+    }
+
+    void ThreadPool::join_parallel(int signet) {
+        // m_working already increased by caller
+        ParallelGuard _guard(signet);
+        while (true) {
+            auto i = m_next_chunk.fetch_add(1);
+            if (i >= m_chunks) break;
+            auto chunk_begin = m_begin + i * m_chunk;
+            auto chunk_end = std::min(m_end, chunk_begin + m_chunk);
+            try {
+                (*m_task)(signet, chunk_begin, chunk_end);
+            } catch (...) {
+                std::unique_lock<std::mutex> locker(m_mutex);
+                if (!m_exception) m_exception = std::current_exception();
+            }
+            if (m_done_chunks.fetch_add(1) + 1 == m_chunks) {
+                std::unique_lock<std::mutex> locker(m_mutex);
+                m_done_cond.notify_all();
+            }
+        }
+        --m_working;
+    }
+
+    void ThreadPool::wait_generation(uint64_t generation) {
+        auto policy = WaitPolicy(m_policy.load());
+        if (policy != WaitPolicy::PASSIVE) {
+            auto spin_end = std::chrono::steady_clock::now() + std::chrono::microseconds(m_spin_time.load());
+            while (m_generation.load() == generation) {
+                if (policy == WaitPolicy::HYBRID && std::chrono::steady_clock::now() >= spin_end) break;
+                std::this_thread::yield();
+            }
+        }
+        std::unique_lock<std::mutex> locker(m_mutex);
+        ++m_sleeping;
+        while (m_generation.load() == generation) m_cond.wait(locker);
+        --m_sleeping;
+    }
+
+    void ThreadPool::operating(int signet) {
+        // worker is in parallel until it leaves pool
+        ParallelGuard _guard(signet);
+        uint64_t generation = 0;
+        while (true) {
+            wait_generation(generation);
+
+            std::unique_lock<std::mutex> locker(m_mutex);
+            generation = m_generation.load();
+            if (m_stop) break;
+
+            if (m_task != nullptr && m_next_chunk.load() < m_chunks) {
+                ++m_working;
+                locker.unlock();
+                join_parallel(signet);
+                locker.lock();
+            }
+
+            while (!m_queue.empty()) {
+                auto task = m_queue.front();
+                m_queue.pop_front();
+                ++m_running;
+                locker.unlock();
+                task.first(signet);
+                if (task.second) task.second(signet);
+                locker.lock();
+                --m_running;
+                if (m_queue.empty() && m_running == 0) m_done_cond.notify_all();
+            }
+        }
+    }
+
+    void ThreadPool::set_wait_policy(WaitPolicy policy) {
+        m_policy = int32_t(policy);
+    }
+
+    ThreadPool::WaitPolicy ThreadPool::get_wait_policy() const {
+        return WaitPolicy(m_policy.load());
+    }
+
+    void ThreadPool::set_spin_time(int spin_time) {
+        m_spin_time = std::max(spin_time, 0);
+    }
+
+    int ThreadPool::get_spin_time() const {
+        return m_spin_time.load();
+    }
+
+    bool ThreadPool::set_affinity(const std::vector<int> &cpu_ids) {
+        std::unique_lock<std::mutex> parallel_locker(m_parallel_mutex);
+        m_affinity = cpu_ids;
+        bool succeed = true;
+        for (int i = 1; i < int(size()); ++i) {
+            succeed = bind_affinity(i) && succeed;
+        }
+        return succeed;
+    }
+
+    const std::vector<int> &ThreadPool::get_affinity() const {
+        return m_affinity;
+    }
+
+    bool ThreadPool::bind_affinity(int signet) {
+#if TS_PLATFORM_OS_LINUX
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (m_affinity.empty()) {
+            auto cpu_num = int(std::thread::hardware_concurrency());
+            for (int i = 0; i < cpu_num; ++i) CPU_SET(i, &mask);
+        } else {
+            CPU_SET(m_affinity[signet % m_affinity.size()], &mask);
+        }
+        auto handle = m_threads[signet - 1].native_handle();
+        return pthread_setaffinity_np(handle, sizeof(mask), &mask) == 0;
+#else
+        (void)(signet);
+        return m_affinity.empty();
+#endif
     }
 
-    void ThreadPool::recycling_thread(int signet) {
-        std::unique_lock<std::mutex> locker(running_core_mutex);
-        this->running_core.push_front(signet);
-        running_core_cond.notify_all();
+    int ThreadPool::ThreadID() {
+        return tls_thread_id;
     }
 }
 
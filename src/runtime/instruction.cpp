@@ -42,7 +42,7 @@ namespace ts {
 
 #ifdef TS_USE_HOOK
         {
-            auto hook = ctx::get<Hook>();
+            auto hook = workbench.running_hook();
             if (hook) hook->emit_before_run({&stack, &*m_func});
         };
 #endif
@@ -69,7 +69,7 @@ namespace ts {
 
 #ifdef TS_USE_HOOK
         {
-            auto hook = ctx::get<Hook>();
+            auto hook = workbench.running_hook();
             if (hook) hook->emit_after_run({&stack, &*m_func});
         };
 #endif
@@ -0,0 +1,317 @@
+#include "runtime/pipeline.h"
+#include "utils/log.h"
+#include "utils/except.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <sstream>
+
+namespace ts {
+    using pipeline_clock = std::chrono::steady_clock;
+
+    static double pipeline_ms(pipeline_clock::time_point begin, pipeline_clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+
+    struct PipelineItem {
+        uint64_t serial = 0;
+        Pipeline::Frame frame;
+        std::exception_ptr error;
+        pipeline_clock::time_point pushed;
+    };
+
+    /**
+     * Bounded queue keeping frame order.
+     * Items pushed by workers of one stage enter in serial order, so a worker finishing early waits for its turn.
+     */
+    class PipelineChannel {
+    public:
+        using self = PipelineChannel;
+
+        explicit PipelineChannel(int capacity) : m_capacity(size_t(capacity)) {}
+
+        /**
+         * @param item pushed item
+         * @param ordered if wait for turn of item's serial, or give item the next serial
+         * @param wait if wait when queue is full
+         * @return false if stopped, or full and not waiting
+         */
+        bool push(PipelineItem &item, bool ordered, bool wait = true) {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            auto ready = [&]() {
+                return m_stopped || ((!ordered || item.serial == m_next) && m_items.size() < m_capacity);
+            };
+            if (wait) {
+                m_cond.wait(_lock, ready);
+            } else if (!ready()) {
+                return false;
+            }
+            if (m_stopped) return false;
+            if (!ordered) item.serial = m_next;
+            ++m_next;
+            m_items.push_back(std::move(item));
+            m_cond.notify_all();
+            return true;
+        }
+
+        /**
+         * @return false if stopped, or closed and empty
+         */
+        bool pop(PipelineItem &item) {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            m_cond.wait(_lock, [&]() { return m_stopped || m_closed || !m_items.empty(); });
+            if (m_stopped || m_items.empty()) return false;
+            item = std::move(m_items.front());
+            m_items.pop_front();
+            m_cond.notify_all();
+            return true;
+        }
+
+        /**
+         * no more items pushed
+         */
+        void close() {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            m_closed = true;
+            m_cond.notify_all();
+        }
+
+        /**
+         * wake up all waiting, and drop items
+         */
+        void stop() {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            m_stopped = true;
+            m_items.clear();
+            m_cond.notify_all();
+        }
+
+        int size() const {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            return int(m_items.size());
+        }
+
+    private:
+        size_t m_capacity;
+        std::deque<PipelineItem> m_items;
+        uint64_t m_next = 0;
+        bool m_closed = false;
+        bool m_stopped = false;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cond;
+    };
+
+    struct Pipeline::Stage {
+        std::string name;
+        // body of each worker
+        std::vector<Function> functions;
+        std::shared_ptr<PipelineChannel> input;
+        std::vector<std::thread> workers;
+        std::atomic<int> alive;
+        Histogram run;
+        Histogram blocked;
+    };
+
+    Pipeline::Pipeline(int capacity)
+            : m_capacity(capacity), m_pushed(0), m_popped(0) {
+        if (capacity < 1) {
+            TS_LOG_ERROR << "Pipeline capacity must be positive, got " << capacity << eject;
+        }
+        m_outputs = std::make_shared<PipelineChannel>(capacity);
+    }
+
+    Pipeline::~Pipeline() {
+        for (auto &stage : m_stages) stage->input->stop();
+        m_outputs->stop();
+        for (auto &stage : m_stages) {
+            for (auto &worker : stage->workers) {
+                if (worker.joinable()) worker.join();
+            }
+        }
+    }
+
+    void Pipeline::add(const std::string &name, const Function &function, int threads, int capacity) {
+        if (threads < 1) {
+            TS_LOG_ERROR << "Pipeline stage \"" << name << "\" must have at least 1 thread, got " << threads << eject;
+        }
+        std::vector<Function> functions(size_t(threads), function);
+        auto stage = std::make_shared<Stage>();
+        stage->name = name;
+        stage->functions = std::move(functions);
+        stage->input = std::make_shared<PipelineChannel>(capacity > 0 ? capacity : m_capacity);
+        stage->alive = 0;
+
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        if (m_started) {
+            TS_LOG_ERROR << "Can not add stage \"" << name << "\" into started pipeline" << eject;
+        }
+        m_stages.push_back(stage);
+    }
+
+    void Pipeline::add(const std::string &name, Workbench::shared bench, int threads, int capacity) {
+        if (bench == nullptr) {
+            TS_LOG_ERROR << "Pipeline stage \"" << name << "\" got null workbench" << eject;
+        }
+        add(name, [bench](const Frame &frame) {
+            return bench->run(frame);
+        }, threads, capacity);
+    }
+
+    void Pipeline::add(const std::string &name, ImageFilter::shared filter, int threads, int capacity) {
+        if (filter == nullptr) {
+            TS_LOG_ERROR << "Pipeline stage \"" << name << "\" got null image filter" << eject;
+        }
+        add(name, Function(), threads, capacity);
+        auto &functions = m_stages.back()->functions;
+        for (size_t i = 0; i < functions.size(); ++i) {
+            // filter runs on workbench bound in context, so each worker has its own
+            auto bench = std::make_shared<Workbench>(filter->device(), 1);
+            if (i == 0) {
+                ctx::bind<Workbench> _bind_bench(bench.get());
+                filter->compile();
+            }
+            auto worker_filter = i == 0 || filter->program() == nullptr ? filter : filter->clone();
+            functions[i] = [worker_filter, bench](const Frame &frame) {
+                if (frame.empty()) {
+                    TS_LOG_ERROR << "Image filter stage got empty frame" << eject;
+                }
+                ctx::bind<Workbench> _bind_bench(bench.get());
+                auto next = frame;
+                // result is in flow memory of worker's workbench, which is not locked,
+                // so it is copied out before freed in other threads
+                next[0] = worker_filter->run(frame[0]).clone();
+                return next;
+            };
+        }
+    }
+
+    void Pipeline::start() {
+        if (m_stages.empty()) {
+            TS_LOG_ERROR << "Can not start pipeline with no stage" << eject;
+        }
+        for (auto &stage : m_stages) {
+            stage->alive = int(stage->functions.size());
+            for (size_t i = 0; i < stage->functions.size(); ++i) {
+                stage->workers.emplace_back(&Pipeline::work, this, std::ref(*stage), int(i));
+            }
+        }
+        m_started = true;
+    }
+
+    void Pipeline::work(Stage &stage, int worker) {
+        size_t index = 0;
+        while (m_stages[index].get() != &stage) ++index;
+        auto &output = index + 1 < m_stages.size() ? m_stages[index + 1]->input : m_outputs;
+        auto &function = stage.functions[worker];
+
+        PipelineItem item;
+        while (stage.input->pop(item)) {
+            if (!item.error) {
+                auto begin = pipeline_clock::now();
+                try {
+                    item.frame = function(item.frame);
+                } catch (const std::exception &e) {
+                    std::ostringstream message;
+                    message << "Pipeline stage \"" << stage.name << "\" failed on frame " << item.serial
+                            << ": " << e.what();
+                    item.error = std::make_exception_ptr(Exception(message.str()));
+                    item.frame.clear();
+                } catch (...) {
+                    item.error = std::current_exception();
+                    item.frame.clear();
+                }
+                stage.run.record(pipeline_ms(begin, pipeline_clock::now()));
+            }
+            auto begin = pipeline_clock::now();
+            if (!output->push(item, true)) break;
+            stage.blocked.record(pipeline_ms(begin, pipeline_clock::now()));
+        }
+        // the last worker leaving tells next stage no more frames
+        if (--stage.alive == 0) output->close();
+    }
+
+    uint64_t Pipeline::push(const Frame &frame) {
+        std::shared_ptr<PipelineChannel> input;
+        {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            if (m_closed) {
+                TS_LOG_ERROR << "Can not push into closed pipeline" << eject;
+            }
+            if (!m_started) start();
+            input = m_stages.front()->input;
+        }
+        PipelineItem item;
+        item.frame = frame;
+        item.pushed = pipeline_clock::now();
+        if (!input->push(item, false)) {
+            TS_LOG_ERROR << "Can not push into stopped pipeline" << eject;
+        }
+        ++m_pushed;
+        return item.serial;
+    }
+
+    bool Pipeline::try_push(const Frame &frame) {
+        std::shared_ptr<PipelineChannel> input;
+        {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            if (m_closed) {
+                TS_LOG_ERROR << "Can not push into closed pipeline" << eject;
+            }
+            if (!m_started) start();
+            input = m_stages.front()->input;
+        }
+        PipelineItem item;
+        item.frame = frame;
+        item.pushed = pipeline_clock::now();
+        if (!input->push(item, false, false)) return false;
+        ++m_pushed;
+        return true;
+    }
+
+    void Pipeline::close() {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        if (m_closed) return;
+        m_closed = true;
+        // workers started to close stages one by one
+        if (!m_started) start();
+        m_stages.front()->input->close();
+    }
+
+    bool Pipeline::pop(Frame &frame) {
+        uint64_t serial;
+        return pop(frame, serial);
+    }
+
+    bool Pipeline::pop(Frame &frame, uint64_t &serial) {
+        PipelineItem item;
+        if (!m_outputs->pop(item)) return false;
+        m_latency.record(pipeline_ms(item.pushed, pipeline_clock::now()));
+        ++m_popped;
+        serial = item.serial;
+        if (item.error) std::rethrow_exception(item.error);
+        frame = std::move(item.frame);
+        return true;
+    }
+
+    int Pipeline::in_flight() const {
+        return int(m_pushed.load() - m_popped.load());
+    }
+
+    std::vector<Pipeline::Statistics> Pipeline::statistics(bool reset) {
+        std::vector<Statistics> statistics;
+        for (auto &stage : m_stages) {
+            Statistics stage_statistics;
+            stage_statistics.name = stage->name;
+            stage_statistics.run = stage->run.snapshot(reset);
+            stage_statistics.blocked = stage->blocked.snapshot(reset);
+            stage_statistics.queued = stage->input->size();
+            statistics.push_back(std::move(stage_statistics));
+        }
+        return statistics;
+    }
+
+    Histogram Pipeline::latency(bool reset) {
+        return m_latency.snapshot(reset);
+    }
+}
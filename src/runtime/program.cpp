@@ -7,9 +7,12 @@
 
 #include "runtime/program.h"
 #include "compiler/compiler.h"
+#include "compiler/tuner.h"
 #include "core/tensor_builder.h"
 #include "core/device_context.h"
 #include "global/memory_device.h"
+#include "runtime/runtime.h"
+#include "board/profiler.h"
 
 namespace ts {
     static std::string fuzzy_name(const Program::map<std::string, int> &map_name_slot, const std::string &name) {
@@ -53,13 +56,6 @@ namespace ts {
 
     Program::shared Program::Compile(const Module::shared &module, const ComputingDevice &device, const std::string &options) {
         Program::shared program(new Program(device));
-        // translate module
-        auto translated_module = Module::Translate(module, device, options);
-        // TODO: support RNN
-        Compiler compiler(device);
-        auto module_inputs = translated_module->inputs();
-        auto module_outputs = translated_module->outputs();
-        InstructionBlock block;
 
         // check workbench context
         {
@@ -69,8 +65,37 @@ namespace ts {
             }
         }
 
+        ArgParser parser;
+        parser.add({"--filter", "-flt"}, {"--no-filter", "-no-flt"}, false);
+        parser.add({"--tune"}, {"--no-tune"}, false);
+        parser.parse(options);
+        auto do_filter = parser.get("--filter");
+
+        // tune kernels on original module, translator and zipper follow the choices
+        TuningTable tuning;
+        if (parser.get("--tune")) {
+            TS_LOG_STATUS << "Compiling with --tune";
+            auto _timer = profiler_timer("compile/tune");
+            tuning = Tuner(device).tune(module);
+        }
+        ctx::bind<TuningTable> _bind_tuning(tuning);
+
+        // translate module
+        Module::shared translated_module;
+        {
+            auto _timer = profiler_timer("compile/translate");
+            translated_module = Module::Translate(module, device, options);
+        }
+        // TODO: support RNN
+        Compiler compiler(device);
+        auto module_inputs = translated_module->inputs();
+        auto module_outputs = translated_module->outputs();
+        InstructionBlock block;
+
         block = compiler.compile(module_inputs, module_outputs, options);
 
+        auto _timer_link = profiler_timer("compile/link");
+
         // link data sagment
         // TODO: link multi-data-sagment
         auto data_sagment_base = int(program->m_data_segment->size());
@@ -80,11 +105,6 @@ namespace ts {
             inst = std::make_shared<DataSegmentInstruction>(data_sagment_inst->data_index() + data_sagment_base);
         }
 
-        ArgParser parser;
-        parser.add({"--filter", "-flt"}, {"--no-filter", "-no-flt"}, false);
-        parser.parse(options);
-        auto do_filter = parser.get("--filter");
-
         for (auto &data : block.data_segment) {
             Tensor *value = nullptr;
             if (data.device.empty()) {
@@ -149,6 +169,7 @@ namespace ts {
         dolly->m_map_input_slots = this->m_map_input_slots;
         dolly->m_map_output_slots = this->m_map_output_slots;
         dolly->m_data_segment = this->m_data_segment;
+        dolly->m_data_segment_replicas = this->m_data_segment_replicas;
         dolly->m_input_filters.resize(this->m_input_filters.size(), nullptr);
 
         for (size_t i = 0; i < this->m_input_filters.size(); ++i) {
@@ -173,6 +194,40 @@ namespace ts {
         return std::move(dolly);
     }
 
+    Program::shared Program::fork() const {
+        std::unique_lock<std::mutex> _lock_fork(*this->m_mutex);
+
+        Program::shared dolly(new Program(this->m_device, this->m_mutex));
+        dolly->m_program = this->m_program;
+        dolly->m_map_input_slots = this->m_map_input_slots;
+        dolly->m_map_output_slots = this->m_map_output_slots;
+        dolly->m_data_segment = this->m_data_segment;
+        dolly->m_data_segment_replicas = this->m_data_segment_replicas;
+        dolly->m_input_filters.resize(this->m_input_filters.size(), nullptr);
+        dolly->m_input_names = this->m_input_names;
+        dolly->m_output_names = this->m_output_names;
+
+        for (size_t i = 0; i < this->m_input_filters.size(); ++i) {
+            if (this->m_input_filters[i] == nullptr) continue;
+            dolly->m_input_filters[i] = this->m_input_filters[i]->fork();
+        }
+
+        // bind device context
+        DeviceContext device_context(m_device);
+        ctx::bind<DeviceContext> bind_device_context(device_context);
+
+        for (auto &instruction : dolly->m_program) {
+            auto op = dynamic_cast<OperatorInstruction*>(instruction.get());
+            if (op == nullptr || op->op()->reentrant()) continue;
+            instruction = op->clone();
+        }
+
+        dolly->m_input_dtypes = m_input_dtypes;
+        dolly->m_output_dtypes = m_output_dtypes;
+
+        return std::move(dolly);
+    }
+
     Program::Program(const ComputingDevice &device)
         : self(device, std::make_shared<std::mutex>()) {
     }
@@ -182,6 +237,7 @@ namespace ts {
         auto memory_device = ComputingMemory::Query(m_device);
 
         this->m_data_segment = std::make_shared<Stack>(memory_device, DynamicSyncMemoryController::Make(memory_device, true));
+        this->m_data_segment_replicas = std::make_shared<std::map<int, Stack::shared>>();
     }
 
     Tensor Program::data_segment(int index) const {
@@ -271,6 +327,31 @@ namespace ts {
         return *m_data_segment;
     }
 
+    bool Program::replicate_data_segment() {
+        auto runtime = ctx::get<RuntimeContext>();
+        if (runtime == nullptr || runtime->get_numa_node() < 0) return false;
+        auto node = runtime->get_numa_node();
+
+        std::unique_lock<std::mutex> _lock_replicate(*this->m_mutex);
+        auto &replica = (*this->m_data_segment_replicas)[node];
+        if (replica == nullptr) {
+            auto memory_device = ComputingMemory::Query(m_device);
+            auto source = this->m_data_segment;
+            replica = std::make_shared<Stack>(memory_device, DynamicSyncMemoryController::Make(memory_device, true));
+            // allocated in bound runtime, so placed on its node
+            for (size_t i = 0; i < source->size(); ++i) {
+                auto &tensor = *source->index(int(i));
+                if (tensor.device().type() == CPU) {
+                    replica->clone_push(tensor, tensor.device());
+                } else {
+                    replica->push(tensor);
+                }
+            }
+        }
+        this->m_data_segment = replica;
+        return true;
+    }
+
     const std::vector<std::string> &Program::input_names() const {
         return m_input_names;
     }
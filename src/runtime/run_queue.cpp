@@ -0,0 +1,115 @@
+#include "runtime/run_queue.h"
+#include "utils/log.h"
+
+#include <algorithm>
+
+namespace ts {
+    RunCancelledException::RunCancelledException(uint64_t request)
+            : Exception("Run request " + std::to_string(request) + " cancelled"), m_request(request) {}
+
+    RunQueue::RunQueue(const Runner &runner, int threads, int capacity, Serial serial)
+            : m_runner(runner), m_threads(threads), m_capacity(capacity), m_serial(std::move(serial)) {
+        if (threads < 1) {
+            TS_LOG_ERROR << "Run queue must have at least 1 thread, got " << threads << eject;
+        }
+        if (capacity < 1) {
+            TS_LOG_ERROR << "Run queue capacity must be positive, got " << capacity << eject;
+        }
+        if (m_serial == nullptr) m_serial = std::make_shared<std::atomic<uint64_t>>(0);
+    }
+
+    RunQueue::~RunQueue() {
+        std::deque<Request> cancelled;
+        {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            m_stopped = true;
+            cancelled.swap(m_requests);
+            m_cond.notify_all();
+        }
+        for (auto &dispatcher : m_dispatchers) dispatcher.join();
+        std::vector<Tensor> outputs;
+        for (auto &request : cancelled) {
+            finish(request, outputs, std::make_exception_ptr(RunCancelledException(request.id)));
+        }
+    }
+
+    uint64_t RunQueue::submit(const std::vector<Tensor> &inputs, const Callback &callback) {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        if (m_stopped) {
+            TS_LOG_ERROR << "Can not submit into stopped run queue" << eject;
+        }
+        if (m_requests.size() >= size_t(m_capacity)) return 0;
+        if (m_dispatchers.empty()) {
+            for (int i = 0; i < m_threads; ++i) {
+                m_dispatchers.emplace_back(&RunQueue::dispatch, this);
+            }
+        }
+        auto id = ++*m_serial;
+        m_requests.push_back(Request{id, inputs, callback});
+        m_cond.notify_one();
+        return id;
+    }
+
+    bool RunQueue::cancel(uint64_t request) {
+        Request cancelled;
+        {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            auto it = std::find_if(m_requests.begin(), m_requests.end(),
+                                   [&](const Request &waiting) { return waiting.id == request; });
+            if (it == m_requests.end()) return false;
+            cancelled = std::move(*it);
+            m_requests.erase(it);
+        }
+        std::vector<Tensor> outputs;
+        finish(cancelled, outputs, std::make_exception_ptr(RunCancelledException(request)));
+        return true;
+    }
+
+    int RunQueue::waiting() const {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        return int(m_requests.size());
+    }
+
+    bool RunQueue::dispatching() const {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        auto id = std::this_thread::get_id();
+        for (auto &dispatcher : m_dispatchers) {
+            if (dispatcher.get_id() == id) return true;
+        }
+        return false;
+    }
+
+    void RunQueue::dispatch() {
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> _lock(m_mutex);
+                m_cond.wait(_lock, [this]() { return m_stopped || !m_requests.empty(); });
+                if (m_stopped) return;
+                request = std::move(m_requests.front());
+                m_requests.pop_front();
+            }
+            std::vector<Tensor> outputs;
+            std::exception_ptr error;
+            try {
+                outputs = m_runner(request.inputs);
+            } catch (...) {
+                error = std::current_exception();
+                outputs.clear();
+            }
+            request.inputs.clear();
+            finish(request, outputs, error);
+        }
+    }
+
+    void RunQueue::finish(Request &request, std::vector<Tensor> &outputs, const std::exception_ptr &error) {
+        if (!request.callback) return;
+        try {
+            request.callback(request.id, outputs, error);
+        } catch (const std::exception &e) {
+            TS_LOG_ERROR << "Callback of run request " << request.id << " failed: " << e.what();
+        } catch (...) {
+            TS_LOG_ERROR << "Callback of run request " << request.id << " failed.";
+        }
+    }
+}
@@ -11,6 +11,8 @@
 #include <algorithm>
 #include <memory/flow.h>
 
+#include "utils/numa.h"
+
 #ifdef TS_USE_CBLAS
 #if TS_PLATFORM_OS_MAC || TS_PLATFORM_OS_IOS
 #include <Accelerate/Accelerate.h>
@@ -26,9 +28,7 @@
 #endif
 #endif
 
-#ifdef TS_USE_OPENMP
-#include <omp.h>
-#endif
+#include <thread>
 
 namespace ts {
     RuntimeContext::RuntimeContext() {
@@ -42,13 +42,8 @@ namespace ts {
     void RuntimeContext::set_computing_thread_number(int computing_thread_number) {
         int fixed_thread_number;
         if (computing_thread_number < 0) {
-            auto max_thread_number =
-#ifdef TS_USE_OPENMP
-                    omp_get_num_procs();
-#else
-                    8;
-#endif
-            fixed_thread_number = max_thread_number;
+            auto max_thread_number = int(std::thread::hardware_concurrency());
+            fixed_thread_number = max_thread_number > 0 ? max_thread_number : 8;
         } else if (computing_thread_number == 0) {
             fixed_thread_number = 1;
         } else {
@@ -56,7 +51,14 @@ namespace ts {
         }
         this->m_computing_thread_number = fixed_thread_number;
 
-        this->m_thread_pool = std::make_shared<ThreadPool>(fixed_thread_number);
+        auto thread_pool = std::make_shared<ThreadPool>(fixed_thread_number);
+        if (this->m_thread_pool) {
+            // keep setting of threads
+            thread_pool->set_wait_policy(this->m_thread_pool->get_wait_policy());
+            thread_pool->set_spin_time(this->m_thread_pool->get_spin_time());
+            thread_pool->set_affinity(this->m_thread_pool->get_affinity());
+        }
+        this->m_thread_pool = thread_pool;
 #ifdef TS_USE_CBLAS
 #ifdef TS_USING_OPENBLAS
         goto_set_num_threads(fixed_thread_number);
@@ -72,8 +74,12 @@ namespace ts {
     RuntimeContext::self RuntimeContext::clone() const {
         self doly;
         doly.m_computing_thread_number = this->m_computing_thread_number;
+        doly.m_numa_node = this->m_numa_node;
         if (m_thread_pool) {
             doly.m_thread_pool = std::make_shared<ThreadPool>(this->m_thread_pool->size());
+            doly.m_thread_pool->set_wait_policy(this->m_thread_pool->get_wait_policy());
+            doly.m_thread_pool->set_spin_time(this->m_thread_pool->get_spin_time());
+            doly.m_thread_pool->set_affinity(this->m_thread_pool->get_affinity());
         }
         if (this->m_dynamic) {
             doly.m_dynamic = this->m_dynamic->clone();
@@ -81,9 +87,23 @@ namespace ts {
         if (this->m_flow) {
             doly.m_flow = this->m_flow->clone();
         }
+        // cloned controllers charge to same budget
+        doly.m_memory_budget = this->m_memory_budget;
         return std::move(doly);
     }
 
+    RuntimeContext::RuntimeContext(ThreadPool::shared thread_pool) {
+        this->bind_thread_pool(std::move(thread_pool));
+    }
+
+    RuntimeContext::self RuntimeContext::share() const {
+        self shared(this->m_thread_pool);
+        shared.m_numa_node = this->m_numa_node;
+        shared.m_dynamic = this->m_dynamic;
+        shared.m_memory_budget = this->m_memory_budget;
+        return std::move(shared);
+    }
+
     RuntimeContext::RuntimeContext(RuntimeContext::self &&other) {
         this->operator=(std::move(other));
     }
@@ -91,8 +111,10 @@ namespace ts {
     RuntimeContext::self &RuntimeContext::operator=(RuntimeContext::self &&other) {
         std::swap(this->m_computing_thread_number, other.m_computing_thread_number);
         std::swap(this->m_thread_pool, other.m_thread_pool);
+        std::swap(this->m_numa_node, other.m_numa_node);
         std::swap(this->m_dynamic, other.m_dynamic);
         std::swap(this->m_flow, other.m_flow);
+        std::swap(this->m_memory_budget, other.m_memory_budget);
         return *this;
     }
 
@@ -100,6 +122,45 @@ namespace ts {
         return *this->m_thread_pool;
     }
 
+    void RuntimeContext::bind_thread_pool(ThreadPool::shared thread_pool) {
+        if (thread_pool == nullptr) {
+            TS_LOG_ERROR << "Can not bind empty thread pool." << eject;
+        }
+        this->m_thread_pool = std::move(thread_pool);
+        this->m_computing_thread_number = int(this->m_thread_pool->size());
+    }
+
+    ThreadPool::shared RuntimeContext::shared_thread_pool() const {
+        return this->m_thread_pool;
+    }
+
+    bool RuntimeContext::set_cpu_affinity(const std::vector<int> &cpu_ids) {
+        return this->m_thread_pool->set_affinity(cpu_ids);
+    }
+
+    const std::vector<int> &RuntimeContext::get_cpu_affinity() const {
+        return this->m_thread_pool->get_affinity();
+    }
+
+    bool RuntimeContext::set_numa_node(int node) {
+        if (node < 0) {
+            this->m_numa_node = -1;
+            return this->m_thread_pool->set_affinity({});
+        }
+        auto cpu_ids = NumaEnable::get_node_cpus(node);
+        if (cpu_ids.empty()) {
+            TS_LOG_ERROR << "Can not place runtime on NUMA node " << node
+                         << ", only " << NumaEnable::get_node_num() << " node(s) found.";
+            return false;
+        }
+        this->m_numa_node = node;
+        return this->m_thread_pool->set_affinity(cpu_ids);
+    }
+
+    int RuntimeContext::get_numa_node() const {
+        return this->m_numa_node;
+    }
+
     void RuntimeContext::bind_flow(SyncMemoryController::shared flow) {
         m_flow = std::move(flow);
     }
@@ -116,6 +177,14 @@ namespace ts {
         return m_dynamic;
     }
 
+    void RuntimeContext::bind_memory_budget(MemoryBudget::shared budget) {
+        m_memory_budget = std::move(budget);
+    }
+
+    MemoryBudget::shared RuntimeContext::memory_budget() const {
+        return m_memory_budget;
+    }
+
     SyncMemoryController::shared RuntimeContext::FlowMemory() {
         auto runtime = ctx::get<RuntimeContext>();
         if (!runtime) return nullptr;
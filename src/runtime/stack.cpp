@@ -23,6 +23,19 @@ namespace ts {
     }
 
     Tensor Stack::make(DTYPE dtype, const Shape &shape, const MemoryDevice &device) {
+        // only the output of operator's own frame takes preset, not temporary tensors of inner operators
+        if (!m_preset.empty() && m_base_stack.size() == m_preset_depth && m_stack.size() >= m_preset_index) {
+            auto slot = m_stack.size() - m_preset_index;
+            if (slot < m_preset.size()) {
+                auto &preset = m_preset[slot];
+                if (!preset.empty() &&
+                    preset.dtype() == dtype && preset.sizes() == shape && preset.device() == device) {
+                    Tensor tensor = preset;
+                    preset = Tensor();
+                    return tensor;
+                }
+            }
+        }
         return Tensor(m_controller, dtype, shape, device);
     }
 
@@ -148,4 +161,14 @@ namespace ts {
         }
         return make(proto);
     }
+
+    void Stack::preset(const std::vector<Tensor> &tensors) {
+        m_preset.clear();
+        for (auto &tensor : tensors) {
+            m_preset.push_back(tensor.packed() ? Tensor() : tensor);
+        }
+        // operator saves base of its arguments, then pushes outputs above them
+        m_preset_index = m_stack.size();
+        m_preset_depth = m_base_stack.size() + 1;
+    }
 }
@@ -16,6 +16,8 @@
 #include "global/hard_converter.h"
 
 #include <climits>
+#include <mutex>
+#include <exception>
 #include <board/hook.h>
 #include "utils/need.h"
 
@@ -107,21 +109,44 @@ namespace ts {
         //check_cpu_features();
 
         this->m_device_context.initialize(device);
+
+        this->setup_memory(std::make_shared<MemoryBudget>());
+
+        this->m_switch_controller = std::make_shared<SwitchControll>();
+        if(!check_cpu_features()){
+            m_switch_controller->auto_switch(device);
+        }
+    }
+
+    void Workbench::setup_memory(MemoryBudget::shared budget) {
         auto &memory_device = this->m_device_context.memory_device;
 
-        this->m_static_memory = DynamicSyncMemoryController::Make(memory_device, true);
+        this->m_memory_budget = std::move(budget);
+        auto &memory_budget = this->m_memory_budget;
+        this->m_static_memory = DynamicSyncMemoryController::Make(memory_device, true, memory_budget);
         // TODO: Make real flow memory controller
-        this->m_flow_memory = HypeSyncMemoryController<FlowMemoryController>::Make(memory_device, false);
-        this->m_dynamic_memory = DynamicSyncMemoryController::Make(memory_device, false);
+        this->m_flow_memory = HypeSyncMemoryController<FlowMemoryController>::Make(memory_device, false, memory_budget);
+        this->m_dynamic_memory = DynamicSyncMemoryController::Make(memory_device, false, memory_budget);
         this->m_stack = std::make_shared<Stack>(memory_device, this->m_flow_memory);
         // bind flow and dynamic memory, so you can use it to alloc memory in any where
         this->m_runtime_context.bind_flow(this->m_flow_memory);
         this->m_runtime_context.bind_dynamic(this->m_dynamic_memory);
+        this->m_runtime_context.bind_memory_budget(memory_budget);
+    }
 
-        this->m_switch_controller = std::make_shared<SwitchControll>();
-        if(!check_cpu_features()){
-            m_switch_controller->auto_switch(device);
-        }
+    Workbench::Workbench(const Workbench &owner, Program::shared program)
+            : m_runtime_context(owner.m_runtime_context.share()) {
+        this->m_device_context.initialize(owner.m_device_context.computing_device);
+
+        auto &memory_device = this->m_device_context.memory_device;
+        this->m_memory_budget = owner.m_memory_budget;
+        this->m_flow_memory = HypeSyncMemoryController<FlowMemoryController>::Make(
+                memory_device, false, this->m_memory_budget);
+        this->m_stack = std::make_shared<Stack>(memory_device, this->m_flow_memory);
+        this->m_runtime_context.bind_flow(this->m_flow_memory);
+
+        this->m_switch_controller = owner.m_switch_controller;
+        this->m_desktop = std::move(program);
     }
 
     Workbench::Workbench(const ComputingDevice &device, int computing_thread_number)
@@ -135,7 +160,9 @@ namespace ts {
     }
 
     Workbench::~Workbench() {
+        this->m_async.reset();
         this->m_desktop.reset();
+        this->m_contexts.reset();
         this->m_stack->clear();
         this->m_inputs.clear();
         this->m_outputs.clear();
@@ -145,6 +172,46 @@ namespace ts {
         this->m_switch_controller.reset();
     }
 
+    /**
+     * idle execution contexts of concurrent run, each has its own stack and flow memory, running its own fork of program
+     */
+    class Workbench::ContextPool {
+    public:
+        using self = ContextPool;
+
+        explicit ContextPool(Program::shared program)
+                : m_program(std::move(program)) {}
+
+        Workbench::shared acquire(const Workbench &bench) {
+            {
+                std::unique_lock<std::mutex> _lock(m_mutex);
+                if (!m_idle.empty()) {
+                    auto context = m_idle.back();
+                    m_idle.pop_back();
+                    return context;
+                }
+            }
+            return Workbench::shared(new Workbench(bench, m_program->fork()));
+        }
+
+        void release(Workbench::shared context) {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            m_idle.push_back(std::move(context));
+        }
+
+        uint64_t trim(uint64_t high_water) {
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            uint64_t released = 0;
+            for (auto &context : m_idle) released += context->trim(high_water);
+            return released;
+        }
+
+    private:
+        Program::shared m_program;
+        std::mutex m_mutex;
+        std::vector<Workbench::shared> m_idle;
+    };
+
     static inline std::unique_ptr<ctx::bind<Profiler>> bind_profiler(bool _do, Profiler &profiler) {
         if (!_do) return nullptr;
         return std::unique_ptr<ctx::bind<Profiler>>(new ctx::bind<Profiler>(profiler));
@@ -157,9 +224,182 @@ namespace ts {
 
         this->m_hooked_tensor.clear();
 
-        auto outputs = launch_offline(m_desktop, m_inputs);
+        auto _bind_profiler = bind_profiler(m_do_profile && ctx::get<Profiler>() != &m_profiler, m_profiler);
+        auto _timer = profiler_timer("run");
+
+        auto capture = sample_capture();
+        ts::need stop_capture([this]() { m_running_capture = nullptr; });
+
+        auto outputs = launch_in_budget(m_desktop, m_inputs);
+
+        if (capture) capture->commit();
 
         m_outputs = outputs;
+
+        auto_trim();
+    }
+
+    std::vector<Tensor> Workbench::run(const std::vector<Tensor> &inputs) {
+        auto contexts = m_contexts;
+        if (contexts == nullptr) {
+            TS_LOG_ERROR << "Can not run workbench with no program setup" << eject;
+        }
+        if (inputs.size() != m_inputs.size()) {
+            TS_LOG_ERROR << "Input number must be " << m_inputs.size() << " vs. " << inputs.size() << " got." << eject;
+        }
+
+        // operators run in contexts are profiled into profiler of this workbench
+        auto _bind_profiler = bind_profiler(m_do_profile && ctx::get<Profiler>() != &m_profiler, m_profiler);
+        auto _timer = profiler_timer("run");
+
+        std::vector<Tensor> outputs;
+        {
+            auto context = contexts->acquire(*this);
+            ts::need release([&]() {
+                if (m_trim_high_water >= 0) context->trim(uint64_t(m_trim_high_water));
+                contexts->release(context);
+            });
+
+            // results use context's flow memory, which can not be touched after context released
+            auto results = context->launch_in_budget(context->m_desktop, inputs);
+            BindWorkbenchRuntime _bind_runtime(*context);
+            for (auto &result : results) {
+                outputs.emplace_back(result.clone());
+            }
+        }
+        return outputs;
+    }
+
+    /**
+     * requests of run_async run like concurrent run
+     */
+    static RunQueue::Runner async_runner(Workbench *bench) {
+        return [bench](const std::vector<Tensor> &inputs) {
+            return bench->run(inputs);
+        };
+    }
+
+    void Workbench::set_async(int threads, int capacity) {
+        auto async = std::make_shared<RunQueue>(async_runner(this), threads, capacity, m_async_serial);
+        RunQueue::shared old;
+        {
+            std::unique_lock<std::mutex> _lock(m_async_mutex);
+            if (m_async != nullptr && m_async->dispatching()) {
+                TS_LOG_ERROR << "Can not set async in callback of run_async" << eject;
+            }
+            old = m_async;
+            m_async = async;
+        }
+        // old queue cancels its waiting requests and waits running ones
+    }
+
+    uint64_t Workbench::run_async(const std::vector<Tensor> &inputs, const RunQueue::Callback &callback) {
+        if (m_contexts == nullptr) {
+            TS_LOG_ERROR << "Can not run workbench with no program setup" << eject;
+        }
+        if (inputs.size() != m_inputs.size()) {
+            TS_LOG_ERROR << "Input number must be " << m_inputs.size() << " vs. " << inputs.size() << " got." << eject;
+        }
+        RunQueue::shared async;
+        {
+            std::unique_lock<std::mutex> _lock(m_async_mutex);
+            if (m_async == nullptr) {
+                m_async = std::make_shared<RunQueue>(async_runner(this), 1, 16, m_async_serial);
+            }
+            async = m_async;
+        }
+        auto request = async->submit(inputs, callback);
+        if (request == 0) {
+            TS_LOG_ERROR << "Can not run async, " << async->capacity() << " requests waiting" << eject;
+        }
+        return request;
+    }
+
+    std::future<std::vector<Tensor>> Workbench::run_async(const std::vector<Tensor> &inputs, uint64_t *request) {
+        auto promise = std::make_shared<std::promise<std::vector<Tensor>>>();
+        auto future = promise->get_future();
+        auto id = run_async(inputs, [promise](uint64_t, std::vector<Tensor> &outputs, const std::exception_ptr &error) {
+            if (error) {
+                promise->set_exception(error);
+            } else {
+                promise->set_value(std::move(outputs));
+            }
+        });
+        if (request) *request = id;
+        return future;
+    }
+
+    bool Workbench::cancel(uint64_t request) {
+        RunQueue::shared async;
+        {
+            std::unique_lock<std::mutex> _lock(m_async_mutex);
+            async = m_async;
+        }
+        return async != nullptr && async->cancel(request);
+    }
+
+    void Workbench::run_into(const std::vector<Tensor> &outputs) {
+        if (m_desktop == nullptr) {
+            TS_LOG_ERROR << "Can not run workbench with no program setup" << eject;
+        }
+        if (outputs.size() != m_outputs.size()) {
+            TS_LOG_ERROR << "Output number must be " << m_outputs.size() << " vs. " << outputs.size() << " got." << eject;
+        }
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            if (outputs[i].packed()) {
+                TS_LOG_ERROR << "Can not run into packed output, at index=" << i << eject;
+            }
+        }
+
+        this->m_hooked_tensor.clear();
+
+        m_output_presets = outputs;
+        ts::need clear_presets([this]() {
+            m_output_presets.clear();
+            m_stack->clear_preset();
+        });
+
+        auto _bind_profiler = bind_profiler(m_do_profile && ctx::get<Profiler>() != &m_profiler, m_profiler);
+        auto _timer = profiler_timer("run");
+
+        auto capture = sample_capture();
+        ts::need stop_capture([this]() { m_running_capture = nullptr; });
+
+        auto results = launch_in_budget(m_desktop, m_inputs);
+
+        if (capture) capture->commit();
+
+        // result may take other output's memory when they have same prototype, move it out before copy
+        for (size_t i = 0; i < results.size(); ++i) {
+            auto &result = results[i];
+            if (result.packed()) continue;
+            for (size_t j = 0; j < outputs.size(); ++j) {
+                if (j == i || outputs[j].empty()) continue;
+                if (result.data() == outputs[j].data()) {
+                    BindWorkbenchRuntime _bind_runtime(*this);
+                    result = result.clone(m_flow_memory, result.device());
+                    break;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            auto output = outputs[i];
+            auto &result = results[i];
+            if (output.empty()) continue;
+            if (result.packed() || result.dtype() != output.dtype() || result.sizes() != output.sizes()) {
+                TS_LOG_ERROR << "Output " << i << " want " << type_str(output.dtype()) << to_string(output.sizes())
+                             << ", but got " << type_str(result.dtype()) << to_string(result.sizes()) << eject;
+            }
+            if (result.data() == output.data()) continue;
+            auto bytes = result.proto().type_bytes() * result.count();
+            memcpy(output.data(), output.device(), bytes, result.data(), result.device(), bytes);
+            result = output;
+        }
+
+        m_outputs = results;
+
+        auto_trim();
     }
 
     Workbench::shared Workbench::clone() const {
@@ -171,8 +411,16 @@ namespace ts {
         dolly->m_inputs.resize(this->m_inputs.size());
         dolly->m_outputs.resize(this->m_outputs.size());
         dolly->m_runtime_context = this->m_runtime_context.clone();
+        // runtime of dolly uses its own memory, charged to its own budget
+        dolly->m_runtime_context.bind_flow(dolly->m_flow_memory);
+        dolly->m_runtime_context.bind_dynamic(dolly->m_dynamic_memory);
+        dolly->m_runtime_context.bind_memory_budget(dolly->m_memory_budget);
+        dolly->m_memory_budget->set_limit(this->m_memory_budget->limit());
+        dolly->m_replicate_data_segment = this->m_replicate_data_segment;
+        dolly->m_trim_high_water = this->m_trim_high_water;
         if (this->m_desktop) {
             dolly->m_desktop = this->m_desktop->clone();
+            dolly->m_contexts = std::make_shared<ContextPool>(dolly->m_desktop);
         }
 
         return std::move(dolly);
@@ -238,6 +486,8 @@ namespace ts {
         BindWorkbenchRuntime _bind_runtime(*this);
         filter->compile();
         m_desktop->bind_filter(slot, filter->program());
+        // contexts run fork of old desktop
+        m_contexts = std::make_shared<ContextPool>(m_desktop);
     }
 
     void Workbench::input(const std::string &name, const Tensor &tensor) {
@@ -335,6 +585,8 @@ namespace ts {
         BindWorkbenchRuntime _bind_runtime(*this);
 
         m_desktop->set_operator_param(node_name, param, value);
+        // contexts run fork of old desktop
+        m_contexts = std::make_shared<ContextPool>(m_desktop);
     }
 
     void Workbench::cast_tensor(DTYPE dtype) {
@@ -425,6 +677,13 @@ namespace ts {
         m_env.push(ProgramEnv(program));
         ts::need pop_env(&std::stack<ProgramEnv>::pop, &m_env);
 
+        /**
+         * instructions emit to hook found here, not looking up context for each one
+         */
+        auto outer_hook = m_running_hook;
+        m_running_hook = ctx::get<Hook>();
+        ts::need restore_hook([&]() { m_running_hook = outer_hook; });
+
         /**
          * bind profiler for running
          */
@@ -472,6 +731,26 @@ namespace ts {
          */
         this->m_stack->erase(0, nargs);
 
+        /**
+         * outputs given by run_into, preset to output slots of desktop program's last instruction,
+         *     if it is an operator giving the last outputs
+         */
+        auto preset_pointer = size_t(-1);
+        std::vector<Tensor> presets;
+        if (!m_output_presets.empty() && m_env.size() == 1 && program->length() > 0) {
+            auto last = dynamic_cast<OperatorInstruction *>(program->instruction(program->length() - 1).get());
+            auto nresults = last ? size_t(last->nresults()) : size_t(0);
+            if (last && nresults <= m_output_presets.size()) {
+                preset_pointer = program->length() - 1;
+                presets.assign(m_output_presets.end() - nresults, m_output_presets.end());
+            }
+        }
+
+        /**
+         * capture only instructions of desktop program
+         */
+        auto capture = m_env.size() == 1 ? m_running_capture : nullptr;
+
         /**
          * Start run program
          */
@@ -481,8 +760,15 @@ namespace ts {
             auto &length = running_program.length;
             if (pointer >= length) break;
             auto &inst = running_program.program->instruction(pointer);
-            pointer++;
-            inst->run(*this);
+            auto index = pointer++;
+            if (index == preset_pointer) {
+                this->m_stack->preset(presets);
+                inst->run(*this);
+                this->m_stack->clear_preset();
+            } else {
+                inst->run(*this);
+            }
+            if (capture && capture->index_of(index) >= 0) capture->capture(index, *this->m_stack);
         }
 
         /**
@@ -504,8 +790,14 @@ namespace ts {
         } else {
             this->m_inputs.resize(program->input_count());
             this->m_outputs.resize(program->output_count());
+            if (this->m_replicate_data_segment) {
+                BindWorkbenchRuntime _bind_runtime(*this);
+                program->replicate_data_segment();
+            }
         }
+        this->m_contexts = program ? std::make_shared<ContextPool>(program) : nullptr;
         this->m_hooked_tensor.clear();
+        this->m_capture.reset();
     }
 
     std::vector<Tensor> Workbench::launch_offline(Program::shared program, const std::vector<Tensor> &args) {
@@ -553,6 +845,7 @@ namespace ts {
          * tell compiler, who is compiling
          */
         BindWorkbenchRuntime _bind_runtime(*this);
+        auto _bind_profiler = bind_profiler(m_do_profile && ctx::get<Profiler>() != &m_profiler, m_profiler);
 
         /**
          * do compile, from module to program
@@ -572,6 +865,7 @@ namespace ts {
 
     Program::shared Workbench::compile(const Module::shared &module, const std::string &options) {
         BindWorkbenchRuntime _bind_runtime(*this);
+        auto _bind_profiler = bind_profiler(m_do_profile && ctx::get<Profiler>() != &m_profiler, m_profiler);
         return Program::Compile(module, this->device().computing_device, options);
     }
 
@@ -601,30 +895,55 @@ namespace ts {
             }
         }
 
-        std::unordered_set<std::string> node_name_set;
-        for (auto &node_name : node_names) {
-            node_name_set.insert(node_name);
+        // capture this run only, keep capture set before
+        auto capture = std::make_shared<Capture>(*m_desktop, node_names);
+        std::swap(capture, m_capture);
+        ts::need restore_capture([&]() { std::swap(capture, m_capture); });
+
+        this->run();
+
+        for (auto &name : node_names) {
+            auto value = m_capture->captured(0, name);
+            if (value.empty()) continue;
+            m_hooked_tensor[name] = value;
         }
+    }
 
-        Hook hooker;
-        hooker.after_run([&](const Hook::StructAfterRun &info) {
-            auto &op = *info.op;
-            auto &stack = *info.stack;
-            auto name = op.name();
-            auto it = node_name_set.find(name);
-            if (it == node_name_set.end()) return;
-            if (stack.size() < 1) return;
-            auto &value = stack[0];
-            auto name_it = m_hooked_tensor.find(name);
-            if (name_it == m_hooked_tensor.end()) {
-                m_hooked_tensor.insert(std::make_pair(name, value.clone(controller)));
-            } else {
-                name_it->second =value.clone(controller);
-            }
-        });
-        ctx::bind<Hook> _hook(hooker);
+    Capture::shared Workbench::sample_capture() {
+        auto capture = m_capture;
+        if (!capture || !capture->sample()) return nullptr;
+        m_running_capture = capture.get();
+        return capture;
+    }
 
-        this->run();
+    void Workbench::set_capture(const std::vector<std::string> &node_names, int slots, int interval) {
+        if (node_names.empty()) {
+            m_capture.reset();
+            return;
+        }
+        if (m_desktop == nullptr) {
+            TS_LOG_ERROR << "Can not capture workbench with no program setup" << eject;
+        }
+        m_capture = std::make_shared<Capture>(*m_desktop, node_names, slots, interval);
+    }
+
+    void Workbench::set_capture_interval(int interval) {
+        if (m_capture == nullptr) {
+            TS_LOG_ERROR << "Can not set interval with no capture set" << eject;
+        }
+        m_capture->set_interval(interval);
+    }
+
+    int Workbench::captured_count() const {
+        return m_capture ? m_capture->count() : 0;
+    }
+
+    Tensor Workbench::captured(int age, const std::string &name) const {
+        return m_capture ? m_capture->captured(age, name) : Tensor();
+    }
+
+    uint64_t Workbench::captured_serial(int age) const {
+        return m_capture ? m_capture->serial(age) : 0;
     }
 
     const std::string &Workbench::summary() {
@@ -643,11 +962,17 @@ namespace ts {
             << ", \"thread\": " << m_runtime_context.get_computing_thread_number()
             << ", \"shared\": \"" << memory_size_string(shared_memory) << "\""
             << ", \"memory\": " << m_flow_memory->summary()
+            << ", \"budget\": " << m_memory_budget->summary()
             << "}";
         m_summary = oss.str();
         return m_summary;
     }
 
+    const std::string &Workbench::profile_summary(bool reset) {
+        m_profile_summary = m_profiler.summary(reset);
+        return m_profile_summary;
+    }
+
     bool Workbench::set_cpu_power_mode(CpuEnable::CpuPowerMode cpu_mode){
         bool flag = CpuEnable::set_power_mode(cpu_mode);
         if (flag) {
@@ -671,6 +996,118 @@ namespace ts {
         return flag;
     }
 
+    bool Workbench::set_cpu_affinity(const std::vector<int> &cpu_ids) {
+        return this->m_runtime_context.set_cpu_affinity(cpu_ids);
+    }
+
+    bool Workbench::set_numa_node(int node, bool replicate_data) {
+        if (!this->m_runtime_context.set_numa_node(node)) return false;
+        this->m_replicate_data_segment = replicate_data && node >= 0;
+        if (this->m_replicate_data_segment && this->m_desktop) {
+            BindWorkbenchRuntime _bind_runtime(*this);
+            this->m_desktop->replicate_data_segment();
+        }
+        return true;
+    }
+
+    uint64_t Workbench::trim(uint64_t high_water) {
+        uint64_t released = m_flow_memory->trim(high_water);
+        auto contexts = m_contexts;
+        if (contexts) released += contexts->trim(high_water);
+        return released;
+    }
+
+    void Workbench::auto_trim() {
+        if (m_trim_high_water < 0) return;
+        m_flow_memory->trim(uint64_t(m_trim_high_water));
+    }
+
+    void Workbench::set_memory_budget(uint64_t limit) {
+        m_memory_budget->set_limit(limit);
+    }
+
+    uint64_t Workbench::get_memory_budget() const {
+        return m_memory_budget->limit();
+    }
+
+    /**
+     * @return batch size shared by all args, 0 if args can not split on batch
+     */
+    static int split_number(const std::vector<Tensor> &args) {
+        int number = 0;
+        for (auto &arg : args) {
+            if (arg.packed() || arg.dims() < 1) return 0;
+            if (number == 0) number = arg.size(0);
+            if (arg.size(0) != number) return 0;
+        }
+        return number;
+    }
+
+    std::vector<Tensor> Workbench::launch_in_budget(Program::shared program, const std::vector<Tensor> &args) {
+        auto number = split_number(args);
+        if (number <= 1 || !m_memory_budget->limited()) return launch_offline(program, args);
+
+        std::exception_ptr refused;
+        try {
+            return launch_offline(program, args);
+        } catch (const OutOfMemoryException &) {
+            // fall through, memory of failed launch released with stack
+            refused = std::current_exception();
+        }
+
+        // presets of run_into hold the whole batch, samples are gathered into them instead
+        auto presets = std::move(m_output_presets);
+        m_output_presets.clear();
+
+        std::vector<Tensor> outputs;
+        for (int i = 0; i < number; ++i) {
+            std::vector<Tensor> sample_args;
+            for (auto arg : args) sample_args.emplace_back(arg.slice(i, i + 1));
+
+            auto results = launch_offline(program, sample_args);
+
+            if (i == 0) {
+                // each output must be batched as inputs, or batch can not be split and budget refusing stands
+                for (auto &result : results) {
+                    if (result.packed() || result.dims() < 1 || result.size(0) != 1) {
+                        TS_LOG_INFO << "Can not run batch sample by sample in memory budget, got output "
+                                    << to_string(result.sizes()) << " of one sample";
+                        std::rethrow_exception(refused);
+                    }
+                }
+                m_memory_budget->degrade();
+
+                BindWorkbenchRuntime _bind_runtime(*this);
+                for (auto &result : results) {
+                    auto shape = result.sizes();
+                    shape[0] = number;
+                    auto j = outputs.size();
+                    if (j < presets.size() && !presets[j].empty() && presets[j].dtype() == result.dtype() &&
+                        presets[j].sizes() == shape && presets[j].device() == result.device()) {
+                        outputs.emplace_back(presets[j]);
+                        continue;
+                    }
+                    outputs.emplace_back(m_flow_memory, result.dtype(), shape, result.device());
+                }
+            }
+
+            for (size_t j = 0; j < results.size(); ++j) {
+                auto &result = results[j];
+                auto &output = outputs[j];
+                auto bytes = result.proto().type_bytes() * result.count();
+                if (result.dtype() != output.dtype() ||
+                    bytes * number != output.proto().type_bytes() * output.count()) {
+                    TS_LOG_ERROR << "Can not run batch sample by sample in memory budget, output " << j
+                                 << " of samples are not same." << eject;
+                }
+                memcpy(output.data<char>() + bytes * i, output.device(), bytes,
+                       result.data(), result.device(), bytes);
+            }
+        }
+
+        return outputs;
+    }
+
     SwitchControll::shared Workbench::switch_controller(){
         return m_switch_controller;
     }
@@ -22,6 +22,9 @@ Modify:Remove some unnecessary feature detection
 #include <mutex>
 #endif
 
+#include <fstream>
+#include <cstring>
+
 #if TS_PLATFORM_IS_X86
 #if TS_PLATFORM_OS_WINDOWS
 // Visual Studio defines a builtin function for CPUID, so use that if possible.
@@ -80,7 +83,8 @@ namespace ts {
                   have_sse3_(0),
                   have_sse4_1_(0),
                   have_sse4_2_(0),
-                  have_ssse3_(0) {}
+                  have_ssse3_(0),
+                  have_aes_(0) {}
 
         static void Initialize() {
             // Initialize cpuid struct
@@ -107,6 +111,7 @@ namespace ts {
             cpuid->have_sse4_2_ = (ecx >> 20) & 0x1;
             cpuid->have_sse_ = (edx >> 25) & 0x1;
             cpuid->have_ssse3_ = (ecx >> 9) & 0x1;
+            cpuid->have_aes_ = (ecx >> 25) & 0x1;
 
             const uint64_t xcr0_xmm_mask = 0x2;
             const uint64_t xcr0_ymm_mask = 0x4;
@@ -135,6 +140,25 @@ namespace ts {
 
             cpuid->have_avx2_ = have_avx && ((ebx >> 5) & 0x1);
 
+            // Get processor brand string (issue CPUID with eax = 0x80000002 to 0x80000004)
+            GETCPUID(eax, ebx, ecx, edx, 0x80000000, 0);
+            if (eax >= 0x80000004) {
+                char brand[49] = {0};
+                for (uint32_t i = 0; i < 3; ++i) {
+                    GETCPUID(eax, ebx, ecx, edx, 0x80000002 + i, 0);
+                    std::memcpy(brand + i * 16, &eax, 4);
+                    std::memcpy(brand + i * 16 + 4, &ebx, 4);
+                    std::memcpy(brand + i * 16 + 8, &ecx, 4);
+                    std::memcpy(brand + i * 16 + 12, &edx, 4);
+                }
+                cpuid->model_name_ = brand;
+            }
+            if (cpuid->model_name_.empty()) cpuid->model_name_ = cpuid->vendor_str_;
+        }
+
+        static const std::string &model_name() {
+            init_cpuid_info();
+            return cpuid->model_name_;
         }
 
         static bool check_feature(CPUFeature feature) {
@@ -159,6 +183,8 @@ namespace ts {
                     return cpuid->have_sse_;
                 case SSSE3:
                     return cpuid->have_ssse3_;
+                case AES:
+                    return cpuid->have_aes_;
                 default:
                     break;
             }
@@ -176,7 +202,9 @@ namespace ts {
         int have_sse4_1_ : 1;
         int have_sse4_2_ : 1;
         int have_ssse3_ : 1;
+        int have_aes_ : 1;
         std::string vendor_str_;
+        std::string model_name_;
     };
 
     std::once_flag cpuid_once_flag;
@@ -197,4 +225,32 @@ namespace ts {
 #endif
     }
 
+    static std::string trim(const std::string &str) {
+        auto begin = str.find_first_not_of(" \t");
+        if (begin == std::string::npos) return "";
+        auto end = str.find_last_not_of(" \t");
+        return str.substr(begin, end - begin + 1);
+    }
+
+    std::string cpu_model_name() {
+        std::string name;
+#if TS_PLATFORM_IS_X86
+        name = trim(CPUIDInfo::model_name());
+#else
+        // arm linux and android give model in "model name", "Hardware" or "Processor" line
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        std::string hardware;
+        while (std::getline(cpuinfo, line)) {
+            auto colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            auto key = trim(line.substr(0, colon));
+            auto value = trim(line.substr(colon + 1));
+            if (key == "model name" && name.empty()) name = value;
+            if ((key == "Hardware" || key == "Processor") && hardware.empty()) hardware = value;
+        }
+        if (name.empty()) name = hardware;
+#endif
+        return name.empty() ? "unknown" : name;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "utils/numa.h"
+#include "utils/log.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdint>
+
+#if TS_PLATFORM_OS_LINUX || TS_PLATFORM_OS_ANDROID
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ts {
+    /**
+     * parse list like 0-3,8,10-11
+     */
+    static std::vector<int> parse_id_list(const std::string &line) {
+        std::vector<int> ids;
+        std::istringstream iss(line);
+        std::string item;
+        while (std::getline(iss, item, ',')) {
+            if (item.empty() || item[0] == '\n') continue;
+            auto dash = item.find('-');
+            try {
+                if (dash == std::string::npos) {
+                    ids.push_back(std::stoi(item));
+                } else {
+                    auto first = std::stoi(item.substr(0, dash));
+                    auto last = std::stoi(item.substr(dash + 1));
+                    for (int i = first; i <= last; ++i) ids.push_back(i);
+                }
+            } catch (const std::exception &) {
+                return {};
+            }
+        }
+        return ids;
+    }
+
+    static std::vector<int> read_id_list(const std::string &path) {
+        std::ifstream fread(path);
+        if (!fread.is_open()) return {};
+        std::string line;
+        std::getline(fread, line);
+        return parse_id_list(line);
+    }
+
+    static std::vector<std::vector<int>> static_get_node_cpus() {
+        std::vector<std::vector<int>> node_cpus;
+#if TS_PLATFORM_OS_LINUX || TS_PLATFORM_OS_ANDROID
+        auto nodes = read_id_list("/sys/devices/system/node/online");
+        for (auto node : nodes) {
+            if (node < 0) continue;
+            if (node >= int(node_cpus.size())) node_cpus.resize(node + 1);
+            node_cpus[node] = read_id_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        }
+#endif
+        return node_cpus;
+    }
+
+    static const std::vector<std::vector<int>> &g_node_cpus() {
+        static auto node_cpus = static_get_node_cpus();
+        return node_cpus;
+    }
+
+    int NumaEnable::get_node_num() {
+        return int(g_node_cpus().size());
+    }
+
+    std::vector<int> NumaEnable::get_node_cpus(int node) {
+        auto &node_cpus = g_node_cpus();
+        if (node < 0 || node >= int(node_cpus.size())) return {};
+        return node_cpus[node];
+    }
+
+    int NumaEnable::get_cpu_node(int cpu) {
+        auto &node_cpus = g_node_cpus();
+        for (size_t node = 0; node < node_cpus.size(); ++node) {
+            for (auto id : node_cpus[node]) {
+                if (id == cpu) return int(node);
+            }
+        }
+        return -1;
+    }
+
+    bool NumaEnable::bind_memory(void *data, size_t size, int node) {
+#if (TS_PLATFORM_OS_LINUX || TS_PLATFORM_OS_ANDROID) && defined(SYS_mbind)
+        if (data == nullptr || node < 0 || node >= get_node_num()) return false;
+        static const auto page_size = uintptr_t(sysconf(_SC_PAGESIZE));
+        auto begin = (uintptr_t(data) + page_size - 1) / page_size * page_size;
+        auto end = (uintptr_t(data) + size) / page_size * page_size;
+        if (begin >= end) return false;
+
+        static const int MPOL_PREFERRED_MODE = 1;
+        static const unsigned MPOL_MF_MOVE_FLAG = 1 << 1;
+        static const int BITS = int(sizeof(unsigned long) * 8);
+        std::vector<unsigned long> mask(node / BITS + 1, 0);
+        mask[node / BITS] |= 1UL << (node % BITS);
+        auto maxnode = (unsigned long)(mask.size() * BITS + 1);
+
+        auto ret = syscall(SYS_mbind, (void *)(begin), (unsigned long)(end - begin),
+                           MPOL_PREFERRED_MODE, mask.data(), maxnode, MPOL_MF_MOVE_FLAG);
+        if (ret != 0) {
+            TS_LOG_DEBUG << "mbind memory to NUMA node " << node << " failed: " << ret;
+            return false;
+        }
+        return true;
+#else
+        (void)(data);
+        (void)(size);
+        (void)(node);
+        return false;
+#endif
+    }
+}
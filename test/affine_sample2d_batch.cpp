@@ -0,0 +1,190 @@
+#include "test_utils.h"
+
+#include <runtime/workbench.h>
+#include <frontend/intime.h>
+
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+using namespace ts;
+using namespace ts::test;
+
+using Matrix = std::array<float, 9>;
+
+static Tensor random_image(DTYPE dtype, int height, int width, int channels, unsigned seed) {
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<int> uniform(0, 255);
+    Tensor image(FLOAT32, {height, width, channels});
+    for (int i = 0; i < image.count(); ++i) image.data<float>()[i] = float(uniform(engine));
+    return tensor::cast(dtype, image);
+}
+
+/**
+ * rotate and scale around image center, then shift, dst -> src
+ */
+static Matrix crop_matrix(float angle, float scale, float shift_x, float shift_y, int width, int height) {
+    auto c = std::cos(angle) * scale, s = std::sin(angle) * scale;
+    return {c, -s, width / 2.0f + shift_x, s, c, height / 2.0f + shift_y, 0, 0, 1};
+}
+
+static Tensor matrices(const std::vector<Matrix> &affine) {
+    Tensor tensor(FLOAT32, {int(affine.size()), 3, 3});
+    for (size_t k = 0; k < affine.size(); ++k) {
+        std::copy(affine[k].begin(), affine[k].end(), tensor.data<float>() + 9 * k);
+    }
+    return tensor;
+}
+
+/**
+ * @note outer_value < 0 means clamp outer pixels to nearest border
+ */
+static Tensor sample(const Tensor &x, int height, int width, const Tensor &affine,
+                     desc::ResizeType type, float outer_value) {
+    auto size = tensor::build(INT32, {height, width});
+    if (outer_value < 0) return intime::affine_on_sample2d(x, size, affine, 0, type).clone();
+    return intime::affine_sample2d(x, size, affine, 0, outer_value, type).clone();
+}
+
+/**
+ * bilinear sample in double, as the per-pixel float kernel
+ * @note outer_value < 0 means clamp outer pixels to nearest border
+ */
+static Tensor reference_linear(const Tensor &x, int height, int width, const Matrix &rz, float outer_value) {
+    auto fx = tensor::cast(FLOAT32, x);
+    int src_height = x.size(0), src_width = x.size(1), channels = x.size(2);
+    Tensor y(FLOAT32, {height, width, channels});
+    for (int n_y_d = 0; n_y_d < height; ++n_y_d) {
+        for (int n_x_d = 0; n_x_d < width; ++n_x_d) {
+            double sx = double(rz[0]) * n_x_d + double(rz[1]) * n_y_d + rz[2];
+            double sy = double(rz[3]) * n_x_d + double(rz[4]) * n_y_d + rz[5];
+            auto dst = y.data<float>() + (n_y_d * width + n_x_d) * channels;
+            auto inner = sx >= 0 && sx < src_width - 1 && sy >= 0 && sy < src_height - 1;
+            if (!inner && outer_value >= 0) {
+                std::fill(dst, dst + channels, outer_value);
+                continue;
+            }
+            sx = std::max(0.0, std::min(src_width - 1 - 1e-5, sx));
+            sy = std::max(0.0, std::min(src_height - 1 - 1e-5, sy));
+            int ix = int(sx), iy = int(sy);
+            double wx = sx - ix, wy = sy - iy;
+            auto src = fx.data<float>();
+            for (int c = 0; c < channels; ++c) {
+                auto value = (1 - wy) * (1 - wx) * src[(iy * src_width + ix) * channels + c] +
+                             (1 - wy) * wx * src[(iy * src_width + ix + 1) * channels + c] +
+                             wy * (1 - wx) * src[((iy + 1) * src_width + ix) * channels + c] +
+                             wy * wx * src[((iy + 1) * src_width + ix + 1) * channels + c];
+                // integer is truncated, as the float kernel does
+                dst[c] = float(x.dtype() == FLOAT32 ? value : std::trunc(value));
+            }
+        }
+    }
+    return y;
+}
+
+/**
+ * @return if |a - b| <= epsilon for each value, a of any dtype, b in float
+ */
+static bool within(const Tensor &a, const Tensor &b, float epsilon) {
+    if (a.sizes() != b.sizes()) return false;
+    auto fa = tensor::cast(FLOAT32, a);
+    for (int i = 0; i < fa.count(); ++i) {
+        if (std::fabs(fa.data<float>()[i] - b.data<float>()[i]) > epsilon) return false;
+    }
+    return true;
+}
+
+/**
+ * @param epsilon 0 for same bytes, linear batch samples in fixed point but single sample in float
+ * @return if k-th slice of batch output equals sampling with k-th matrix alone
+ */
+static bool batch_equals_singles(const Tensor &x, int height, int width, const std::vector<Matrix> &affine,
+                                 desc::ResizeType type, float outer_value, float epsilon = 0) {
+    auto batch = sample(x, height, width, matrices(affine), type, outer_value);
+    if (batch.sizes() != Shape({int(affine.size()), height, width, x.size(2)})) return false;
+    for (size_t k = 0; k < affine.size(); ++k) {
+        auto single = sample(x, height, width, matrices({affine[k]}).reshape({3, 3}), type, outer_value);
+        auto slice = batch.slice(int(k));
+        if (epsilon > 0 ? !within(slice, tensor::cast(FLOAT32, single), epsilon) : !same(slice, single)) return false;
+    }
+    return true;
+}
+
+int main() {
+    Report report;
+
+    Workbench bench(ComputingDevice(CPU), 4);
+    ctx::bind<Workbench> _bind_bench(bench);
+
+    const int src_height = 60, src_width = 80, dst_height = 32, dst_width = 40;
+    // inside crops, crops crossing each border, a flip and a near identity, so row walk goes every direction
+    std::vector<Matrix> crops = {
+            crop_matrix(0.0f, 1.0f, -20, -16, src_width, src_height),
+            crop_matrix(0.3f, 0.75f, -15, -12, src_width, src_height),
+            crop_matrix(-1.2f, 1.6f, 10, -5, src_width, src_height),
+            crop_matrix(3.1f, 2.5f, 30, 25, src_width, src_height),
+            {-1.0f, 0, float(src_width - 1), 0, 1.0f, 3.5f, 0, 0, 1},
+            {1.0001f, 0, 0.25f, 0, 0.9999f, -0.25f, 0, 0, 1},
+    };
+
+    const std::vector<desc::ResizeType> types = {desc::ResizeType::LINEAR, desc::ResizeType::NEAREST,
+                                                 desc::ResizeType::CUBIC};
+    const char *type_names[] = {"linear", "nearest", "cubic"};
+    for (auto dtype : {UINT8, FLOAT32, INT32}) {
+        for (int channels : {1, 3, 4, 7}) {
+            auto x = random_image(dtype, src_height, src_width, channels, unsigned(channels));
+            for (size_t t = 0; t < types.size(); ++t) {
+                auto epsilon = types[t] != desc::ResizeType::LINEAR ? 0.0f : dtype == FLOAT32 ? 1e-2f : 1.0f;
+                bool ok = true;
+                for (float outer_value : {-1.0f, 114.0f}) {
+                    ok = ok && batch_equals_singles(x, dst_height, dst_width, crops, types[t], outer_value, epsilon);
+                }
+                std::ostringstream title;
+                title << "batch " << type_str(dtype) << " " << type_names[t] << " " << channels << " channels";
+                report(title.str(), ok);
+            }
+        }
+    }
+
+    // a projective matrix in batch falls back to affine_sample_batch_run of base operator
+    {
+        auto x = random_image(UINT8, src_height, src_width, 3, 1);
+        auto projective = crops;
+        projective[2][8] = 2;
+        report("batch fallback with projective matrix",
+               batch_equals_singles(x, dst_height, dst_width, projective, desc::ResizeType::LINEAR, -1));
+    }
+
+    // image narrower than 2 pixels falls back too
+    {
+        auto x = random_image(FLOAT32, 1, src_width, 3, 2);
+        std::vector<Matrix> strips = {{1, 0, 0, 0, 1, 0, 0, 0, 1}, {0.5f, 0, 3, 0, 1, 0, 0, 0, 1}};
+        report("batch fallback with one row image",
+               batch_equals_singles(x, 1, dst_width, strips, desc::ResizeType::LINEAR, 0));
+    }
+
+    // fixed point linear sampling against float reference
+    for (auto dtype : {UINT8, FLOAT32}) {
+        for (int channels : {1, 3, 4, 7}) {
+            auto x = random_image(dtype, src_height, src_width, channels, unsigned(channels) + 10);
+            bool ok = true;
+            for (float outer_value : {-1.0f, 114.0f}) {
+                auto batch = sample(x, dst_height, dst_width, matrices(crops), desc::ResizeType::LINEAR, outer_value);
+                for (size_t k = 0; ok && k < crops.size(); ++k) {
+                    auto expected = reference_linear(x, dst_height, dst_width, crops[k], outer_value);
+                    // uint8 blends with 11 bits integer weights, float walks rows with 20 bits coordinates
+                    ok = within(batch.slice(int(k)), expected, dtype == UINT8 ? 1.0f : 1e-2f);
+                }
+            }
+            std::ostringstream title;
+            title << "fixed point " << type_str(dtype) << " " << channels << " channels";
+            report(title.str(), ok);
+        }
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,112 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <cmath>
+#include <chrono>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * build residual like graph: x = x + relu(x), with a skip from `skip` blocks before every `skip` blocks
+ */
+static Module::shared build_residual(int blocks, int skip) {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32, {1, 4});
+    std::vector<Node> history = {x};
+    for (int i = 0; i < blocks; ++i) {
+        auto id = std::to_string(i);
+        auto y = bubble::op("relu_" + id, name::layer::relu(), {x});
+        x = bubble::op("add_" + id, name::layer::add(), {x, y});
+        if (skip > 0 && i % skip == skip - 1) {
+            auto &from = history[history.size() - skip];
+            x = bubble::op("skip_" + id, name::layer::add(), {x, from});
+        }
+        history.push_back(x);
+    }
+    auto module = std::make_shared<Module>();
+    module->load(g, {x});
+    return module;
+}
+
+/**
+ * build rnn like unrolled graph: h = sigmoid(h + x_t + c), c is const and folded in compiling
+ */
+static Module::shared build_unrolled(int steps) {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32, {1, 4});
+    auto c = bubble::data("c", tensor::build(FLOAT32, {0.0f, 0.0f, 0.0f, 0.0f}));
+    auto bias = bubble::op("bias", name::layer::add(), {c, c});
+    Node h = x;
+    for (int i = 0; i < steps; ++i) {
+        auto id = std::to_string(i);
+        auto s = bubble::op("step_" + id, name::layer::add(), {h, x});
+        s = bubble::op("bias_" + id, name::layer::add(), {s, bias});
+        h = bubble::op("h_" + id, name::layer::sigmoid(), {s});
+    }
+    auto module = std::make_shared<Module>();
+    module->load(g, {h});
+    return module;
+}
+
+static Tensor run(Workbench::shared bench, const std::vector<float> &x) {
+    bench->input(0, tensor::build(FLOAT32, Shape({1, 4}), x));
+    bench->run();
+    return bench->output(0);
+}
+
+static Workbench::shared timed_load(const std::string &title, Module::shared module) {
+    auto start = std::chrono::system_clock::now();
+    auto bench = Workbench::Load(module, ComputingDevice(CPU));
+    auto end = std::chrono::system_clock::now();
+    std::chrono::duration<double, std::milli> spent = end - start;
+    std::cout << "Load " << title << ": " << spent.count() << "ms" << std::endl;
+    return bench;
+}
+
+int main() {
+    Report report;
+
+    // small graphs checked by value
+    {
+        auto bench = timed_load("residual 10 blocks", build_residual(10, 0));
+        auto y = run(bench, {-1, 0, 1, 2});
+        auto expected = tensor::build(FLOAT32, Shape({1, 4}), {-1, 0, 1024, 2048});
+        report("residual 10 blocks", near(y, expected, 1e-6f));
+    }
+    {
+        // every 2 blocks: x = 4 * x + x = 5 * x for positive x, x = x + x for negative x
+        auto bench = timed_load("residual 8 blocks with skip", build_residual(8, 2));
+        auto y = run(bench, {-1, 0, 1, 2});
+        auto expected = tensor::build(FLOAT32, Shape({1, 4}), {-16, 0, 625, 1250});
+        report("residual 8 blocks with skip", near(y, expected, 1e-6f));
+    }
+    {
+        auto bench = timed_load("unrolled 3 steps", build_unrolled(3));
+        auto y = run(bench, {0, 0, 0, 0});
+        float h = 0;
+        for (int i = 0; i < 3; ++i) h = 1 / (1 + std::exp(-h));
+        auto expected = tensor::build(FLOAT32, Shape({1, 4}), std::vector<float>(4, h));
+        report("unrolled 3 steps", near(y, expected, 1e-5f));
+    }
+
+    // compile speed on very large graphs
+    for (int size : {1000, 5000, 10000, 50000}) {
+        auto nodes = std::to_string(size * 2 + size / 8);
+        timed_load("residual " + nodes + " nodes", build_residual(size, 8));
+    }
+    for (int size : {1000, 5000, 10000, 50000}) {
+        auto nodes = std::to_string(size * 3);
+        timed_load("unrolled " + nodes + " nodes", build_unrolled(size));
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,92 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * conv3x3 layers, each kernel is a const subgraph: kernel * scale + shift, folded in compiling
+ */
+static Module::shared build_net(int layers, int channels) {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32, {1, channels, 32, 32});
+    Node y = x;
+    for (int i = 0; i < layers; ++i) {
+        auto id = std::to_string(i);
+        auto w = bubble::data("w_" + id, random_tensor({channels, channels, 3, 3}, unsigned(i)));
+        auto scale = bubble::data("scale_" + id, tensor::from<float>(0.5f));
+        auto shift = bubble::data("shift_" + id, tensor::from<float>(0.01f));
+        auto kernel = bubble::op("kernel_" + id, name::layer::add(), {
+            bubble::op("scaled_" + id, name::layer::mul(), {w, scale}), shift});
+        y = conv2d("conv_" + id, y, kernel, 1);
+        y = bubble::op("relu_" + id, name::layer::relu(), {y});
+    }
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+static Tensor run(int threads, const Tensor &x, bool show_profile) {
+    // kernels packed in place when compiling, so build net each time
+    auto module = build_net(16, 16);
+
+    Workbench bench(ComputingDevice(CPU), threads);
+    bench.do_profile(true);
+
+    auto start = std::chrono::steady_clock::now();
+    auto program = bench.compile(module, "");
+    std::chrono::duration<double, std::milli> spent = std::chrono::steady_clock::now() - start;
+    std::cout << "compile with " << threads << " threads: " << spent.count() << "ms" << std::endl;
+    if (show_profile) bench.profiler().log(std::cout);
+
+    bench.setup(program);
+    bench.input(0, x);
+    bench.run();
+    return bench.output(0).clone();
+}
+
+int main() {
+    Report report;
+
+    auto x = random_tensor({1, 16, 32, 32}, 100);
+    auto expected = run(1, x, false);
+    auto first = run(4, x, true);
+    report("4 threads compiled output", near(first, expected));
+    for (int i = 0; i < 3; ++i) {
+        // compiled in different order each time, result must be same bit by bit
+        auto y = run(4, x, false);
+        report("4 threads compiled again " + std::to_string(i),
+               y.count() == first.count() &&
+               std::memcmp(y.data(), first.data(), size_t(y.count()) * sizeof(float)) == 0);
+    }
+
+    {
+        Workbench bench(ComputingDevice(CPU), 4);
+        bench.do_profile(true);
+        bench.compile(build_net(2, 4), "");
+        bool has_phases = true;
+        for (auto &phase : {"compile/translate", "compile/zip", "compile/fold", "compile/init", "compile/link"}) {
+            bool found = false;
+            for (auto &pair : bench.profiler().board()) {
+                if (pair.first == phase) found = true;
+            }
+            has_phases = has_phases && found;
+        }
+        report("compile phases profiled", has_phases);
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,161 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+#include <global/operator_factory.h>
+
+#include <iostream>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * conv, relu, pooling2d_v2 (not reentrant), then inner_prod
+ */
+static Module::shared build_net() {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32, {1, 8, 32, 32});
+    auto conv = conv2d("conv", x, random_tensor({16, 8, 3, 3}, 1), 1);
+    auto relu = bubble::op("relu", name::layer::relu(), {conv});
+    auto pool = bubble::op("pool", name::layer::pooling2d_v2(), {
+            relu,
+            bubble::data("pool_padding", tensor::build(INT32, Shape({4, 2}), {0, 0, 0, 0, 0, 0, 0, 0})),
+            bubble::data("pool_ksize", tensor::build(INT32, {1, 1, 2, 2})),
+            bubble::data("pool_stride", tensor::build(INT32, {1, 1, 2, 2}))});
+    pool->set(name::format, tensor::from(name::NCHW));
+    auto flatten = bubble::op("flatten", name::layer::flatten(), {pool});
+    auto fc = bubble::data("fc_w", random_tensor({16 * 16 * 16, 10}, 2));
+    auto y = bubble::op("fc", name::layer::inner_prod(), {flatten, fc});
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+/**
+ * operators writing state of input size in run: slice_v3, nhwc_scale_resize2d,
+ *     nhwc_letterbox falling back to affine_sample2d, and sample2d
+ */
+static Module::shared build_resize_net() {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32);
+    auto slice = bubble::op("slice", "slice_v3", {
+            x,
+            bubble::data("slice_starts", tensor::build(INT32, {1, 2})),
+            bubble::data("slice_ends", tensor::build(INT32, {-1, -2})),
+            bubble::data("slice_axes", tensor::build(INT32, {1, 2}))});
+    auto resize = bubble::op("resize", name::layer::nhwc_scale_resize2d(), {x});
+    resize->set(name::size, tensor::build(INT32, {24, 18}));
+    auto letterbox = bubble::op("letterbox", name::layer::nhwc_letterbox(), {x});
+    letterbox->set(name::size, tensor::build(INT32, {20, 16}));
+    letterbox->set(name::type, tensor::from<int32_t>(1));   // cubic, sampled by affine_sample2d
+    auto sample = bubble::op("sample", name::layer::sample2d(), {x});
+    sample->set(name::scale, tensor::from<float>(1.5f));
+    sample->set(name::dim, tensor::from<int32_t>(1));
+    auto module = std::make_shared<Module>();
+    module->load(g, {slice, resize, letterbox, sample});
+    return module;
+}
+
+/**
+ * @return number of runs of given threads, whose outputs not equal to expected
+ */
+static int run_concurrent(Workbench &bench, const std::vector<Tensor> &inputs,
+                          const std::vector<std::vector<Tensor>> &expected, int threads, int loops) {
+    std::atomic<int> mismatched(0);
+    std::vector<std::thread> runners;
+    for (int t = 0; t < threads; ++t) {
+        runners.emplace_back([&, t]() {
+            for (int i = 0; i < loops; ++i) {
+                auto sample = size_t(t + i) % inputs.size();
+                auto outputs = bench.run({inputs[sample]});
+                bool ok = outputs.size() == expected[sample].size();
+                for (size_t j = 0; ok && j < outputs.size(); ++j) ok = same(outputs[j], expected[sample][j]);
+                if (!ok) ++mismatched;
+            }
+        });
+    }
+    for (auto &runner : runners) runner.join();
+    return mismatched;
+}
+
+int main() {
+    Report report;
+
+    // contexts share thread pool of workbench
+    Workbench bench(ComputingDevice(CPU), 4);
+    bench.setup(bench.compile(build_net()));
+
+    // expected outputs by serial run
+    const int samples = 8;
+    std::vector<Tensor> inputs;
+    std::vector<std::vector<Tensor>> expected;
+    for (int i = 0; i < samples; ++i) {
+        inputs.push_back(random_tensor({1, 8, 32, 32}, unsigned(100 + i)));
+        bench.input(0, inputs.back());
+        bench.run();
+        expected.push_back({bench.output(0).clone()});
+    }
+
+    const int threads = 4;
+    const int loops = 50;
+    auto start = std::chrono::steady_clock::now();
+    auto mismatched = run_concurrent(bench, inputs, expected, threads, loops);
+    std::chrono::duration<double, std::milli> spent = std::chrono::steady_clock::now() - start;
+    std::cout << threads << " threads x " << loops << " runs: " << spent.count() << "ms" << std::endl;
+    report("concurrent outputs", mismatched == 0);
+
+    // serial run still works with concurrent contexts
+    bench.input(0, inputs[0]);
+    bench.run();
+    report("serial run after concurrent", same(bench.output(0), expected[0][0]));
+
+    {
+        // forked programs share reentrant operators, so operators keeping state in run must be cloned
+        bool cloned = true;
+        for (auto &op : {std::string("slice_v3"), name::layer::nhwc_scale_resize2d(),
+                         name::layer::nhwc_letterbox(), name::layer::sample2d()}) {
+            cloned = cloned && !OperatorCreator::Create(CPU, op, false)->reentrant();
+        }
+        report("stateful operators not reentrant", cloned);
+
+        // only audited operators are shared, others are cloned by default
+        bool shared = true;
+        for (auto &op : {name::layer::conv2d(), name::layer::relu(), name::layer::add(), name::layer::flatten(),
+                         name::layer::inner_prod(), name::layer::softmax(), name::layer::transpose(),
+                         name::layer::concat()}) {
+            shared = shared && OperatorCreator::Create(CPU, op, false)->reentrant();
+        }
+        report("audited operators reentrant", shared);
+        report("operators not reentrant by default",
+               !OperatorCreator::Create(CPU, name::layer::pad(), false)->reentrant());
+    }
+
+    {
+        // each sample has its own size, so state left by another thread gives wrong shape or value
+        Workbench resize_bench(ComputingDevice(CPU), 1);
+        resize_bench.setup(resize_bench.compile(build_resize_net()));
+        std::vector<Tensor> images;
+        std::vector<std::vector<Tensor>> resized;
+        for (int i = 0; i < samples; ++i) {
+            images.push_back(random_tensor({1, 12 + 3 * i, 30 - 2 * i, 3}, unsigned(200 + i)));
+            resize_bench.input(0, images.back());
+            resize_bench.run();
+            std::vector<Tensor> outputs;
+            for (int j = 0; j < resize_bench.output_count(); ++j) outputs.push_back(resize_bench.output(j).clone());
+            resized.push_back(outputs);
+        }
+        report("concurrent stateful operators", run_concurrent(resize_bench, images, resized, threads, loops) == 0);
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,117 @@
+#include "test_utils.h"
+
+#include "kernels/cpu/dcn/dcn_v2.h"
+#include "kernels/cpu/dcn/dcn_v2_im2col_cpu.h"
+#include <kernels/cpu/math_cpu.h>
+#include <utils/random.h>
+
+#include <iostream>
+#include <cmath>
+#include <chrono>
+
+using namespace ts;
+using namespace ts::test;
+
+struct DCNCase {
+    int batch, channels, height, width;
+    int channels_out, kernel, stride, pad, deformable_group;
+};
+
+static void fill(Tensor &x, Random &rand, double scale) {
+    for (int i = 0; i < x.count(); ++i) x.data<float>()[i] = float((rand.u() * 2 - 1) * scale);
+}
+
+/**
+ * full column buffer then one gemm per image, as the original DCNv2 cpu implementation
+ */
+static void dcn_v2_full_im2col(const Tensor &x, const Tensor &w, const Tensor &b, const Tensor &offset, const Tensor &mask,
+                               const DCNCase &c, Tensor &out) {
+    int k = c.channels * c.kernel * c.kernel;
+    int ho = out.size(2), wo = out.size(3);
+    Tensor columns(FLOAT32, {c.batch, k, ho * wo});
+    modulated_deformable_im2col_cpu(x.data<float>(), offset.data<float>(), mask.data<float>(),
+                                    c.batch, c.channels, c.height, c.width, ho, wo, c.kernel, c.kernel,
+                                    c.pad, c.pad, c.stride, c.stride, 1, 1, c.deformable_group, columns.data<float>());
+    for (int n = 0; n < c.batch; ++n) {
+        float *out_at = out.data<float>() + n * c.channels_out * ho * wo;
+        cpu::math<float, float>::gemm(blas::NoTrans, blas::NoTrans, c.channels_out, ho * wo, k,
+                                      1.0f, w.data<float>(), columns.data<float>() + n * k * ho * wo, 0.0f, out_at);
+        for (int i = 0; i < c.channels_out; ++i) {
+            for (int j = 0; j < ho * wo; ++j) out_at[i * ho * wo + j] += b.data<float>()[i];
+        }
+    }
+}
+
+static bool test_case(const DCNCase &c, bool bench) {
+    Random rand(4399);
+    int ho = (c.height + 2 * c.pad - c.kernel) / c.stride + 1;
+    int wo = (c.width + 2 * c.pad - c.kernel) / c.stride + 1;
+    int kk = c.kernel * c.kernel;
+    Tensor x(FLOAT32, {c.batch, c.channels, c.height, c.width});
+    Tensor w(FLOAT32, {c.channels_out, c.channels, c.kernel, c.kernel});
+    Tensor b(FLOAT32, {c.channels_out});
+    Tensor offset(FLOAT32, {c.batch, c.deformable_group * 2 * kk, ho, wo});
+    Tensor mask(FLOAT32, {c.batch, c.deformable_group * kk, ho, wo});
+    fill(x, rand, 1);
+    fill(w, rand, 0.1);
+    fill(b, rand, 1);
+    fill(offset, rand, 3);
+    for (int i = 0; i < mask.count(); ++i) mask.data<float>()[i] = float(rand.u());
+
+    Tensor expected(FLOAT32, {c.batch, c.channels_out, ho, wo});
+    Tensor out(FLOAT32, {c.batch, c.channels_out, ho, wo});
+
+    using clock = std::chrono::system_clock;
+    auto start = clock::now();
+    dcn_v2_full_im2col(x, w, b, offset, mask, c, expected);
+    auto middle = clock::now();
+    dcn_v2_cpu_forward(x, w, b, offset, mask, c.kernel, c.kernel, c.stride, c.stride, c.pad, c.pad, 1, 1,
+                       c.deformable_group, &out);
+    auto end = clock::now();
+
+    for (int i = 0; i < out.count(); ++i) {
+        auto diff = std::fabs(out.data<float>()[i] - expected.data<float>()[i]);
+        if (diff > 1e-3f * std::max(1.0f, std::fabs(expected.data<float>()[i]))) {
+            std::cout << "[FAILED] at " << i << ": " << out.data<float>()[i] << " vs. "
+                      << expected.data<float>()[i] << std::endl;
+            return false;
+        }
+    }
+    if (bench) {
+        std::chrono::duration<double, std::milli> full = middle - start;
+        std::chrono::duration<double, std::milli> tiled = end - middle;
+        std::cout << "DCNv2 [" << c.batch << ", " << c.channels << ", " << c.height << ", " << c.width << "] -> "
+                  << c.channels_out << " k" << c.kernel << "s" << c.stride << ": full im2col " << full.count()
+                  << "ms, tiled " << tiled.count() << "ms" << std::endl;
+    }
+    return true;
+}
+
+int main() {
+    Report report;
+
+    int passed = 0, total = 0;
+    std::vector<DCNCase> cases = {
+            {1, 3, 7, 9, 5, 3, 1, 1, 1},
+            {2, 8, 13, 11, 16, 3, 2, 1, 2},
+            {1, 16, 20, 20, 9, 1, 1, 0, 4},
+            {1, 12, 31, 17, 24, 5, 1, 2, 3},
+    };
+    for (auto &c : cases) {
+        ++total;
+        if (test_case(c, false)) ++passed;
+    }
+    report(std::to_string(passed) + "/" + std::to_string(total) + " DCNv2 cases", passed == total);
+
+    // CenterNet (DLA-34 / ResNet) deformable up-sampling heads on 512x512 input
+    std::vector<DCNCase> heads = {
+            {1, 256, 32, 32, 128, 3, 1, 1, 1},
+            {1, 128, 64, 64, 64, 3, 1, 1, 1},
+            {1, 64, 128, 128, 64, 3, 1, 1, 1},
+    };
+    bool heads_ok = true;
+    for (auto &c : heads) heads_ok = test_case(c, true) && heads_ok;
+    report("DCNv2 heads", heads_ok);
+
+    return report.exit_code();
+}
@@ -0,0 +1,125 @@
+#include "test_utils.h"
+
+#include <encryption/encrypted_fstream.h>
+#include <module/io/fstream.h>
+#include <utils/log.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cstring>
+
+using namespace ts;
+using namespace ts::test;
+
+static std::vector<uint8_t> random_bytes(size_t size) {
+    std::mt19937 engine(static_cast<unsigned>(size));
+    std::vector<uint8_t> data(size);
+    for (auto &byte : data) byte = uint8_t(engine());
+    return data;
+}
+
+static void write_file(const std::string &path, const std::string &key, EncryptionMode mode,
+                       const std::vector<uint8_t> &data) {
+    EncryptedFileStreamWriter out(path, key, mode);
+    // odd sized writes
+    size_t offset = 0;
+    size_t step = 1;
+    while (offset < data.size()) {
+        auto n = std::min(step, data.size() - offset);
+        out.write(data.data() + offset, n);
+        offset += n;
+        step = step * 3 + 1;
+    }
+    out.close();
+}
+
+static bool check_sequential(const std::string &path, const std::string &key,
+                             const std::vector<uint8_t> &data) {
+    EncryptedFileStreamReader in(path, key);
+    if (in.size() != data.size()) return false;
+    std::vector<uint8_t> read(data.size());
+    size_t offset = 0;
+    size_t step = 4;
+    while (offset < read.size()) {
+        auto n = std::min(step, read.size() - offset);
+        if (in.read(read.data() + offset, n) != n) return false;
+        offset += n;
+        step = step * 7 + 3;
+    }
+    return read == data;
+}
+
+static bool check_random_access(const std::string &path, const std::string &key,
+                                const std::vector<uint8_t> &data) {
+    EncryptedFileStreamReader in(path, key);
+    std::mt19937 engine(7);
+    for (int i = 0; i < 100; ++i) {
+        auto offset = engine() % data.size();
+        auto size = std::min<size_t>(engine() % (256 * 1024), data.size() - offset);
+        std::vector<uint8_t> read(size);
+        if (!in.seek(offset)) return false;
+        if (in.read(read.data(), size) != size) return false;
+        if (std::memcmp(read.data(), data.data() + offset, size) != 0) return false;
+    }
+    return !in.seek(data.size() + 1);
+}
+
+/**
+ * FIPS-197 C.3, AES-256
+ */
+static bool check_known_answer() {
+    std::string key;
+    for (int i = 0; i < 32; ++i) key.push_back(char(i));
+    uint8_t plain[16];
+    for (int i = 0; i < 16; ++i) plain[i] = uint8_t(i * 0x11);
+    const uint8_t cipher[16] = {0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf,
+                                0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89};
+
+    TempFile file("encryption.kat");
+    write_file(file.path(), key, EncryptionMode::AES_ECB, std::vector<uint8_t>(plain, plain + 16));
+    FileStreamReader in(file.path());
+    uint8_t read[16];
+    if (in.read(read, 16) != 16) return false;
+    return std::memcmp(read, cipher, 16) == 0;
+}
+
+int main() {
+    Report report;
+
+    report("AES-256 known answer", check_known_answer());
+
+    TempFile file("encryption");
+    const auto &path = file.path();
+    std::string key = "TenniS";
+    for (auto mode : {EncryptionMode::AES_ECB, EncryptionMode::AES_CTR}) {
+        std::string name = mode == EncryptionMode::AES_ECB ? "ECB" : "CTR";
+        for (size_t size : {size_t(1), size_t(16), size_t(1000), size_t(3 * 1024 * 1024 + 5)}) {
+            auto data = random_bytes(size);
+            write_file(path, key, mode, data);
+            {
+                EncryptedFileStreamReader in(path, key);
+                report(name + " mode detected", in.mode() == mode);
+            }
+            report(name + " sequential read " + std::to_string(size), check_sequential(path, key, data));
+            report(name + " random access " + std::to_string(size), check_random_access(path, key, data));
+        }
+    }
+
+    // speed of decrypting big file
+    auto data = random_bytes(64 * 1024 * 1024);
+    for (auto mode : {EncryptionMode::AES_ECB, EncryptionMode::AES_CTR}) {
+        write_file(path, key, mode, data);
+        EncryptedFileStreamReader in(path, key);
+        std::vector<uint8_t> read(data.size());
+        auto start = std::chrono::steady_clock::now();
+        in.read(read.data(), read.size());
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::milli> spent = end - start;
+        std::cout << (mode == EncryptionMode::AES_ECB ? "ECB" : "CTR") << " read 64MB: " << spent.count() << "ms" << std::endl;
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,94 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <random>
+#include <cmath>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * conv, relu, then sigmoid as output, so relu is inner node
+ * @note compiling packs weights of module, so build one for each compiling
+ */
+static Module::shared build_net() {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32, {1, 4, 16, 16});
+    auto conv = conv2d("conv", x, random_tensor({4, 4, 3, 3}, 1), 1);
+    auto relu = bubble::op("relu", name::layer::relu(), {conv});
+    auto y = bubble::op("sigmoid", name::layer::sigmoid(), {relu});
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+int main() {
+    Report report;
+
+    std::vector<Tensor> inputs;
+    for (unsigned i = 0; i < 6; ++i) inputs.push_back(random_tensor({1, 4, 16, 16}, 10 + i));
+
+    // hooked relu of each input
+    std::vector<Tensor> hooked;
+    {
+        Workbench bench(ComputingDevice(CPU), 1);
+        bench.setup(bench.compile(build_net()));
+        for (auto &input : inputs) {
+            bench.input(0, input);
+            bench.run_hook({"relu"});
+            hooked.push_back(bench.output("relu").clone());
+        }
+        // output is sigmoid of hooked relu
+        auto &relu = hooked.back();
+        auto &output = bench.output(0);
+        bool ok = relu.count() == 4 * 16 * 16 && is_sigmoid(output, relu);
+        for (int i = 0; ok && i < relu.count(); ++i) ok = relu.data<float>()[i] >= 0;
+        report("run hook", ok);
+    }
+
+    {
+        Workbench bench(ComputingDevice(CPU), 1);
+        bench.setup(bench.compile(build_net()));
+        bench.set_capture({"relu", "not_exist"}, 2, 2);
+        for (auto &input : inputs) {
+            bench.input(0, input);
+            bench.run();
+        }
+        // runs 1, 3, 5 sampled, 3 and 5 kept
+        report("captured count", bench.captured_count() == 2);
+        report("captured serial", bench.captured_serial(0) == 5 && bench.captured_serial(1) == 3);
+        report("captured latest", same(bench.captured(0, "relu"), hooked[4]));
+        report("captured older", same(bench.captured(1, "relu"), hooked[2]));
+        report("not captured", bench.captured(0, "not_exist").empty() && bench.captured(2, "relu").empty());
+
+        auto data = bench.captured(0, "relu").data();
+        for (auto &input : inputs) {
+            bench.input(0, input);
+            bench.run();
+        }
+        // runs 7, 9, 11 sampled, slots reused
+        auto reused = bench.captured(0, "relu").data() == data || bench.captured(1, "relu").data() == data;
+        report("slots reused", bench.captured_serial(0) == 11 && reused);
+        report("captured after reuse", same(bench.captured(0, "relu"), hooked[4]));
+
+        bench.set_capture_interval(0);
+        bench.input(0, inputs[0]);
+        bench.run();
+        report("capture paused", bench.captured_serial(0) == 11);
+
+        bench.run_hook({"relu"});
+        report("run hook keeps capture", same(bench.output("relu"), hooked[0]) && bench.captured_serial(0) == 11);
+
+        bench.set_capture({});
+        report("capture stopped", bench.captured_count() == 0);
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,97 @@
+#include "test_utils.h"
+
+#include <runtime/image_filter.h>
+#include <runtime/workbench.h>
+#include <module/module.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+
+using namespace ts;
+using namespace ts::test;
+
+static Tensor random_image(int height, int width, int channels, unsigned seed) {
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<int> uniform(0, 255);
+    Tensor image(UINT8, {1, height, width, channels});
+    for (int i = 0; i < image.count(); ++i) image.data<uint8_t>()[i] = uint8_t(uniform(engine));
+    return image;
+}
+
+template<typename FUNC>
+static double spent(int loops, FUNC func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < loops; ++i) func();
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    return duration.count() / loops;
+}
+
+int main() {
+    Report report;
+
+    ComputingDevice device(CPU);
+    Workbench bench(device, 4);
+    ctx::bind<Workbench> _bind_bench(bench);
+
+    using Setup = std::function<void(ImageFilter &)>;
+    std::vector<std::pair<std::string, Setup>> cases = {
+            {"detector", [](ImageFilter &filter) {
+                filter.resize(320, 240);
+                filter.to_float();
+                filter.channel_swap({2, 1, 0});
+                filter.sub_mean({104, 117, 123});
+                filter.div_std({58.4f, 57.1f, 57.4f});
+                filter.to_chw();
+            }},
+            {"float resize", [](ImageFilter &filter) {
+                filter.channel_swap({2, 1, 0});
+                filter.to_float();
+                filter.scale(1 / 255.0f);
+                filter.resize(160, 160);
+                filter.to_chw();
+            }},
+            {"nearest", [](ImageFilter &filter) {
+                filter.to_float();
+                filter.resize(200, 100, ImageFilter::ResizeMethod::NEAREST);
+                filter.sub_mean({127.5f});
+                filter.div_std({128});
+            }},
+            {"uint8", [](ImageFilter &filter) {
+                filter.resize(128, 96);
+                filter.channel_swap({2, 1, 0});
+                filter.to_chw();
+            }},
+            {"partial", [](ImageFilter &filter) {
+                filter.to_float();
+                filter.sub_mean({104, 117, 123});
+                filter.center_crop(300, 200);
+                filter.resize(112, 112, ImageFilter::ResizeMethod::BICUBIC);
+                filter.channel_swap({2, 1, 0});
+                filter.to_chw();
+            }},
+    };
+
+    auto image = random_image(480, 640, 3, 1);
+    for (auto &test : cases) {
+        ImageFilter filter(device);
+        test.second(filter);
+        filter.compile();
+        auto unfused = Program::Compile(filter.module(), device);
+
+        auto fused_output = filter.run(image).clone();
+        auto unfused_output = bench.launch_offline(unfused, {image})[0].clone();
+        report(test.first + " output", fused_output.dtype() == unfused_output.dtype() &&
+               near(tensor::cast(FLOAT32, fused_output), tensor::cast(FLOAT32, unfused_output)));
+
+        auto fused_time = spent(20, [&]() { filter.run(image); });
+        auto unfused_time = spent(20, [&]() { bench.launch_offline(unfused, {image}); });
+        std::cout << test.first << ": fused " << fused_time << "ms, unfused " << unfused_time << "ms" << std::endl;
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,134 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <cmath>
+
+using namespace ts;
+using namespace ts::test;
+
+static Tensor random_image(DTYPE dtype, const Shape &shape, unsigned seed) {
+    std::mt19937 engine(seed);
+    std::uniform_int_distribution<int> uniform(0, 255);
+    Tensor image(FLOAT32, shape);
+    for (int i = 0; i < image.count(); ++i) image.data<float>()[i] = float(uniform(engine));
+    return tensor::cast(dtype, image);
+}
+
+static Tensor run(Module::shared module, const Tensor &x) {
+    Workbench bench(ComputingDevice(CPU), 2);
+    bench.setup(bench.compile(module));
+    bench.input(0, x);
+    bench.run();
+    return bench.output(0).clone();
+}
+
+static Module::shared letterbox_net(DTYPE dtype, int width, int height, int type, float outer_value) {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", dtype);
+    auto y = bubble::op("letterbox", name::layer::nhwc_letterbox(), {x});
+    y->set(name::size, tensor::build(INT32, {width, height}));
+    y->set(name::type, tensor::from<int32_t>(type));
+    y->set(name::outer_value, tensor::from<float>(outer_value));
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+/**
+ * letterbox was sampled by affine, which is the reference
+ */
+static Module::shared affine_net(DTYPE dtype, const Tensor &x, int width, int height, int type, float outer_value) {
+    auto scale = std::min(float(width) / x.size(2), float(height) / x.size(1));
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto input = bubble::param("x", dtype);
+    auto size = bubble::data("size", tensor::build(INT32, {height, width}));
+    auto affine = bubble::data("affine", tensor::build(FLOAT32, Shape({3, 3}),
+                                                       {1 / scale, 0.0f, 0.0f, 0.0f, 1 / scale, 0.0f, 0.0f, 0.0f, 1.0f}));
+    auto y = bubble::op("sample", name::layer::affine_sample2d(), {input, size, affine});
+    y->set(name::type, tensor::from<int32_t>(type));
+    y->set(name::dim, tensor::from<int32_t>(1));
+    y->set(name::outer_value, tensor::from<float>(outer_value));
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+static Module::shared divided_net(DTYPE dtype, const std::vector<int32_t> &size, float padding_value) {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", dtype);
+    auto y = bubble::op("divided", name::layer::divided(), {x});
+    y->set(name::size, tensor::build(INT32, size));
+    y->set(name::padding_value, tensor::from<float>(padding_value));
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+int main() {
+    Report report;
+
+    struct Case {
+        int number, height, width, channels;
+        int out_width, out_height;
+    };
+    std::vector<Case> cases = {
+            {1, 120, 200, 3, 96, 96},     // down scale, bottom border
+            {2, 50, 30, 3, 64, 64},       // up scale, right border
+            {1, 31, 47, 1, 47, 31},       // same size
+            {1, 17, 23, 4, 160, 90},      // up scale, source rows reused
+    };
+    const char *types[] = {"linear", "cubic", "nearest", "hard"};
+
+    for (auto dtype : {UINT8, FLOAT32}) {
+        for (auto &c : cases) {
+            for (int type : {0, 2, 3}) {
+                for (float outer_value : {0.0f, 114.0f}) {
+                    auto x = random_image(dtype, {c.number, c.height, c.width, c.channels}, unsigned(c.width));
+                    auto y = run(letterbox_net(dtype, c.out_width, c.out_height, type, outer_value), x);
+                    auto expected = run(affine_net(dtype, x, c.out_width, c.out_height, type, outer_value), x);
+
+                    std::ostringstream title;
+                    title << "letterbox " << type_str(dtype) << " " << types[type] << " "
+                          << c.width << "x" << c.height << " to " << c.out_width << "x" << c.out_height
+                          << " outer " << outer_value;
+                    report(title.str(), same(y, expected));
+                }
+            }
+        }
+    }
+
+    for (auto dtype : {UINT8, FLOAT32, INT32}) {
+        auto x = random_image(dtype, {2, 13, 10, 3}, 7);
+        auto y = run(divided_net(dtype, {8, 4, 1}, 3), x);
+        bool ok = y.sizes() == Shape({2, 16, 12, 3});
+        auto fx = tensor::cast(FLOAT32, x);
+        auto fy = tensor::cast(FLOAT32, y);
+        for (int n = 0; ok && n < 2; ++n)
+        for (int h = 0; ok && h < 16; ++h)
+        for (int w = 0; ok && w < 12; ++w)
+        for (int c = 0; ok && c < 3; ++c) {
+            auto value = h < 13 && w < 10 ? fx.data<float>()[((n * 13 + h) * 10 + w) * 3 + c] : 3.0f;
+            ok = fy.data<float>()[((n * 16 + h) * 12 + w) * 3 + c] == value;
+        }
+        report(std::string("divided ") + type_str(dtype), ok);
+    }
+
+    {
+        auto x = random_image(UINT8, {1, 16, 12, 3}, 9);
+        auto y = run(divided_net(UINT8, {8, 4, 1}, 0), x);
+        report("divided already divided", same(y, x));
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,130 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <random>
+#include <cmath>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * conv with large im2col workspace, then relu
+ * @param sum_on_batch sum conv on batch instead of relu, dropping batch dim, so output is not batched as input
+ * @note compiling packs weights of module, so build one for each compiling
+ */
+static Module::shared build_net(bool sum_on_batch = false) {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32);
+    auto w = bubble::data("w", random_tensor({16, 16, 5, 5}, 1));
+    auto conv = bubble::op("conv", name::layer::conv2d(), {x, w});
+    conv->set(name::format, tensor::from(name::NCHW));
+    conv->set(name::padding, tensor::build(INT32, Shape({4, 2}), {0, 0, 0, 0, 2, 2, 1, 3}));
+    conv->set(name::stride, tensor::build(INT32, {1, 1, 2, 1}));
+    conv->set(name::dilation, tensor::build(INT32, {1, 1, 1, 1}));
+    auto y = sum_on_batch ? bubble::op("sum", name::layer::reduce_sum(), {conv})
+                          : bubble::op("relu", name::layer::relu(), {conv});
+    if (sum_on_batch) {
+        y->set(name::dims, tensor::from<int32_t>(0));
+        y->set(name::keep_dims, tensor::from<bool>(false));
+    }
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+int main() {
+    Report report;
+
+    auto input = random_tensor({1, 16, 96, 96}, 2);
+    auto batch = random_tensor({4, 16, 96, 96}, 3);
+
+    Tensor expected, expected_batch;
+    {
+        Workbench bench(ComputingDevice(CPU), 1);
+        bench.setup(bench.compile(build_net()));
+        bench.input(0, input);
+        bench.run();
+        expected = bench.output(0).clone();
+        bench.input(0, batch);
+        bench.run();
+        expected_batch = bench.output(0).clone();
+    }
+
+    {
+        // full im2col workspace is 16*25*48*96*4 = 7.0MB, output 0.6MB
+        const uint64_t limit = 3 << 20;
+        Workbench bench(ComputingDevice(CPU), 1);
+        bench.set_memory_budget(limit);
+        bench.setup(bench.compile(build_net()));
+        bench.input(0, input);
+        bench.run();
+        auto budget = bench.runtime().memory_budget();
+        report("tiled im2col output", near(bench.output(0), expected));
+        report("tiled im2col degraded", budget->degraded() > 0);
+        report("peak in budget", budget->peak() <= limit);
+        std::cout << bench.summary() << std::endl;
+
+        auto degraded = budget->degraded();
+        auto outputs = bench.run({input});
+        report("concurrent run in budget", outputs.size() == 1 && near(outputs[0], expected));
+        report("concurrent run degraded", budget->degraded() > degraded);
+        report("summary has budget", bench.summary().find("\"budget\"") != std::string::npos);
+    }
+
+    {
+        // outputs of one sample fit, outputs of whole batch not
+        const uint64_t limit = 2 << 20;
+        Workbench bench(ComputingDevice(CPU), 1);
+        bench.set_memory_budget(limit);
+        bench.setup(bench.compile(build_net()));
+        bench.input(0, batch);
+        bench.run();
+        auto budget = bench.runtime().memory_budget();
+        report("batch in budget output", near(bench.output(0), expected_batch));
+        report("batch in budget peak", budget->peak() <= limit);
+        std::cout << bench.summary() << std::endl;
+
+        auto degraded = budget->degraded();
+        Tensor output(FLOAT32, expected_batch.sizes());
+        bench.run_into({output});
+        report("run_into batch in budget", near(output, expected_batch) && budget->degraded() > degraded);
+    }
+
+    {
+        // batch refused, but samples can not be stacked back to output summed on batch
+        Workbench bench(ComputingDevice(CPU), 1);
+        bench.set_memory_budget(1 << 20);
+        bench.setup(bench.compile(build_net(true)));
+        bench.input(0, batch);
+        bool refused = false;
+        try {
+            bench.run();
+        } catch (const OutOfMemoryException &) {
+            refused = true;
+        }
+        report("refused when output not batched", refused);
+    }
+
+    {
+        Workbench bench(ComputingDevice(CPU), 1);
+        bench.set_memory_budget(64 << 10);
+        bench.setup(bench.compile(build_net()));
+        bench.input(0, input);
+        bool refused = false;
+        try {
+            bench.run();
+        } catch (const OutOfMemoryException &) {
+            refused = true;
+        }
+        report("refused when no way to degrade", refused && bench.runtime().memory_budget()->refused() > 0);
+    }
+
+    return report.exit_code();
+}
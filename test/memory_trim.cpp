@@ -0,0 +1,142 @@
+#include "test_utils.h"
+
+#include <kernels/cpu/memory_cpu.h>
+#include <global/hard_allocator.h>
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+#include <memory/orz/vat.h>
+
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <cstring>
+#include <vector>
+
+using namespace ts;
+using namespace ts::test;
+
+static bool aligned(const void *mem, size_t alignment) {
+    return reinterpret_cast<size_t>(mem) % alignment == 0;
+}
+
+/**
+ * @return resident memory in bytes, 0 if unknown
+ */
+static uint64_t resident() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, pages = 0;
+    if (!(statm >> size >> pages)) return 0;
+    return pages * 4096;
+}
+
+/**
+ * conv then relu, input size not fixed, so flow memory grows with input
+ */
+static Module::shared build_net() {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32);
+    auto conv = conv2d("conv", x, random_tensor({8, 8, 3, 3}, 1), 1);
+    auto y = bubble::op("relu", name::layer::relu(), {conv});
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+int main() {
+    Report report;
+
+    // cpu_allocator is registered as hard allocator of CPU
+    auto cpu_allocator = HardAllocator::Query(CPU);
+
+    {
+        bool ok = true;
+        for (size_t size : {1, 100, 4096, 3 << 20, 64 << 20}) {
+            auto mem = cpu_allocator(0, size, nullptr, 0);
+            ok = ok && aligned(mem, 64);
+            std::memset(mem, 1, size);
+            cpu_allocator(0, 0, mem, 0);
+        }
+        report("default alignment", ok);
+
+        CPUAllocator::SetAlignment(256);
+        auto mem = cpu_allocator(0, 1000, nullptr, 0);
+        report("set alignment", aligned(mem, 256));
+        std::memset(mem, 7, 1000);
+        // grow into large block, content kept
+        mem = cpu_allocator(0, 8 << 20, mem, 1000);
+        auto bytes = reinterpret_cast<unsigned char *>(mem);
+        report("realloc keeps content", aligned(mem, 256) && bytes[0] == 7 && bytes[999] == 7);
+        cpu_allocator(0, 0, mem, 0);
+        CPUAllocator::SetAlignment(64);
+    }
+
+    {
+        CPUAllocator::SetHugePage(CPUAllocator::HugePage::ADVISE);
+        auto size = size_t(64) << 20;
+        auto mem = cpu_allocator(0, size, nullptr, 0);
+        std::memset(mem, 1, size);
+        report("huge page block", aligned(mem, 64));
+        cpu_allocator(0, 0, mem, 0);
+
+        CPUAllocator::SetHugePage(CPUAllocator::HugePage::HUGETLB);
+        mem = cpu_allocator(0, size, nullptr, 0);   // falls back if hugetlb pool is empty
+        std::memset(mem, 1, size);
+        report("hugetlb block", aligned(mem, 64));
+        cpu_allocator(0, 0, mem, 0);
+        CPUAllocator::SetHugePage(CPUAllocator::HugePage::NONE);
+    }
+
+    // pots freed in ascending order, trim still releases the biggest first
+    {
+        Vat vat;
+        std::vector<void *> pots;
+        for (size_t size : {1 << 10, 2 << 10, 3 << 10, 4 << 10}) pots.push_back(vat.malloc(size));
+        for (auto pot : pots) vat.free(pot);
+        auto sum = vat.summary();
+        auto released = vat.trim(sum - 1);
+        report("trim biggest pot first", released == (4 << 10) && vat.summary() == sum - (4 << 10));
+        released = vat.trim(1 << 10);
+        report("trim keeps smallest pot", released == (5 << 10) && vat.summary() == (1 << 10));
+    }
+
+    Workbench bench(ComputingDevice(CPU), 1);
+    bench.setup(bench.compile(build_net()));
+
+    auto small = random_tensor({1, 8, 32, 32}, 2);
+    auto large = random_tensor({1, 8, 512, 512}, 3);
+
+    bench.input(0, small);
+    bench.run();
+    auto expected = bench.output(0).clone();
+
+    {
+        bench.input(0, large);
+        bench.run();
+        bench.input(0, small);
+        bench.run();
+        auto before = resident();
+        auto released = bench.trim(0);
+        auto after = resident();
+        std::cout << "trim released " << released << " bytes, resident " << before << " -> " << after << std::endl;
+        report("trim releases idle memory", released >= uint64_t(8 * 512 * 512 * 4));
+        report("trim gives memory back", before == 0 || after < before);
+        report("output kept after trim", same(bench.output(0), expected));
+    }
+
+    {
+        const uint64_t high_water = 1 << 20;
+        bench.set_trim_policy(int64_t(high_water));
+        bench.input(0, large);
+        bench.run();
+        bench.input(0, small);
+        bench.run();
+        report("trim policy", bench.trim(0) <= high_water);
+        report("run after trim", same(bench.output(0), expected));
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,78 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+#include <utils/numa.h>
+
+#include <iostream>
+#include <cmath>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * y = x + c, c is a large const in data segment
+ */
+static Module::shared build_add_const(int count) {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32, {count});
+    std::vector<float> c(count);
+    for (int i = 0; i < count; ++i) c[i] = float(i);
+    auto data = bubble::data("c", tensor::build(FLOAT32, Shape({count}), c));
+    auto y = bubble::op("y", name::layer::add(), {x, data});
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+static bool check(Workbench &bench, int count) {
+    bench.input(0, tensor::build(FLOAT32, Shape({count}), std::vector<float>(count, 1.0f)));
+    bench.run();
+    auto y = bench.output(0);
+    for (int i = 0; i < count; ++i) {
+        if (std::fabs(y.data<float>()[i] - float(i + 1)) > 1e-5f) return false;
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "NUMA nodes: " << NumaEnable::get_node_num() << std::endl;
+    for (int node = 0; node < NumaEnable::get_node_num(); ++node) {
+        std::cout << "Node " << node << ": " << NumaEnable::get_node_cpus(node).size() << " cpu(s)" << std::endl;
+    }
+    if (NumaEnable::get_node_num() == 0) {
+        std::cout << "[SKIP] no NUMA support" << std::endl;
+        return 0;
+    }
+
+    Report report;
+
+    const int count = 1 << 20;
+    auto bench = std::make_shared<Workbench>(ComputingDevice(CPU));
+    auto program = bench->compile(build_add_const(count));
+    bench->setup(program);
+    auto origin = program->data_segment(0).data();
+
+    report("set numa node", bench->set_numa_node(0, true) && bench->runtime().get_numa_node() == 0);
+    auto replica = program->data_segment(0).data();
+    report("data replicated", replica != origin && check(*bench, count));
+
+    // clones on same node share replica
+    auto dolly = bench->clone();
+    report("clone on same node", dolly->runtime().get_numa_node() == 0 && check(*dolly, count));
+    {
+        ctx::bind<RuntimeContext> _bind_runtime(bench->runtime());
+        auto dolly_program = program->clone();
+        report("replica shared", dolly_program->replicate_data_segment() &&
+                                 dolly_program->data_segment(0).data() == replica);
+    }
+
+    // not existing node
+    report("not existing node refused", !bench->set_numa_node(NumaEnable::get_node_num()));
+
+    return report.exit_code();
+}
@@ -2,7 +2,6 @@
 // Created by kier on 2018/12/21.
 //
 
-#include <omp.h>
 #include <cstdio>
 
 #include "runtime/runtime.h"
@@ -68,11 +67,15 @@ float dot3(const float *x, const float *y, int N) {
 }
 
 float dot4(const float *x, const float *y, int N) {
+    std::vector<float> parallel_sum(ts::openmp_threads(), 0);
+    ts::parallel_run([&](int, int begin, int end) {
+        auto id = ts::openmp_thread_id();
+        float local = 0;
+        for (int i = begin; i < end; ++i) local += x[i] * y[i];
+        parallel_sum[id] += local;
+    }, 0, N);
     float sum = 0;
-#pragma omp parallel for reduction(+:sum) num_threads(ts::openmp_threads(N / 4))
-    for (int i = 0; i < N; ++i) {
-        sum += x[i] * y[i];
-    }
+    for (auto value : parallel_sum) sum += value;
     return sum;
 }
 
@@ -114,7 +117,6 @@ float dot6(const float *x, const float *y, int N) {
 float dot7(const float *x, const float *y, int N) {
     float sum = 0;
     ts::float32x4 sumx4 = 0;
-//#pragma omp parallel for reduction(+:sumx4) num_threads(ts::openmp_threads(N / 4))
     for (int i = 0; i < N - 3; i += 4) {
         sumx4 += ts::float32x4(&x[i]) * ts::float32x4(&y[i]);
     }
@@ -129,12 +131,15 @@ float dot7(const float *x, const float *y, int N) {
 }
 
 float dot8(const float *x, const float *y, int N) {
+    std::vector<float> parallel_sum(ts::openmp_threads(), 0);
+    ts::parallel_run([&](int, int begin, int end) {
+        auto id = ts::openmp_thread_id();
+        ts::float32x4 sumx4 = 0;
+        for (int i = begin; i < end; ++i) sumx4 += ts::float32x4(&x[i * 4]) * ts::float32x4(&y[i * 4]);
+        parallel_sum[id] += ts::sum(sumx4);
+    }, 0, N / 4);
     float sum = 0;
-#pragma omp parallel for reduction(+:sum) num_threads(ts::openmp_threads(N / 4))
-    for (int i = 0; i < N - 3; i += 4) {
-        ts::float32x4 sumx4 = ts::float32x4(&x[i]) * ts::float32x4(&y[i]);
-        sum += ts::sum(sumx4);
-    }
+    for (auto value : parallel_sum) sum += value;
 
     for (int i = N / 4 * 4; i < N; ++i) {
         sum += x[i] * y[i];
@@ -144,17 +149,16 @@ float dot8(const float *x, const float *y, int N) {
 }
 
 void test_loop_bottom(int top, int top_id) {
-#pragma omp parallel for num_threads(1)
-    for (int i = 0; i < 10; ++i) {
-        printf("Top task: %2d, Top ID: %d, Bottom task: %2d, Bottom ID: %d\n", top, top_id, i, omp_get_thread_num());
-    }
+    // nested parallel_for runs inline on calling thread
+    ts::parallel_for(0, 10, [&](int i) {
+        printf("Top task: %2d, Top ID: %d, Bottom task: %2d, Bottom ID: %d\n", top, top_id, i, ts::openmp_thread_id());
+    });
 }
 
 void test_loop_top() {
-#pragma omp parallel for num_threads(1)
-    for (int i = 0; i < 10; ++i) {
-        test_loop_bottom(i, omp_get_thread_num());
-    }
+    ts::parallel_for(0, 10, [&](int i) {
+        test_loop_bottom(i, ts::openmp_thread_id());
+    });
 }
 
 using dot_function = std::function<float(const float *, const float *, int)>;
@@ -202,11 +206,11 @@ int main()
     print_avg_time("Pure CPU    ", times, dot1, a, b, N);
     print_avg_time("Pure CPU(4) ", times, dot2, a, b, N);
     print_avg_time("Threads CPU ", times, dot3, a, b, N);
-    print_avg_time("OpenMP CPU  ", times, dot4, a, b, N);
+    print_avg_time("Pool CPU    ", times, dot4, a, b, N);
     print_avg_time("Pure SIMD   ", times, dot5, a, b, N);
     print_avg_time("Threads SIMD", times, dot6, a, b, N);
-    print_avg_time("OpenMP SIMD ", times, dot7, a, b, N);
-    print_avg_time("OpenMP SIMD2", times, dot8, a, b, N);
+    print_avg_time("SIMD(4)     ", times, dot7, a, b, N);
+    print_avg_time("Pool SIMD   ", times, dot8, a, b, N);
 
     return 0;
 }
@@ -3,9 +3,14 @@
 //
 
 #include "runtime/inside/parallel.h"
+#include "kernels/cpu/math_cpu.h"
 
 #include "utils/log.h"
 
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
 void test_parallel_for() {
     for (int i = 0; i < 10; ++i) {
         TS_PARALLEL_FOR_BEGIN(j, 0, 10, i)
@@ -22,6 +27,78 @@ void test_parallel_range() {
     }
 }
 
+int test_thread_pool(ts::ThreadPool &pool) {
+    int failed = 0;
+    // every index visited once, nested calls run inline
+    std::vector<int> visited(10007, 0);
+    std::atomic<int> nested(0);
+    ts::parallel_for(0, 10007, [&](int i) {
+        ++visited[i];
+        if (i % 1000 == 0) ts::parallel_for(0, 10, [&](int) { ++nested; });
+    });
+    for (auto v : visited) if (v != 1) { ++failed; break; }
+    if (nested != 110) ++failed;
+
+    // exception thrown in worker comes back to caller
+    bool caught = false;
+    try {
+        ts::parallel_for(0, 1000, [&](int i) {
+            if (i == 777) throw std::runtime_error("777");
+        });
+    } catch (const std::runtime_error &) {
+        caught = true;
+    }
+    if (!caught) ++failed;
+
+    // pool still usable after exception, in every wait policy
+    for (auto policy : {ts::ThreadPool::WaitPolicy::PASSIVE,
+                        ts::ThreadPool::WaitPolicy::HYBRID,
+                        ts::ThreadPool::WaitPolicy::ACTIVE}) {
+        pool.set_wait_policy(policy);
+        std::atomic<int64_t> sum(0);
+        ts::parallel_for(0, 1000, [&](int i) { sum += i; });
+        if (sum != 499500) ++failed;
+    }
+    pool.set_wait_policy(ts::ThreadPool::WaitPolicy::HYBRID);
+
+    // async task and join
+    std::atomic<int> async(0);
+    for (int i = 0; i < 10; ++i) pool.run([&](int) { ++async; });
+    pool.join();
+    if (async != 10) ++failed;
+
+    // reductions split on fixed chunks, same bits whichever threads run them
+    std::vector<float> x(100003), y(100003);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = float(i % 97) / 7.0f - 6;
+        y[i] = float(i % 89) / 11.0f - 3;
+    }
+    auto N = int(x.size());
+    auto dot = ts::cpu::math<float, float>::dot(N, x.data(), y.data());
+    auto asum = ts::cpu::math<float, float>::asum(N, x.data(), 1);
+    for (int i = 0; i < 20; ++i) {
+        if (ts::cpu::math<float, float>::dot(N, x.data(), y.data()) != dot) { ++failed; break; }
+        if (ts::cpu::math<float, float>::asum(N, x.data(), 1) != asum) { ++failed; break; }
+    }
+    {
+        ts::ThreadPool other(3);
+        ts::ctx::bind<ts::ThreadPool> _bind_other(other);
+        if (ts::cpu::math<float, float>::dot(N, x.data(), y.data()) != dot) ++failed;
+        if (ts::cpu::math<float, float>::asum(N, x.data(), 1) != asum) ++failed;
+    }
+
+    // parallel in pool task runs inline on worker, caller keeps its thread id
+    std::atomic<int> inline_runs(0);
+    pool.run([&](int) {
+        ts::parallel_for(0, 4, [&](int) { ++inline_runs; });
+    });
+    pool.join();
+    if (inline_runs != 4 || ts::ThreadPool::ThreadID() != 0) ++failed;
+
+    TS_LOG_INFO << "[" << (failed ? "FAILED" : "OK") << "] thread pool";
+    return failed;
+}
+
 int main() {
 
     ts::ThreadPool pool(4);
@@ -31,6 +108,6 @@ int main() {
     test_parallel_for();
     test_parallel_range();
 
-    return 0;
+    return test_thread_pool(pool) ? 1 : 0;
 }
 
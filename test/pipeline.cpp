@@ -0,0 +1,209 @@
+#include "test_utils.h"
+
+#include <runtime/pipeline.h>
+#include <module/module.h>
+#include <module/menu.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+#include <limits>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * synthetic frame, whose value is its index
+ */
+static Pipeline::Frame frame_of(int index) {
+    return {tensor::from<int32_t>(index)};
+}
+
+static int index_of(const Pipeline::Frame &frame) {
+    return tensor::to_int(frame[0]);
+}
+
+static void sleep_ms(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+/**
+ * holds frames in stage function until released, so workers stop at known points
+ */
+class StageGate {
+public:
+    Pipeline::Function function() {
+        return [this](const Pipeline::Frame &frame) {
+            auto index = index_of(frame);
+            std::unique_lock<std::mutex> _lock(m_mutex);
+            m_entered.insert(index);
+            m_cond.notify_all();
+            m_cond.wait(_lock, [&]() { return index < m_released; });
+            return frame;
+        };
+    }
+
+    /**
+     * wait until worker holding frame of index
+     */
+    void wait_entered(int index) {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        m_cond.wait(_lock, [&]() { return m_entered.count(index) > 0; });
+    }
+
+    /**
+     * let frames before index pass
+     */
+    void release(int index) {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        m_released = std::max(m_released, index);
+        m_cond.notify_all();
+    }
+
+    void open() { release(std::numeric_limits<int>::max()); }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::set<int> m_entered;
+    int m_released = 0;
+};
+
+int main() {
+    Report report;
+
+    {
+        // workers of first stage finish out of order
+        Pipeline pipeline(2);
+        pipeline.add("shuffle", [](const Pipeline::Frame &frame) {
+            auto index = index_of(frame);
+            sleep_ms((index * 7) % 5);
+            return frame;
+        }, 3);
+        pipeline.add("double", [](const Pipeline::Frame &frame) {
+            return frame_of(index_of(frame) * 2);
+        });
+        std::thread producer([&]() {
+            for (int i = 0; i < 30; ++i) pipeline.push(frame_of(i));
+            pipeline.close();
+        });
+        Pipeline::Frame frame;
+        uint64_t serial;
+        bool ordered = true;
+        int count = 0;
+        while (pipeline.pop(frame, serial)) {
+            ordered = ordered && index_of(frame) == count * 2 && serial == uint64_t(count);
+            ++count;
+        }
+        producer.join();
+        report("frames in order", ordered && count == 30);
+
+        auto statistics = pipeline.statistics();
+        report("statistics", statistics.size() == 2 && statistics[0].name == "shuffle" &&
+                             statistics[0].run.count() == 30 && statistics[1].run.count() == 30 &&
+                             pipeline.latency().count() == 30 && pipeline.in_flight() == 0);
+    }
+
+    {
+        // queues of 1, workers held by gates
+        StageGate preprocess, inference;
+        Pipeline pipeline(1);
+        pipeline.add("preprocess", preprocess.function());
+        pipeline.add("inference", inference.function());
+
+        pipeline.push(frame_of(0));
+        preprocess.wait_entered(0);
+        bool ok = pipeline.try_push(frame_of(1)) && !pipeline.try_push(frame_of(2));
+        auto statistics = pipeline.statistics();
+        report("backpressure", ok && statistics[0].queued == 1 && statistics[1].queued == 0 &&
+                               pipeline.in_flight() == 2);
+
+        // frame 1 preprocessed while frame 0 inferring
+        preprocess.release(1);
+        inference.wait_entered(0);
+        preprocess.wait_entered(1);
+        statistics = pipeline.statistics();
+        report("stages overlapped", statistics[0].queued == 0 && statistics[1].queued == 0);
+
+        ok = pipeline.try_push(frame_of(2)) && !pipeline.try_push(frame_of(3));
+        report("pushed after queue drained", ok && pipeline.statistics()[0].queued == 1 && pipeline.in_flight() == 3);
+
+        preprocess.open();
+        inference.open();
+        Pipeline::Frame frame;
+        ok = true;
+        for (int i = 0; i < 3; ++i) {
+            ok = ok && pipeline.pop(frame) && index_of(frame) == i;
+        }
+        report("pushed after pop", ok && pipeline.in_flight() == 0 && pipeline.try_push(frame_of(3)));
+    }
+
+    {
+        Pipeline pipeline;
+        pipeline.add("check", [](const Pipeline::Frame &frame) {
+            if (index_of(frame) == 3) throw Exception("bad frame");
+            return frame;
+        }, 2);
+        int skipped = 0;
+        pipeline.add("count", [&](const Pipeline::Frame &frame) {
+            ++skipped;
+            return frame;
+        });
+        for (int i = 0; i < 6; ++i) pipeline.push(frame_of(i));
+        pipeline.close();
+        bool ok = true;
+        for (int i = 0; i < 6; ++i) {
+            Pipeline::Frame frame;
+            try {
+                ok = ok && pipeline.pop(frame) && i != 3 && index_of(frame) == i;
+            } catch (const Exception &e) {
+                ok = ok && i == 3 && std::string(e.what()).find("\"check\" failed on frame 3") != std::string::npos;
+            }
+        }
+        Pipeline::Frame frame;
+        report("failed frame", ok && skipped == 5 && !pipeline.pop(frame));
+    }
+
+    {
+        // filter, then workbench, on real images
+        auto filter = std::make_shared<ImageFilter>();
+        filter->to_float();
+        filter->scale(1.0f / 255);
+        auto bench = Workbench::Load(sigmoid_net(), ComputingDevice(CPU));
+
+        Pipeline pipeline;
+        pipeline.add("preprocess", filter, 2);
+        pipeline.add("sigmoid", bench, 2);
+
+        std::vector<Tensor> images;
+        for (int i = 0; i < 6; ++i) {
+            Tensor image(UINT8, {4, 5, 3});
+            for (int j = 0; j < image.count(); ++j) image.data<uint8_t>()[j] = uint8_t((i * 31 + j * 7) % 256);
+            images.push_back(image);
+        }
+        std::thread producer([&]() {
+            for (auto &image : images) pipeline.push({image});
+            pipeline.close();
+        });
+        bool ok = true;
+        Pipeline::Frame frame;
+        for (auto &image : images) {
+            ok = ok && pipeline.pop(frame) && frame.size() == 1 && frame[0].count() == image.count();
+            for (int j = 0; ok && j < image.count(); ++j) {
+                auto expected = 1 / (1 + std::exp(-image.data<uint8_t>()[j] / 255.0f));
+                ok = std::fabs(frame[0].data<float>()[j] - expected) < 1e-5f;
+            }
+        }
+        producer.join();
+        report("filter and workbench stages", ok && !pipeline.pop(frame));
+    }
+
+    return report.exit_code();
+}
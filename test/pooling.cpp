@@ -0,0 +1,115 @@
+#include "test_utils.h"
+
+#include <kernels/cpu/pooling_algorithm.h>
+#include <utils/random.h>
+
+#include <iostream>
+#include <cmath>
+#include <chrono>
+
+using namespace ts;
+using namespace ts::test;
+using namespace cpu;
+
+static void naive_pooling(const Tensor &x, Tensor &out, bool is_max, bool white,
+                          const Padding2D &padding, const KSize2D &ksize, const Stride2D &stride) {
+    auto &in_shape = x.sizes();
+    auto &out_shape = out.sizes();
+    int planes = in_shape[0] * in_shape[1];
+    int ih = in_shape[2], iw = in_shape[3], oh = out_shape[2], ow = out_shape[3];
+    for (int p = 0; p < planes; ++p) {
+        auto in = x.data<float>() + p * ih * iw;
+        auto o = out.data<float>() + p * oh * ow;
+        for (int h = 0; h < oh; ++h) {
+            for (int w = 0; w < ow; ++w) {
+                int hs = h * stride.height - padding.top, ws = w * stride.width - padding.left;
+                int he = std::min(hs + ksize.height, ih), we = std::min(ws + ksize.width, iw);
+                hs = std::max(hs, 0);
+                ws = std::max(ws, 0);
+                float acc = is_max ? -1e30f : 0.0f;
+                for (int y = hs; y < he; ++y) {
+                    for (int xx = ws; xx < we; ++xx) {
+                        auto v = in[y * iw + xx];
+                        acc = is_max ? std::max(acc, v) : acc + v;
+                    }
+                }
+                if (!is_max) {
+                    int count = white ? ksize.height * ksize.width : (he - hs) * (we - ws);
+                    acc = count ? acc / count : 0;
+                }
+                o[h * ow + w] = acc;
+            }
+        }
+    }
+}
+
+static bool test_case(const Shape &shape, int k, int s, int pad, bool is_max, bool white) {
+    Tensor x(FLOAT32, shape);
+    Random rand(4399);
+    for (int i = 0; i < x.count(); ++i) x.data<float>()[i] = float(rand.u() * 2 - 1);
+
+    Padding2D padding(pad, pad, pad, pad);
+    KSize2D ksize(k, k);
+    Stride2D stride(s, s);
+    // ceil mode output size
+    int oh = (shape[2] + 2 * pad - k + s - 1) / s + 1;
+    int ow = (shape[3] + 2 * pad - k + s - 1) / s + 1;
+    // last window must start inside the image or left padding
+    if ((oh - 1) * s >= shape[2] + pad) --oh;
+    if ((ow - 1) * s >= shape[3] + pad) --ow;
+    Tensor expected(FLOAT32, {shape[0], shape[1], oh, ow});
+    Tensor out(FLOAT32, {shape[0], shape[1], oh, ow});
+
+    naive_pooling(x, expected, is_max, white, padding, ksize, stride);
+    if (is_max) {
+        PoolingAlgorithm<float>::max_pooling(x, out, padding, ksize, stride);
+    } else {
+        PoolingAlgorithm<float>::avg_pooling(x, out, padding, ksize, stride,
+                                             white ? Padding2DType::WHITE : Padding2DType::BLACK);
+    }
+    for (int i = 0; i < out.count(); ++i) {
+        if (std::fabs(out.data<float>()[i] - expected.data<float>()[i]) > 1e-4f) {
+            std::cout << "[FAILED] k=" << k << ", s=" << s << ", pad=" << pad
+                      << (is_max ? " max" : " avg") << " at " << i << ": "
+                      << out.data<float>()[i] << " vs. " << expected.data<float>()[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    Report report;
+
+    int passed = 0, total = 0;
+    for (auto &shape : std::vector<Shape>({{1, 3, 13, 13}, {2, 4, 17, 23}, {1, 1, 5, 64}})) {
+        for (int k : {1, 2, 3, 5, 9, 13}) {
+            for (int s : {1, 2, 3}) {
+                for (int pad : {0, 1, k / 2}) {
+                    if (pad >= k || k > shape[2] + 2 * pad || k > shape[3] + 2 * pad) continue;
+                    for (int mode = 0; mode < 3; ++mode) {
+                        ++total;
+                        if (test_case(shape, k, s, pad, mode == 0, mode == 2)) ++passed;
+                    }
+                }
+            }
+        }
+    }
+    report(std::to_string(passed) + "/" + std::to_string(total) + " pooling cases", passed == total);
+
+    // SPP pooling speed on large map
+    for (int k : {5, 9, 13}) {
+        Tensor x(FLOAT32, {1, 512, 76, 76});
+        Tensor out(FLOAT32, {1, 512, 76, 76});
+        auto start = std::chrono::system_clock::now();
+        for (int i = 0; i < 10; ++i) {
+            PoolingAlgorithm<float>::max_pooling(x, out, Padding2D(k / 2, k / 2, k / 2, k / 2),
+                                                 KSize2D(k, k), Stride2D(1, 1));
+        }
+        auto end = std::chrono::system_clock::now();
+        std::chrono::duration<double, std::milli> spent = end - start;
+        std::cout << "Max pooling k" << k << "s1 [1, 512, 76, 76]: " << spent.count() / 10 << "ms" << std::endl;
+    }
+
+    return report.exit_code();
+}
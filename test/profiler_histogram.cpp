@@ -0,0 +1,121 @@
+#include "test_utils.h"
+
+#include <board/histogram.h>
+#include <board/profiler.h>
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace ts;
+using namespace ts::test;
+
+static Module::shared build_net() {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32, {1, 8, 32, 32});
+    auto conv = conv2d("conv", x, random_tensor({8, 8, 3, 3}, 1), 1);
+    auto y = bubble::op("relu", name::layer::relu(), {conv});
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+static double exact_percentile(std::vector<double> data, double q) {
+    std::sort(data.begin(), data.end());
+    auto rank = std::max<size_t>(1, size_t(std::ceil(q * data.size())));
+    return data[rank - 1];
+}
+
+int main() {
+    Report report;
+
+    {
+        // latency like data, log normal
+        std::mt19937 engine(7);
+        std::lognormal_distribution<double> lognormal(0, 1);
+        std::vector<double> data;
+        Histogram histogram;
+        for (int i = 0; i < 100000; ++i) {
+            data.push_back(lognormal(engine));
+            histogram.record(data.back());
+        }
+        bool ok = true;
+        for (double q : {0.5, 0.9, 0.99, 0.999}) {
+            auto exact = exact_percentile(data, q);
+            auto got = histogram.percentile(q);
+            std::cout << "p" << q * 100 << ": exact " << exact << ", histogram " << got << std::endl;
+            ok = ok && std::fabs(got - exact) <= exact / Histogram::SubBuckets;
+        }
+        report("percentile error", ok);
+        report("min and max exact", histogram.min() == *std::min_element(data.begin(), data.end()) &&
+                                    histogram.max() == *std::max_element(data.begin(), data.end()));
+        report("count", histogram.count() == data.size());
+
+        auto snapshot = histogram.snapshot(true);
+        report("snapshot and reset", snapshot.count() == data.size() && histogram.count() == 0 &&
+                                     histogram.percentile(0.5) == 0);
+    }
+
+    {
+        Histogram histogram;
+        const int threads = 4;
+        const int loops = 100000;
+        std::vector<std::thread> recorders;
+        for (int t = 0; t < threads; ++t) {
+            recorders.emplace_back([&, t]() {
+                for (int i = 0; i < loops; ++i) histogram.record(t + 1);
+            });
+        }
+        for (auto &recorder : recorders) recorder.join();
+        report("concurrent record", histogram.count() == uint64_t(threads * loops) &&
+                                    histogram.sum() == double(loops) * (1 + 2 + 3 + 4) &&
+                                    histogram.max() == threads);
+    }
+
+    {
+        Workbench bench(ComputingDevice(CPU), 1);
+        bench.setup(bench.compile(build_net()));
+        bench.do_profile(true);
+        auto input = random_tensor({1, 8, 32, 32}, 2);
+        for (int i = 0; i < 100; ++i) {
+            bench.input(0, input);
+            bench.run();
+        }
+        for (int i = 0; i < 20; ++i) bench.run({input});
+
+        auto names = 0;
+        for (auto &pair : bench.profiler().board()) {
+            (void)(pair);
+            ++names;
+        }
+        report("run profiled", bench.profiler().board().count("run") == 120);
+
+        for (int i = 0; i < 100; ++i) {
+            bench.input(0, input);
+            bench.run();
+        }
+        auto same_names = 0;
+        for (auto &pair : bench.profiler().board()) {
+            (void)(pair);
+            ++same_names;
+        }
+        report("names not growing", names == same_names);
+
+        auto summary = bench.profile_summary(true);
+        std::cout << summary << std::endl;
+        report("summary has percentiles", summary.find("\"run\"") != std::string::npos &&
+                                          summary.find("\"p99\"") != std::string::npos);
+        report("summary reset", bench.profiler().board().count("run") == 0 && bench.profile_summary() == "{}");
+    }
+
+    return report.exit_code();
+}
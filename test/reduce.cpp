@@ -0,0 +1,109 @@
+#include "test_utils.h"
+
+#include <kernels/cpu/reduce_algorithm.h>
+#include <utils/random.h>
+
+#include <iostream>
+#include <cmath>
+#include <numeric>
+#include <functional>
+#include <chrono>
+
+using namespace ts;
+using namespace ts::test;
+using namespace cpu;
+
+static std::vector<float> naive_reduce(const std::vector<float> &x, const std::vector<int> &shape,
+                                       const std::vector<int> &axes, ReduceType type) {
+    auto dims = int(shape.size());
+    std::vector<bool> reduced(shape.size(), false);
+    for (auto axis : axes) reduced[axis] = true;
+    std::vector<int> out_shape(shape);
+    for (int i = 0; i < dims; ++i) if (reduced[i]) out_shape[i] = 1;
+    auto out_count = std::accumulate(out_shape.begin(), out_shape.end(), 1, std::multiplies<int>());
+    auto reduce_count = int(x.size()) / out_count;
+
+    float init = type == ReduceType::MAX ? -1e30f : type == ReduceType::MIN ? 1e30f : 0.0f;
+    std::vector<float> out(out_count, init);
+    std::vector<int> coord(shape.size(), 0);
+    for (size_t i = 0; i < x.size(); ++i) {
+        int out_index = 0;
+        for (int d = 0; d < dims; ++d) {
+            out_index = out_index * out_shape[d] + (reduced[d] ? 0 : coord[d]);
+        }
+        auto &acc = out[out_index];
+        switch (type) {
+            case ReduceType::SUM:
+            case ReduceType::MEAN: acc += x[i]; break;
+            case ReduceType::MAX: acc = std::max(acc, x[i]); break;
+            case ReduceType::MIN: acc = std::min(acc, x[i]); break;
+            case ReduceType::SUM_SQUARE: acc += x[i] * x[i]; break;
+        }
+        for (int d = dims - 1; d >= 0; --d) {
+            if (++coord[d] < shape[d]) break;
+            coord[d] = 0;
+        }
+    }
+    if (type == ReduceType::MEAN) {
+        for (auto &value : out) value /= reduce_count;
+    }
+    return out;
+}
+
+static bool test_case(const std::vector<int> &shape, const std::vector<int> &axes, ReduceType type) {
+    auto count = std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<int>());
+    std::vector<float> x(count);
+    Random rand(4399);
+    for (auto &value : x) value = float(rand.u() * 2 - 1);
+
+    auto expected = naive_reduce(x, shape, axes, type);
+    std::vector<float> out(expected.size());
+    ReduceAlgorithm<float>::reduce(x.data(), shape, axes, type, out.data());
+
+    for (size_t i = 0; i < out.size(); ++i) {
+        auto diff = std::fabs(out[i] - expected[i]);
+        if (diff > 1e-3f * std::max(1.0f, std::fabs(expected[i]))) {
+            std::cout << "[FAILED] type=" << int(type) << " at " << i << ": "
+                      << out[i] << " vs. " << expected[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::vector<std::vector<int>> shapes = {{7}, {3, 5}, {2, 3, 17}, {2, 16, 9, 9}, {1, 3, 128, 129}};
+    std::vector<ReduceType> types = {ReduceType::SUM, ReduceType::MEAN, ReduceType::MAX,
+                                     ReduceType::MIN, ReduceType::SUM_SQUARE};
+
+    Report report;
+
+    int passed = 0, total = 0;
+    for (auto &shape : shapes) {
+        auto dims = int(shape.size());
+        // every non-empty subset of axes
+        for (int mask = 1; mask < (1 << dims); ++mask) {
+            std::vector<int> axes;
+            for (int d = 0; d < dims; ++d) if (mask & (1 << d)) axes.push_back(d);
+            for (auto type : types) {
+                ++total;
+                if (test_case(shape, axes, type)) ++passed;
+            }
+        }
+    }
+    report(std::to_string(passed) + "/" + std::to_string(total) + " reduce cases", passed == total);
+
+    // speed of global pooling like reduction
+    std::vector<int> shape = {1, 256, 64, 64};
+    std::vector<float> x(256 * 64 * 64, 1.0f);
+    std::vector<float> out(256);
+    auto start = std::chrono::system_clock::now();
+    for (int i = 0; i < 100; ++i) {
+        ReduceAlgorithm<float>::reduce(x.data(), shape, {2, 3}, ReduceType::MEAN, out.data());
+    }
+    auto end = std::chrono::system_clock::now();
+    std::chrono::duration<double, std::milli> spent = end - start;
+    std::cout << "Reduce mean [1, 256, 64, 64] on {2, 3}: " << spent.count() / 100 << "ms" << std::endl;
+
+    return report.exit_code();
+}
@@ -0,0 +1,263 @@
+#include "test_utils.h"
+
+#include "kernels/cpu/dragon/op_kernel.h"
+#include "kernels/cpu/dragon/bbox_utils.h"
+#include <runtime/inside/thread_pool.h>
+
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+using namespace ts;
+using namespace ts::test;
+using dragon::CPUContext;
+
+/**
+ * scalar IoU of the previous ApplyNMS, (x2 - x1 + 1) box convention
+ */
+static float reference_iou(const float A[], const float B[]) {
+    if (A[0] > B[2] || A[1] > B[3] ||
+        A[2] < B[0] || A[3] < B[1]) return 0;
+    const float x1 = std::max(A[0], B[0]);
+    const float y1 = std::max(A[1], B[1]);
+    const float x2 = std::min(A[2], B[2]);
+    const float y2 = std::min(A[3], B[3]);
+    const float width = std::max(0.f, x2 - x1 + 1);
+    const float height = std::max(0.f, y2 - y1 + 1);
+    const float area = width * height;
+    const float A_area = (A[2] - A[0] + 1) * (A[3] - A[1] + 1);
+    const float B_area = (B[2] - B[0] + 1) * (B[3] - B[1] + 1);
+    return area / (A_area + B_area - area);
+}
+
+static std::vector<int> reference_nms(const std::vector<float> &boxes, int max_keeps, float thresh) {
+    auto num_boxes = int(boxes.size() / 5);
+    std::vector<int> keep;
+    std::vector<char> is_dead(num_boxes, 0);
+    for (int i = 0; i < num_boxes; ++i) {
+        if (is_dead[i]) continue;
+        keep.push_back(i);
+        if (int(keep.size()) == max_keeps) break;
+        for (int j = i + 1; j < num_boxes; ++j)
+            if (!is_dead[j] && reference_iou(&boxes[i * 5], &boxes[j * 5]) > thresh)
+                is_dead[j] = 1;
+    }
+    return keep;
+}
+
+static std::vector<int> nms(const std::vector<float> &boxes, int max_keeps, float thresh) {
+    auto num_boxes = int(boxes.size() / 5);
+    std::vector<int> keep(num_boxes);
+    int num_keep = 0;
+    dragon::rcnn::ApplyNMS<float, CPUContext>(num_boxes, max_keeps, thresh, boxes.data(),
+                                              keep.data(), num_keep, nullptr);
+    keep.resize(num_keep);
+    return keep;
+}
+
+/**
+ * boxes in [-margin, size + margin), so some cross the image edge
+ */
+static std::vector<float> random_boxes(int num, float size, float margin, unsigned seed) {
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<float> corner(-margin, size + margin);
+    std::uniform_real_distribution<float> extent(0, size / 4);
+    std::vector<float> boxes;
+    for (int i = 0; i < num; ++i) {
+        auto x1 = corner(engine), y1 = corner(engine);
+        boxes.insert(boxes.end(), {x1, y1, x1 + extent(engine), y1 + extent(engine), 1.0f - float(i) / num});
+    }
+    return boxes;
+}
+
+/**
+ * each IoU of box j with box 0 is exactly j / width, so every threshold j / width is hit on the nose
+ */
+static std::vector<float> threshold_boxes(int width) {
+    std::vector<float> boxes = {0, 0, float(width - 1), 0, 1};
+    for (int j = width - 1; j > 0; --j) {
+        boxes.insert(boxes.end(), {0, 0, float(j - 1), 0, 1});
+    }
+    return boxes;
+}
+
+/**
+ * scalar interpolation of the previous ROIAlign
+ */
+static float reference_interpolate(const float *X, int height, int width, float y, float x) {
+    if (y < -1.0 || y > height || x < -1.0 || x > width) return 0;
+    if (y <= 0) y = 0;
+    if (x <= 0) x = 0;
+    int y_low = (int) y, x_low = (int) x, y_high, x_high;
+    if (y_low >= height - 1) {
+        y_high = y_low = height - 1;
+        y = (float) y_low;
+    } else {
+        y_high = y_low + 1;
+    }
+    if (x_low >= width - 1) {
+        x_high = x_low = width - 1;
+        x = (float) x_low;
+    } else {
+        x_high = x_low + 1;
+    }
+    float ly = y - y_low, lx = x - x_low;
+    float hy = 1 - ly, hx = 1 - lx;
+    return hy * hx * X[y_low * width + x_low] + hy * lx * X[y_low * width + x_high] +
+           ly * hx * X[y_high * width + x_low] + ly * lx * X[y_high * width + x_high];
+}
+
+static Tensor reference_roi_align(const Tensor &x, const std::vector<float> &rois,
+                                  int pool_h, int pool_w, float spatial_scale, int sampling_ratio) {
+    auto C = x.size(1), H = x.size(2), W = x.size(3);
+    auto num_rois = int(rois.size() / 5);
+    Tensor y(FLOAT32, {num_rois, C, pool_h, pool_w});
+    for (int n = 0; n < num_rois; ++n) {
+        auto *R = &rois[n * 5];
+        auto roi_batch_ind = (int) R[0];
+        auto *Y = y.data<float>() + n * C * pool_h * pool_w;
+        if (roi_batch_ind < 0) {
+            std::fill(Y, Y + C * pool_h * pool_w, 0.f);
+            continue;
+        }
+        float roi_start_w = R[1] * spatial_scale;
+        float roi_start_h = R[2] * spatial_scale;
+        float roi_width = std::max(R[3] * spatial_scale - roi_start_w, 1.f);
+        float roi_height = std::max(R[4] * spatial_scale - roi_start_h, 1.f);
+        float bin_size_h = roi_height / pool_h;
+        float bin_size_w = roi_width / pool_w;
+        int grid_h = sampling_ratio > 0 ? sampling_ratio : (int) std::ceil(roi_height / pool_h);
+        int grid_w = sampling_ratio > 0 ? sampling_ratio : (int) std::ceil(roi_width / pool_w);
+        for (int c = 0; c < C; ++c) {
+            auto *X = x.data<float>() + (roi_batch_ind * C + c) * H * W;
+            for (int ph = 0; ph < pool_h; ++ph) {
+                for (int pw = 0; pw < pool_w; ++pw) {
+                    float value = 0;
+                    for (int iy = 0; iy < grid_h; ++iy) {
+                        const float sy = roi_start_h + ph * bin_size_h + (iy + .5f) * bin_size_h / grid_h;
+                        for (int ix = 0; ix < grid_w; ++ix) {
+                            const float sx = roi_start_w + pw * bin_size_w + (ix + .5f) * bin_size_w / grid_w;
+                            value += reference_interpolate(X, H, W, sy, sx);
+                        }
+                    }
+                    Y[(c * pool_h + ph) * pool_w + pw] = value / float(grid_h * grid_w);
+                }
+            }
+        }
+    }
+    return y;
+}
+
+static Tensor roi_align(const Tensor &x, const std::vector<float> &rois,
+                        int pool_h, int pool_w, float spatial_scale, int sampling_ratio) {
+    auto num_rois = int(rois.size() / 5);
+    Tensor y(FLOAT32, {num_rois, x.size(1), pool_h, pool_w});
+    dragon::kernel::ROIAlign<float, CPUContext>(x.size(1), x.size(2), x.size(3), pool_h, pool_w, num_rois,
+                                                spatial_scale, sampling_ratio, x.data<float>(), rois.data(),
+                                                y.data<float>(), nullptr);
+    return y;
+}
+
+/**
+ * RoIs of [batch, x1, y1, x2, y2] in image coordinates, image is size / spatial_scale
+ */
+static std::vector<float> random_rois(int num, int batch, float image_w, float image_h, unsigned seed) {
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<float> x(-0.25f * image_w, 1.1f * image_w);
+    std::uniform_real_distribution<float> y(-0.25f * image_h, 1.1f * image_h);
+    std::uniform_real_distribution<float> extent(0, 0.6f);
+    std::vector<float> rois;
+    for (int i = 0; i < num; ++i) {
+        auto x1 = x(engine), y1 = y(engine);
+        rois.insert(rois.end(), {float(i % batch), x1, y1,
+                                 x1 + extent(engine) * image_w, y1 + extent(engine) * image_h});
+    }
+    return rois;
+}
+
+int main() {
+    Report report;
+
+    // tie-breaking, same order: sorted boxes keep the first of duplicated ones
+    {
+        std::vector<float> boxes = {
+                0, 0, 9, 9, 1,
+                0, 0, 9, 9, 1,      // same box, same score
+                20, 20, 29, 29, 1,
+                20, 20, 29, 29, 1,
+                0, 0, 9, 4, 0.5f,   // IoU 0.5 with the first box
+                0, 5, 9, 9, 0.5f,   // IoU 0.5 with the first box
+        };
+        bool ok = true;
+        for (float thresh : {0.3f, 0.5f, 0.7f}) {
+            for (int max_keeps : {1, 2, 3, 6}) {
+                ok = ok && nms(boxes, max_keeps, thresh) == reference_nms(boxes, max_keeps, thresh);
+            }
+        }
+        report("nms ties", ok && nms(boxes, 6, 0.5f) == std::vector<int>({0, 2, 4, 5}));
+    }
+
+    // IoU exactly at threshold is not suppressed
+    {
+        int mismatched = 0, total = 0;
+        for (int width = 2; width <= 64; ++width) {
+            auto boxes = threshold_boxes(width);
+            for (int k = 1; k < width; ++k) {
+                auto thresh = float(k) / float(width);
+                ++total;
+                if (nms(boxes, width, thresh) != reference_nms(boxes, width, thresh)) ++mismatched;
+            }
+        }
+        std::ostringstream title;
+        title << "nms IoU at threshold " << total - mismatched << "/" << total;
+        report(title.str(), mismatched == 0);
+    }
+
+    // boxes crossing image edge, enough boxes to split suppress loop
+    for (int num : {100, 1000, 6000}) {
+        auto boxes = random_boxes(num, 600, 100, unsigned(num));
+        bool ok = true;
+        for (float thresh : {0.3f, 0.5f, 0.7f}) {
+            ok = ok && nms(boxes, num, thresh) == reference_nms(boxes, num, thresh) &&
+                 nms(boxes, 300, thresh) == reference_nms(boxes, 300, thresh);
+        }
+        report("nms " + std::to_string(num) + " boxes crossing edge", ok);
+    }
+
+    struct Case {
+        int batch, channels, height, width;
+        int pool_h, pool_w;
+        float spatial_scale;
+        int sampling_ratio;
+        int num_rois;
+    };
+    std::vector<Case> cases = {
+            {1, 3, 13, 17, 7, 7, 1.0f / 16, 0, 1},      // fewer RoIs than threads, split on channels
+            {2, 8, 20, 20, 7, 7, 1.0f / 16, 2, 3},
+            {1, 16, 38, 50, 2, 3, 0.5f, 0, 40},         // split on RoIs
+            {2, 64, 25, 25, 14, 14, 1.0f / 8, 2, 300},
+            {1, 4, 1, 1, 2, 2, 1, 0, 5},                // feature of one pixel
+    };
+    ThreadPool pool(4);
+    ctx::bind<ThreadPool> _bind_pool(pool);
+    for (auto &c : cases) {
+        auto x = random_tensor({c.batch, c.channels, c.height, c.width}, unsigned(c.num_rois));
+        auto rois = random_rois(c.num_rois, c.batch, c.width / c.spatial_scale, c.height / c.spatial_scale,
+                                unsigned(c.channels));
+        // dropped RoI, RoI smaller than one pixel, and RoI out of image
+        rois.insert(rois.end(), {-1, 0, 0, 8, 8,
+                                 0, 1, 1, 1.5f, 1.2f,
+                                 0, -4 / c.spatial_scale, 0, -2 / c.spatial_scale, 8});
+        auto y = roi_align(x, rois, c.pool_h, c.pool_w, c.spatial_scale, c.sampling_ratio);
+        auto expected = reference_roi_align(x, rois, c.pool_h, c.pool_w, c.spatial_scale, c.sampling_ratio);
+        std::ostringstream title;
+        title << "roi_align " << c.num_rois + 3 << " RoIs on [" << c.batch << ", " << c.channels << ", "
+              << c.height << ", " << c.width << "] to " << c.pool_h << "x" << c.pool_w;
+        report(title.str(), near(y, expected, 1e-5f));
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,195 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+#include <api/declare_workbench.h>
+#include <api/declare_tensor.h>
+
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * blocks dispatching thread in callback, until opened
+ */
+class Gate {
+public:
+    void enter() {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        m_entered = true;
+        m_cond.notify_all();
+        m_cond.wait(_lock, [this]() { return m_opened; });
+    }
+
+    void wait_entered() {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        m_cond.wait(_lock, [this]() { return m_entered; });
+    }
+
+    void open() {
+        std::unique_lock<std::mutex> _lock(m_mutex);
+        m_opened = true;
+        m_cond.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_entered = false;
+    bool m_opened = false;
+};
+
+struct CallbackRecord {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<std::pair<int64_t, ts_RunStatus>> calls;
+
+    void wait(size_t count) {
+        std::unique_lock<std::mutex> _lock(mutex);
+        cond.wait(_lock, [&]() { return calls.size() >= count; });
+    }
+};
+
+static void record_callback(void *user_data, int64_t request, ts_RunStatus status) {
+    auto record = reinterpret_cast<CallbackRecord *>(user_data);
+    std::unique_lock<std::mutex> _lock(record->mutex);
+    record->calls.emplace_back(request, status);
+    record->cond.notify_all();
+}
+
+int main() {
+    Report report;
+
+    std::vector<Tensor> inputs;
+    for (unsigned i = 0; i < 8; ++i) inputs.push_back(random_tensor({2, 3, 4}, i + 1));
+
+    {
+        auto bench = Workbench::Load(sigmoid_net(), ComputingDevice(CPU));
+        bench->set_async(2, 8);
+        std::vector<std::future<std::vector<Tensor>>> futures;
+        for (auto &input : inputs) futures.push_back(bench->run_async({input}));
+        bool ok = true;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            auto outputs = futures[i].get();
+            ok = ok && outputs.size() == 1 && is_sigmoid(outputs[0], inputs[i]);
+        }
+        report("futures", ok);
+    }
+
+    {
+        auto bench = Workbench::Load(sigmoid_net(), ComputingDevice(CPU));
+        bench->set_async(1, 2);
+
+        // the only dispatching thread is held in callback of first request
+        Gate gate;
+        auto first = bench->run_async({inputs[0]}, [&](uint64_t, std::vector<Tensor> &, const std::exception_ptr &) {
+            gate.enter();
+        });
+        gate.wait_entered();
+
+        uint64_t second, third;
+        auto second_future = bench->run_async({inputs[1]}, &second);
+        auto third_future = bench->run_async({inputs[2]}, &third);
+        bool refused = false;
+        try {
+            bench->run_async({inputs[3]});
+        } catch (const Exception &) {
+            refused = true;
+        }
+        report("queue full refused", refused);
+
+        bool cancelled = false;
+        bool cancel_ok = bench->cancel(third);
+        try {
+            third_future.get();
+        } catch (const RunCancelledException &e) {
+            cancelled = e.request() == third;
+        }
+        report("cancel waiting", cancel_ok && cancelled);
+        report("cancel running", !bench->cancel(first) && !bench->cancel(third));
+
+        gate.open();
+        auto outputs = second_future.get();
+        report("run after cancel", outputs.size() == 1 && is_sigmoid(outputs[0], inputs[1]));
+    }
+
+    {
+        auto bench = Workbench::Load(sigmoid_net(), ComputingDevice(CPU));
+        uint64_t old_request;
+        bench->run_async({inputs[0]}, &old_request).get();
+        bench->set_async(1, 2);
+
+        Gate gate;
+        bench->run_async({inputs[0]}, [&](uint64_t, std::vector<Tensor> &, const std::exception_ptr &) {
+            gate.enter();
+        });
+        gate.wait_entered();
+        uint64_t new_request;
+        auto new_future = bench->run_async({inputs[1]}, &new_request);
+        // id of old queue never cancels request of new queue
+        report("request ids not reused", new_request != old_request && !bench->cancel(old_request));
+        gate.open();
+        new_future.get();
+
+        std::promise<bool> refused;
+        bench->run_async({inputs[2]}, [&](uint64_t, std::vector<Tensor> &, const std::exception_ptr &) {
+            try {
+                bench->set_async(1, 4);
+                refused.set_value(false);
+            } catch (const Exception &) {
+                refused.set_value(true);
+            }
+        });
+        report("set async in callback refused", refused.get_future().get());
+    }
+
+    {
+        auto bench = Workbench::Load(sigmoid_net(), ComputingDevice(CPU));
+        ts_Workbench workbench(bench);
+        CallbackRecord record;
+        std::vector<std::unique_ptr<ts_Tensor>> outputs;
+        std::vector<int64_t> requests;
+        {
+            ts_Workbench_set_async(&workbench, 1, 8);
+            for (auto &input : inputs) {
+                ts_Tensor c_input(input);
+                const ts_Tensor *c_inputs[] = {&c_input};
+                outputs.emplace_back(new ts_Tensor());
+                ts_Tensor *c_outputs[] = {outputs.back().get()};
+                requests.push_back(ts_Workbench_run_async(&workbench, c_inputs, 1, c_outputs, 1,
+                                                          record_callback, &record));
+            }
+            // cancel the last one if not started yet
+            ts_Workbench_cancel(&workbench, requests.back());
+            record.wait(inputs.size());
+        }
+        bool ok = record.calls.size() == inputs.size();
+        int succeed = 0;
+        for (auto &call : record.calls) {
+            auto index = std::find(requests.begin(), requests.end(), call.first) - requests.begin();
+            if (index == int64_t(requests.size())) {
+                ok = false;
+                continue;
+            }
+            if (call.second == TS_RUN_SUCCEED) {
+                ++succeed;
+                ok = ok && is_sigmoid(**outputs[index], inputs[index]);
+            } else {
+                ok = ok && call.second == TS_RUN_CANCELLED;
+            }
+        }
+        // only the last one could be cancelled
+        report("C API callbacks", ok && succeed >= int(inputs.size()) - 1);
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,159 @@
+#include "test_utils.h"
+
+#include <runtime/workbench.h>
+#include <runtime/stack.h>
+#include <board/hook.h>
+#include <api/declare_workbench.h>
+#include <api/declare_tensor.h>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * outputs {relu(x), sigmoid(relu(x))}, both with x's shape
+ */
+static Module::shared two_outputs_net() {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32);
+    auto relu = bubble::op("relu", name::layer::relu(), {x});
+    auto y = bubble::op("sigmoid", name::layer::sigmoid(), {relu});
+    auto module = std::make_shared<Module>();
+    module->load(g, {relu, y});
+    return module;
+}
+
+/**
+ * outputs {sigmoid(x), sigmoid(x)}, the same node twice
+ */
+static Module::shared same_outputs_net() {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32);
+    auto y = bubble::op("sigmoid", name::layer::sigmoid(), {x});
+    auto module = std::make_shared<Module>();
+    module->load(g, {y, y});
+    return module;
+}
+
+static Tensor relu_of(const Tensor &x) {
+    auto y = x.clone();
+    for (int i = 0; i < y.count(); ++i) y.data<float>()[i] = std::max(0.0f, y.data<float>()[i]);
+    return y;
+}
+
+/**
+ * keeps data of outputs left by the last operator run, before workbench copying any output
+ */
+class LastOperatorOutputs {
+public:
+    LastOperatorOutputs() {
+        m_hook.after_run([this](const Hook::StructAfterRun &info) {
+            m_data.clear();
+            for (auto &tensor : *info.stack) m_data.push_back(tensor.data());
+        });
+    }
+
+    Hook &hook() { return m_hook; }
+
+    bool written(size_t i, const void *data) const { return i < m_data.size() && m_data[i] == data; }
+
+private:
+    Hook m_hook;
+    std::vector<const void *> m_data;
+};
+
+static void count_release(void *, void *userdata) {
+    ++*reinterpret_cast<int *>(userdata);
+}
+
+int main() {
+    Report report;
+
+    auto x = random_tensor({2, 3, 4, 5}, 1);
+
+    {
+        Stack stack{MemoryDevice(CPU)};
+        stack.push(x);
+        Tensor given(FLOAT32, x.sizes());
+        stack.preset({given});
+        stack.push_base(-1);    // frame of operator, x as argument
+
+        stack.push_base(0);     // inner operator making tensor of same prototype
+        auto inner = stack.make(FLOAT32, x.sizes(), MemoryDevice(CPU));
+        stack.pop_base();
+
+        stack.push(INT32, {2}, MemoryDevice(CPU));  // temporary in operator's frame
+        auto temporary = stack.make(FLOAT32, x.sizes(), MemoryDevice(CPU));
+        stack.pop();
+
+        auto output = stack.make(FLOAT32, x.sizes(), MemoryDevice(CPU));
+        auto again = stack.make(FLOAT32, x.sizes(), MemoryDevice(CPU));
+        stack.pop_base();
+        stack.clear_preset();
+
+        report("preset bound to output slot", inner.data() != given.data() && temporary.data() != given.data() &&
+                                             output.data() == given.data() && again.data() != given.data());
+    }
+
+    {
+        std::vector<float> buffer(size_t(x.count()), 0);
+        std::vector<int32_t> shape(x.sizes().begin(), x.sizes().end());
+        int released = 0;
+        {
+            auto bench = Workbench::Load(sigmoid_net(), ComputingDevice(CPU));
+            ts_Workbench workbench(bench);
+            std::unique_ptr<ts_Tensor> output(ts_new_Tensor_borrowed(shape.data(), int32_t(shape.size()),
+                                                                      TS_FLOAT32, buffer.data(),
+                                                                      count_release, &released));
+            bench->input(0, x);
+
+            LastOperatorOutputs last;
+            ctx::bind<Hook> _bind_hook(last.hook());
+            ts_Tensor *outputs[] = {output.get()};
+            auto ok = ts_Workbench_run_into(&workbench, outputs, 1);
+
+            Tensor result(FLOAT32, x.sizes());
+            std::memcpy(result.data(), buffer.data(), buffer.size() * sizeof(float));
+            report("borrowed output written", ok && is_sigmoid(result, x));
+            report("borrowed output not copied", last.written(0, buffer.data()) &&
+                                                 bench->output(0).data() == buffer.data());
+            report("borrowed output kept by workbench", released == 0);
+        }
+        report("borrowed output released", released == 1);
+    }
+
+    {
+        Workbench bench(ComputingDevice(CPU), 1);
+        bench.setup(bench.compile(two_outputs_net()));
+        bench.input(0, x);
+
+        std::vector<Tensor> outputs = {Tensor(FLOAT32, x.sizes()), Tensor(FLOAT32, x.sizes())};
+        LastOperatorOutputs last;
+        ctx::bind<Hook> _bind_hook(last.hook());
+        bench.run_into(outputs);
+
+        // relu is not the last operator, so its output, with the same prototype, is copied
+        report("multi outputs", same(outputs[0], relu_of(x)) && is_sigmoid(outputs[1], relu_of(x)));
+        report("last output not copied", last.written(0, outputs[1].data()) &&
+                                         bench.output(0).data() == outputs[0].data() &&
+                                         bench.output(1).data() == outputs[1].data());
+    }
+
+    {
+        Workbench bench(ComputingDevice(CPU), 1);
+        bench.setup(bench.compile(same_outputs_net()));
+        bench.input(0, x);
+
+        std::vector<Tensor> outputs = {Tensor(FLOAT32, x.sizes()), Tensor(FLOAT32, x.sizes())};
+        bench.run_into(outputs);
+        report("aliased outputs", outputs[0].data() != outputs[1].data() &&
+                                  is_sigmoid(outputs[0], x) && is_sigmoid(outputs[1], x));
+
+        // output not given is kept in workbench
+        bench.run_into({Tensor(), outputs[1]});
+        report("output not given", is_sigmoid(bench.output(0), x) && bench.output(1).data() == outputs[1].data());
+    }
+
+    return report.exit_code();
+}
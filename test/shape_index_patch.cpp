@@ -0,0 +1,86 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <random>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * landmarks on whole image and beyond border, so patches cross all borders
+ */
+static Tensor random_pos(int number, int landmarks, unsigned seed) {
+    std::mt19937 engine(seed);
+    std::uniform_real_distribution<float> uniform(-0.1f, 1.1f);
+    Tensor pos(FLOAT32, {number, landmarks * 2, 1, 1});
+    for (int i = 0; i < pos.count(); ++i) pos.data<float>()[i] = uniform(engine);
+    return pos;
+}
+
+static Module::shared build_net(int origin_patch, int origin) {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32);
+    auto pos = bubble::param("pos", FLOAT32);
+    auto y = bubble::op("patch", name::layer::shape_index_patch(), {x, pos});
+    y->set("origin_patch", tensor::build(INT32, {origin_patch, origin_patch}));
+    y->set("origin", tensor::build(INT32, {origin, origin}));
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+static Tensor reference(const Tensor &x, const Tensor &pos, int patch_h, int patch_w) {
+    auto number = x.size(0), channels = x.size(1), height = x.size(2), width = x.size(3);
+    auto landmarks = pos.size(1) / 2;
+    Tensor out(FLOAT32, {number, channels, patch_h, landmarks, patch_w});
+    const float r_h = (patch_h - 1) / 2.0f;
+    const float r_w = (patch_w - 1) / 2.0f;
+    for (int i = 0; i < landmarks; ++i)
+    for (int n = 0; n < number; ++n) {
+        auto py = pos.data<float>()[n * landmarks * 2 + 2 * i + 1];
+        auto px = pos.data<float>()[n * landmarks * 2 + 2 * i];
+        const int y = int(py * (height - 1) - r_h + 0.5f);
+        const int x0 = int(px * (width - 1) - r_w + 0.5f);
+        for (int c = 0; c < channels; ++c)
+        for (int ph = 0; ph < patch_h; ++ph)
+        for (int pw = 0; pw < patch_w; ++pw) {
+            auto yy = y + ph, xx = x0 + pw;
+            auto value = yy < 0 || yy >= height || xx < 0 || xx >= width ? 0.0f
+                         : x.data<float>()[((n * channels + c) * height + yy) * width + xx];
+            out.data<float>()[(((n * channels + c) * patch_h + ph) * landmarks + i) * patch_w + pw] = value;
+        }
+    }
+    return out;
+}
+
+int main() {
+    Report report;
+
+    Tensor x(FLOAT32, {3, 5, 20, 18});
+    for (int i = 0; i < x.count(); ++i) x.data<float>()[i] = float(i % 97) + 1;
+    auto pos = random_pos(3, 68, 7);
+
+    // patch of 24 on origin 112 is 4x4 on 20x18 feature map
+    Workbench bench(ComputingDevice(CPU), 2);
+    bench.setup(bench.compile(build_net(24, 112)));
+    bench.input("x", x);
+    bench.input("pos", pos);
+    bench.run();
+    auto &out = bench.output(0);
+    auto expected = reference(x, pos, out.size(2), out.size(4));
+
+    bool same = out.sizes() == expected.sizes();
+    for (int i = 0; same && i < out.count(); ++i) {
+        same = out.data<float>()[i] == expected.data<float>()[i];
+    }
+    report("patches", same);
+
+    return report.exit_code();
+}
@@ -0,0 +1,77 @@
+#include <runtime/stack.h>
+#include <core/sync/sync_controller.h>
+#include <memory/flow.h>
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+
+using namespace ts;
+
+/**
+ * print nanoseconds per call of func
+ */
+static void benchmark(const std::string &title, int times, const std::function<void()> &func) {
+    for (int i = 0; i < times / 10; ++i) func();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < times; ++i) func();
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::nano> spent = end - start;
+    std::cout << std::left << std::setw(28) << title << ": "
+              << std::fixed << std::setprecision(1) << spent.count() / times << "ns" << std::endl;
+}
+
+int main() {
+    MemoryDevice device(CPU);
+    auto flow = HypeSyncMemoryController<FlowMemoryController>::Make(device, false);
+    Stack stack(device, flow);
+    const int times = 1000000;
+
+    Shape shape = {1, 3, 4};
+    Tensor x = stack.make(FLOAT32, shape);
+
+    benchmark("Tensor()", times, []() {
+        Tensor t;
+    });
+    benchmark("copy Tensor", times, [&]() {
+        Tensor t = x;
+    });
+    benchmark("move Tensor", times, [&]() {
+        Tensor t = x;
+        Tensor moved(std::move(t));
+    });
+    benchmark("Tensor::data", times, [&]() {
+        volatile auto data = x.data();
+        (void)(data);
+    });
+    benchmark("Tensor::reshape", times, [&]() {
+        auto t = x.reshape({3, 4});
+    });
+    benchmark("Stack::make", times, [&]() {
+        auto t = stack.make(FLOAT32, shape);
+    });
+    benchmark("Stack::make on device", times, [&]() {
+        auto t = stack.make(FLOAT32, shape, device);
+    });
+    benchmark("Stack::push(dtype, shape)", times, [&]() {
+        stack.push(FLOAT32, shape);
+        stack.pop();
+    });
+    benchmark("Stack::push(tensor)", times, [&]() {
+        stack.push(x);
+        stack.pop();
+    });
+    benchmark("Stack::push 8, pop 8", times / 8, [&]() {
+        for (int i = 0; i < 8; ++i) stack.push(FLOAT32, shape);
+        stack.pop(8);
+    });
+    benchmark("Tensor::view same device", times, [&]() {
+        auto t = x.view(device);
+    });
+    benchmark("Tensor::field(0)", times, [&]() {
+        auto t = x.field(0);
+    });
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "test_utils.h"
+
+#include <core/sync/sync_block.h>
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <set>
+
+using namespace ts;
+using namespace ts::test;
+
+using Block = SyncBlock<int, int64_t>;
+
+/**
+ * value on key k is always base + 1000 * k, whichever key it synchronized from
+ */
+static int64_t expected(int key) {
+    return 7 + 1000 * int64_t(key);
+}
+
+static Block::sync_handler counting_handler(std::atomic<int> &count) {
+    return [&count](const int64_t &from_value, const int &from_key, const int &to_key) {
+        ++count;
+        return from_value - 1000 * int64_t(from_key) + 1000 * int64_t(to_key);
+    };
+}
+
+/**
+ * @param keys number of keys in block
+ * @return if each value in block is the one of its key
+ */
+static bool consistent(const Block &block, int &keys) {
+    bool ok = true;
+    keys = 0;
+    block.foreach([&](const int &key, const int64_t &value) {
+        ok = ok && value == expected(key);
+        ++keys;
+    });
+    return ok;
+}
+
+int main() {
+    Report report;
+
+    const int threads = 8, loops = 2000, key_count = 6;
+
+    {
+        std::atomic<int> count(0);
+        Block block(0, expected(0), counting_handler(count), false);
+        int keys = 0;
+        report("single key", block.value() == expected(0) && consistent(block, keys) && keys == 1 && count == 0);
+        report("sync other key", block.sync(3) == expected(3) && block.sync(3) == expected(3) && count == 1 &&
+                                 consistent(block, keys) && keys == 2);
+        auto view = block.view(3);
+        report("view of synced key", view->key() == 3 && &view->value() == &block.sync(3) && count == 1);
+        report("view syncs back", view->sync(0) == expected(0) && view->sync(5) == expected(5) && count == 2);
+        auto same_key = block.view(0);
+        report("view of default key", same_key->value() == expected(0) && count == 2);
+    }
+
+    // broadcast by view of other key, default key synchronized back from it
+    {
+        std::atomic<int> count(0);
+        Block block(0, expected(0), counting_handler(count), false);
+        block.view(2)->broadcast();
+        auto back = block.view(0);
+        int keys = 0;
+        report("view of default key after broadcast", back->value() == expected(0) && block.value() == expected(0) &&
+                                                      count == 2 && consistent(block, keys) && keys == 2);
+    }
+
+    // concurrent readers and syncing writers on the same keys
+    {
+        std::atomic<int> count(0);
+        Block block(0, expected(0), counting_handler(count), true);
+        std::atomic<int> wrong(0);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (int i = 0; i < loops; ++i) {
+                    auto key = (t + i) % key_count;
+                    if (block.value() != expected(0)) ++wrong;
+                    if (block.sync(key) != expected(key)) ++wrong;
+                    if (i % 100 == 0) {
+                        auto view = block.view(key);
+                        if (view->value() != expected(key)) ++wrong;
+                        if (view->sync((key + 1) % key_count) != expected((key + 1) % key_count)) ++wrong;
+                    }
+                    int keys = 0;
+                    if (i % 10 == 0 && !consistent(block, keys)) ++wrong;
+                }
+            });
+        }
+        for (auto &worker : workers) worker.join();
+        int keys = 0;
+        report("concurrent sync", wrong == 0 && consistent(block, keys) && keys == key_count);
+        // every other key synchronized once, no matter how many threads missed it together
+        report("concurrent sync once for each key", count == key_count - 1);
+    }
+
+    // eviction by broadcast, while readers keep reading default value and walking keys
+    {
+        std::atomic<int> count(0);
+        Block block(0, expected(0), counting_handler(count), true);
+        std::atomic<bool> stop(false);
+        std::atomic<int> wrong(0);
+        std::vector<std::thread> readers;
+        for (int t = 0; t < threads - 1; ++t) {
+            readers.emplace_back([&]() {
+                while (!stop) {
+                    if (block.value() != expected(0)) ++wrong;
+                    int keys = 0;
+                    if (!consistent(block, keys) || keys < 1 || keys > key_count) ++wrong;
+                }
+            });
+        }
+        int evicted = 0;
+        for (int i = 0; i < loops; ++i) {
+            for (int key = 1; key < key_count; ++key) block.sync(key);
+            block.broadcast();
+            int keys = 0;
+            if (consistent(block, keys) && keys == 1) ++evicted;
+        }
+        stop = true;
+        for (auto &reader : readers) reader.join();
+        report("concurrent eviction", wrong == 0 && evicted == loops);
+        // evicted keys synchronized again after each broadcast
+        report("sync after eviction", count == loops * (key_count - 1) && block.sync(2) == expected(2));
+    }
+
+    // values owning memory, kept in block or moved with it
+    {
+        std::atomic<int> count(0);
+        auto append_key = [&](const std::string &value, const int &, const int &to_key) {
+            ++count;
+            return value + std::to_string(to_key);
+        };
+        SyncBlock<int, std::string> block(0, std::string(64, 'a'), append_key, true);
+        auto &synced = block.sync(1);
+        SyncBlock<int, std::string> moved(std::move(block));
+        auto view = moved.view(2);
+        report("moved block", moved.value() == std::string(64, 'a') && moved.sync(1) == synced &&
+                              &moved.sync(1) == &synced && view->value() == std::string(64, 'a') + "2");
+        moved.broadcast();
+        std::set<int> keys;
+        moved.foreach([&](const int &key, const std::string &) { keys.insert(key); });
+        report("moved block evicted", keys == std::set<int>({0}) && moved.value() == std::string(64, 'a'));
+    }
+
+    return report.exit_code();
+}
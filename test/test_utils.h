@@ -0,0 +1,166 @@
+#ifndef TENSORSTACK_TEST_TEST_UTILS_H
+#define TENSORSTACK_TEST_TEST_UTILS_H
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+#include <utils/platform.h>
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#if TS_PLATFORM_OS_WINDOWS
+#include <stdlib.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace ts {
+    namespace test {
+        /**
+         * print [OK] or [FAILED] of each check, and count failed ones
+         */
+        class Report {
+        public:
+            void operator()(const std::string &title, bool ok) {
+                std::cout << "[" << (ok ? "OK" : "FAILED") << "] " << title << std::endl;
+                if (!ok) ++m_failed;
+            }
+
+            int failed() const { return m_failed; }
+
+            /**
+             * @return exit code of test, 0 if all checks passed
+             */
+            int exit_code() const { return m_failed ? 1 : 0; }
+
+        private:
+            int m_failed = 0;
+        };
+
+        /**
+         * unique file in temp directory, removed when it goes out of scope
+         * @note path is empty if no file could be created
+         */
+        class TempFile {
+        public:
+            explicit TempFile(const std::string &prefix) {
+#if TS_PLATFORM_OS_WINDOWS
+                auto name = _tempnam(nullptr, prefix.c_str());
+                if (name == nullptr) return;
+                m_path = name;
+                std::free(name);
+#else
+                auto dir = std::getenv("TMPDIR");
+                std::string pattern = std::string(dir && *dir ? dir : "/tmp") + "/" + prefix + ".XXXXXX";
+                std::vector<char> name(pattern.begin(), pattern.end());
+                name.push_back('\0');
+                auto fd = mkstemp(name.data());
+                if (fd < 0) return;
+                close(fd);
+                m_path = name.data();
+#endif
+            }
+
+            ~TempFile() {
+                if (!m_path.empty()) std::remove(m_path.c_str());
+            }
+
+            TempFile(const TempFile &) = delete;
+
+            TempFile &operator=(const TempFile &) = delete;
+
+            const std::string &path() const { return m_path; }
+
+        private:
+            std::string m_path;
+        };
+
+        /**
+         * @return float32 tensor, uniform in [-1, 1)
+         */
+        inline Tensor random_tensor(const Shape &shape, unsigned seed) {
+            std::mt19937 engine(seed);
+            std::uniform_real_distribution<float> uniform(-1, 1);
+            Tensor tensor(FLOAT32, shape);
+            for (int i = 0; i < tensor.count(); ++i) tensor.data<float>()[i] = uniform(engine);
+            return tensor;
+        }
+
+        /**
+         * @return if a and b have same dtype, shape and bytes
+         */
+        inline bool same(const Tensor &a, const Tensor &b) {
+            if (a.empty() || b.empty() || a.dtype() != b.dtype() || a.sizes() != b.sizes()) return false;
+            return std::memcmp(a.data(), b.data(), size_t(a.count()) * size_t(a.proto().type_bytes())) == 0;
+        }
+
+        /**
+         * @param epsilon tolerance relative to expected value, at least absolute epsilon
+         * @return if float32 a and expected b have same shape, and near values
+         */
+        inline bool near(const Tensor &a, const Tensor &b, float epsilon = 1e-4f) {
+            if (a.empty() || b.empty() || a.sizes() != b.sizes()) return false;
+            for (int i = 0; i < a.count(); ++i) {
+                auto va = a.data<float>()[i];
+                auto vb = b.data<float>()[i];
+                if (std::fabs(va - vb) > epsilon * std::max(1.0f, std::fabs(vb))) return false;
+            }
+            return true;
+        }
+
+        /**
+         * NCHW conv2d with stride 1, no dilation and same padding on each side
+         */
+        inline Node conv2d(const std::string &name, Node x, Node w, int pad) {
+            auto conv = bubble::op(name, name::layer::conv2d(), {x, w});
+            conv->set(name::format, tensor::from(name::NCHW));
+            conv->set(name::padding, tensor::build(INT32, Shape({4, 2}), {0, 0, 0, 0, pad, pad, pad, pad}));
+            conv->set(name::stride, tensor::build(INT32, {1, 1, 1, 1}));
+            conv->set(name::dilation, tensor::build(INT32, {1, 1, 1, 1}));
+            return conv;
+        }
+
+        /**
+         * conv2d with weights in data node named name + "_w"
+         */
+        inline Node conv2d(const std::string &name, Node x, const Tensor &kernel, int pad) {
+            return conv2d(name, x, bubble::data(name + "_w", kernel), pad);
+        }
+
+        /**
+         * @return module of y = sigmoid(x), x of any shape
+         */
+        inline Module::shared sigmoid_net() {
+            Graph g;
+            ctx::bind<Graph> _bind_graph(g);
+            auto x = bubble::param("x", FLOAT32);
+            auto y = bubble::op("sigmoid", name::layer::sigmoid(), {x});
+            auto module = std::make_shared<Module>();
+            module->load(g, {y});
+            return module;
+        }
+
+        /**
+         * @return if y is sigmoid of x
+         */
+        inline bool is_sigmoid(const Tensor &y, const Tensor &x) {
+            if (y.sizes() != x.sizes()) return false;
+            for (int i = 0; i < x.count(); ++i) {
+                auto expected = 1 / (1 + std::exp(-x.data<float>()[i]));
+                if (std::fabs(y.data<float>()[i] - expected) > 1e-5f) return false;
+            }
+            return true;
+        }
+    }
+}
+
+#endif //TENSORSTACK_TEST_TEST_UTILS_H
@@ -0,0 +1,116 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <cmath>
+
+using namespace ts;
+using namespace ts::test;
+
+struct Case {
+    int batch, input_channels, output_channels, height, width;
+    int kernel_height, kernel_width;
+    int stride_height, stride_width;
+    int dilation_height, dilation_width;
+    int pad_top, pad_bottom, pad_left, pad_right;
+};
+
+static Module::shared build_net(const Case &c, const Tensor &w) {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32);
+    auto weight = bubble::data("w", w);
+    auto y = bubble::op("deconv", name::layer::transpose_conv2d(), {x, weight});
+    y->set(name::format, tensor::from(name::NCHW));
+    y->set(name::padding, tensor::build(INT32, Shape({4, 2}),
+                                        {0, 0, 0, 0, c.pad_top, c.pad_bottom, c.pad_left, c.pad_right}));
+    y->set(name::stride, tensor::build(INT32, {1, 1, c.stride_height, c.stride_width}));
+    y->set(name::dilation, tensor::build(INT32, {1, 1, c.dilation_height, c.dilation_width}));
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+/**
+ * scatter each input pixel by kernel, which is definition of transposed conv
+ */
+static Tensor reference(const Case &c, const Tensor &x, const Tensor &w) {
+    auto out_height = (c.height - 1) * c.stride_height + c.dilation_height * (c.kernel_height - 1) + 1
+                      - c.pad_top - c.pad_bottom;
+    auto out_width = (c.width - 1) * c.stride_width + c.dilation_width * (c.kernel_width - 1) + 1
+                     - c.pad_left - c.pad_right;
+    Tensor out(FLOAT32, {c.batch, c.output_channels, out_height, out_width});
+    auto y = out.data<float>();
+    for (int i = 0; i < out.count(); ++i) y[i] = 0;
+    auto px = x.data<float>();
+    auto pw = w.data<float>();
+    for (int n = 0; n < c.batch; ++n)
+    for (int ic = 0; ic < c.input_channels; ++ic)
+    for (int iy = 0; iy < c.height; ++iy)
+    for (int ix = 0; ix < c.width; ++ix) {
+        auto value = px[((n * c.input_channels + ic) * c.height + iy) * c.width + ix];
+        for (int oc = 0; oc < c.output_channels; ++oc)
+        for (int ky = 0; ky < c.kernel_height; ++ky)
+        for (int kx = 0; kx < c.kernel_width; ++kx) {
+            auto oy = iy * c.stride_height + ky * c.dilation_height - c.pad_top;
+            auto ox = ix * c.stride_width + kx * c.dilation_width - c.pad_left;
+            if (oy < 0 || oy >= out_height || ox < 0 || ox >= out_width) continue;
+            auto weight = pw[((ic * c.output_channels + oc) * c.kernel_height + ky) * c.kernel_width + kx];
+            y[((n * c.output_channels + oc) * out_height + oy) * out_width + ox] += value * weight;
+        }
+    }
+    return out;
+}
+
+int main() {
+    Report report;
+
+    std::vector<Case> cases = {
+            // upsampling of segmentation, kernel 4 stride 2 pad 1
+            {2, 8, 6, 9, 7, 4, 4, 2, 2, 1, 1, 1, 1, 1, 1},
+            // kernel equals stride, each phase is one gemm on input
+            {1, 5, 4, 6, 8, 2, 2, 2, 2, 1, 1, 0, 0, 0, 0},
+            // kernel 6 stride 3 with uneven padding, sub-pixel phases start at different columns
+            {2, 3, 4, 5, 7, 6, 6, 3, 3, 1, 1, 1, 2, 2, 0},
+            // sub-pixel on one axis, stride 1 on the other
+            {1, 4, 2, 6, 5, 4, 3, 2, 1, 1, 1, 1, 1, 1, 1},
+            // kernel 3 stride 2, phases have different taps, computed by col2im
+            {1, 3, 5, 7, 5, 3, 3, 2, 2, 1, 1, 1, 0, 1, 0},
+            // stride 3 with dilation, and uneven padding
+            {2, 4, 3, 5, 6, 3, 2, 3, 2, 2, 3, 1, 2, 0, 3},
+            // dilation and stride share factor, some phases get no tap
+            {1, 2, 3, 4, 4, 3, 3, 2, 2, 2, 2, 0, 0, 0, 0},
+            // stride 1
+            {1, 6, 4, 8, 8, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1},
+            // 1x1
+            {3, 4, 7, 5, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0},
+    };
+
+    for (size_t i = 0; i < cases.size(); ++i) {
+        auto &c = cases[i];
+        auto x = random_tensor({c.batch, c.input_channels, c.height, c.width}, unsigned(i * 2 + 1));
+        auto w = random_tensor({c.input_channels, c.output_channels, c.kernel_height, c.kernel_width},
+                               unsigned(i * 2 + 2));
+        auto expected = reference(c, x, w);
+
+        Workbench bench(ComputingDevice(CPU), 2);
+        bench.setup(bench.compile(build_net(c, w)));
+        bench.input(0, x);
+        bench.run();
+
+        std::ostringstream title;
+        title << "case " << i << ": kernel " << c.kernel_height << "x" << c.kernel_width
+              << ", stride " << c.stride_height << "x" << c.stride_width
+              << ", dilation " << c.dilation_height << "x" << c.dilation_width;
+        report(title.str(), near(bench.output(0), expected));
+    }
+
+    return report.exit_code();
+}
@@ -0,0 +1,91 @@
+#include "test_utils.h"
+
+#include <module/module.h>
+#include <module/menu.h>
+#include <runtime/workbench.h>
+#include <compiler/tuner.h>
+#include <backend/name.h>
+#include <core/tensor_builder.h>
+
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace ts;
+using namespace ts::test;
+
+/**
+ * 3x3 conv, 1x1 conv, then inner_prod
+ */
+static Module::shared build_net(const Tensor &w3x3, const Tensor &w1x1, const Tensor &fc) {
+    Graph g;
+    ctx::bind<Graph> _bind_graph(g);
+    auto x = bubble::param("x", FLOAT32, {1, 32, 28, 28});
+    auto conv3x3 = conv2d("conv3x3", x, w3x3, 1);
+    auto conv1x1 = conv2d("conv1x1", conv3x3, w1x1, 0);
+    auto flatten = bubble::op("flatten", name::layer::flatten(), {conv1x1});
+    auto w = bubble::data("fc_w", fc);
+    auto y = bubble::op("fc", name::layer::inner_prod(), {flatten, w});
+    auto module = std::make_shared<Module>();
+    module->load(g, {y});
+    return module;
+}
+
+static Tensor run(const std::string &options, const Tensor &x, double &compile_ms) {
+    // compiling packs consts in place, so build net each time
+    static auto w3x3 = random_tensor({64, 32, 3, 3}, 1);
+    static auto w1x1 = random_tensor({16, 64, 1, 1}, 2);
+    static auto fc = random_tensor({16 * 28 * 28, 10}, 3);
+    auto module = build_net(w3x3.clone(), w1x1.clone(), fc.clone());
+
+    Workbench bench(ComputingDevice(CPU), 1);
+    auto start = std::chrono::steady_clock::now();
+    auto program = bench.compile(module, options);
+    std::chrono::duration<double, std::milli> spent = std::chrono::steady_clock::now() - start;
+    compile_ms = spent.count();
+
+    bench.setup(program);
+    bench.input(0, x);
+    bench.run();
+    return bench.output(0).clone();
+}
+
+int main() {
+    Report report;
+
+    // cache starts empty, and is removed when test ends
+    TempFile file("tuner.tuning");
+    const auto &cache = file.path();
+    std::remove(cache.c_str());
+    Tuner::SetCacheFile(cache);
+
+    auto x = random_tensor({1, 32, 28, 28}, 4);
+
+    double default_ms, tune_ms, cached_ms;
+    auto expected = run("", x, default_ms);
+    auto tuned = run("--tune", x, tune_ms);
+    report("tuned output", near(tuned, expected, 1e-3f));
+    report("cache written", std::ifstream(cache).good());
+
+    auto cached = run("--tune", x, cached_ms);
+    report("cached output", near(cached, expected, 1e-3f));
+    report("cached compile faster", cached_ms < tune_ms);
+
+    std::cout << "compile: default " << default_ms << "ms, tune " << tune_ms << "ms, cached " << cached_ms << "ms" << std::endl;
+    std::cout << std::ifstream(cache).rdbuf();
+
+    // no cache file unless set, nothing written in working directory
+    Tuner::SetCacheFile("");
+    if (std::getenv("TS_TUNING_CACHE") == nullptr) {
+        double uncached_ms;
+        auto uncached = run("--tune", x, uncached_ms);
+        report("tune without cache file", near(uncached, expected, 1e-3f) && Tuner::GetCacheFile().empty() &&
+                                          !std::ifstream("tennis.tuning").good());
+    }
+
+    return report.exit_code();
+}